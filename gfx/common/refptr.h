@@ -30,6 +30,19 @@ class RefCounted {
 
   void AddRef() const { ref_count_.fetch_add(1, std::memory_order_relaxed); }
 
+  // Adds a reference only if the object is still alive, used by weak caches
+  // which may observe an object whose last reference is being released.
+  bool TryAddRef() const {
+    CountTy count = ref_count_.load(std::memory_order_relaxed);
+    while (count != 0) {
+      if (ref_count_.compare_exchange_weak(count, count + 1,
+                                           std::memory_order_acquire,
+                                           std::memory_order_relaxed))
+        return true;
+    }
+    return false;
+  }
+
   bool Release() const {
     if (ref_count_.fetch_sub(1, std::memory_order_release) == 1) {
       // Acquire fence ensures that the destructor sees all changes
@@ -31,6 +31,12 @@ static constexpr std::array<DeviceExtInfo, GFXAdapter::kExtensionNums>
         DeviceExtInfo{GFXAdapter::kSwapchain, VK_KHR_SWAPCHAIN_EXTENSION_NAME},
         DeviceExtInfo{GFXAdapter::kDepthClipEnable,
                       VK_EXT_DEPTH_CLIP_ENABLE_EXTENSION_NAME},
+        DeviceExtInfo{GFXAdapter::kImageFormatList,
+                      VK_KHR_IMAGE_FORMAT_LIST_EXTENSION_NAME},
+        DeviceExtInfo{GFXAdapter::kImagelessFramebuffer,
+                      VK_KHR_IMAGELESS_FRAMEBUFFER_EXTENSION_NAME},
+        DeviceExtInfo{GFXAdapter::kTimelineSemaphore,
+                      VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME},
     };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -132,6 +138,20 @@ void GFXAdapter::ConfigureAdapterInternal() {
           &device_info_.shader_integer_dot_product_features);
     }
 
+    // VK_KHR_imageless_framebuffer
+    if (extensions_[DeviceExtension::kImagelessFramebuffer]) {
+      device_info_.imageless_framebuffer_features = {
+          VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_IMAGELESS_FRAMEBUFFER_FEATURES_KHR};
+      features_chain_builder.Add(&device_info_.imageless_framebuffer_features);
+    }
+
+    // VK_KHR_timeline_semaphore
+    if (extensions_[DeviceExtension::kTimelineSemaphore]) {
+      device_info_.timeline_semaphore_features = {
+          VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES_KHR};
+      features_chain_builder.Add(&device_info_.timeline_semaphore_features);
+    }
+
     vkGetPhysicalDeviceFeatures2(adapter_, &device_info_.features);
   }
 }
@@ -472,6 +492,24 @@ WGPUFuture GFXAdapter::RequestDevice(
 #undef CHECK_FEATURE
   }
 
+  // Render pass framebuffers, independent of WebGPU features
+  if (SupportsImagelessFramebuffer()) {
+    features_knobs.imageless_framebuffer_features =
+        device_info_.imageless_framebuffer_features;
+    features_knobs.imageless_framebuffer_features.pNext = nullptr;
+    NextChainBuilder(&enabled_features)
+        .Add(&features_knobs.imageless_framebuffer_features);
+  }
+
+  // Queue submission serials
+  if (SupportsTimelineSemaphore()) {
+    features_knobs.timeline_semaphore_features =
+        device_info_.timeline_semaphore_features;
+    features_knobs.timeline_semaphore_features.pNext = nullptr;
+    NextChainBuilder(&enabled_features)
+        .Add(&features_knobs.timeline_semaphore_features);
+  }
+
   // Queue family select
   uint32_t main_queue_family = UINT32_MAX;
   {
@@ -520,7 +558,8 @@ WGPUFuture GFXAdapter::RequestDevice(
 
     GFXDevice* device_impl = nullptr;
     if (device)
-      device_impl = new GFXDevice(device, this, descriptor->label,
+      device_impl = new GFXDevice(device, main_queue_family, this,
+                                  descriptor->label,
                                   descriptor->deviceLostCallbackInfo,
                                   descriptor->uncapturedErrorCallbackInfo);
 
@@ -530,6 +569,17 @@ WGPUFuture GFXAdapter::RequestDevice(
   return GFXInstance::kImmediateFuture;
 }
 
+bool GFXAdapter::SupportsImagelessFramebuffer() const {
+  // VK_KHR_imageless_framebuffer depends on VK_KHR_image_format_list
+  return extensions_[kImagelessFramebuffer] && extensions_[kImageFormatList] &&
+         device_info_.imageless_framebuffer_features.imagelessFramebuffer;
+}
+
+bool GFXAdapter::SupportsTimelineSemaphore() const {
+  return extensions_[kTimelineSemaphore] &&
+         device_info_.timeline_semaphore_features.timelineSemaphore;
+}
+
 // https://www.w3.org/TR/webgpu/#feature-index
 std::vector<WGPUFeatureName> GFXAdapter::GetAdapterFeatures() {
   VkFormatProperties format_properties;
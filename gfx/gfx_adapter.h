@@ -28,6 +28,9 @@ class GFXAdapter : public RefCounted<GFXAdapter>, public WGPUAdapterImpl {
     kShaderIntegerDotProduct,         // promoted to 1.3
     kSwapchain,                       // never promoted
     kDepthClipEnable,                 // never promoted
+    kImageFormatList,                 // promoted to 1.2
+    kImagelessFramebuffer,            // promoted to 1.2
+    kTimelineSemaphore,               // promoted to 1.2
     kExtensionNums,
   };
 
@@ -59,6 +62,11 @@ class GFXAdapter : public RefCounted<GFXAdapter>, public WGPUAdapterImpl {
     // VK_KHR_shader_integer_dot_product
     VkPhysicalDeviceShaderIntegerDotProductFeaturesKHR
         shader_integer_dot_product_features;
+    // VK_KHR_imageless_framebuffer
+    VkPhysicalDeviceImagelessFramebufferFeaturesKHR
+        imageless_framebuffer_features;
+    // VK_KHR_timeline_semaphore
+    VkPhysicalDeviceTimelineSemaphoreFeaturesKHR timeline_semaphore_features;
   };
 
   struct DeviceInfo : public DeviceProperties, public DeviceFeatures {};
@@ -73,6 +81,11 @@ class GFXAdapter : public RefCounted<GFXAdapter>, public WGPUAdapterImpl {
 
   RefPtr<GFXInstance> GetInstance() const { return instance_; }
   const DeviceInfo& GetDeviceInfo() const { return device_info_; }
+  // Imageless framebuffers are enabled on every device when supported
+  bool SupportsImagelessFramebuffer() const;
+  // Queues track their submissions with a timeline semaphore when supported,
+  // with fences otherwise
+  bool SupportsTimelineSemaphore() const;
 
  public:
   void GetFeatures(WGPUSupportedFeatures* features);
@@ -0,0 +1,51 @@
+// Copyright 2025 Admenri.
+// Use of this source code is governed by a MIT-style license that can be
+// found in the LICENSE file.
+
+#include "gfx/gfx_barrier_batch.h"
+
+namespace vkgfx {
+
+///////////////////////////////////////////////////////////////////////////////
+// GFXBarrierBatch Implement
+
+void GFXBarrierBatch::AddBufferBarrier(const VkBufferMemoryBarrier& barrier,
+                                       VkPipelineStageFlags src_stages,
+                                       VkPipelineStageFlags dst_stages) {
+  buffer_barriers_.push_back(barrier);
+  src_stages_ |= src_stages;
+  dst_stages_ |= dst_stages;
+}
+
+void GFXBarrierBatch::AddImageBarrier(const VkImageMemoryBarrier& barrier,
+                                      VkPipelineStageFlags src_stages,
+                                      VkPipelineStageFlags dst_stages) {
+  image_barriers_.push_back(barrier);
+  src_stages_ |= src_stages;
+  dst_stages_ |= dst_stages;
+}
+
+void GFXBarrierBatch::Record(VkCommandBuffer command_buffer) {
+  if (IsEmpty())
+    return;
+
+  // Nothing to wait for is expressed with the top of the pipe
+  VkPipelineStageFlags src_stages =
+      src_stages_ ? src_stages_
+                  : static_cast<VkPipelineStageFlags>(
+                        VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT);
+  VkPipelineStageFlags dst_stages =
+      dst_stages_ ? dst_stages_
+                  : static_cast<VkPipelineStageFlags>(
+                        VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
+  vkCmdPipelineBarrier(command_buffer, src_stages, dst_stages, 0, 0, nullptr,
+                       buffer_barriers_.size(), buffer_barriers_.data(),
+                       image_barriers_.size(), image_barriers_.data());
+
+  src_stages_ = 0;
+  dst_stages_ = 0;
+  buffer_barriers_.clear();
+  image_barriers_.clear();
+}
+
+}  // namespace vkgfx
@@ -0,0 +1,60 @@
+// Copyright 2025 Admenri.
+// Use of this source code is governed by a MIT-style license that can be
+// found in the LICENSE file.
+
+#ifndef GFX_GFX_BARRIER_BATCH_H_
+#define GFX_GFX_BARRIER_BATCH_H_
+
+#include <vector>
+
+#include "gfx/gfx_config.h"
+
+namespace vkgfx {
+
+// Accesses making a usage a write for hazard tracking
+constexpr VkAccessFlags kWriteAccessMask =
+    VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT |
+    VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT |
+    VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_HOST_WRITE_BIT |
+    VK_ACCESS_MEMORY_WRITE_BIT;
+
+// Barriers collected by the resource state trackers for one synchronization
+// point, recorded together with a single vkCmdPipelineBarrier.
+class GFXBarrierBatch {
+ public:
+  GFXBarrierBatch() = default;
+  ~GFXBarrierBatch() = default;
+
+  GFXBarrierBatch(const GFXBarrierBatch&) = delete;
+  GFXBarrierBatch& operator=(const GFXBarrierBatch&) = delete;
+
+  void AddBufferBarrier(const VkBufferMemoryBarrier& barrier,
+                        VkPipelineStageFlags src_stages,
+                        VkPipelineStageFlags dst_stages);
+  void AddImageBarrier(const VkImageMemoryBarrier& barrier,
+                       VkPipelineStageFlags src_stages,
+                       VkPipelineStageFlags dst_stages);
+
+  bool IsEmpty() const {
+    return buffer_barriers_.empty() && image_barriers_.empty();
+  }
+  const std::vector<VkBufferMemoryBarrier>& GetBufferBarriers() const {
+    return buffer_barriers_;
+  }
+  const std::vector<VkImageMemoryBarrier>& GetImageBarriers() const {
+    return image_barriers_;
+  }
+
+  // Records and clears the batch, no-op when empty.
+  void Record(VkCommandBuffer command_buffer);
+
+ private:
+  VkPipelineStageFlags src_stages_ = 0;
+  VkPipelineStageFlags dst_stages_ = 0;
+  std::vector<VkBufferMemoryBarrier> buffer_barriers_;
+  std::vector<VkImageMemoryBarrier> image_barriers_;
+};
+
+}  // namespace vkgfx
+
+#endif  // GFX_GFX_BARRIER_BATCH_H_
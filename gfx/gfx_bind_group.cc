@@ -4,6 +4,11 @@
 
 #include "gfx/gfx_bind_group.h"
 
+#include <array>
+#include <string>
+
+#include "gfx/common/log.h"
+#include "gfx/gfx_bind_group_cache.h"
 #include "gfx/gfx_bind_group_layout.h"
 #include "gfx/gfx_buffer.h"
 #include "gfx/gfx_utils.h"
@@ -13,71 +18,185 @@ namespace vkgfx {
 ///////////////////////////////////////////////////////////////////////////////
 // GFXBindGroup Implement
 
-GFXBindGroup::GFXBindGroup(VkDescriptorPool descriptor_pool,
-                           VkDescriptorSet descriptor_set,
+GFXBindGroup::GFXBindGroup(const GFXDescriptorAllocator::Allocation& allocation,
+                           RefPtr<GFXBindGroupLayout> layout,
                            RefPtr<GFXDevice> device,
                            WGPUStringView label)
-    : descriptor_pool_(descriptor_pool),
-      descriptor_set_(descriptor_set),
-      device_(device) {
+    : allocation_(allocation), layout_(layout), device_(device) {
   if (label.data && label.length)
     label_ = std::string(label.data, label.length);
 }
 
 GFXBindGroup::~GFXBindGroup() {
-  // Implicit release of DescriptorSet
-  if (descriptor_pool_)
-    vkDestroyDescriptorPool(device_->GetVkHandle(), descriptor_pool_, nullptr);
+  if (device_ && device_->GetBindGroupCache())
+    device_->GetBindGroupCache()->Remove(this);
+
+  // Recycle set into the layout slab once no submission reads it
+  auto* descriptor_allocator =
+      device_ ? device_->GetDescriptorAllocator() : nullptr;
+  if (descriptor_allocator && device_->GetResourceTracker())
+    device_->GetResourceTracker()->ReleaseDescriptorSet(
+        descriptor_allocator, layout_.get(), allocation_, last_usage_serial_);
+  else if (descriptor_allocator)
+    descriptor_allocator->Free(layout_.get(), allocation_);
+}
+
+void GFXBindGroup::SetLastUsageSerial(uint64_t serial) {
+  last_usage_serial_ = serial;
+
+  // Samplers are only ever used through bind groups
+  for (const auto& it : resources_)
+    if (it.sampler)
+      it.sampler->SetLastUsageSerial(serial);
 }
 
 void GFXBindGroup::SetLabel(WGPUStringView label) {
   label_ = std::string(label.data, label.length);
 }
 
-void GFXBindGroup::Write(const WGPUBindGroupDescriptor* descriptor) {
-  /*if (!descriptor)
-    return;
+bool GFXBindGroup::Write(const WGPUBindGroupDescriptor* descriptor) {
+  if (!descriptor)
+    return false;
 
-  if (!descriptor->layout)
-    return;
+  const uint32_t slot_count = layout_->GetLayoutEntries().size();
+  if (descriptor->entryCount != slot_count) {
+    device_->CallDeviceErrorCallback(
+        WGPUErrorType_Validation,
+        "Bind group entry count does not match the layout.");
+    return false;
+  }
+
+  if (!slot_count)
+    return true;
+
+  if (!layout_->GetUpdateTemplate()) {
+    GFX_ERROR() << __FUNCTION__ << ": Missing descriptor update template.";
+    return false;
+  }
 
-  auto* bind_group_layout =
-      static_cast<GFXBindGroupLayout*>(descriptor->layout);
-  auto layout_entries = bind_group_layout->GetLayoutEntries();
+  // Flat payload in layout slot order, no heap allocation in the common case.
+  // Larger layouts reuse a per thread arena.
+  using DescriptorInfo = GFXBindGroupLayout::DescriptorInfo;
+  std::array<DescriptorInfo, kInlinePayloadSize> inline_payload;
+  DescriptorInfo* payload = inline_payload.data();
+  if (slot_count > kInlinePayloadSize) {
+    thread_local std::vector<DescriptorInfo> payload_arena;
+    if (payload_arena.size() < slot_count)
+      payload_arena.resize(slot_count);
+    payload = payload_arena.data();
+  }
 
-  std::vector<VkWriteDescriptorSet> write_infos;
+  resources_.resize(slot_count);
   for (size_t i = 0; i < descriptor->entryCount; ++i) {
     const auto& descriptor_entry = descriptor->entries[i];
 
-    VkWriteDescriptorSet write_info = {VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET};
-    write_info.dstSet = descriptor_set_;
-    write_info.dstBinding = descriptor_entry.binding;
-    write_info.dstArrayElement = 0;
-    write_info.descriptorCount = 1;
-    write_info.descriptorType = ;
+    const uint32_t slot = layout_->GetBindingSlot(descriptor_entry.binding);
+    if (slot == GFXBindGroupLayout::kInvalidSlot) {
+      device_->CallDeviceErrorCallback(
+          WGPUErrorType_Validation,
+          "Bind group entry binding " +
+              std::to_string(descriptor_entry.binding) +
+              " is not present in the layout.");
+      return false;
+    }
+
+    auto& payload_info = payload[slot];
+    auto& resource = resources_[slot];
+    if (resource.buffer || resource.sampler || resource.texture_view) {
+      device_->CallDeviceErrorCallback(
+          WGPUErrorType_Validation,
+          "Bind group entry binding " +
+              std::to_string(descriptor_entry.binding) + " is duplicated.");
+      return false;
+    }
+    const auto descriptor_type = layout_->GetSlotDescriptorType(slot);
 
     if (descriptor_entry.buffer) {
-      auto* buffer_info = new VkDescriptorBufferInfo{};
-      buffer_info->buffer = ;
-      buffer_info->offset = descriptor_entry.offset;
-      buffer_info->range = descriptor_entry.size;
-      write_info.pBufferInfo = buffer_info;
+      auto* buffer = static_cast<GFXBuffer*>(descriptor_entry.buffer);
+      resource.buffer = buffer;
+
+      // Suballocated buffers share their VkBuffer, never bind to its end
+      payload_info.buffer.buffer = buffer->GetVkHandle();
+      payload_info.buffer.offset =
+          buffer->GetOffset() + descriptor_entry.offset;
+      payload_info.buffer.range =
+          descriptor_entry.size == WGPU_WHOLE_SIZE
+              ? buffer->GetSize() - descriptor_entry.offset
+              : descriptor_entry.size;
     } else if (descriptor_entry.sampler) {
-      auto* sampler_info = new VkDescriptorImageInfo{};
-      sampler_info->sampler = ;
-      write_info.pImageInfo = sampler_info;
+      auto* sampler = static_cast<GFXSampler*>(descriptor_entry.sampler);
+      resource.sampler = sampler;
+
+      payload_info.image = {};
+      payload_info.image.sampler = sampler->GetVkHandle();
     } else if (descriptor_entry.textureView) {
-      auto* image_info = new VkDescriptorImageInfo{};
-      image_info->imageView = ;
-      image_info->imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-      write_info.pImageInfo = image_info;
+      auto* texture_view =
+          static_cast<GFXTextureView*>(descriptor_entry.textureView);
+      resource.texture_view = texture_view;
+
+      payload_info.image = {};
+      payload_info.image.imageView = texture_view->GetVkHandle();
+      if (descriptor_type == VK_DESCRIPTOR_TYPE_STORAGE_IMAGE) {
+        payload_info.image.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+      } else if (ToVulkanImageAspect(WGPUTextureAspect_All,
+                                     texture_view->GetFormat()) &
+                 (VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT)) {
+        payload_info.image.imageLayout =
+            VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
+      } else {
+        payload_info.image.imageLayout =
+            VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+      }
+    } else {
+      device_->CallDeviceErrorCallback(
+          WGPUErrorType_Validation,
+          "Bind group entry binding " +
+              std::to_string(descriptor_entry.binding) +
+              " has no resource.");
+      return false;
+    }
+  }
+
+  vkUpdateDescriptorSetWithTemplate(device_->GetVkHandle(), allocation_.set,
+                                    layout_->GetUpdateTemplate(), payload);
+
+  // Slots follow the binding order dynamic offsets are given in
+  auto layout_entries = layout_->GetLayoutEntries();
+  for (uint32_t slot = 0; slot < slot_count; ++slot) {
+    if (resources_[slot].texture_view) {
+      TextureBinding binding;
+      binding.view = resources_[slot].texture_view.get();
+      binding.layout = payload[slot].image.imageLayout;
+      switch (layout_entries[slot].main.storageTexture.access) {
+        case WGPUStorageTextureAccess_WriteOnly:
+          binding.access = VK_ACCESS_SHADER_WRITE_BIT;
+          break;
+        case WGPUStorageTextureAccess_ReadWrite:
+          binding.access =
+              VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+          break;
+        default:
+          binding.access = VK_ACCESS_SHADER_READ_BIT;
+          break;
+      }
+      texture_bindings_.push_back(binding);
+      continue;
     }
 
-    write_infos.push_back(write_info);
+    if (!resources_[slot].buffer)
+      continue;
+
+    const auto& buffer_layout = layout_entries[slot].main.buffer;
+    BufferBinding binding;
+    binding.buffer = resources_[slot].buffer.get();
+    binding.offset = payload[slot].buffer.offset - binding.buffer->GetOffset();
+    binding.size = payload[slot].buffer.range;
+    binding.type = buffer_layout.type;
+    binding.has_dynamic_offset = buffer_layout.hasDynamicOffset;
+    buffer_bindings_.push_back(binding);
   }
 
-  vkUpdateDescriptorSets(device_->GetVkHandle(), write_infos.size(),
-                         write_infos.data(), 0, nullptr);*/
+  return true;
 }
 
 }  // namespace vkgfx
@@ -5,9 +5,17 @@
 #ifndef GFX_GFX_BIND_GROUP_H_
 #define GFX_GFX_BIND_GROUP_H_
 
+#include <atomic>
+#include <vector>
+
 #include "gfx/common/refptr.h"
+#include "gfx/gfx_bind_group_layout.h"
+#include "gfx/gfx_buffer.h"
 #include "gfx/gfx_config.h"
+#include "gfx/gfx_descriptor_allocator.h"
 #include "gfx/gfx_device.h"
+#include "gfx/gfx_sampler.h"
+#include "gfx/gfx_texture_view.h"
 
 struct WGPUBindGroupImpl {};
 
@@ -16,8 +24,26 @@ namespace vkgfx {
 // https://gpuweb.github.io/gpuweb/#gpubindgroup
 class GFXBindGroup : public RefCounted<GFXBindGroup>, public WGPUBindGroupImpl {
  public:
-  GFXBindGroup(VkDescriptorPool descriptor_pool,
-               VkDescriptorSet descriptor_set,
+  // Buffer entry as seen by hazard tracking, in binding order. Entries with
+  // a dynamic offset are shifted by the offset given to SetBindGroup.
+  struct BufferBinding {
+    GFXBuffer* buffer;
+    uint64_t offset;
+    uint64_t size;
+    WGPUBufferBindingType type;
+    bool has_dynamic_offset;
+  };
+
+  // Texture entry as seen by hazard tracking, in binding order, with the
+  // layout its descriptor was written with.
+  struct TextureBinding {
+    GFXTextureView* view;
+    VkImageLayout layout;
+    VkAccessFlags access;
+  };
+
+  GFXBindGroup(const GFXDescriptorAllocator::Allocation& allocation,
+               RefPtr<GFXBindGroupLayout> layout,
                RefPtr<GFXDevice> device,
                WGPUStringView label);
   ~GFXBindGroup();
@@ -25,17 +51,45 @@ class GFXBindGroup : public RefCounted<GFXBindGroup>, public WGPUBindGroupImpl {
   GFXBindGroup(const GFXBindGroup&) = delete;
   GFXBindGroup& operator=(const GFXBindGroup&) = delete;
 
-  VkDescriptorSet GetVkHandle() const { return descriptor_set_; }
+  VkDescriptorSet GetVkHandle() const { return allocation_.set; }
+  GFXBindGroupLayout* GetLayout() const { return layout_.get(); }
+  const std::vector<BufferBinding>& GetBufferBindings() const {
+    return buffer_bindings_;
+  }
+  const std::vector<TextureBinding>& GetTextureBindings() const {
+    return texture_bindings_;
+  }
+  // Serial of the last submission using the bind group, the descriptor set
+  // is recycled once it completed. Setting it stamps the bound samplers too.
+  uint64_t GetLastUsageSerial() const { return last_usage_serial_; }
+  void SetLastUsageSerial(uint64_t serial);
 
   void SetLabel(WGPUStringView label);
-  void Write(const WGPUBindGroupDescriptor* descriptor);
+  // Fills the descriptor set through the layout update template, returns
+  // false on validation failure.
+  bool Write(const WGPUBindGroupDescriptor* descriptor);
 
  private:
-  VkDescriptorPool descriptor_pool_;
-  VkDescriptorSet descriptor_set_;
+  // Payloads up to this many entries are packed on the stack
+  static constexpr uint32_t kInlinePayloadSize = 16;
 
+  struct BoundResource {
+    RefPtr<GFXBuffer> buffer;
+    RefPtr<GFXSampler> sampler;
+    RefPtr<GFXTextureView> texture_view;
+  };
+
+  GFXDescriptorAllocator::Allocation allocation_;
+
+  RefPtr<GFXBindGroupLayout> layout_;
   RefPtr<GFXDevice> device_;
 
+  // Bound resources are kept alive by the bind group, indexed by layout slot
+  std::vector<BoundResource> resources_;
+  std::vector<BufferBinding> buffer_bindings_;
+  std::vector<TextureBinding> texture_bindings_;
+  std::atomic<uint64_t> last_usage_serial_ = 0;
+
   std::string label_ = "GFX.BindGroup";
 };
 
@@ -0,0 +1,152 @@
+// Copyright 2025 Admenri.
+// Use of this source code is governed by a MIT-style license that can be
+// found in the LICENSE file.
+
+#include "gfx/gfx_bind_group_cache.h"
+
+#include <algorithm>
+
+#include "gfx/gfx_bind_group.h"
+#include "gfx/gfx_buffer.h"
+#include "gfx/gfx_texture_view.h"
+#include "gfx/gfx_utils.h"
+
+namespace vkgfx {
+
+///////////////////////////////////////////////////////////////////////////////
+// GFXBindGroupCache Implement
+
+bool GFXBindGroupCache::Key::operator==(const Key& other) const {
+  if (hash != other.hash || layout != other.layout ||
+      entries.size() != other.entries.size())
+    return false;
+
+  for (size_t i = 0; i < entries.size(); ++i) {
+    const auto& lhs = entries[i];
+    const auto& rhs = other.entries[i];
+    if (lhs.binding != rhs.binding || lhs.buffer != rhs.buffer ||
+        lhs.offset != rhs.offset || lhs.size != rhs.size ||
+        lhs.sampler != rhs.sampler || lhs.textureView != rhs.textureView)
+      return false;
+  }
+
+  return true;
+}
+
+// static
+GFXBindGroupCache::Key GFXBindGroupCache::MakeKey(
+    const WGPUBindGroupDescriptor* descriptor) {
+  Key key;
+  key.layout = static_cast<GFXBindGroupLayout*>(descriptor->layout);
+  key.entries.reserve(descriptor->entryCount);
+
+  for (size_t i = 0; i < descriptor->entryCount; ++i) {
+    WGPUBindGroupEntry entry = descriptor->entries[i];
+    entry.nextInChain = nullptr;
+
+    // Same range expressed with an explicit size
+    if (entry.buffer && entry.size == WGPU_WHOLE_SIZE) {
+      auto* buffer = static_cast<GFXBuffer*>(entry.buffer);
+      entry.size = buffer->GetSize() - entry.offset;
+    }
+
+    key.entries.push_back(entry);
+  }
+
+  std::sort(key.entries.begin(), key.entries.end(),
+            [](const WGPUBindGroupEntry& lhs, const WGPUBindGroupEntry& rhs) {
+              return lhs.binding < rhs.binding;
+            });
+
+  HashCombine(&key.hash, static_cast<const void*>(key.layout));
+  for (const auto& it : key.entries) {
+    HashCombine(&key.hash, it.binding);
+    HashCombine(&key.hash, static_cast<const void*>(it.buffer));
+    HashCombine(&key.hash, it.offset);
+    HashCombine(&key.hash, it.size);
+    HashCombine(&key.hash, static_cast<const void*>(it.sampler));
+    HashCombine(&key.hash, static_cast<const void*>(it.textureView));
+  }
+
+  return key;
+}
+
+GFXBindGroup* GFXBindGroupCache::Find(const Key& key) {
+  std::lock_guard guard(lock_);
+  auto it = bind_groups_.find(key);
+  if (it == bind_groups_.end())
+    return nullptr;
+
+  // The last reference may be released concurrently, treat it as a miss
+  if (!it->second->TryAddRef())
+    return nullptr;
+
+  return it->second;
+}
+
+void GFXBindGroupCache::Insert(Key key, GFXBindGroup* bind_group) {
+  Record record;
+  for (const auto& it : key.entries) {
+    if (it.buffer)
+      record.resources.push_back(it.buffer);
+    if (it.sampler)
+      record.resources.push_back(it.sampler);
+    if (it.textureView) {
+      auto* texture_view = static_cast<GFXTextureView*>(it.textureView);
+      record.resources.push_back(texture_view);
+      record.resources.push_back(texture_view->GetTexture());
+    }
+  }
+
+  std::lock_guard guard(lock_);
+  for (auto* resource : record.resources)
+    resource_index_.emplace(resource, bind_group);
+
+  bind_groups_[key] = bind_group;
+  record.key = std::move(key);
+  records_[bind_group] = std::move(record);
+}
+
+void GFXBindGroupCache::Remove(GFXBindGroup* bind_group) {
+  std::lock_guard guard(lock_);
+  RemoveLocked(bind_group);
+}
+
+void GFXBindGroupCache::EvictResource(const void* resource) {
+  std::lock_guard guard(lock_);
+  auto range = resource_index_.equal_range(resource);
+  if (range.first == range.second)
+    return;
+
+  std::vector<GFXBindGroup*> evicted;
+  for (auto it = range.first; it != range.second; ++it)
+    evicted.push_back(it->second);
+
+  for (auto* bind_group : evicted)
+    RemoveLocked(bind_group);
+}
+
+void GFXBindGroupCache::RemoveLocked(GFXBindGroup* bind_group) {
+  auto record = records_.find(bind_group);
+  if (record == records_.end())
+    return;
+
+  // A newer bind group may have replaced this one under the same key
+  auto it = bind_groups_.find(record->second.key);
+  if (it != bind_groups_.end() && it->second == bind_group)
+    bind_groups_.erase(it);
+
+  for (auto* resource : record->second.resources) {
+    auto range = resource_index_.equal_range(resource);
+    for (auto iter = range.first; iter != range.second; ++iter) {
+      if (iter->second == bind_group) {
+        resource_index_.erase(iter);
+        break;
+      }
+    }
+  }
+
+  records_.erase(record);
+}
+
+}  // namespace vkgfx
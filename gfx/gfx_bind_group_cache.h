@@ -0,0 +1,74 @@
+// Copyright 2025 Admenri.
+// Use of this source code is governed by a MIT-style license that can be
+// found in the LICENSE file.
+
+#ifndef GFX_GFX_BIND_GROUP_CACHE_H_
+#define GFX_GFX_BIND_GROUP_CACHE_H_
+
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "gfx/gfx_config.h"
+
+namespace vkgfx {
+
+class GFXBindGroup;
+class GFXBindGroupLayout;
+
+// Device level cache of bind groups keyed on layout and entries.
+// The cache holds weak references only: a bind group removes itself on
+// destruction, and entries referencing a destroyed buffer, texture, texture
+// view or sampler are evicted so they are never handed out again.
+class GFXBindGroupCache {
+ public:
+  struct Key {
+    GFXBindGroupLayout* layout = nullptr;
+    // Sorted by binding, resource fields only
+    std::vector<WGPUBindGroupEntry> entries;
+    size_t hash = 0;
+
+    bool operator==(const Key& other) const;
+  };
+
+  GFXBindGroupCache() = default;
+  ~GFXBindGroupCache() = default;
+
+  GFXBindGroupCache(const GFXBindGroupCache&) = delete;
+  GFXBindGroupCache& operator=(const GFXBindGroupCache&) = delete;
+
+  static Key MakeKey(const WGPUBindGroupDescriptor* descriptor);
+
+  // Returns a cached bind group with an extra reference, or null.
+  GFXBindGroup* Find(const Key& key);
+
+  // Publishes |bind_group| which must hold a reference already.
+  void Insert(Key key, GFXBindGroup* bind_group);
+
+  // Called by bind group destruction.
+  void Remove(GFXBindGroup* bind_group);
+
+  // Evicts every bind group referencing |resource|.
+  void EvictResource(const void* resource);
+
+ private:
+  struct KeyHash {
+    size_t operator()(const Key& key) const { return key.hash; }
+  };
+
+  struct Record {
+    Key key;
+    std::vector<const void*> resources;
+  };
+
+  void RemoveLocked(GFXBindGroup* bind_group);
+
+  std::mutex lock_;
+  std::unordered_map<Key, GFXBindGroup*, KeyHash> bind_groups_;
+  std::unordered_map<GFXBindGroup*, Record> records_;
+  std::unordered_multimap<const void*, GFXBindGroup*> resource_index_;
+};
+
+}  // namespace vkgfx
+
+#endif  // GFX_GFX_BIND_GROUP_CACHE_H_
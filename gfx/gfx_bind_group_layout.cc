@@ -4,7 +4,10 @@
 
 #include "gfx/gfx_bind_group_layout.h"
 
+#include <algorithm>
+
 #include "gfx/gfx_device.h"
+#include "gfx/gfx_utils.h"
 
 namespace vkgfx {
 
@@ -18,9 +21,39 @@ GFXBindGroupLayout::GFXBindGroupLayout(VkDescriptorSetLayout layout,
     : layout_(layout), entries_(entries), device_(device) {
   if (label.data && label.length)
     label_ = std::string(label.data, label.length);
+
+  std::sort(entries_.begin(), entries_.end(),
+            [](const LayoutEntry& lhs, const LayoutEntry& rhs) {
+              return lhs.main.binding < rhs.main.binding;
+            });
+
+  for (const auto& it : entries_) {
+    auto descriptor_type = ToVulkanDescriptorType(it.main);
+    auto iter = std::find_if(pool_sizes_.begin(), pool_sizes_.end(),
+                             [&](const VkDescriptorPoolSize& it) {
+                               return it.type == descriptor_type;
+                             });
+
+    auto descriptor_count = std::max<uint32_t>(1, it.main.bindingArraySize);
+    if (iter != pool_sizes_.end()) {
+      iter->descriptorCount += descriptor_count;
+    } else {
+      pool_sizes_.push_back(
+          VkDescriptorPoolSize{descriptor_type, descriptor_count});
+    }
+  }
+
+  CreateUpdateTemplateInternal();
 }
 
 GFXBindGroupLayout::~GFXBindGroupLayout() {
+  if (device_ && device_->GetLayoutCache())
+    device_->GetLayoutCache()->RemoveBindGroupLayout(this);
+  if (device_ && device_->GetDescriptorAllocator())
+    device_->GetDescriptorAllocator()->ReleaseLayout(this);
+  if (update_template_ && device_)
+    vkDestroyDescriptorUpdateTemplate(device_->GetVkHandle(), update_template_,
+                                      nullptr);
   if (layout_ && device_)
     vkDestroyDescriptorSetLayout(device_->GetVkHandle(), layout_, nullptr);
 }
@@ -29,6 +62,43 @@ void GFXBindGroupLayout::SetLabel(WGPUStringView label) {
   label_ = std::string(label.data, label.length);
 }
 
+void GFXBindGroupLayout::CreateUpdateTemplateInternal() {
+  if (entries_.empty())
+    return;
+
+  std::vector<VkDescriptorUpdateTemplateEntry> template_entries;
+  for (size_t i = 0; i < entries_.size(); ++i) {
+    const auto& entry = entries_[i].main;
+    const uint32_t slot = static_cast<uint32_t>(i);
+
+    if (entry.binding >= binding_slots_.size())
+      binding_slots_.resize(entry.binding + 1, kInvalidSlot);
+    binding_slots_[entry.binding] = slot;
+    descriptor_types_.push_back(ToVulkanDescriptorType(entry));
+
+    VkDescriptorUpdateTemplateEntry template_entry = {};
+    template_entry.dstBinding = entry.binding;
+    template_entry.dstArrayElement = 0;
+    template_entry.descriptorCount = 1;
+    template_entry.descriptorType = descriptor_types_.back();
+    template_entry.offset = slot * sizeof(DescriptorInfo);
+    template_entry.stride = sizeof(DescriptorInfo);
+    template_entries.push_back(template_entry);
+  }
+
+  VkDescriptorUpdateTemplateCreateInfo create_info = {
+      VK_STRUCTURE_TYPE_DESCRIPTOR_UPDATE_TEMPLATE_CREATE_INFO};
+  create_info.descriptorUpdateEntryCount = template_entries.size();
+  create_info.pDescriptorUpdateEntries = template_entries.data();
+  create_info.templateType = VK_DESCRIPTOR_UPDATE_TEMPLATE_TYPE_DESCRIPTOR_SET;
+  create_info.descriptorSetLayout = layout_;
+
+  if (vkCreateDescriptorUpdateTemplate(device_->GetVkHandle(), &create_info,
+                                       nullptr,
+                                       &update_template_) != VK_SUCCESS)
+    update_template_ = VK_NULL_HANDLE;
+}
+
 }  // namespace vkgfx
 
 ///////////////////////////////////////////////////////////////////////////////
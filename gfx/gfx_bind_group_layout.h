@@ -26,6 +26,15 @@ class GFXBindGroupLayout : public RefCounted<GFXBindGroupLayout>,
     // Chained struct
   };
 
+  // Payload element of the descriptor update template. Each layout entry owns
+  // one element, in binding order.
+  union DescriptorInfo {
+    VkDescriptorBufferInfo buffer;
+    VkDescriptorImageInfo image;
+  };
+
+  static constexpr uint32_t kInvalidSlot = UINT32_MAX;
+
   GFXBindGroupLayout(VkDescriptorSetLayout layout,
                      const std::vector<LayoutEntry>& entries,
                      RefPtr<GFXDevice> device,
@@ -36,15 +45,37 @@ class GFXBindGroupLayout : public RefCounted<GFXBindGroupLayout>,
   GFXBindGroupLayout& operator=(const GFXBindGroupLayout&) = delete;
 
   VkDescriptorSetLayout GetVkHandle() const { return layout_; }
+  VkDescriptorUpdateTemplate GetUpdateTemplate() const {
+    return update_template_;
+  }
   std::span<LayoutEntry> GetLayoutEntries() {
     return std::span<LayoutEntry>(entries_);
   }
+  // Payload slot of |binding|, or kInvalidSlot
+  uint32_t GetBindingSlot(uint32_t binding) const {
+    return binding < binding_slots_.size() ? binding_slots_[binding]
+                                           : kInvalidSlot;
+  }
+  VkDescriptorType GetSlotDescriptorType(uint32_t slot) const {
+    return descriptor_types_[slot];
+  }
+  // Descriptor counts required by a single set of this layout
+  std::span<const VkDescriptorPoolSize> GetPoolSizes() const {
+    return std::span<const VkDescriptorPoolSize>(pool_sizes_);
+  }
 
   void SetLabel(WGPUStringView label);
 
  private:
+  void CreateUpdateTemplateInternal();
+
   VkDescriptorSetLayout layout_;
   std::vector<LayoutEntry> entries_;
+  std::vector<VkDescriptorPoolSize> pool_sizes_;
+
+  VkDescriptorUpdateTemplate update_template_ = VK_NULL_HANDLE;
+  std::vector<uint32_t> binding_slots_;
+  std::vector<VkDescriptorType> descriptor_types_;
 
   RefPtr<GFXDevice> device_;
 
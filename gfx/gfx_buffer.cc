@@ -4,7 +4,13 @@
 
 #include "gfx/gfx_buffer.h"
 
+#include <cstring>
+
+#include "gfx/common/log.h"
 #include "gfx/gfx_device.h"
+#include "gfx/gfx_event_manager.h"
+#include "gfx/gfx_instance.h"
+#include "gfx/gfx_queue.h"
 
 namespace vkgfx {
 
@@ -13,65 +19,376 @@ namespace vkgfx {
 
 GFXBuffer::GFXBuffer(VkBuffer buffer,
                      VmaAllocation allocation,
-                     RefPtr<GFXDevice> device,
-                     WGPUStringView label)
-    : buffer_(buffer), allocation_(allocation), device_(device) {
-  if (label.data && label.length)
-    label_ = std::string(label.data, label.length);
+                     const WGPUBufferDescriptor& descriptor,
+                     RefPtr<GFXDevice> device)
+    : buffer_(buffer),
+      allocation_(allocation),
+      size_(descriptor.size),
+      usage_(descriptor.usage),
+      device_(device) {
+  if (descriptor.label.data && descriptor.label.length)
+    label_ = std::string(descriptor.label.data, descriptor.label.length);
+
+  // Host visible allocations stay mapped for their whole lifetime
+  VmaAllocationInfo allocation_info = {};
+  vmaGetAllocationInfo(device_->GetAllocator(), allocation_, &allocation_info);
+  mapped_data_ = static_cast<uint8_t*>(allocation_info.pMappedData);
+}
+
+GFXBuffer::GFXBuffer(const GFXBufferSuballocator::Allocation& suballocation,
+                     const WGPUBufferDescriptor& descriptor,
+                     RefPtr<GFXDevice> device)
+    : buffer_(suballocation.buffer),
+      offset_(suballocation.offset),
+      allocation_(nullptr),
+      suballocation_(suballocation),
+      size_(descriptor.size),
+      usage_(descriptor.usage),
+      mapped_data_(static_cast<uint8_t*>(suballocation.mapped_data)),
+      device_(device) {
+  if (descriptor.label.data && descriptor.label.length)
+    label_ = std::string(descriptor.label.data, descriptor.label.length);
 }
 
 GFXBuffer::~GFXBuffer() {
   Destroy();
 }
 
+bool GFXBuffer::MapAtCreation() {
+  if (!mapped_data_ && size_) {
+    VkBufferCreateInfo buffer_info = {VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO};
+    buffer_info.size = size_;
+    buffer_info.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+
+    VmaAllocationCreateInfo allocation_info = {};
+    allocation_info.usage = VMA_MEMORY_USAGE_AUTO_PREFER_HOST;
+    allocation_info.flags =
+        VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT |
+        VMA_ALLOCATION_CREATE_MAPPED_BIT;
+
+    VmaAllocationInfo allocation_result = {};
+    if (vmaCreateBuffer(device_->GetAllocator(), &buffer_info,
+                        &allocation_info, &staging_buffer_,
+                        &staging_allocation_,
+                        &allocation_result) != VK_SUCCESS) {
+      GFX_ERROR() << __FUNCTION__ << ": Failed to create staging buffer.";
+      return false;
+    }
+    staging_data_ = static_cast<uint8_t*>(allocation_result.pMappedData);
+  }
+
+  map_state_ = WGPUBufferMapState_Mapped;
+  map_mode_ = WGPUMapMode_Write;
+  map_offset_ = 0;
+  map_size_ = size_;
+  return true;
+}
+
 void GFXBuffer::Destroy() {
-  if (buffer_ && device_ && allocation_)
-    vmaDestroyBuffer(device_->GetAllocator(), buffer_, allocation_);
+  // Cached bind groups must not hand out a destroyed buffer
+  if (device_ && device_->GetBindGroupCache())
+    device_->GetBindGroupCache()->EvictResource(this);
+
+  AbortPendingMap();
+
+  // Queue writes recorded on Submit would target the released buffer. Only
+  // set while the queue holds a reference, so never from the destructor,
+  // which may run under the queue lock.
+  if (HasPendingWrites() && device_ && device_->GetDefaultQueue())
+    device_->GetDefaultQueue()->DiscardPendingWrites(this);
+
+  // Never unmapped, nothing to upload
+  if (staging_buffer_ && device_)
+    vmaDestroyBuffer(device_->GetAllocator(), staging_buffer_,
+                     staging_allocation_);
+  staging_buffer_ = VK_NULL_HANDLE;
+  staging_allocation_ = VK_NULL_HANDLE;
+  staging_data_ = nullptr;
+  mapped_data_ = nullptr;
+  {
+    std::lock_guard guard(map_lock_);
+    map_state_ = WGPUBufferMapState_Unmapped;
+  }
+
+  // Submissions still using the buffer keep its memory alive
+  auto* tracker = device_ ? device_->GetResourceTracker() : nullptr;
+  if (buffer_ && device_ && allocation_) {
+    if (tracker)
+      tracker->ReleaseBuffer(buffer_, allocation_, last_usage_serial_);
+    else
+      vmaDestroyBuffer(device_->GetAllocator(), buffer_, allocation_);
+  }
+
+  if (suballocation_.block && device_ && device_->GetBufferSuballocator()) {
+    if (tracker)
+      tracker->ReleaseSuballocation(device_->GetBufferSuballocator(),
+                                    suballocation_, last_usage_serial_);
+    else
+      device_->GetBufferSuballocator()->Free(suballocation_);
+  }
 
   buffer_ = nullptr;
+  suballocation_ = {};
   device_.reset();
   allocation_ = nullptr;
 }
 
 void const* GFXBuffer::GetConstMappedRange(size_t offset, size_t size) {
-  return nullptr;
+  if (offset % 8 || (size != WGPU_WHOLE_MAP_SIZE && size % 4))
+    return nullptr;
+
+  return GetMappedPointer(offset, size);
 }
 
 void* GFXBuffer::GetMappedRange(size_t offset, size_t size) {
-  return nullptr;
+  if (!(map_mode_ & WGPUMapMode_Write))
+    return nullptr;
+
+  if (offset % 8 || (size != WGPU_WHOLE_MAP_SIZE && size % 4))
+    return nullptr;
+
+  return GetMappedPointer(offset, size);
 }
 
 WGPUBufferMapState GFXBuffer::GetMapState() {
-  return WGPUBufferMapState();
+  std::lock_guard guard(map_lock_);
+  return map_state_;
 }
 
 uint64_t GFXBuffer::GetSize() {
-  return 0;
+  return size_;
 }
 
 WGPUBufferUsage GFXBuffer::GetUsage() {
-  return WGPUBufferUsage();
+  return usage_;
 }
 
 WGPUFuture GFXBuffer::MapAsync(WGPUMapMode mode,
                                size_t offset,
                                size_t size,
                                WGPUBufferMapCallbackInfo callbackInfo) {
-  return WGPUFuture();
+  if (!device_) {
+    // Destroyed buffers cannot reach the event manager anymore
+    if (callbackInfo.callback) {
+      std::string message = "MapAsync: Buffer is destroyed.";
+      callbackInfo.callback(WGPUMapAsyncStatus_Error,
+                            {message.c_str(), message.size()},
+                            callbackInfo.userdata1, callbackInfo.userdata2);
+    }
+    return GFXInstance::kImmediateFuture;
+  }
+
+  auto* event_manager = device_->GetAdapter()->GetInstance()->GetEventManager();
+  if (size == WGPU_WHOLE_MAP_SIZE)
+    size = offset < size_ ? size_ - offset : 0;
+
+  std::string error;
+  bool can_read =
+      mode == WGPUMapMode_Read && (usage_ & WGPUBufferUsage_MapRead);
+  bool can_write =
+      mode == WGPUMapMode_Write && (usage_ & WGPUBufferUsage_MapWrite);
+  if (!can_read && !can_write)
+    error = "MapAsync: Map mode is not allowed by the buffer usage.";
+  else if (offset % 8 || size % 4)
+    error = "MapAsync: Offset must be a multiple of 8 and size of 4.";
+  else if (offset > size_ || size > size_ - offset)
+    error = "MapAsync: Map range exceeds the buffer size.";
+
+  std::unique_lock guard(map_lock_);
+  if (error.empty() && map_state_ != WGPUBufferMapState_Unmapped)
+    error = "MapAsync: Buffer is already mapped or pending.";
+
+  if (!error.empty()) {
+    guard.unlock();
+    WGPUFuture future = event_manager->RegisterEvent(callbackInfo.mode);
+    device_->CallDeviceErrorCallback(WGPUErrorType_Validation, error.c_str());
+    CompleteMapInternal(future, callbackInfo, WGPUMapAsyncStatus_Error, error);
+    return future;
+  }
+
+  // Resolved by the last submission using the buffer, either from Tick or
+  // by a poll seeing it complete. Nothing waits on the device here.
+  GFXQueue* queue = device_->GetDefaultQueue();
+  const uint64_t serial = last_usage_serial_;
+  const uint64_t request_id = ++map_request_id_;
+  RefPtr<GFXBuffer> self(this);
+  WGPUFuture future = event_manager->RegisterEvent(
+      callbackInfo.mode, queue, serial, [self, request_id, callbackInfo]() {
+        self->ResolveMapAsync(request_id, callbackInfo);
+      });
+
+  map_state_ = WGPUBufferMapState_Pending;
+  map_mode_ = mode;
+  map_offset_ = offset;
+  map_size_ = size;
+  map_future_ = future;
+  map_callback_ = callbackInfo;
+  guard.unlock();
+
+  queue->RunWhenCompleted(serial, [event_manager, future]() {
+    event_manager->ResolveEvent(future);
+  });
+  return future;
 }
 
 WGPUStatus GFXBuffer::ReadMappedRange(size_t offset, void* data, size_t size) {
-  return WGPUStatus();
+  auto* mapped_pointer = GetMappedPointer(offset, size);
+  if (!mapped_pointer)
+    return WGPUStatus_Error;
+
+  std::memcpy(data, mapped_pointer, size);
+  return WGPUStatus_Success;
 }
 
-void GFXBuffer::SetLabel(WGPUStringView label) {}
+void GFXBuffer::SetLabel(WGPUStringView label) {
+  label_ = std::string(label.data, label.length);
+}
 
-void GFXBuffer::Unmap() {}
+void GFXBuffer::Unmap() {
+  if (AbortPendingMap())
+    return;
+
+  std::lock_guard guard(map_lock_);
+  if (map_state_ != WGPUBufferMapState_Mapped)
+    return;
+
+  if (staging_buffer_) {
+    // The queue copies the staging contents ahead of the next submission
+    // and releases the staging buffer once the copy executed.
+    device_->GetDefaultQueue()->ScheduleStagingUpload(this, staging_buffer_,
+                                                      staging_allocation_);
+    staging_buffer_ = VK_NULL_HANDLE;
+    staging_allocation_ = VK_NULL_HANDLE;
+    staging_data_ = nullptr;
+  } else if (map_mode_ & WGPUMapMode_Write) {
+    FlushMappedRange();
+  }
+
+  map_state_ = WGPUBufferMapState_Unmapped;
+  map_mode_ = WGPUMapMode_None;
+  map_offset_ = 0;
+  map_size_ = 0;
+}
 
 WGPUStatus GFXBuffer::WriteMappedRange(size_t offset,
                                        void const* data,
                                        size_t size) {
-  return WGPUStatus();
+  if (!(map_mode_ & WGPUMapMode_Write))
+    return WGPUStatus_Error;
+
+  auto* mapped_pointer = GetMappedPointer(offset, size);
+  if (!mapped_pointer)
+    return WGPUStatus_Error;
+
+  std::memcpy(mapped_pointer, data, size);
+  return WGPUStatus_Success;
+}
+
+uint8_t* GFXBuffer::GetMappedPointer(size_t offset, size_t size) {
+  std::lock_guard guard(map_lock_);
+  if (map_state_ != WGPUBufferMapState_Mapped)
+    return nullptr;
+
+  size_t map_end = map_offset_ + map_size_;
+  if (offset < map_offset_ || offset > map_end)
+    return nullptr;
+
+  if (size == WGPU_WHOLE_MAP_SIZE)
+    size = map_end - offset;
+  if (size > map_end - offset)
+    return nullptr;
+
+  uint8_t* base = staging_data_ ? staging_data_ : mapped_data_;
+  return base ? base + offset : nullptr;
+}
+
+void GFXBuffer::FlushMappedRange() {
+  if (!device_ || !map_size_)
+    return;
+
+  // No-op on host coherent memory
+  if (allocation_)
+    vmaFlushAllocation(device_->GetAllocator(), allocation_, map_offset_,
+                       map_size_);
+  else if (suballocation_.block && device_->GetBufferSuballocator())
+    device_->GetBufferSuballocator()->Flush(suballocation_, map_offset_,
+                                            map_size_);
+}
+
+void GFXBuffer::InvalidateMappedRange() {
+  if (!device_ || !map_size_)
+    return;
+
+  // No-op on host coherent memory
+  if (allocation_)
+    vmaInvalidateAllocation(device_->GetAllocator(), allocation_, map_offset_,
+                            map_size_);
+  else if (suballocation_.block && device_->GetBufferSuballocator())
+    device_->GetBufferSuballocator()->Invalidate(suballocation_, map_offset_,
+                                                 map_size_);
+}
+
+void GFXBuffer::ResolveMapAsync(
+    uint64_t request_id,
+    const WGPUBufferMapCallbackInfo& callback_info) {
+  std::unique_lock guard(map_lock_);
+  WGPUMapAsyncStatus status = WGPUMapAsyncStatus_Success;
+  std::string message;
+  if (request_id != map_request_id_ ||
+      map_state_ != WGPUBufferMapState_Pending) {
+    // Unmapped while this resolution had the event already, the abort could
+    // not complete it in its place.
+    status = WGPUMapAsyncStatus_Aborted;
+    message = "MapAsync: Buffer was unmapped before the mapping resolved.";
+  } else if (mapped_data_) {
+    if (map_mode_ & WGPUMapMode_Read)
+      InvalidateMappedRange();
+    map_state_ = WGPUBufferMapState_Mapped;
+  } else {
+    status = WGPUMapAsyncStatus_Error;
+    message = "MapAsync: Buffer memory is not host visible.";
+    map_state_ = WGPUBufferMapState_Unmapped;
+    map_mode_ = WGPUMapMode_None;
+  }
+  guard.unlock();
+
+  if (callback_info.callback)
+    callback_info.callback(status, {message.c_str(), message.size()},
+                           callback_info.userdata1, callback_info.userdata2);
+}
+
+void GFXBuffer::CompleteMapInternal(
+    WGPUFuture future,
+    const WGPUBufferMapCallbackInfo& callback_info,
+    WGPUMapAsyncStatus status,
+    const std::string& message) {
+  auto* event_manager = device_->GetAdapter()->GetInstance()->GetEventManager();
+  event_manager->CompleteEvent(future, [callback_info, status, message]() {
+    if (callback_info.callback)
+      callback_info.callback(status, {message.c_str(), message.size()},
+                             callback_info.userdata1, callback_info.userdata2);
+  });
+}
+
+bool GFXBuffer::AbortPendingMap() {
+  std::unique_lock guard(map_lock_);
+  if (map_state_ != WGPUBufferMapState_Pending)
+    return false;
+
+  // The queue task sees the state change and does nothing
+  map_state_ = WGPUBufferMapState_Unmapped;
+  map_mode_ = WGPUMapMode_None;
+  map_offset_ = 0;
+  map_size_ = 0;
+  WGPUFuture future = map_future_;
+  WGPUBufferMapCallbackInfo callback_info = map_callback_;
+  guard.unlock();
+
+  if (device_)
+    CompleteMapInternal(future, callback_info, WGPUMapAsyncStatus_Aborted,
+                        "MapAsync: Buffer was unmapped before the mapping "
+                        "resolved.");
+  return true;
 }
 
 }  // namespace vkgfx
@@ -5,7 +5,12 @@
 #ifndef GFX_GFX_BUFFER_H_
 #define GFX_GFX_BUFFER_H_
 
+#include <atomic>
+#include <mutex>
+
 #include "gfx/common/refptr.h"
+#include "gfx/gfx_buffer_state.h"
+#include "gfx/gfx_buffer_suballocator.h"
 #include "gfx/gfx_config.h"
 #include "gfx/gfx_device.h"
 
@@ -20,14 +25,39 @@ class GFXBuffer : public RefCounted<GFXBuffer>, public WGPUBufferImpl {
  public:
   GFXBuffer(VkBuffer buffer,
             VmaAllocation allocation,
-            RefPtr<GFXDevice> device,
-            WGPUStringView label);
+            const WGPUBufferDescriptor& descriptor,
+            RefPtr<GFXDevice> device);
+  // Carved out of a shared block of the device suballocator.
+  GFXBuffer(const GFXBufferSuballocator::Allocation& suballocation,
+            const WGPUBufferDescriptor& descriptor,
+            RefPtr<GFXDevice> device);
   ~GFXBuffer();
 
   GFXBuffer(const GFXBuffer&) = delete;
   GFXBuffer& operator=(const GFXBuffer&) = delete;
 
+  // Contents start at GetOffset() within GetVkHandle(), which may be shared
+  // with other buffers.
   VkBuffer GetVkHandle() const { return buffer_; }
+  VkDeviceSize GetOffset() const { return offset_; }
+
+  // Enters the mapped state for mappedAtCreation. Host visible buffers map
+  // their permanent mapping, others write a staging buffer uploaded on Unmap.
+  bool MapAtCreation();
+
+  // Ranges as left by the command buffers submitted so far, only touched by
+  // the queue under its lock.
+  GFXBufferState* GetState() { return &state_; }
+
+  // Serial of the last queue submission using the buffer, MapAsync resolves
+  // once it completed.
+  uint64_t GetLastUsageSerial() const { return last_usage_serial_; }
+  void SetLastUsageSerial(uint64_t serial) { last_usage_serial_ = serial; }
+
+  // Set by the queue while writes to the buffer wait for the next Submit,
+  // they hold a reference to it.
+  bool HasPendingWrites() const { return has_pending_writes_; }
+  void SetHasPendingWrites(bool pending) { has_pending_writes_ = pending; }
 
   void Destroy();
   void const* GetConstMappedRange(size_t offset, size_t size);
@@ -45,8 +75,51 @@ class GFXBuffer : public RefCounted<GFXBuffer>, public WGPUBufferImpl {
   WGPUStatus WriteMappedRange(size_t offset, void const* data, size_t size);
 
  private:
+  // Mapped range check shared by the range accessors
+  uint8_t* GetMappedPointer(size_t offset, size_t size);
+  void FlushMappedRange();
+  void InvalidateMappedRange();
+
+  // Resolver of the MapAsync request |request_id|, maps the buffer unless
+  // the request was aborted and runs |callback_info|.
+  void ResolveMapAsync(uint64_t request_id,
+                       const WGPUBufferMapCallbackInfo& callback_info);
+  void CompleteMapInternal(WGPUFuture future,
+                           const WGPUBufferMapCallbackInfo& callback_info,
+                           WGPUMapAsyncStatus status,
+                           const std::string& message);
+  // Fails a pending MapAsync with Aborted, returns false if none was.
+  bool AbortPendingMap();
+
   VkBuffer buffer_;
+  VkDeviceSize offset_ = 0;
+  // Dedicated allocation, or null for suballocated buffers
   VmaAllocation allocation_;
+  GFXBufferSuballocator::Allocation suballocation_;
+  uint64_t size_;
+  WGPUBufferUsage usage_;
+
+  // Persistent mapping of host visible buffers at |offset_|, or null
+  uint8_t* mapped_data_ = nullptr;
+
+  // Upload source of a device local buffer mapped at creation
+  VkBuffer staging_buffer_ = VK_NULL_HANDLE;
+  VmaAllocation staging_allocation_ = VK_NULL_HANDLE;
+  uint8_t* staging_data_ = nullptr;
+
+  GFXBufferState state_;
+  std::atomic<uint64_t> last_usage_serial_ = 0;
+  std::atomic<bool> has_pending_writes_ = false;
+
+  // Guards the map state against MapAsync resolving on the ticking thread
+  std::mutex map_lock_;
+  WGPUBufferMapState map_state_ = WGPUBufferMapState_Unmapped;
+  WGPUMapMode map_mode_ = WGPUMapMode_None;
+  size_t map_offset_ = 0;
+  size_t map_size_ = 0;
+  uint64_t map_request_id_ = 0;
+  WGPUFuture map_future_ = {};
+  WGPUBufferMapCallbackInfo map_callback_ = {};
 
   RefPtr<GFXDevice> device_;
 
@@ -0,0 +1,228 @@
+// Copyright 2025 Admenri.
+// Use of this source code is governed by a MIT-style license that can be
+// found in the LICENSE file.
+
+#include "gfx/gfx_buffer_state.h"
+
+#include <algorithm>
+
+#include "gfx/gfx_buffer.h"
+
+namespace vkgfx {
+
+///////////////////////////////////////////////////////////////////////////////
+// GFXBufferState Implement
+
+bool GFXBufferState::Range::HasSameState(const Range& other) const {
+  return write_stages == other.write_stages &&
+         write_access == other.write_access &&
+         read_stages == other.read_stages &&
+         read_access == other.read_access &&
+         entry_stages == other.entry_stages &&
+         entry_access == other.entry_access && entry_open == other.entry_open;
+}
+
+void GFXBufferState::Use(GFXBuffer* buffer,
+                         uint64_t offset,
+                         uint64_t size,
+                         const BufferAccess& access,
+                         GFXBarrierBatch* batch) {
+  if (!size)
+    return;
+
+  // Ranges now either lie within [offset, end) or outside of it
+  uint64_t end = offset + size;
+  SplitAt(offset);
+  SplitAt(end);
+
+  // Barrier being extended over consecutive ranges
+  bool has_barrier = false;
+  uint64_t barrier_begin = 0;
+  uint64_t barrier_end = 0;
+  VkPipelineStageFlags barrier_stages = 0;
+  VkAccessFlags barrier_access = 0;
+  auto flush_barrier = [&]() {
+    if (!has_barrier)
+      return;
+
+    VkBufferMemoryBarrier barrier = {VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER};
+    barrier.srcAccessMask = barrier_access;
+    barrier.dstAccessMask = access.access;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.buffer = buffer->GetVkHandle();
+    barrier.offset = buffer->GetOffset() + barrier_begin;
+    barrier.size = barrier_end - barrier_begin;
+    batch->AddBufferBarrier(barrier, barrier_stages, access.stages);
+    has_barrier = false;
+  };
+
+  uint64_t cursor = offset;
+  auto it = ranges_.lower_bound(offset);
+  while (cursor < end) {
+    // Never used before
+    if (it == ranges_.end() || it->first > cursor) {
+      uint64_t gap_end = it == ranges_.end() ? end : std::min(it->first, end);
+      it = ranges_.emplace_hint(it, cursor, Range{gap_end});
+    }
+
+    VkPipelineStageFlags src_stages = 0;
+    VkAccessFlags src_access = 0;
+    if (UpdateRange(&it->second, access, &src_stages, &src_access)) {
+      if (has_barrier && barrier_end == it->first &&
+          barrier_stages == src_stages && barrier_access == src_access) {
+        barrier_end = it->second.end;
+      } else {
+        flush_barrier();
+        has_barrier = true;
+        barrier_begin = it->first;
+        barrier_end = it->second.end;
+        barrier_stages = src_stages;
+        barrier_access = src_access;
+      }
+    }
+
+    cursor = it->second.end;
+    ++it;
+  }
+
+  flush_barrier();
+  MergeRanges(offset, end);
+}
+
+void GFXBufferState::Stitch(GFXBuffer* buffer,
+                            const GFXBufferState& next,
+                            GFXBarrierBatch* batch) {
+  for (const auto& it : next.ranges_) {
+    uint64_t begin = it.first;
+    const Range& next_range = it.second;
+
+    // Later accesses of |next| are ordered after its first ones already
+    Use(buffer, begin, next_range.end - begin,
+        {next_range.entry_stages, next_range.entry_access}, batch);
+
+    SplitAt(begin);
+    SplitAt(next_range.end);
+    for (auto range = ranges_.lower_bound(begin);
+         range != ranges_.end() && range->first < next_range.end; ++range) {
+      if (next_range.write_stages) {
+        range->second.write_stages = next_range.write_stages;
+        range->second.write_access = next_range.write_access;
+        range->second.read_stages = next_range.read_stages;
+        range->second.read_access = next_range.read_access;
+      }
+      range->second.entry_stages = 0;
+      range->second.entry_access = 0;
+      range->second.entry_open = false;
+    }
+    MergeRanges(begin, next_range.end);
+  }
+}
+
+// static
+bool GFXBufferState::UpdateRange(Range* range,
+                                 const BufferAccess& access,
+                                 VkPipelineStageFlags* src_stages,
+                                 VkAccessFlags* src_access) {
+  if (range->entry_open) {
+    range->entry_stages |= access.stages;
+    range->entry_access |= access.access;
+    range->entry_open = !(access.access & kWriteAccessMask);
+  }
+
+  if (!(access.access & kWriteAccessMask)) {
+    // Reads wait for the last write once per stage and access
+    bool visible = !range->write_stages ||
+                   (!(access.stages & ~range->read_stages) &&
+                    !(access.access & ~range->read_access));
+    *src_stages = range->write_stages;
+    *src_access = range->write_access;
+    range->read_stages |= access.stages;
+    range->read_access |= access.access;
+    return !visible;
+  }
+
+  // Writes wait for every access since the last write
+  bool idle = !range->write_stages && !range->read_stages;
+  *src_stages = range->write_stages | range->read_stages;
+  *src_access = range->write_access;
+  range->write_stages = access.stages;
+  range->write_access = access.access & kWriteAccessMask;
+  range->read_stages = 0;
+  range->read_access = 0;
+  return !idle;
+}
+
+void GFXBufferState::SplitAt(uint64_t offset) {
+  auto it = ranges_.upper_bound(offset);
+  if (it == ranges_.begin())
+    return;
+
+  --it;
+  if (it->first < offset && offset < it->second.end) {
+    Range tail = it->second;
+    it->second.end = offset;
+    ranges_.emplace_hint(std::next(it), offset, tail);
+  }
+}
+
+void GFXBufferState::MergeRanges(uint64_t begin, uint64_t end) {
+  auto it = ranges_.lower_bound(begin);
+  if (it != ranges_.begin())
+    --it;
+
+  while (it != ranges_.end() && it->first <= end) {
+    auto next = std::next(it);
+    if (next != ranges_.end() && next->first == it->second.end &&
+        it->second.HasSameState(next->second)) {
+      it->second.end = next->second.end;
+      ranges_.erase(next);
+      continue;
+    }
+    it = next;
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// GFXBufferUsageTracker Implement
+
+// static
+BufferAccess GFXBufferUsageTracker::GetBindingAccess(
+    WGPUBufferBindingType type,
+    VkPipelineStageFlags stages) {
+  switch (type) {
+    case WGPUBufferBindingType_Uniform:
+      return {stages, VK_ACCESS_UNIFORM_READ_BIT};
+    case WGPUBufferBindingType_ReadOnlyStorage:
+      return {stages, VK_ACCESS_SHADER_READ_BIT};
+    case WGPUBufferBindingType_Storage:
+    default:
+      return {stages, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT};
+  }
+}
+
+void GFXBufferUsageTracker::Use(GFXBuffer* buffer,
+                                uint64_t offset,
+                                uint64_t size,
+                                const BufferAccess& access,
+                                GFXBarrierBatch* batch) {
+  if (!size)
+    return;
+
+  auto& usage = buffers_[buffer];
+  if (!usage.buffer)
+    usage.buffer = buffer;
+  usage.state.Use(buffer, offset, size, access, batch);
+}
+
+std::vector<GFXBufferUsageTracker::BufferUsage>
+GFXBufferUsageTracker::TakeUsages() {
+  std::vector<BufferUsage> usages;
+  usages.reserve(buffers_.size());
+  for (auto& it : buffers_)
+    usages.push_back(std::move(it.second));
+  buffers_.clear();
+  return usages;
+}
+
+}  // namespace vkgfx
@@ -0,0 +1,123 @@
+// Copyright 2025 Admenri.
+// Use of this source code is governed by a MIT-style license that can be
+// found in the LICENSE file.
+
+#ifndef GFX_GFX_BUFFER_STATE_H_
+#define GFX_GFX_BUFFER_STATE_H_
+
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+#include "gfx/common/refptr.h"
+#include "gfx/gfx_barrier_batch.h"
+#include "gfx/gfx_config.h"
+
+namespace vkgfx {
+
+class GFXBuffer;
+
+// Stages and accesses one usage of a buffer range needs.
+struct BufferAccess {
+  VkPipelineStageFlags stages = 0;
+  VkAccessFlags access = 0;
+};
+
+// Hazard state of the ranges of one buffer.
+// Disjoint ranges keep the last write and the reads which already waited for
+// it. A usage only needs a barrier where it overlaps an earlier write, or for
+// writes an earlier read, so passes reading the same uniform or read only
+// storage ranges and dispatches over disjoint ranges run without any.
+// Overlapping ranges needing the same dependency share one
+// VkBufferMemoryBarrier. Ranges also remember how they were first used, up
+// to their first write, for stitching states recorded independently.
+class GFXBufferState {
+ public:
+  GFXBufferState() = default;
+
+  GFXBufferState(GFXBufferState&&) = default;
+  GFXBufferState& operator=(GFXBufferState&&) = default;
+
+  // Records |access| of |size| bytes at |offset| within |buffer|, appending
+  // the barriers required to |batch|.
+  void Use(GFXBuffer* buffer,
+           uint64_t offset,
+           uint64_t size,
+           const BufferAccess& access,
+           GFXBarrierBatch* batch);
+
+  // Appends to |batch| what |next|, recorded from an idle state, needs to
+  // run after this state, then takes over the ranges |next| wrote.
+  void Stitch(GFXBuffer* buffer,
+              const GFXBufferState& next,
+              GFXBarrierBatch* batch);
+
+ private:
+  struct Range {
+    uint64_t end;
+    VkPipelineStageFlags write_stages = 0;
+    VkAccessFlags write_access = 0;
+    // Reads since the last write which already waited for it
+    VkPipelineStageFlags read_stages = 0;
+    VkAccessFlags read_access = 0;
+    // Accesses up to and including the first write
+    VkPipelineStageFlags entry_stages = 0;
+    VkAccessFlags entry_access = 0;
+    bool entry_open = true;
+
+    bool HasSameState(const Range& other) const;
+  };
+
+  // Disjoint ranges keyed by their start
+  using Ranges = std::map<uint64_t, Range>;
+
+  // Applies |access| to |range|, returns true with the source of the
+  // barrier needed first.
+  static bool UpdateRange(Range* range,
+                          const BufferAccess& access,
+                          VkPipelineStageFlags* src_stages,
+                          VkAccessFlags* src_access);
+  void SplitAt(uint64_t offset);
+  void MergeRanges(uint64_t begin, uint64_t end);
+
+  Ranges ranges_;
+};
+
+// Buffer ranges used by one command encoder, recorded without any lock so
+// encoders on different threads never contend. GFXQueue::Submit stitches the
+// states into the ones of the buffers.
+class GFXBufferUsageTracker {
+ public:
+  struct BufferUsage {
+    RefPtr<GFXBuffer> buffer;
+    GFXBufferState state;
+  };
+
+  GFXBufferUsageTracker() = default;
+  ~GFXBufferUsageTracker() = default;
+
+  GFXBufferUsageTracker(const GFXBufferUsageTracker&) = delete;
+  GFXBufferUsageTracker& operator=(const GFXBufferUsageTracker&) = delete;
+
+  // Access of a bind group entry of |type| from shaders in |stages|.
+  static BufferAccess GetBindingAccess(WGPUBufferBindingType type,
+                                       VkPipelineStageFlags stages);
+
+  // Records |access| of |size| bytes at |offset| within |buffer|, appending
+  // the barriers required to |batch|.
+  void Use(GFXBuffer* buffer,
+           uint64_t offset,
+           uint64_t size,
+           const BufferAccess& access,
+           GFXBarrierBatch* batch);
+
+  // Every buffer used so far, once each, with the state it was left in.
+  std::vector<BufferUsage> TakeUsages();
+
+ private:
+  std::unordered_map<GFXBuffer*, BufferUsage> buffers_;
+};
+
+}  // namespace vkgfx
+
+#endif  // GFX_GFX_BUFFER_STATE_H_
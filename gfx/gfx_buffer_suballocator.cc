@@ -0,0 +1,250 @@
+// Copyright 2025 Admenri.
+// Use of this source code is governed by a MIT-style license that can be
+// found in the LICENSE file.
+
+#include "gfx/gfx_buffer_suballocator.h"
+
+#include <algorithm>
+
+#include "gfx/common/log.h"
+#include "gfx/gfx_utils.h"
+
+namespace vkgfx {
+
+namespace {
+
+// Every usage a device local block may serve
+constexpr WGPUBufferUsage kDeviceLocalUsages =
+    WGPUBufferUsage_Vertex | WGPUBufferUsage_Index | WGPUBufferUsage_Uniform |
+    WGPUBufferUsage_Storage | WGPUBufferUsage_Indirect |
+    WGPUBufferUsage_CopySrc | WGPUBufferUsage_CopyDst |
+    WGPUBufferUsage_QueryResolve;
+
+constexpr WGPUBufferUsage kMapReadUsages =
+    WGPUBufferUsage_MapRead | WGPUBufferUsage_CopyDst;
+constexpr WGPUBufferUsage kMapWriteUsages =
+    WGPUBufferUsage_MapWrite | WGPUBufferUsage_CopySrc;
+
+constexpr VkDeviceSize kMinAlignment = 16;
+
+}  // namespace
+
+struct GFXBufferSuballocator::Block {
+  UsageClass usage_class;
+  VkBuffer buffer = VK_NULL_HANDLE;
+  VmaAllocation allocation = VK_NULL_HANDLE;
+  VmaVirtualBlock virtual_block = VK_NULL_HANDLE;
+  void* mapped_data = nullptr;
+  uint32_t allocation_count = 0;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// GFXBufferSuballocator Implement
+
+GFXBufferSuballocator::GFXBufferSuballocator(
+    VmaAllocator allocator,
+    const VkPhysicalDeviceLimits& limits)
+    : allocator_(allocator), limits_(limits) {}
+
+GFXBufferSuballocator::~GFXBufferSuballocator() {
+  for (auto& blocks : blocks_) {
+    for (auto& block : blocks) {
+      // Live buffers are released with the device
+      vmaClearVirtualBlock(block->virtual_block);
+      DestroyBlockInternal(block.get());
+    }
+  }
+}
+
+bool GFXBufferSuballocator::Allocate(VkDeviceSize size,
+                                     WGPUBufferUsage usage,
+                                     Allocation* allocation) {
+  if (size > kMaxSuballocationSize)
+    return false;
+
+  UsageClass usage_class;
+  if (!GetUsageClass(usage, &usage_class))
+    return false;
+
+  VmaVirtualAllocationCreateInfo create_info = {};
+  create_info.size = std::max<VkDeviceSize>((size + 3) & ~VkDeviceSize(3), 4);
+  create_info.alignment = GetAlignment(usage);
+
+  std::lock_guard guard(lock_);
+  auto& blocks = blocks_[usage_class];
+
+  Block* block = nullptr;
+  VmaVirtualAllocation virtual_allocation = VK_NULL_HANDLE;
+  VkDeviceSize offset = 0;
+
+  // Newest blocks are the least fragmented
+  for (auto it = blocks.rbegin(); it != blocks.rend(); ++it) {
+    if (vmaVirtualAllocate((*it)->virtual_block, &create_info,
+                           &virtual_allocation, &offset) == VK_SUCCESS) {
+      block = it->get();
+      break;
+    }
+  }
+
+  if (!block) {
+    auto new_block = CreateBlockInternal(usage_class);
+    if (!new_block)
+      return false;
+
+    if (vmaVirtualAllocate(new_block->virtual_block, &create_info,
+                           &virtual_allocation, &offset) != VK_SUCCESS) {
+      DestroyBlockInternal(new_block.get());
+      return false;
+    }
+
+    block = new_block.get();
+    blocks.push_back(std::move(new_block));
+    ++stats_.block_count;
+  }
+
+  ++block->allocation_count;
+  ++stats_.allocation_count;
+  stats_.allocated_bytes += create_info.size;
+
+  allocation->buffer = block->buffer;
+  allocation->offset = offset;
+  allocation->mapped_data =
+      block->mapped_data ? static_cast<uint8_t*>(block->mapped_data) + offset
+                         : nullptr;
+  allocation->block = block;
+  allocation->virtual_allocation = virtual_allocation;
+  return true;
+}
+
+void GFXBufferSuballocator::Free(const Allocation& allocation) {
+  std::lock_guard guard(lock_);
+  auto* block = allocation.block;
+
+  VmaVirtualAllocationInfo allocation_info;
+  vmaGetVirtualAllocationInfo(block->virtual_block,
+                              allocation.virtual_allocation, &allocation_info);
+  vmaVirtualFree(block->virtual_block, allocation.virtual_allocation);
+
+  --stats_.allocation_count;
+  stats_.allocated_bytes -= allocation_info.size;
+  if (--block->allocation_count)
+    return;
+
+  // Keep one empty block per class to absorb create/release churn
+  auto& blocks = blocks_[block->usage_class];
+  if (blocks.size() <= 1)
+    return;
+
+  auto it = std::find_if(blocks.begin(), blocks.end(),
+                         [block](const auto& it) { return it.get() == block; });
+  DestroyBlockInternal(block);
+  blocks.erase(it);
+  --stats_.block_count;
+}
+
+void GFXBufferSuballocator::Flush(const Allocation& allocation,
+                                  VkDeviceSize offset,
+                                  VkDeviceSize size) {
+  vmaFlushAllocation(allocator_, allocation.block->allocation,
+                     allocation.offset + offset, size);
+}
+
+void GFXBufferSuballocator::Invalidate(const Allocation& allocation,
+                                       VkDeviceSize offset,
+                                       VkDeviceSize size) {
+  vmaInvalidateAllocation(allocator_, allocation.block->allocation,
+                          allocation.offset + offset, size);
+}
+
+GFXBufferSuballocator::Stats GFXBufferSuballocator::GetStats() {
+  std::lock_guard guard(lock_);
+  return stats_;
+}
+
+// static
+bool GFXBufferSuballocator::GetUsageClass(WGPUBufferUsage usage,
+                                          UsageClass* usage_class) {
+  if (usage & WGPUBufferUsage_MapRead) {
+    *usage_class = kMapRead;
+    return !(usage & ~kMapReadUsages);
+  }
+
+  if (usage & WGPUBufferUsage_MapWrite) {
+    *usage_class = kMapWrite;
+    return !(usage & ~kMapWriteUsages);
+  }
+
+  *usage_class = kDeviceLocal;
+  return !(usage & ~kDeviceLocalUsages);
+}
+
+VkDeviceSize GFXBufferSuballocator::GetAlignment(WGPUBufferUsage usage) const {
+  VkDeviceSize alignment = kMinAlignment;
+  if (usage & WGPUBufferUsage_Uniform)
+    alignment = std::max(alignment, limits_.minUniformBufferOffsetAlignment);
+  if (usage & WGPUBufferUsage_Storage)
+    alignment = std::max(alignment, limits_.minStorageBufferOffsetAlignment);
+
+  // Host flushes and invalidates operate on whole atoms
+  if (usage & (WGPUBufferUsage_MapRead | WGPUBufferUsage_MapWrite))
+    alignment = std::max(alignment, limits_.nonCoherentAtomSize);
+
+  return alignment;
+}
+
+std::unique_ptr<GFXBufferSuballocator::Block>
+GFXBufferSuballocator::CreateBlockInternal(UsageClass usage_class) {
+  auto block = std::make_unique<Block>();
+  block->usage_class = usage_class;
+
+  VkBufferCreateInfo buffer_info = {VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO};
+  buffer_info.size = kBlockSize;
+
+  VmaAllocationCreateInfo allocation_info = {};
+  allocation_info.usage = VMA_MEMORY_USAGE_AUTO;
+  switch (usage_class) {
+    default:
+    case kDeviceLocal:
+      buffer_info.usage = ToVulkanBufferUsage(kDeviceLocalUsages);
+      break;
+    case kMapRead:
+      buffer_info.usage = ToVulkanBufferUsage(kMapReadUsages);
+      allocation_info.flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT |
+                              VMA_ALLOCATION_CREATE_MAPPED_BIT;
+      break;
+    case kMapWrite:
+      buffer_info.usage = ToVulkanBufferUsage(kMapWriteUsages);
+      allocation_info.flags =
+          VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT |
+          VMA_ALLOCATION_CREATE_MAPPED_BIT;
+      break;
+  }
+
+  VmaAllocationInfo allocation_result = {};
+  if (vmaCreateBuffer(allocator_, &buffer_info, &allocation_info,
+                      &block->buffer, &block->allocation,
+                      &allocation_result) != VK_SUCCESS) {
+    GFX_ERROR() << __FUNCTION__ << ": Failed to create buffer block.";
+    return nullptr;
+  }
+  block->mapped_data = allocation_result.pMappedData;
+
+  VmaVirtualBlockCreateInfo virtual_block_info = {};
+  virtual_block_info.size = kBlockSize;
+  if (vmaCreateVirtualBlock(&virtual_block_info, &block->virtual_block) !=
+      VK_SUCCESS) {
+    vmaDestroyBuffer(allocator_, block->buffer, block->allocation);
+    return nullptr;
+  }
+
+  return block;
+}
+
+void GFXBufferSuballocator::DestroyBlockInternal(Block* block) {
+  if (block->virtual_block)
+    vmaDestroyVirtualBlock(block->virtual_block);
+  if (block->buffer)
+    vmaDestroyBuffer(allocator_, block->buffer, block->allocation);
+}
+
+}  // namespace vkgfx
@@ -0,0 +1,95 @@
+// Copyright 2025 Admenri.
+// Use of this source code is governed by a MIT-style license that can be
+// found in the LICENSE file.
+
+#ifndef GFX_GFX_BUFFER_SUBALLOCATOR_H_
+#define GFX_GFX_BUFFER_SUBALLOCATOR_H_
+
+#include <array>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "gfx/gfx_config.h"
+
+#include "vma/vma.h"
+
+namespace vkgfx {
+
+// Device owned allocator carving small buffers out of large shared VkBuffers.
+// Blocks are grouped by usage class (device local, map read, map write) and
+// managed with a VmaVirtualBlock each, so creating a small WGPUBuffer costs
+// no driver object nor VMA allocation. A block is released once its last
+// suballocation is freed.
+class GFXBufferSuballocator {
+ public:
+  static constexpr VkDeviceSize kMaxSuballocationSize = 64 * 1024;
+  static constexpr VkDeviceSize kBlockSize = 4 * 1024 * 1024;
+
+  struct Block;
+
+  struct Allocation {
+    VkBuffer buffer = VK_NULL_HANDLE;
+    VkDeviceSize offset = 0;
+    // Persistently mapped block memory at |offset|, host visible classes only
+    void* mapped_data = nullptr;
+
+    Block* block = nullptr;
+    VmaVirtualAllocation virtual_allocation = VK_NULL_HANDLE;
+  };
+
+  struct Stats {
+    uint32_t block_count = 0;
+    uint32_t allocation_count = 0;
+    VkDeviceSize allocated_bytes = 0;
+  };
+
+  GFXBufferSuballocator(VmaAllocator allocator,
+                        const VkPhysicalDeviceLimits& limits);
+  ~GFXBufferSuballocator();
+
+  GFXBufferSuballocator(const GFXBufferSuballocator&) = delete;
+  GFXBufferSuballocator& operator=(const GFXBufferSuballocator&) = delete;
+
+  // Returns false when the buffer should get a dedicated allocation, either
+  // because of its size or usage, or when a new block cannot be created.
+  bool Allocate(VkDeviceSize size,
+                WGPUBufferUsage usage,
+                Allocation* allocation);
+  void Free(const Allocation& allocation);
+
+  // Flushes host writes to |size| bytes at |offset| within |allocation|.
+  void Flush(const Allocation& allocation,
+             VkDeviceSize offset,
+             VkDeviceSize size);
+  // Makes device writes to |size| bytes at |offset| visible to the host.
+  void Invalidate(const Allocation& allocation,
+                  VkDeviceSize offset,
+                  VkDeviceSize size);
+
+  Stats GetStats();
+
+ private:
+  enum UsageClass {
+    kDeviceLocal,
+    kMapRead,
+    kMapWrite,
+    kUsageClassNums,
+  };
+
+  static bool GetUsageClass(WGPUBufferUsage usage, UsageClass* usage_class);
+  VkDeviceSize GetAlignment(WGPUBufferUsage usage) const;
+  std::unique_ptr<Block> CreateBlockInternal(UsageClass usage_class);
+  void DestroyBlockInternal(Block* block);
+
+  VmaAllocator allocator_;
+  VkPhysicalDeviceLimits limits_;
+
+  std::mutex lock_;
+  std::array<std::vector<std::unique_ptr<Block>>, kUsageClassNums> blocks_;
+  Stats stats_;
+};
+
+}  // namespace vkgfx
+
+#endif  // GFX_GFX_BUFFER_SUBALLOCATOR_H_
@@ -0,0 +1,166 @@
+// Copyright 2025 Admenri.
+// Use of this source code is governed by a MIT-style license that can be
+// found in the LICENSE file.
+
+#include "gfx/gfx_command_allocator.h"
+
+#include <algorithm>
+#include <atomic>
+
+#include "gfx/common/log.h"
+
+namespace vkgfx {
+
+namespace {
+
+std::atomic<uint64_t> g_next_allocator_id = 1;
+
+// Pool of the calling thread in the allocator it was last looked up from
+struct ThreadPoolCache {
+  uint64_t allocator_id = 0;
+  void* thread_pool = nullptr;
+};
+
+thread_local ThreadPoolCache g_thread_pool_cache;
+
+}  // namespace
+
+///////////////////////////////////////////////////////////////////////////////
+// GFXCommandAllocator Implement
+
+GFXCommandAllocator::GFXCommandAllocator(VkDevice device,
+                                         uint32_t queue_family_index)
+    : device_(device),
+      queue_family_index_(queue_family_index),
+      id_(g_next_allocator_id++) {}
+
+GFXCommandAllocator::~GFXCommandAllocator() {
+  std::lock_guard guard(lock_);
+  for (auto& it : thread_pools_)
+    for (auto& frame : it.second->frames)
+      vkDestroyCommandPool(device_, frame->pool, nullptr);
+  thread_pools_.clear();
+}
+
+bool GFXCommandAllocator::Allocate(
+    uint64_t pending_serial,
+    uint64_t completed_serial,
+    Allocation* allocation,
+    const VkCommandBufferInheritanceInfo* inheritance) {
+  ThreadPool* thread_pool = GetThreadPool();
+
+  std::lock_guard guard(thread_pool->lock);
+  Frame* frame = thread_pool->current;
+  if (!frame || frame->frame_serial != pending_serial) {
+    // A submission happened since, move on to the next frame
+    frame = AcquireFrameInternal(thread_pool, completed_serial);
+    if (!frame)
+      return false;
+
+    frame->frame_serial = pending_serial;
+    thread_pool->current = frame;
+  }
+
+  auto& command_buffers = inheritance ? frame->secondary_command_buffers
+                                      : frame->command_buffers;
+  uint32_t& used = inheritance ? frame->secondary_used : frame->used;
+  if (used == command_buffers.size()) {
+    VkCommandBufferAllocateInfo allocate_info = {
+        VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO};
+    allocate_info.commandPool = frame->pool;
+    allocate_info.level = inheritance ? VK_COMMAND_BUFFER_LEVEL_SECONDARY
+                                      : VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    allocate_info.commandBufferCount = kAllocationBatch;
+
+    size_t size = command_buffers.size();
+    command_buffers.resize(size + kAllocationBatch);
+    if (vkAllocateCommandBuffers(device_, &allocate_info,
+                                 command_buffers.data() + size) !=
+        VK_SUCCESS) {
+      command_buffers.resize(size);
+      GFX_ERROR() << __FUNCTION__ << ": Failed to allocate command buffers.";
+      return false;
+    }
+  }
+
+  VkCommandBuffer command_buffer = command_buffers[used];
+  VkCommandBufferBeginInfo begin_info = {
+      VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO};
+  begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+  if (inheritance) {
+    begin_info.flags |= VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+    begin_info.pInheritanceInfo = inheritance;
+  }
+  if (vkBeginCommandBuffer(command_buffer, &begin_info) != VK_SUCCESS) {
+    GFX_ERROR() << __FUNCTION__ << ": Failed to begin command buffer.";
+    return false;
+  }
+
+  ++used;
+  ++frame->outstanding;
+  allocation->command_buffer = command_buffer;
+  allocation->frame = frame;
+  return true;
+}
+
+void GFXCommandAllocator::Release(const Allocation& allocation,
+                                  uint64_t serial) {
+  Frame* frame = allocation.frame;
+  if (!frame)
+    return;
+
+  std::lock_guard guard(frame->owner->lock);
+  frame->last_serial = std::max(frame->last_serial, serial);
+  --frame->outstanding;
+}
+
+GFXCommandAllocator::ThreadPool* GFXCommandAllocator::GetThreadPool() {
+  auto& cache = g_thread_pool_cache;
+  if (cache.allocator_id == id_)
+    return static_cast<ThreadPool*>(cache.thread_pool);
+
+  std::lock_guard guard(lock_);
+  auto& thread_pool = thread_pools_[std::this_thread::get_id()];
+  if (!thread_pool)
+    thread_pool = std::make_unique<ThreadPool>();
+
+  cache.allocator_id = id_;
+  cache.thread_pool = thread_pool.get();
+  return thread_pool.get();
+}
+
+GFXCommandAllocator::Frame* GFXCommandAllocator::AcquireFrameInternal(
+    ThreadPool* thread_pool,
+    uint64_t completed_serial) {
+  for (auto& frame : thread_pool->frames) {
+    if (frame->outstanding || frame->last_serial > completed_serial)
+      continue;
+
+    // Every command buffer of the frame retired, recycle them at once
+    if (frame->used || frame->secondary_used) {
+      vkResetCommandPool(device_, frame->pool, 0);
+      frame->used = 0;
+      frame->secondary_used = 0;
+    }
+    frame->last_serial = 0;
+    return frame.get();
+  }
+
+  auto frame = std::make_unique<Frame>();
+  frame->owner = thread_pool;
+
+  VkCommandPoolCreateInfo pool_info = {
+      VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO};
+  pool_info.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+  pool_info.queueFamilyIndex = queue_family_index_;
+  if (vkCreateCommandPool(device_, &pool_info, nullptr, &frame->pool) !=
+      VK_SUCCESS) {
+    GFX_ERROR() << __FUNCTION__ << ": Failed to create command pool.";
+    return nullptr;
+  }
+
+  thread_pool->frames.push_back(std::move(frame));
+  return thread_pool->frames.back().get();
+}
+
+}  // namespace vkgfx
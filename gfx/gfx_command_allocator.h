@@ -0,0 +1,100 @@
+// Copyright 2025 Admenri.
+// Use of this source code is governed by a MIT-style license that can be
+// found in the LICENSE file.
+
+#ifndef GFX_GFX_COMMAND_ALLOCATOR_H_
+#define GFX_GFX_COMMAND_ALLOCATOR_H_
+
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "gfx/gfx_config.h"
+
+namespace vkgfx {
+
+// Device owned source of the command buffers command encoders record into,
+// primary ones and the secondary ones render passes are split across.
+// Every recording thread owns a ring of transient pools, one per frame of
+// submissions: command buffers are handed out from the pool of the current
+// frame and never freed individually. Once every command buffer of a frame
+// was released and its last submission completed, the whole pool is
+// recycled with a single vkResetCommandPool, keeping the buffers allocated
+// for the next frame reusing it. Threads find their pool through a thread
+// local cache, recording threads never contend on the allocator.
+class GFXCommandAllocator {
+ private:
+  struct Frame;
+
+ public:
+  struct Allocation {
+    VkCommandBuffer command_buffer = VK_NULL_HANDLE;
+    Frame* frame = nullptr;
+  };
+
+  GFXCommandAllocator(VkDevice device, uint32_t queue_family_index);
+  // Destroys every pool, the device must be idle.
+  ~GFXCommandAllocator();
+
+  GFXCommandAllocator(const GFXCommandAllocator&) = delete;
+  GFXCommandAllocator& operator=(const GFXCommandAllocator&) = delete;
+
+  // Returns a command buffer begun for one time submission from the pool of
+  // the calling thread. |pending_serial| is the serial of the next queue
+  // submission, |completed_serial| the last one known complete. With
+  // |inheritance| the command buffer is a secondary one continuing the
+  // render pass it describes.
+  bool Allocate(uint64_t pending_serial,
+                uint64_t completed_serial,
+                Allocation* allocation,
+                const VkCommandBufferInheritanceInfo* inheritance = nullptr);
+
+  // Hands the command buffer back, |serial| being the submission executing
+  // it or 0 if it was never submitted.
+  void Release(const Allocation& allocation, uint64_t serial);
+
+ private:
+  // Command buffers allocated from a pool at once when it runs out
+  static constexpr uint32_t kAllocationBatch = 8;
+
+  struct ThreadPool;
+
+  struct Frame {
+    ThreadPool* owner;
+    VkCommandPool pool = VK_NULL_HANDLE;
+    std::vector<VkCommandBuffer> command_buffers;
+    std::vector<VkCommandBuffer> secondary_command_buffers;
+    uint32_t used = 0;
+    uint32_t secondary_used = 0;
+    uint32_t outstanding = 0;
+    // Submission serial the frame was opened for
+    uint64_t frame_serial = 0;
+    // Last submission executing one of its command buffers
+    uint64_t last_serial = 0;
+  };
+
+  struct ThreadPool {
+    std::mutex lock;
+    std::vector<std::unique_ptr<Frame>> frames;
+    Frame* current = nullptr;
+  };
+
+  ThreadPool* GetThreadPool();
+  Frame* AcquireFrameInternal(ThreadPool* thread_pool,
+                              uint64_t completed_serial);
+
+  VkDevice device_;
+  uint32_t queue_family_index_;
+  // Identifies the allocator in the thread local caches
+  uint64_t id_;
+
+  std::mutex lock_;
+  std::unordered_map<std::thread::id, std::unique_ptr<ThreadPool>>
+      thread_pools_;
+};
+
+}  // namespace vkgfx
+
+#endif  // GFX_GFX_COMMAND_ALLOCATOR_H_
@@ -9,9 +9,44 @@ namespace vkgfx {
 ///////////////////////////////////////////////////////////////////////////////
 // GFXCommandBuffer Implement
 
-GFXCommandBuffer::GFXCommandBuffer() {}
+GFXCommandBuffer::GFXCommandBuffer(
+    const GFXCommandAllocator::Allocation& allocation,
+    std::vector<GFXCommandAllocator::Allocation> secondaries,
+    std::vector<GFXBufferUsageTracker::BufferUsage> buffers,
+    std::vector<GFXTextureUsageTracker::TextureUsage> textures,
+    std::vector<RefPtr<GFXBindGroup>> bind_groups,
+    std::vector<RefPtr<GFXComputePipeline>> compute_pipelines,
+    std::vector<RefPtr<GFXRenderPipeline>> render_pipelines,
+    RefPtr<GFXDevice> device,
+    WGPUStringView label)
+    : allocation_(allocation),
+      secondaries_(std::move(secondaries)),
+      buffers_(std::move(buffers)),
+      textures_(std::move(textures)),
+      bind_groups_(std::move(bind_groups)),
+      compute_pipelines_(std::move(compute_pipelines)),
+      render_pipelines_(std::move(render_pipelines)),
+      device_(device) {
+  if (label.data && label.length)
+    label_ = std::string(label.data, label.length);
+}
+
+GFXCommandBuffer::~GFXCommandBuffer() {
+  // Submissions hold a reference until they completed
+  if (auto* command_allocator = device_->GetCommandAllocator()) {
+    command_allocator->Release(allocation_, submit_serial_);
+    for (const auto& it : secondaries_)
+      command_allocator->Release(it, submit_serial_);
+  }
+}
 
-GFXCommandBuffer::~GFXCommandBuffer() {}
+bool GFXCommandBuffer::MarkSubmitted(uint64_t serial) {
+  if (submit_serial_)
+    return false;
+
+  submit_serial_ = serial;
+  return true;
+}
 
 void GFXCommandBuffer::SetLabel(WGPUStringView label) {
   label_ = std::string(label.data, label.length);
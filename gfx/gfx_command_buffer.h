@@ -5,8 +5,19 @@
 #ifndef GFX_GFX_COMMAND_BUFFER_H_
 #define GFX_GFX_COMMAND_BUFFER_H_
 
+#include <vector>
+
 #include "gfx/common/refptr.h"
+#include "gfx/gfx_bind_group.h"
+#include "gfx/gfx_buffer.h"
+#include "gfx/gfx_buffer_state.h"
+#include "gfx/gfx_command_allocator.h"
+#include "gfx/gfx_compute_pipeline.h"
 #include "gfx/gfx_config.h"
+#include "gfx/gfx_device.h"
+#include "gfx/gfx_render_pipeline.h"
+#include "gfx/gfx_texture.h"
+#include "gfx/gfx_texture_state.h"
 
 struct WGPUCommandBufferImpl {};
 
@@ -16,15 +27,68 @@ namespace vkgfx {
 class GFXCommandBuffer : public RefCounted<GFXCommandBuffer>,
                          public WGPUCommandBufferImpl {
  public:
-  GFXCommandBuffer();
+  // Takes over |allocation| holding the recorded commands and the
+  // |secondaries| it executes. |bind_groups| and the pipelines are the ones
+  // the commands bound, they stay valid as long as the command buffer.
+  GFXCommandBuffer(
+      const GFXCommandAllocator::Allocation& allocation,
+      std::vector<GFXCommandAllocator::Allocation> secondaries,
+      std::vector<GFXBufferUsageTracker::BufferUsage> buffers,
+      std::vector<GFXTextureUsageTracker::TextureUsage> textures,
+      std::vector<RefPtr<GFXBindGroup>> bind_groups,
+      std::vector<RefPtr<GFXComputePipeline>> compute_pipelines,
+      std::vector<RefPtr<GFXRenderPipeline>> render_pipelines,
+      RefPtr<GFXDevice> device,
+      WGPUStringView label);
   ~GFXCommandBuffer();
 
   GFXCommandBuffer(const GFXCommandBuffer&) = delete;
   GFXCommandBuffer& operator=(const GFXCommandBuffer&) = delete;
 
+  // Primary command buffer, null when nothing was recorded.
+  VkCommandBuffer GetVkHandle() const {
+    return allocation_.command_buffer;
+  }
+  // Buffers used by the recorded commands, alive as long as the command
+  // buffer is, with the ranges the commands used.
+  const std::vector<GFXBufferUsageTracker::BufferUsage>& GetBuffers() const {
+    return buffers_;
+  }
+  // Textures used by the recorded commands, with the layouts and accesses
+  // the commands left their subresources in.
+  const std::vector<GFXTextureUsageTracker::TextureUsage>& GetTextures()
+      const {
+    return textures_;
+  }
+  const std::vector<RefPtr<GFXBindGroup>>& GetBindGroups() const {
+    return bind_groups_;
+  }
+  const std::vector<RefPtr<GFXComputePipeline>>& GetComputePipelines()
+      const {
+    return compute_pipelines_;
+  }
+  const std::vector<RefPtr<GFXRenderPipeline>>& GetRenderPipelines() const {
+    return render_pipelines_;
+  }
+
+  // Command buffers execute once, false if it was submitted before.
+  // |serial| is the submission executing it.
+  bool MarkSubmitted(uint64_t serial);
+
   void SetLabel(WGPUStringView label);
 
  private:
+  GFXCommandAllocator::Allocation allocation_;
+  std::vector<GFXCommandAllocator::Allocation> secondaries_;
+  std::vector<GFXBufferUsageTracker::BufferUsage> buffers_;
+  std::vector<GFXTextureUsageTracker::TextureUsage> textures_;
+  std::vector<RefPtr<GFXBindGroup>> bind_groups_;
+  std::vector<RefPtr<GFXComputePipeline>> compute_pipelines_;
+  std::vector<RefPtr<GFXRenderPipeline>> render_pipelines_;
+  uint64_t submit_serial_ = 0;
+
+  RefPtr<GFXDevice> device_;
+
   std::string label_;
 };
 
@@ -4,34 +4,231 @@
 
 #include "gfx/gfx_command_encoder.h"
 
+#include <algorithm>
+#include <string>
+
+#include "gfx/gfx_buffer.h"
+#include "gfx/gfx_command_buffer.h"
+#include "gfx/gfx_compute_pass_encoder.h"
+#include "gfx/gfx_render_pass_encoder.h"
+#include "gfx/gfx_utils.h"
+
 namespace vkgfx {
 
 ///////////////////////////////////////////////////////////////////////////////
 // GFXCommandEncoder Implement
 
-GFXCommandEncoder::GFXCommandEncoder() {}
+GFXCommandEncoder::GFXCommandEncoder(
+    const GFXCommandAllocator::Allocation& allocation,
+    RefPtr<GFXDevice> device,
+    WGPUStringView label)
+    : allocation_(allocation),
+      command_buffer_(allocation.command_buffer),
+      device_(device) {
+  if (label.data && label.length)
+    label_ = std::string(label.data, label.length);
+}
+
+GFXCommandEncoder::~GFXCommandEncoder() {
+  // Never finished, nothing was submitted
+  auto* command_allocator = device_->GetCommandAllocator();
+  if (allocation_.frame && command_allocator) {
+    command_allocator->Release(allocation_, 0);
+    for (const auto& it : secondaries_)
+      command_allocator->Release(it, 0);
+  }
+}
+
+void GFXCommandEncoder::RetainBindGroup(GFXBindGroup* group) {
+  // Consecutive binds of the same group are the common case
+  if (bind_groups_.empty() || bind_groups_.back() != group)
+    bind_groups_.push_back(group);
+}
 
-GFXCommandEncoder::~GFXCommandEncoder() {}
+void GFXCommandEncoder::RetainPipeline(GFXComputePipeline* pipeline) {
+  if (compute_pipelines_.empty() || compute_pipelines_.back() != pipeline)
+    compute_pipelines_.push_back(pipeline);
+}
+
+void GFXCommandEncoder::RetainPipeline(GFXRenderPipeline* pipeline) {
+  if (render_pipelines_.empty() || render_pipelines_.back() != pipeline)
+    render_pipelines_.push_back(pipeline);
+}
 
 WGPUComputePassEncoder GFXCommandEncoder::BeginComputePass(
     WGPUComputePassDescriptor const* descriptor) {
-  return WGPUComputePassEncoder();
+  if (!ValidateRecording("BeginComputePass"))
+    return nullptr;
+
+  pass_active_ = true;
+  WGPUStringView label = descriptor ? descriptor->label : WGPUStringView{};
+  return AdaptExternalRefCounted(new GFXComputePassEncoder(this, label));
 }
 
 WGPURenderPassEncoder GFXCommandEncoder::BeginRenderPass(
     WGPURenderPassDescriptor const* descriptor) {
-  return WGPURenderPassEncoder();
+  if (!ValidateRecording("BeginRenderPass"))
+    return nullptr;
+
+  if (!descriptor ||
+      descriptor->colorAttachmentCount >
+          GFXRenderPassCache::kMaxColorAttachments ||
+      (descriptor->depthStencilAttachment &&
+       !descriptor->depthStencilAttachment->view)) {
+    device_->CallDeviceErrorCallback(
+        WGPUErrorType_Validation,
+        "BeginRenderPass: Invalid color or depth stencil attachments.");
+    return nullptr;
+  }
+
+  std::vector<GFXTextureView*> attachments;
+  GFXRenderPassCache::CollectAttachments(descriptor, &attachments);
+  if (attachments.empty()) {
+    device_->CallDeviceErrorCallback(
+        WGPUErrorType_Validation, "BeginRenderPass: Pass has no attachment.");
+    return nullptr;
+  }
+
+  for (auto* view : attachments) {
+    if (!(view->GetTexture()->GetUsage() &
+          WGPUTextureUsage_RenderAttachment)) {
+      device_->CallDeviceErrorCallback(
+          WGPUErrorType_Validation,
+          "BeginRenderPass: Attachment usage does not contain "
+          "RenderAttachment.");
+      return nullptr;
+    }
+  }
+
+  auto* render_pass_cache = device_->GetRenderPassCache();
+  GFXRenderPassEncoder::Target target;
+  target.render_pass = render_pass_cache->GetRenderPass(
+      GFXRenderPassCache::MakeRenderPassKey(descriptor));
+  if (target.render_pass)
+    target.framebuffer =
+        render_pass_cache->GetFramebuffer(target.render_pass, attachments);
+  if (!target.framebuffer) {
+    device_->CallDeviceErrorCallback(
+        WGPUErrorType_OutOfMemory,
+        "BeginRenderPass: Failed to create render pass or framebuffer.");
+    return nullptr;
+  }
+
+  // Same extent as the framebuffer
+  auto* texture = attachments.front()->GetTexture();
+  uint32_t mip_level = attachments.front()->GetBaseMipLevel();
+  target.extent.width = std::max(texture->GetWidth() >> mip_level, 1u);
+  target.extent.height = std::max(texture->GetHeight() >> mip_level, 1u);
+
+  pass_active_ = true;
+  return AdaptExternalRefCounted(
+      new GFXRenderPassEncoder(this, *descriptor, target));
 }
 
 void GFXCommandEncoder::ClearBuffer(WGPUBuffer buffer,
                                     uint64_t offset,
-                                    uint64_t size) {}
+                                    uint64_t size) {
+  if (!ValidateRecording("ClearBuffer"))
+    return;
+
+  auto* buffer_impl = static_cast<GFXBuffer*>(buffer);
+  if (!buffer_impl || !(buffer_impl->GetUsage() & WGPUBufferUsage_CopyDst)) {
+    device_->CallDeviceErrorCallback(
+        WGPUErrorType_Validation,
+        "ClearBuffer: Buffer usage does not contain CopyDst.");
+    return;
+  }
+
+  if (offset > buffer_impl->GetSize()) {
+    device_->CallDeviceErrorCallback(
+        WGPUErrorType_Validation,
+        "ClearBuffer: Offset exceeds the buffer size.");
+    return;
+  }
+
+  if (size == WGPU_WHOLE_SIZE)
+    size = buffer_impl->GetSize() - offset;
+  if (offset % 4 || size % 4 || size > buffer_impl->GetSize() - offset) {
+    device_->CallDeviceErrorCallback(
+        WGPUErrorType_Validation,
+        "ClearBuffer: Range is not 4 byte aligned or exceeds the buffer.");
+    return;
+  }
+
+  if (!size)
+    return;
+
+  GFXBarrierBatch barriers;
+  buffer_usage_.Use(buffer_impl, offset, size,
+                    {VK_PIPELINE_STAGE_TRANSFER_BIT,
+                     VK_ACCESS_TRANSFER_WRITE_BIT},
+                    &barriers);
+  barriers.Record(command_buffer_);
+
+  vkCmdFillBuffer(command_buffer_, buffer_impl->GetVkHandle(),
+                  buffer_impl->GetOffset() + offset, size, 0);
+}
 
 void GFXCommandEncoder::CopyBufferToBuffer(WGPUBuffer source,
                                            uint64_t sourceOffset,
                                            WGPUBuffer destination,
                                            uint64_t destinationOffset,
-                                           uint64_t size) {}
+                                           uint64_t size) {
+  if (!ValidateRecording("CopyBufferToBuffer"))
+    return;
+
+  auto* source_impl = static_cast<GFXBuffer*>(source);
+  auto* destination_impl = static_cast<GFXBuffer*>(destination);
+  if (!source_impl || !destination_impl ||
+      !(source_impl->GetUsage() & WGPUBufferUsage_CopySrc) ||
+      !(destination_impl->GetUsage() & WGPUBufferUsage_CopyDst)) {
+    device_->CallDeviceErrorCallback(
+        WGPUErrorType_Validation,
+        "CopyBufferToBuffer: Buffers must be CopySrc and CopyDst.");
+    return;
+  }
+
+  if (sourceOffset % 4 || destinationOffset % 4 || size % 4 ||
+      sourceOffset > source_impl->GetSize() ||
+      size > source_impl->GetSize() - sourceOffset ||
+      destinationOffset > destination_impl->GetSize() ||
+      size > destination_impl->GetSize() - destinationOffset) {
+    device_->CallDeviceErrorCallback(
+        WGPUErrorType_Validation,
+        "CopyBufferToBuffer: Range is not 4 byte aligned or out of bounds.");
+    return;
+  }
+
+  if (source_impl == destination_impl &&
+      sourceOffset < destinationOffset + size &&
+      destinationOffset < sourceOffset + size) {
+    device_->CallDeviceErrorCallback(
+        WGPUErrorType_Validation,
+        "CopyBufferToBuffer: Source and destination ranges overlap.");
+    return;
+  }
+
+  if (!size)
+    return;
+
+  GFXBarrierBatch barriers;
+  buffer_usage_.Use(source_impl, sourceOffset, size,
+                    {VK_PIPELINE_STAGE_TRANSFER_BIT,
+                     VK_ACCESS_TRANSFER_READ_BIT},
+                    &barriers);
+  buffer_usage_.Use(destination_impl, destinationOffset, size,
+                    {VK_PIPELINE_STAGE_TRANSFER_BIT,
+                     VK_ACCESS_TRANSFER_WRITE_BIT},
+                    &barriers);
+  barriers.Record(command_buffer_);
+
+  VkBufferCopy region = {};
+  region.srcOffset = source_impl->GetOffset() + sourceOffset;
+  region.dstOffset = destination_impl->GetOffset() + destinationOffset;
+  region.size = size;
+  vkCmdCopyBuffer(command_buffer_, source_impl->GetVkHandle(),
+                  destination_impl->GetVkHandle(), 1, &region);
+}
 
 void GFXCommandEncoder::CopyBufferToTexture(
     WGPUTexelCopyBufferInfo const* source,
@@ -50,7 +247,29 @@ void GFXCommandEncoder::CopyTextureToTexture(
 
 WGPUCommandBuffer GFXCommandEncoder::Finish(
     WGPUCommandBufferDescriptor const* descriptor) {
-  return WGPUCommandBuffer();
+  if (!ValidateRecording("Finish"))
+    return nullptr;
+
+  finished_ = true;
+  if (vkEndCommandBuffer(command_buffer_) != VK_SUCCESS) {
+    device_->CallDeviceErrorCallback(WGPUErrorType_OutOfMemory,
+                                     "Finish: Failed to end command buffer.");
+    return nullptr;
+  }
+
+  // The command buffer releases the allocation from now on
+  WGPUStringView label = descriptor ? descriptor->label : WGPUStringView{};
+  auto* command_buffer = new GFXCommandBuffer(
+      allocation_, std::move(secondaries_), buffer_usage_.TakeUsages(),
+      texture_usage_.TakeUsages(), std::move(bind_groups_),
+      std::move(compute_pipelines_), std::move(render_pipelines_), device_,
+      label);
+  allocation_ = {};
+  secondaries_.clear();
+  bind_groups_.clear();
+  compute_pipelines_.clear();
+  render_pipelines_.clear();
+  return AdaptExternalRefCounted(command_buffer);
 }
 
 void GFXCommandEncoder::InsertDebugMarker(WGPUStringView markerLabel) {}
@@ -72,6 +291,19 @@ void GFXCommandEncoder::SetLabel(WGPUStringView label) {
 void GFXCommandEncoder::WriteTimestamp(WGPUQuerySet querySet,
                                        uint32_t queryIndex) {}
 
+bool GFXCommandEncoder::ValidateRecording(const char* function) {
+  const char* error = nullptr;
+  if (finished_)
+    error = ": Encoder is already finished.";
+  else if (pass_active_)
+    error = ": A pass is still being recorded.";
+
+  if (error)
+    device_->CallDeviceErrorCallback(WGPUErrorType_Validation,
+                                     std::string(function) + error);
+  return !error;
+}
+
 }  // namespace vkgfx
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -5,9 +5,17 @@
 #ifndef GFX_GFX_COMMAND_ENCODER_H_
 #define GFX_GFX_COMMAND_ENCODER_H_
 
+#include <vector>
+
 #include "gfx/common/refptr.h"
+#include "gfx/gfx_bind_group.h"
+#include "gfx/gfx_buffer_state.h"
+#include "gfx/gfx_command_allocator.h"
+#include "gfx/gfx_compute_pipeline.h"
 #include "gfx/gfx_config.h"
 #include "gfx/gfx_device.h"
+#include "gfx/gfx_render_pipeline.h"
+#include "gfx/gfx_texture_state.h"
 
 struct WGPUCommandEncoderImpl {};
 
@@ -17,12 +25,32 @@ namespace vkgfx {
 class GFXCommandEncoder : public RefCounted<GFXCommandEncoder>,
                           public WGPUCommandEncoderImpl {
  public:
-  GFXCommandEncoder();
+  // Records into the begun command buffer of |allocation|.
+  GFXCommandEncoder(const GFXCommandAllocator::Allocation& allocation,
+                    RefPtr<GFXDevice> device,
+                    WGPUStringView label);
   ~GFXCommandEncoder();
 
   GFXCommandEncoder(const GFXCommandEncoder&) = delete;
   GFXCommandEncoder& operator=(const GFXCommandEncoder&) = delete;
 
+  // Shared with the pass encoders recording into the encoder.
+  VkCommandBuffer GetVkHandle() const { return command_buffer_; }
+  GFXDevice* GetDevice() const { return device_.get(); }
+  GFXBufferUsageTracker* GetBufferUsage() { return &buffer_usage_; }
+  GFXTextureUsageTracker* GetTextureUsage() { return &texture_usage_; }
+  void EndPass() { pass_active_ = false; }
+
+  // Takes over a secondary command buffer executed by the primary one.
+  void AddSecondary(const GFXCommandAllocator::Allocation& allocation) {
+    secondaries_.push_back(allocation);
+  }
+  // Keeps |group| alive along with the command buffer, which submissions
+  // hold until they completed.
+  void RetainBindGroup(GFXBindGroup* group);
+  void RetainPipeline(GFXComputePipeline* pipeline);
+  void RetainPipeline(GFXRenderPipeline* pipeline);
+
   WGPUComputePassEncoder BeginComputePass(
       WGPUComputePassDescriptor const* descriptor);
   WGPURenderPassEncoder BeginRenderPass(
@@ -55,6 +83,21 @@ class GFXCommandEncoder : public RefCounted<GFXCommandEncoder>,
   void WriteTimestamp(WGPUQuerySet querySet, uint32_t queryIndex);
 
  private:
+  // Reports a validation error unless commands can be recorded.
+  bool ValidateRecording(const char* function);
+
+  // Reset once the command buffer took it over
+  GFXCommandAllocator::Allocation allocation_;
+  VkCommandBuffer command_buffer_;
+  std::vector<GFXCommandAllocator::Allocation> secondaries_;
+  std::vector<RefPtr<GFXBindGroup>> bind_groups_;
+  std::vector<RefPtr<GFXComputePipeline>> compute_pipelines_;
+  std::vector<RefPtr<GFXRenderPipeline>> render_pipelines_;
+  GFXBufferUsageTracker buffer_usage_;
+  GFXTextureUsageTracker texture_usage_;
+  bool pass_active_ = false;
+  bool finished_ = false;
+
   RefPtr<GFXDevice> device_;
 
   std::string label_;
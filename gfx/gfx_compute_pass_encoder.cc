@@ -9,19 +9,56 @@ namespace vkgfx {
 ///////////////////////////////////////////////////////////////////////////////
 // GFXComputePassEncoder Implement
 
-GFXComputePassEncoder::GFXComputePassEncoder() {}
+GFXComputePassEncoder::GFXComputePassEncoder(RefPtr<GFXCommandEncoder> encoder,
+                                             WGPUStringView label)
+    : encoder_(encoder) {
+  if (label.data && label.length)
+    label_ = std::string(label.data, label.length);
+}
 
 GFXComputePassEncoder::~GFXComputePassEncoder() {}
 
 void GFXComputePassEncoder::DispatchWorkgroups(uint32_t workgroupCountX,
                                                uint32_t workgroupCountY,
-                                               uint32_t workgroupCountZ) {}
+                                               uint32_t workgroupCountZ) {
+  if (!PrepareDispatch("DispatchWorkgroups", nullptr, 0))
+    return;
+
+  vkCmdDispatch(encoder_->GetVkHandle(), workgroupCountX, workgroupCountY,
+                workgroupCountZ);
+}
 
 void GFXComputePassEncoder::DispatchWorkgroupsIndirect(
     WGPUBuffer indirectBuffer,
-    uint64_t indirectOffset) {}
+    uint64_t indirectOffset) {
+  auto* buffer_impl = static_cast<GFXBuffer*>(indirectBuffer);
+  if (!buffer_impl || !(buffer_impl->GetUsage() & WGPUBufferUsage_Indirect) ||
+      indirectOffset % 4 || indirectOffset > buffer_impl->GetSize() ||
+      buffer_impl->GetSize() - indirectOffset < kIndirectDispatchSize) {
+    encoder_->GetDevice()->CallDeviceErrorCallback(
+        WGPUErrorType_Validation,
+        "DispatchWorkgroupsIndirect: Invalid indirect buffer range.");
+    return;
+  }
+
+  if (!PrepareDispatch("DispatchWorkgroupsIndirect", buffer_impl,
+                       indirectOffset))
+    return;
+
+  vkCmdDispatchIndirect(encoder_->GetVkHandle(), buffer_impl->GetVkHandle(),
+                        buffer_impl->GetOffset() + indirectOffset);
+}
+
+void GFXComputePassEncoder::End() {
+  if (ended_) {
+    encoder_->GetDevice()->CallDeviceErrorCallback(
+        WGPUErrorType_Validation, "End: Pass is already ended.");
+    return;
+  }
 
-void GFXComputePassEncoder::End() {}
+  ended_ = true;
+  encoder_->EndPass();
+}
 
 void GFXComputePassEncoder::InsertDebugMarker(WGPUStringView markerLabel) {}
 
@@ -32,13 +69,105 @@ void GFXComputePassEncoder::PushDebugGroup(WGPUStringView groupLabel) {}
 void GFXComputePassEncoder::SetBindGroup(uint32_t groupIndex,
                                          WGPU_NULLABLE WGPUBindGroup group,
                                          size_t dynamicOffsetCount,
-                                         uint32_t const* dynamicOffsets) {}
+                                         uint32_t const* dynamicOffsets) {
+  if (groupIndex >= bind_groups_.size())
+    bind_groups_.resize(groupIndex + 1);
+
+  auto& state = bind_groups_[groupIndex];
+  state.group = static_cast<GFXBindGroup*>(group);
+  state.dynamic_offsets.assign(dynamicOffsets,
+                               dynamicOffsets + dynamicOffsetCount);
+  state.dirty = true;
+}
 
 void GFXComputePassEncoder::SetLabel(WGPUStringView label) {
   label_ = std::string(label.data, label.length);
 }
 
-void GFXComputePassEncoder::SetPipeline(WGPUComputePipeline pipeline) {}
+void GFXComputePassEncoder::SetPipeline(WGPUComputePipeline pipeline) {
+  pipeline_ = static_cast<GFXComputePipeline*>(pipeline);
+  if (!pipeline_)
+    return;
+
+  encoder_->RetainPipeline(pipeline_.get());
+  vkCmdBindPipeline(encoder_->GetVkHandle(), VK_PIPELINE_BIND_POINT_COMPUTE,
+                    pipeline_->GetVkPipeline());
+
+  // Sets are rebound against the layout of the new pipeline
+  for (auto& state : bind_groups_)
+    state.dirty = true;
+}
+
+bool GFXComputePassEncoder::PrepareDispatch(const char* function,
+                                            GFXBuffer* indirect_buffer,
+                                            uint64_t indirect_offset) {
+  if (ended_ || !pipeline_) {
+    encoder_->GetDevice()->CallDeviceErrorCallback(
+        WGPUErrorType_Validation,
+        std::string(function) + ": No pipeline set or pass already ended.");
+    return false;
+  }
+
+  GFXBarrierBatch barriers;
+  auto* buffer_usage = encoder_->GetBufferUsage();
+  auto* texture_usage = encoder_->GetTextureUsage();
+  for (const auto& state : bind_groups_) {
+    if (!state.group)
+      continue;
+
+    size_t dynamic_index = 0;
+    for (const auto& binding : state.group->GetBufferBindings()) {
+      uint64_t offset = binding.offset;
+      if (binding.has_dynamic_offset &&
+          dynamic_index < state.dynamic_offsets.size())
+        offset += state.dynamic_offsets[dynamic_index++];
+
+      buffer_usage->Use(binding.buffer, offset, binding.size,
+                        GFXBufferUsageTracker::GetBindingAccess(
+                            binding.type,
+                            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT),
+                        &barriers);
+    }
+
+    // Uploads and render targets reach the shader in the descriptor layout
+    for (const auto& binding : state.group->GetTextureBindings()) {
+      auto* view = binding.view;
+      texture_usage->Transition(
+          view->GetTexture(),
+          {view->GetBaseMipLevel(), view->GetMipLevelCount(),
+           view->GetBaseArrayLayer(), view->GetArrayLayerCount()},
+          {binding.layout, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+           binding.access},
+          &barriers);
+    }
+  }
+
+  if (indirect_buffer)
+    buffer_usage->Use(indirect_buffer, indirect_offset, kIndirectDispatchSize,
+                      {VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT,
+                       VK_ACCESS_INDIRECT_COMMAND_READ_BIT},
+                      &barriers);
+
+  VkCommandBuffer command_buffer = encoder_->GetVkHandle();
+  barriers.Record(command_buffer);
+
+  VkPipelineLayout layout = pipeline_->GetLayout()->GetVkHandle();
+  for (uint32_t i = 0; i < bind_groups_.size(); ++i) {
+    auto& state = bind_groups_[i];
+    if (!state.dirty || !state.group)
+      continue;
+
+    VkDescriptorSet set = state.group->GetVkHandle();
+    vkCmdBindDescriptorSets(
+        command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, layout, i, 1, &set,
+        static_cast<uint32_t>(state.dynamic_offsets.size()),
+        state.dynamic_offsets.data());
+    state.dirty = false;
+    encoder_->RetainBindGroup(state.group.get());
+  }
+
+  return true;
+}
 
 }  // namespace vkgfx
 
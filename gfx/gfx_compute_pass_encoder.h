@@ -5,7 +5,13 @@
 #ifndef GFX_GFX_COMPUTE_PASS_ENCODER_H_
 #define GFX_GFX_COMPUTE_PASS_ENCODER_H_
 
+#include <string>
+#include <vector>
+
 #include "gfx/common/refptr.h"
+#include "gfx/gfx_bind_group.h"
+#include "gfx/gfx_command_encoder.h"
+#include "gfx/gfx_compute_pipeline.h"
 #include "gfx/gfx_config.h"
 #include "gfx/gfx_device.h"
 
@@ -17,7 +23,8 @@ namespace vkgfx {
 class GFXComputePassEncoder : public RefCounted<GFXComputePassEncoder>,
                               public WGPUComputePassEncoderImpl {
  public:
-  GFXComputePassEncoder();
+  GFXComputePassEncoder(RefPtr<GFXCommandEncoder> encoder,
+                        WGPUStringView label);
   ~GFXComputePassEncoder();
 
   GFXComputePassEncoder(const GFXComputePassEncoder&) = delete;
@@ -40,6 +47,27 @@ class GFXComputePassEncoder : public RefCounted<GFXComputePassEncoder>,
   void SetPipeline(WGPUComputePipeline pipeline);
 
  private:
+  // x, y and z workgroup counts
+  static constexpr uint64_t kIndirectDispatchSize = 3 * sizeof(uint32_t);
+
+  struct BindGroupState {
+    RefPtr<GFXBindGroup> group;
+    std::vector<uint32_t> dynamic_offsets;
+    bool dirty = false;
+  };
+
+  // Tracks the buffers the dispatch reads or writes, then binds the
+  // descriptor sets changed since the last dispatch.
+  bool PrepareDispatch(const char* function,
+                       GFXBuffer* indirect_buffer,
+                       uint64_t indirect_offset);
+
+  RefPtr<GFXCommandEncoder> encoder_;
+  RefPtr<GFXComputePipeline> pipeline_;
+  // Indexed by group, grown by SetBindGroup
+  std::vector<BindGroupState> bind_groups_;
+  bool ended_ = false;
+
   std::string label_;
 };
 
@@ -4,18 +4,111 @@
 
 #include "gfx/gfx_compute_pipeline.h"
 
+#include "gfx/gfx_pipeline_cache.h"
+#include "gfx/gfx_utils.h"
+
 namespace vkgfx {
 
 ///////////////////////////////////////////////////////////////////////////////
 // GFXComputePipeline Implement
 
-GFXComputePipeline::GFXComputePipeline() {}
+// static
+bool GFXComputePipeline::CaptureCreateInfo(
+    const WGPUComputePipelineDescriptor* descriptor,
+    CreateInfo* create_info,
+    std::string* error) {
+  if (!descriptor->layout) {
+    *error = "Implicit pipeline layouts are not supported.";
+    return false;
+  }
+
+  if (!descriptor->compute.module) {
+    *error = "Missing compute shader module.";
+    return false;
+  }
+
+  if (descriptor->compute.constantCount) {
+    *error = "Pipeline overridable constants are not supported.";
+    return false;
+  }
+
+  create_info->layout =
+      static_cast<GFXPipelineLayout*>(descriptor->layout);
+  create_info->module =
+      static_cast<GFXShaderModule*>(descriptor->compute.module);
+  create_info->entry_point =
+      FromWGPUStringView(descriptor->compute.entryPoint);
+  if (!create_info->module->ResolveEntryPoint(VK_SHADER_STAGE_COMPUTE_BIT,
+                                              &create_info->entry_point)) {
+    *error = "Invalid compute entry point.";
+    return false;
+  }
+  create_info->label = FromWGPUStringView(descriptor->label);
+
+  // Layouts and shader handles are interned, they identify content
+  std::string& key = create_info->key;
+  AppendKey(&key, static_cast<const void*>(create_info->layout.get()));
+  AppendKey(&key, create_info->module->GetVkHandle());
+  AppendKey(&key, std::string_view(create_info->entry_point));
+
+  return true;
+}
+
+// static
+GFXComputePipeline* GFXComputePipeline::Create(RefPtr<GFXDevice> device,
+                                               const CreateInfo& create_info,
+                                               std::string* error) {
+  VkComputePipelineCreateInfo pipeline_info = {
+      VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO};
+  pipeline_info.stage.sType =
+      VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+  pipeline_info.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+  pipeline_info.stage.module = create_info.module->GetVkHandle();
+  pipeline_info.stage.pName = create_info.entry_point.c_str();
+  pipeline_info.layout = create_info.layout->GetVkHandle();
 
-GFXComputePipeline::~GFXComputePipeline() {}
+  VkPipelineCache pipeline_cache = VK_NULL_HANDLE;
+  if (device->GetPipelineCache())
+    pipeline_cache = device->GetPipelineCache()->AcquireCache();
+
+  VkPipeline pipeline = VK_NULL_HANDLE;
+  VkResult result =
+      vkCreateComputePipelines(device->GetVkHandle(), pipeline_cache, 1,
+                               &pipeline_info, nullptr, &pipeline);
+  if (pipeline_cache)
+    device->GetPipelineCache()->ReleaseCache(pipeline_cache);
+  if (result != VK_SUCCESS) {
+    *error = "Failed to create compute pipeline.";
+    return nullptr;
+  }
+
+  return AdaptExternalRefCounted(new GFXComputePipeline(
+      pipeline, create_info.layout, device, create_info.label));
+}
+
+GFXComputePipeline::GFXComputePipeline(VkPipeline pipeline,
+                                       RefPtr<GFXPipelineLayout> layout,
+                                       RefPtr<GFXDevice> device,
+                                       const std::string& label)
+    : pipeline_(pipeline), layout_(layout), device_(device) {
+  if (!label.empty())
+    label_ = label;
+}
+
+GFXComputePipeline::~GFXComputePipeline() {
+  if (!pipeline_ || !device_)
+    return;
+
+  // Command buffers binding it may still execute
+  if (auto* tracker = device_->GetResourceTracker())
+    tracker->ReleasePipeline(pipeline_, last_usage_serial_);
+  else
+    vkDestroyPipeline(device_->GetVkHandle(), pipeline_, nullptr);
+}
 
 WGPUBindGroupLayout GFXComputePipeline::GetBindGroupLayout(
     uint32_t groupIndex) {
-  return WGPUBindGroupLayout();
+  return AdaptExternalRefCounted(layout_->GetBindGroupLayout(groupIndex));
 }
 
 void GFXComputePipeline::SetLabel(WGPUStringView label) {
@@ -5,9 +5,14 @@
 #ifndef GFX_GFX_COMPUTE_PIPELINE_H_
 #define GFX_GFX_COMPUTE_PIPELINE_H_
 
+#include <atomic>
+#include <string>
+
 #include "gfx/common/refptr.h"
 #include "gfx/gfx_config.h"
 #include "gfx/gfx_device.h"
+#include "gfx/gfx_pipeline_layout.h"
+#include "gfx/gfx_shader_module.h"
 
 struct WGPUComputePipelineImpl {};
 
@@ -17,23 +22,52 @@ namespace vkgfx {
 class GFXComputePipeline : public RefCounted<GFXComputePipeline>,
                            public WGPUComputePipelineImpl {
  public:
-  GFXComputePipeline();
+  // Self contained copy of a descriptor, compiled on any thread.
+  struct CreateInfo {
+    RefPtr<GFXPipelineLayout> layout;
+    RefPtr<GFXShaderModule> module;
+    std::string entry_point;
+    std::string label;
+    // Identity of the descriptor, merges identical async requests
+    std::string key;
+  };
+
+  static bool CaptureCreateInfo(const WGPUComputePipelineDescriptor* descriptor,
+                                CreateInfo* create_info,
+                                std::string* error);
+  // Returns a pipeline holding one reference, or null with |error|.
+  static GFXComputePipeline* Create(RefPtr<GFXDevice> device,
+                                    const CreateInfo& create_info,
+                                    std::string* error);
+
+  GFXComputePipeline(VkPipeline pipeline,
+                     RefPtr<GFXPipelineLayout> layout,
+                     RefPtr<GFXDevice> device,
+                     const std::string& label);
   ~GFXComputePipeline();
 
   GFXComputePipeline(const GFXComputePipeline&) = delete;
   GFXComputePipeline& operator=(const GFXComputePipeline&) = delete;
 
   VkPipeline GetVkPipeline() const { return pipeline_; }
+  GFXPipelineLayout* GetLayout() const { return layout_.get(); }
+
+  // Serial of the last submission binding the pipeline, it is destroyed
+  // once that completed.
+  uint64_t GetLastUsageSerial() const { return last_usage_serial_; }
+  void SetLastUsageSerial(uint64_t serial) { last_usage_serial_ = serial; }
 
   WGPUBindGroupLayout GetBindGroupLayout(uint32_t groupIndex);
   void SetLabel(WGPUStringView label);
 
  private:
   VkPipeline pipeline_;
+  RefPtr<GFXPipelineLayout> layout_;
+  std::atomic<uint64_t> last_usage_serial_ = 0;
 
   RefPtr<GFXDevice> device_;
 
-  std::string label_;
+  std::string label_ = "GFX.ComputePipeline";
 };
 
 }  // namespace vkgfx
@@ -0,0 +1,139 @@
+// Copyright 2025 Admenri.
+// Use of this source code is governed by a MIT-style license that can be
+// found in the LICENSE file.
+
+#include "gfx/gfx_descriptor_allocator.h"
+
+#include <algorithm>
+#include <atomic>
+
+#include "gfx/common/log.h"
+#include "gfx/gfx_bind_group_layout.h"
+
+namespace vkgfx {
+
+///////////////////////////////////////////////////////////////////////////////
+// GFXDescriptorAllocator Implement
+
+GFXDescriptorAllocator::GFXDescriptorAllocator(VkDevice device)
+    : device_(device) {}
+
+GFXDescriptorAllocator::~GFXDescriptorAllocator() {
+  for (auto& shard : shards_) {
+    std::lock_guard guard(shard.lock);
+    for (auto& it : shard.slabs)
+      DestroySlab(&it.second);
+    shard.slabs.clear();
+  }
+}
+
+bool GFXDescriptorAllocator::Allocate(GFXBindGroupLayout* layout,
+                                      Allocation* allocation) {
+  const uint32_t shard_index = GetCurrentShardIndex();
+  auto& shard = shards_[shard_index];
+
+  std::lock_guard guard(shard.lock);
+  auto& slab = shard.slabs[layout];
+  if (slab.free_sets.empty() && !GrowSlab(layout, &slab))
+    return false;
+
+  allocation->set = slab.free_sets.back();
+  allocation->shard = shard_index;
+  slab.free_sets.pop_back();
+
+  return true;
+}
+
+void GFXDescriptorAllocator::Free(GFXBindGroupLayout* layout,
+                                  const Allocation& allocation) {
+  if (!allocation.set)
+    return;
+
+  auto& shard = shards_[allocation.shard];
+
+  std::lock_guard guard(shard.lock);
+  auto it = shard.slabs.find(layout);
+  if (it != shard.slabs.end())
+    it->second.free_sets.push_back(allocation.set);
+}
+
+void GFXDescriptorAllocator::ReleaseLayout(GFXBindGroupLayout* layout) {
+  for (auto& shard : shards_) {
+    std::lock_guard guard(shard.lock);
+    auto it = shard.slabs.find(layout);
+    if (it != shard.slabs.end()) {
+      DestroySlab(&it->second);
+      shard.slabs.erase(it);
+    }
+  }
+}
+
+bool GFXDescriptorAllocator::GrowSlab(GFXBindGroupLayout* layout, Slab* slab) {
+  const uint32_t set_count = slab->next_pool_size;
+
+  // Pool sizes of one set, scaled to the slab capacity
+  std::vector<VkDescriptorPoolSize> pool_sizes(layout->GetPoolSizes().begin(),
+                                               layout->GetPoolSizes().end());
+  for (auto& it : pool_sizes)
+    it.descriptorCount *= set_count;
+
+  VkDescriptorPoolCreateInfo pool_create_info = {
+      VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO};
+  pool_create_info.maxSets = set_count;
+  pool_create_info.poolSizeCount = pool_sizes.size();
+  pool_create_info.pPoolSizes = pool_sizes.data();
+
+  VkDescriptorPool pool;
+  if (vkCreateDescriptorPool(device_, &pool_create_info, nullptr, &pool) !=
+      VK_SUCCESS) {
+    GFX_ERROR() << __FUNCTION__ << ": Failed to create descriptor pool.";
+    return false;
+  }
+
+  // Sets never return to the pool individually, allocate the whole slab at
+  // once and let the free list hand them out.
+  std::vector<VkDescriptorSetLayout> set_layouts(set_count,
+                                                 layout->GetVkHandle());
+
+  VkDescriptorSetAllocateInfo allocate_info = {
+      VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO};
+  allocate_info.descriptorPool = pool;
+  allocate_info.descriptorSetCount = set_count;
+  allocate_info.pSetLayouts = set_layouts.data();
+
+  const size_t free_offset = slab->free_sets.size();
+  slab->free_sets.resize(free_offset + set_count);
+  if (vkAllocateDescriptorSets(device_, &allocate_info,
+                               slab->free_sets.data() + free_offset) !=
+      VK_SUCCESS) {
+    GFX_ERROR() << __FUNCTION__ << ": Failed to allocate descriptor sets.";
+    slab->free_sets.resize(free_offset);
+    vkDestroyDescriptorPool(device_, pool, nullptr);
+    return false;
+  }
+
+  slab->pools.push_back(pool);
+  slab->next_pool_size = std::min(set_count * 2, kMaxSlabSize);
+
+  return true;
+}
+
+void GFXDescriptorAllocator::DestroySlab(Slab* slab) {
+  // Implicit release of DescriptorSet
+  for (auto pool : slab->pools)
+    vkDestroyDescriptorPool(device_, pool, nullptr);
+
+  slab->pools.clear();
+  slab->free_sets.clear();
+}
+
+// static
+uint32_t GFXDescriptorAllocator::GetCurrentShardIndex() {
+  // Round-robin assignment spreads threads evenly over the shards
+  static std::atomic<uint32_t> next_shard_index = 0;
+  thread_local const uint32_t shard_index =
+      next_shard_index.fetch_add(1, std::memory_order_relaxed) % kShardCount;
+  return shard_index;
+}
+
+}  // namespace vkgfx
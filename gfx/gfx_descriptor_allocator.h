@@ -0,0 +1,73 @@
+// Copyright 2025 Admenri.
+// Use of this source code is governed by a MIT-style license that can be
+// found in the LICENSE file.
+
+#ifndef GFX_GFX_DESCRIPTOR_ALLOCATOR_H_
+#define GFX_GFX_DESCRIPTOR_ALLOCATOR_H_
+
+#include <array>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "gfx/gfx_config.h"
+
+namespace vkgfx {
+
+class GFXBindGroupLayout;
+
+// Device owned descriptor set allocator.
+// Sets are carved out of slab pools sized for a single bind group layout and
+// recycled through a free list when their bind group is released, so the
+// common allocation path is a pop from the free list. Slabs are sharded per
+// thread to avoid contention between concurrent bind group creation.
+class GFXDescriptorAllocator {
+ public:
+  struct Allocation {
+    VkDescriptorSet set = VK_NULL_HANDLE;
+    uint32_t shard = 0;
+  };
+
+  explicit GFXDescriptorAllocator(VkDevice device);
+  ~GFXDescriptorAllocator();
+
+  GFXDescriptorAllocator(const GFXDescriptorAllocator&) = delete;
+  GFXDescriptorAllocator& operator=(const GFXDescriptorAllocator&) = delete;
+
+  // Returns a set compatible with |layout|, the contents are undefined.
+  bool Allocate(GFXBindGroupLayout* layout, Allocation* allocation);
+
+  // Returns the set to the free list of the shard it was allocated from.
+  void Free(GFXBindGroupLayout* layout, const Allocation& allocation);
+
+  // Destroys all slab pools of |layout|, called on layout destruction.
+  void ReleaseLayout(GFXBindGroupLayout* layout);
+
+ private:
+  static constexpr uint32_t kShardCount = 8;
+  static constexpr uint32_t kInitialSlabSize = 16;
+  static constexpr uint32_t kMaxSlabSize = 1024;
+
+  struct Slab {
+    std::vector<VkDescriptorPool> pools;
+    std::vector<VkDescriptorSet> free_sets;
+    uint32_t next_pool_size = kInitialSlabSize;
+  };
+
+  struct Shard {
+    std::mutex lock;
+    std::unordered_map<GFXBindGroupLayout*, Slab> slabs;
+  };
+
+  bool GrowSlab(GFXBindGroupLayout* layout, Slab* slab);
+  void DestroySlab(Slab* slab);
+
+  static uint32_t GetCurrentShardIndex();
+
+  VkDevice device_;
+  std::array<Shard, kShardCount> shards_;
+};
+
+}  // namespace vkgfx
+
+#endif  // GFX_GFX_DESCRIPTOR_ALLOCATOR_H_
@@ -4,12 +4,23 @@
 
 #include "gfx/gfx_device.h"
 
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
 #include <map>
+#include <sstream>
 
 #include "gfx/gfx_bind_group.h"
 #include "gfx/gfx_bind_group_layout.h"
 #include "gfx/gfx_buffer.h"
+#include "gfx/gfx_command_encoder.h"
+#include "gfx/gfx_compute_pipeline.h"
+#include "gfx/gfx_pipeline_layout.h"
+#include "gfx/gfx_queue.h"
+#include "gfx/gfx_render_pipeline.h"
+#include "gfx/common/log.h"
 #include "gfx/gfx_sampler.h"
+#include "gfx/gfx_shader_module.h"
 #include "gfx/gfx_texture.h"
 #include "gfx/gfx_utils.h"
 
@@ -19,6 +30,7 @@ namespace vkgfx {
 // GFXDevice Implement
 
 GFXDevice::GFXDevice(VkDevice device,
+                     uint32_t queue_family_index,
                      RefPtr<GFXAdapter> adapter,
                      WGPUStringView label,
                      WGPUDeviceLostCallbackInfo device_lost_callback,
@@ -30,7 +42,34 @@ GFXDevice::GFXDevice(VkDevice device,
   if (label.data && label.length)
     label_ = std::string(label.data, label.length);
 
+  ParseTogglesInternal();
   CreateAllocatorInternal();
+  descriptor_allocator_ = std::make_unique<GFXDescriptorAllocator>(device_);
+  layout_cache_ = std::make_unique<GFXLayoutCache>();
+  sampler_cache_ = std::make_unique<GFXSamplerCache>(
+      device_, adapter_->GetDeviceInfo()
+                   .properties.properties.limits.maxSamplerAllocationCount);
+  CreatePipelineCacheInternal();
+  render_pass_cache_ = std::make_unique<GFXRenderPassCache>(
+      device_, adapter_->SupportsImagelessFramebuffer());
+  worker_pool_ =
+      std::make_unique<GFXWorkerPool>(GFXWorkerPool::GetDefaultThreadCount());
+  pipeline_compiler_ = std::make_unique<GFXPipelineCompiler>(
+      this, worker_pool_.get(), adapter_->GetInstance()->GetEventManager());
+  if (toggles_.bind_group_cache)
+    bind_group_cache_ = std::make_unique<GFXBindGroupCache>();
+  if (toggles_.buffer_suballocation)
+    buffer_suballocator_ = std::make_unique<GFXBufferSuballocator>(
+        allocator_,
+        adapter_->GetDeviceInfo().properties.properties.limits);
+  resource_tracker_ =
+      std::make_unique<GFXResourceTracker>(device_, allocator_);
+  command_allocator_ =
+      std::make_unique<GFXCommandAllocator>(device_, queue_family_index);
+
+  VkQueue queue;
+  vkGetDeviceQueue(device_, queue_family_index, 0, &queue);
+  queue_ = new GFXQueue(queue, queue_family_index, this);
 }
 
 GFXDevice::~GFXDevice() {
@@ -48,6 +87,15 @@ void GFXDevice::CallDeviceLostCallback(WGPUDeviceLostReason reason,
   }
 }
 
+bool GFXDevice::SavePipelineCache() {
+  if (!pipeline_cache_ || !shader_store_)
+    return false;
+
+  bool pipeline_cache_saved = pipeline_cache_->Save();
+  bool shader_store_saved = shader_store_->Save();
+  return pipeline_cache_saved && shader_store_saved;
+}
+
 void GFXDevice::CallDeviceErrorCallback(WGPUErrorType type,
                                         const std::string& message) {
   if (uncaptured_error_callback_.callback) {
@@ -73,52 +121,31 @@ WGPUBindGroup GFXDevice::CreateBindGroup(
   auto* bind_group_layout =
       static_cast<GFXBindGroupLayout*>(descriptor->layout);
 
-  // Pool
-  std::vector<VkDescriptorPoolSize> pool_sizes;
-  for (const auto& it : bind_group_layout->GetLayoutEntries()) {
-    auto descriptor_type = ToVulkanDescriptorType(it.main);
-    auto iter = std::find_if(pool_sizes.begin(), pool_sizes.end(),
-                             [&](const VkDescriptorPoolSize& it) {
-                               return it.type == descriptor_type;
-                             });
-
-    auto descriptor_count = std::max<uint32_t>(1, it.main.bindingArraySize);
-    if (iter != pool_sizes.end()) {
-      iter->descriptorCount += descriptor_count;
-    } else {
-      pool_sizes.push_back(
-          VkDescriptorPoolSize{descriptor_type, descriptor_count});
-    }
+  // Identical descriptors share one bind group
+  GFXBindGroupCache::Key cache_key;
+  if (bind_group_cache_) {
+    cache_key = GFXBindGroupCache::MakeKey(descriptor);
+    if (auto* cached_bind_group = bind_group_cache_->Find(cache_key))
+      return cached_bind_group;
   }
 
-  VkDescriptorPoolCreateInfo pool_create_info = {
-      VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO};
-  pool_create_info.maxSets = 1;
-  pool_create_info.poolSizeCount = pool_sizes.size();
-  pool_create_info.pPoolSizes = pool_sizes.data();
-
-  VkDescriptorPool pool;
-  if (vkCreateDescriptorPool(device_, &pool_create_info, nullptr, &pool) !=
-      VK_SUCCESS)
+  GFXDescriptorAllocator::Allocation allocation;
+  if (!descriptor_allocator_->Allocate(bind_group_layout, &allocation))
     return nullptr;
 
-  // Set
-  auto vk_layout = bind_group_layout->GetVkHandle();
-
-  VkDescriptorSetAllocateInfo allocate_info = {
-      VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO};
-  allocate_info.descriptorPool = pool;
-  allocate_info.descriptorSetCount = 1;
-  allocate_info.pSetLayouts = &vk_layout;
-
-  VkDescriptorSet descriptor_set;
-  vkAllocateDescriptorSets(device_, &allocate_info, &descriptor_set);
-
   auto* bind_group =
-      new GFXBindGroup(pool, descriptor_set, this, descriptor->label);
-  bind_group->Write(descriptor);
+      new GFXBindGroup(allocation, bind_group_layout, this, descriptor->label);
+  if (!bind_group->Write(descriptor)) {
+    // Returns the set to the allocator
+    delete bind_group;
+    return nullptr;
+  }
 
-  return AdaptExternalRefCounted(bind_group);
+  AdaptExternalRefCounted(bind_group);
+  if (bind_group_cache_)
+    bind_group_cache_->Insert(std::move(cache_key), bind_group);
+
+  return bind_group;
 }
 
 WGPUBindGroupLayout GFXDevice::CreateBindGroupLayout(
@@ -129,11 +156,14 @@ WGPUBindGroupLayout GFXDevice::CreateBindGroupLayout(
   if (!descriptor)
     return nullptr;
 
+  // Identical entry lists share one layout
+  auto cache_key = GFXLayoutCache::MakeBindGroupLayoutKey(descriptor);
+  if (auto* interned_layout = layout_cache_->FindBindGroupLayout(cache_key))
+    return interned_layout;
+
   std::vector<GFXBindGroupLayout::LayoutEntry> layout_entries;
   std::vector<VkDescriptorSetLayoutBinding> vk_bindings;
-  for (size_t i = 0; i < descriptor->entryCount; ++i) {
-    const auto& entry = descriptor->entries[i];
-
+  for (const auto& entry : cache_key.entries) {
     VkDescriptorSetLayoutBinding vk_binding = {};
     vk_binding.binding = entry.binding;
     vk_binding.descriptorType = ToVulkanDescriptorType(entry);
@@ -156,8 +186,14 @@ WGPUBindGroupLayout GFXDevice::CreateBindGroupLayout(
       VK_SUCCESS)
     return nullptr;
 
-  return AdaptExternalRefCounted(
+  auto* bind_group_layout = AdaptExternalRefCounted(
       new GFXBindGroupLayout(layout, layout_entries, this, descriptor->label));
+  auto* interned_layout = layout_cache_->InsertBindGroupLayout(
+      std::move(cache_key), bind_group_layout);
+  if (interned_layout != bind_group_layout)
+    bind_group_layout->Release();
+
+  return interned_layout;
 }
 
 WGPUBuffer GFXDevice::CreateBuffer(WGPUBufferDescriptor const* descriptor) {
@@ -167,25 +203,55 @@ WGPUBuffer GFXDevice::CreateBuffer(WGPUBufferDescriptor const* descriptor) {
   if (!descriptor)
     return nullptr;
 
-  VkBufferCreateInfo create_info = {VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO};
-  create_info.size = descriptor->size;
-  create_info.usage = ToVulkanBufferUsage(descriptor->usage);
-
-  VmaAllocationCreateInfo allocation_info = {};
-  allocation_info.usage = VMA_MEMORY_USAGE_AUTO;
-
-  VkBuffer buffer;
-  VmaAllocation allocation;
-  if (vmaCreateBuffer(allocator_, &create_info, &allocation_info, &buffer,
-                      &allocation, nullptr) != VK_SUCCESS)
+  if (descriptor->mappedAtCreation && descriptor->size % 4) {
+    CallDeviceErrorCallback(
+        WGPUErrorType_Validation,
+        "CreateBuffer: mappedAtCreation size must be a multiple of 4.");
     return nullptr;
+  }
 
-  if (descriptor->mappedAtCreation) {
+  GFXBuffer* buffer = nullptr;
+  GFXBufferSuballocator::Allocation suballocation;
+  if (buffer_suballocator_ &&
+      buffer_suballocator_->Allocate(descriptor->size, descriptor->usage,
+                                     &suballocation)) {
+    buffer = new GFXBuffer(suballocation, *descriptor, this);
   } else {
+    VkBufferCreateInfo create_info = {VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO};
+    create_info.size = descriptor->size;
+    create_info.usage = ToVulkanBufferUsage(descriptor->usage);
+
+    // Mappable buffers are mapped once, for their whole lifetime
+    VmaAllocationCreateInfo allocation_info = {};
+    allocation_info.usage = VMA_MEMORY_USAGE_AUTO;
+    if (descriptor->usage & WGPUBufferUsage_MapRead)
+      allocation_info.flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT |
+                              VMA_ALLOCATION_CREATE_MAPPED_BIT;
+    else if (descriptor->usage & WGPUBufferUsage_MapWrite)
+      allocation_info.flags =
+          VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT |
+          VMA_ALLOCATION_CREATE_MAPPED_BIT;
+    else if (descriptor->mappedAtCreation)
+      create_info.usage |= VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+
+    VkBuffer vk_buffer;
+    VmaAllocation allocation;
+    if (vmaCreateBuffer(allocator_, &create_info, &allocation_info,
+                        &vk_buffer, &allocation, nullptr) != VK_SUCCESS)
+      return nullptr;
+
+    buffer = new GFXBuffer(vk_buffer, allocation, *descriptor, this);
   }
 
-  return AdaptExternalRefCounted(
-      new GFXBuffer(buffer, allocation, this, descriptor->label));
+  if (descriptor->mappedAtCreation && !buffer->MapAtCreation()) {
+    delete buffer;
+    CallDeviceErrorCallback(
+        WGPUErrorType_OutOfMemory,
+        "CreateBuffer: Failed to map the buffer at creation.");
+    return nullptr;
+  }
+
+  return AdaptExternalRefCounted(buffer);
 }
 
 WGPUCommandEncoder GFXDevice::CreateCommandEncoder(
@@ -193,7 +259,20 @@ WGPUCommandEncoder GFXDevice::CreateCommandEncoder(
   if (!device_)
     return nullptr;
 
-  return WGPUCommandEncoder();
+  // Frames of the thread pools follow the queue submissions
+  GFXCommandAllocator::Allocation allocation;
+  if (!command_allocator_->Allocate(queue_->GetPendingSerial(),
+                                    queue_->GetCompletedSerial(),
+                                    &allocation)) {
+    CallDeviceErrorCallback(
+        WGPUErrorType_OutOfMemory,
+        "CreateCommandEncoder: Failed to allocate command buffer.");
+    return nullptr;
+  }
+
+  WGPUStringView label = descriptor ? descriptor->label : WGPUStringView{};
+  return AdaptExternalRefCounted(
+      new GFXCommandEncoder(allocation, this, label));
 }
 
 WGPUComputePipeline GFXDevice::CreateComputePipeline(
@@ -201,7 +280,19 @@ WGPUComputePipeline GFXDevice::CreateComputePipeline(
   if (!device_)
     return nullptr;
 
-  return WGPUComputePipeline();
+  GFXComputePipeline::CreateInfo create_info;
+  std::string error;
+  if (!GFXComputePipeline::CaptureCreateInfo(descriptor, &create_info,
+                                             &error)) {
+    CallDeviceErrorCallback(WGPUErrorType_Validation, error);
+    return nullptr;
+  }
+
+  auto* pipeline = GFXComputePipeline::Create(this, create_info, &error);
+  if (!pipeline)
+    CallDeviceErrorCallback(WGPUErrorType_Internal, error);
+
+  return pipeline;
 }
 
 WGPUFuture GFXDevice::CreateComputePipelineAsync(
@@ -210,7 +301,8 @@ WGPUFuture GFXDevice::CreateComputePipelineAsync(
   if (!device_)
     return GFXInstance::kInvalidFuture;
 
-  return WGPUFuture();
+  return pipeline_compiler_->CreateComputePipelineAsync(descriptor,
+                                                        callbackInfo);
 }
 
 WGPUPipelineLayout GFXDevice::CreatePipelineLayout(
@@ -218,7 +310,77 @@ WGPUPipelineLayout GFXDevice::CreatePipelineLayout(
   if (!device_)
     return nullptr;
 
-  return WGPUPipelineLayout();
+  if (!descriptor)
+    return nullptr;
+
+  // Unused slots are bound to the interned empty layout
+  RefPtr<GFXBindGroupLayout> empty_layout;
+  std::vector<RefPtr<GFXBindGroupLayout>> bind_group_layouts;
+  std::vector<GFXBindGroupLayout*> key_layouts;
+  for (size_t i = 0; i < descriptor->bindGroupLayoutCount; ++i) {
+    auto* bind_group_layout =
+        static_cast<GFXBindGroupLayout*>(descriptor->bindGroupLayouts[i]);
+    if (!bind_group_layout) {
+      if (!empty_layout) {
+        WGPUBindGroupLayoutDescriptor empty_descriptor = {};
+        auto* layout = static_cast<GFXBindGroupLayout*>(
+            CreateBindGroupLayout(&empty_descriptor));
+        if (!layout)
+          return nullptr;
+
+        empty_layout = layout;
+        layout->Release();
+      }
+
+      bind_group_layout = empty_layout.get();
+    }
+
+    bind_group_layouts.push_back(bind_group_layout);
+    key_layouts.push_back(bind_group_layout);
+  }
+
+  // Identical layouts share one pipeline layout
+  auto cache_key = GFXLayoutCache::MakePipelineLayoutKey(
+      key_layouts, descriptor->immediateSize);
+  if (auto* interned_layout = layout_cache_->FindPipelineLayout(cache_key))
+    return interned_layout;
+
+  std::vector<VkDescriptorSetLayout> set_layouts;
+  for (auto* it : key_layouts)
+    set_layouts.push_back(it->GetVkHandle());
+
+  // Immediate data maps onto a single push constant range
+  VkPushConstantRange push_constant_range = {};
+  push_constant_range.stageFlags = VK_SHADER_STAGE_VERTEX_BIT |
+                                   VK_SHADER_STAGE_FRAGMENT_BIT |
+                                   VK_SHADER_STAGE_COMPUTE_BIT;
+  push_constant_range.offset = 0;
+  push_constant_range.size = descriptor->immediateSize;
+
+  VkPipelineLayoutCreateInfo create_info = {
+      VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO};
+  create_info.setLayoutCount = set_layouts.size();
+  create_info.pSetLayouts = set_layouts.data();
+  if (descriptor->immediateSize) {
+    create_info.pushConstantRangeCount = 1;
+    create_info.pPushConstantRanges = &push_constant_range;
+  }
+
+  VkPipelineLayout layout;
+  if (vkCreatePipelineLayout(device_, &create_info, nullptr, &layout) !=
+      VK_SUCCESS)
+    return nullptr;
+
+  auto* pipeline_layout = AdaptExternalRefCounted(
+      new GFXPipelineLayout(layout, std::move(bind_group_layouts),
+                            descriptor->immediateSize, this,
+                            descriptor->label));
+  auto* interned_layout = layout_cache_->InsertPipelineLayout(
+      std::move(cache_key), pipeline_layout);
+  if (interned_layout != pipeline_layout)
+    pipeline_layout->Release();
+
+  return interned_layout;
 }
 
 WGPUQuerySet GFXDevice::CreateQuerySet(
@@ -242,7 +404,19 @@ WGPURenderPipeline GFXDevice::CreateRenderPipeline(
   if (!device_)
     return nullptr;
 
-  return WGPURenderPipeline();
+  GFXRenderPipeline::CreateInfo create_info;
+  std::string error;
+  if (!GFXRenderPipeline::CaptureCreateInfo(descriptor, this, &create_info,
+                                            &error)) {
+    CallDeviceErrorCallback(WGPUErrorType_Validation, error);
+    return nullptr;
+  }
+
+  auto* pipeline = GFXRenderPipeline::Create(this, create_info, &error);
+  if (!pipeline)
+    CallDeviceErrorCallback(WGPUErrorType_Internal, error);
+
+  return pipeline;
 }
 
 WGPUFuture GFXDevice::CreateRenderPipelineAsync(
@@ -251,7 +425,8 @@ WGPUFuture GFXDevice::CreateRenderPipelineAsync(
   if (!device_)
     return GFXInstance::kInvalidFuture;
 
-  return WGPUFuture();
+  return pipeline_compiler_->CreateRenderPipelineAsync(descriptor,
+                                                       callbackInfo);
 }
 
 WGPUSampler GFXDevice::CreateSampler(WGPUSamplerDescriptor const* descriptor) {
@@ -275,22 +450,35 @@ WGPUSampler GFXDevice::CreateSampler(WGPUSamplerDescriptor const* descriptor) {
   create_info.maxLod = descriptor->lodMaxClamp;
   if (descriptor->compare != WGPUCompareFunction_Undefined) {
     create_info.compareEnable = VK_TRUE;
-    create_info.compareOp;
+    create_info.compareOp = ToVulkanCompareOp(descriptor->compare);
   } else {
     create_info.compareEnable = VK_FALSE;
     create_info.compareOp = VK_COMPARE_OP_NEVER;
   }
 
-  if (adapter_->GetDeviceInfo().features.features.samplerAnisotropy) {
+  const auto& device_info = adapter_->GetDeviceInfo();
+  if (device_info.features.features.samplerAnisotropy &&
+      descriptor->maxAnisotropy > 1) {
     create_info.anisotropyEnable = VK_TRUE;
-    create_info.maxAnisotropy = descriptor->maxAnisotropy;
+    create_info.maxAnisotropy =
+        std::min<float>(descriptor->maxAnisotropy,
+                        device_info.properties.properties.limits
+                            .maxSamplerAnisotropy);
   } else {
     create_info.anisotropyEnable = VK_FALSE;
     create_info.maxAnisotropy = 1.0f;
   }
 
+  // Equivalent descriptors share one VkSampler
   VkSampler sampler = VK_NULL_HANDLE;
-  vkCreateSampler(device_, &create_info, nullptr, &sampler);
+  VkResult result = sampler_cache_->Acquire(create_info, &sampler);
+  if (result == VK_ERROR_TOO_MANY_OBJECTS) {
+    CallDeviceErrorCallback(WGPUErrorType_OutOfMemory,
+                            "Sampler allocation limit reached.");
+    return nullptr;
+  } else if (result != VK_SUCCESS) {
+    return nullptr;
+  }
 
   return AdaptExternalRefCounted(
       new GFXSampler(sampler, this, descriptor->label));
@@ -301,7 +489,28 @@ WGPUShaderModule GFXDevice::CreateShaderModule(
   if (!device_)
     return nullptr;
 
-  return WGPUShaderModule();
+  const WGPUShaderSourceSPIRV* spirv_source = nullptr;
+  for (auto* chain = descriptor->nextInChain; chain; chain = chain->next) {
+    if (chain->sType == WGPUSType_ShaderSourceSPIRV)
+      spirv_source = reinterpret_cast<const WGPUShaderSourceSPIRV*>(chain);
+  }
+
+  if (!spirv_source) {
+    CallDeviceErrorCallback(WGPUErrorType_Validation,
+                            "Only SPIR-V shader sources are supported.");
+    return nullptr;
+  }
+
+  std::string error;
+  const auto* module = shader_store_->Acquire(
+      spirv_source->code, spirv_source->codeSize, &error);
+  if (!module) {
+    CallDeviceErrorCallback(WGPUErrorType_Validation, error);
+    return nullptr;
+  }
+
+  return AdaptExternalRefCounted(
+      new GFXShaderModule(module, this, descriptor->label));
 }
 
 WGPUTexture GFXDevice::CreateTexture(WGPUTextureDescriptor const* descriptor) {
@@ -323,14 +532,14 @@ WGPUTexture GFXDevice::CreateTexture(WGPUTextureDescriptor const* descriptor) {
       create_info.imageType = VK_IMAGE_TYPE_2D;
       create_info.extent =
           VkExtent3D{descriptor->size.width, descriptor->size.height, 1};
-      create_info.arrayLayers = 1;
+      create_info.arrayLayers = descriptor->size.depthOrArrayLayers;
       break;
     case WGPUTextureDimension_3D:
       create_info.imageType = VK_IMAGE_TYPE_3D;
       create_info.extent =
           VkExtent3D{descriptor->size.width, descriptor->size.height,
                      descriptor->size.depthOrArrayLayers};
-      create_info.arrayLayers = descriptor->size.depthOrArrayLayers;
+      create_info.arrayLayers = 1;
       break;
   }
   create_info.format = ToVulkanPixelFormat(descriptor->format);
@@ -351,10 +560,41 @@ WGPUTexture GFXDevice::CreateTexture(WGPUTextureDescriptor const* descriptor) {
     return nullptr;
 
   return AdaptExternalRefCounted(
-      new GFXTexture(image, allocation, this, descriptor->label));
+      new GFXTexture(image, allocation, *descriptor, this));
 }
 
 void GFXDevice::Destroy() {
+  // Wait for the GPU before anything it may still use is released
+  if (queue_) {
+    queue_->Destroy();
+    queue_.reset();
+  }
+
+  // Objects released by in flight work, the device is idle now
+  resource_tracker_.reset();
+  command_allocator_.reset();
+
+  // Drain compiles in flight while the caches they use are still alive
+  worker_pool_.reset();
+  pipeline_compiler_.reset();
+
+  if (shader_store_) {
+    shader_store_->Save();
+    shader_store_.reset();
+  }
+
+  if (pipeline_cache_) {
+    pipeline_cache_->Save();
+    pipeline_cache_.reset();
+  }
+
+  bind_group_cache_.reset();
+  render_pass_cache_.reset();
+  layout_cache_.reset();
+  sampler_cache_.reset();
+  descriptor_allocator_.reset();
+  buffer_suballocator_.reset();
+
   if (allocator_) {
     vmaDestroyAllocator(allocator_);
     allocator_ = nullptr;
@@ -393,7 +633,7 @@ WGPUFuture GFXDevice::GetLostFuture() {
 }
 
 WGPUQueue GFXDevice::GetQueue() {
-  return WGPUQueue();
+  return AdaptExternalRefCounted(queue_.get());
 }
 
 WGPUBool GFXDevice::HasFeature(WGPUFeatureName feature) {
@@ -414,6 +654,50 @@ void GFXDevice::SetLabel(WGPUStringView label) {
   label_ = std::string(label.data, label.length);
 }
 
+void GFXDevice::ParseTogglesInternal() {
+  const char* disabled_toggles = std::getenv("VKGFX_DISABLED_TOGGLES");
+  if (!disabled_toggles)
+    return;
+
+  std::stringstream stream(disabled_toggles);
+  std::string toggle;
+  while (std::getline(stream, toggle, ',')) {
+    if (toggle == "bind_group_cache") {
+      toggles_.bind_group_cache = false;
+    } else if (toggle == "buffer_suballocation") {
+      toggles_.buffer_suballocation = false;
+    } else {
+      GFX_WARNING() << "[Device] Unknown toggle: " << toggle;
+      continue;
+    }
+
+    GFX_INFO() << "[Device] Disabled toggle: " << toggle;
+  }
+}
+
+void GFXDevice::CreatePipelineCacheInternal() {
+  const auto& properties = adapter_->GetDeviceInfo().properties.properties;
+
+  // One file per physical device, the header rejects other drivers
+  std::filesystem::path cache_path;
+  if (const char* cache_dir = std::getenv("VKGFX_PIPELINE_CACHE_DIR")) {
+    std::stringstream file_name;
+    file_name << "pipeline_cache_" << std::hex << properties.vendorID << "_"
+              << properties.deviceID << ".bin";
+    cache_path = std::filesystem::path(cache_dir) / file_name.str();
+  }
+
+  pipeline_cache_ =
+      std::make_unique<GFXPipelineCache>(device_, properties, cache_path);
+
+  // Reflection does not depend on the driver, one store for all devices
+  std::filesystem::path store_path;
+  if (const char* cache_dir = std::getenv("VKGFX_PIPELINE_CACHE_DIR"))
+    store_path = std::filesystem::path(cache_dir) / "shader_store.bin";
+
+  shader_store_ = std::make_unique<GFXShaderStore>(device_, store_path);
+}
+
 void GFXDevice::CreateAllocatorInternal() {
   VmaVulkanFunctions vulkan_functions;
   VmaAllocatorCreateInfo allocator_create_info = {};
@@ -592,3 +876,9 @@ GFX_EXPORT void GFX_FUNCTION(DeviceSetLabel)(WGPUDevice device,
   auto* self = static_cast<vkgfx::GFXDevice*>(device);
   self->SetLabel(label);
 }
+
+// vkgfx extension, not part of webgpu.h
+GFX_EXPORT WGPUBool GFX_FUNCTION(DeviceSavePipelineCache)(WGPUDevice device) {
+  auto* self = static_cast<vkgfx::GFXDevice*>(device);
+  return self->SavePipelineCache();
+}
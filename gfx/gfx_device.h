@@ -5,11 +5,24 @@
 #ifndef GFX_GFX_DEVICE_H_
 #define GFX_GFX_DEVICE_H_
 
+#include <memory>
 #include <string>
 
 #include "gfx/common/refptr.h"
 #include "gfx/gfx_adapter.h"
+#include "gfx/gfx_bind_group_cache.h"
+#include "gfx/gfx_buffer_suballocator.h"
+#include "gfx/gfx_command_allocator.h"
 #include "gfx/gfx_config.h"
+#include "gfx/gfx_descriptor_allocator.h"
+#include "gfx/gfx_layout_cache.h"
+#include "gfx/gfx_pipeline_cache.h"
+#include "gfx/gfx_pipeline_compiler.h"
+#include "gfx/gfx_render_pass_cache.h"
+#include "gfx/gfx_resource_track.h"
+#include "gfx/gfx_sampler_cache.h"
+#include "gfx/gfx_shader_store.h"
+#include "gfx/gfx_worker_pool.h"
 
 #include "vma/vma.h"
 
@@ -17,10 +30,22 @@ struct WGPUDeviceImpl {};
 
 namespace vkgfx {
 
+class GFXQueue;
+
 // https://gpuweb.github.io/gpuweb/#gpudevice
 class GFXDevice : public RefCounted<GFXDevice>, public WGPUDeviceImpl {
  public:
+  // Internal behaviour switches, overridable by the VKGFX_DISABLED_TOGGLES
+  // environment variable as a comma separated list of toggle names.
+  struct Toggles {
+    // Return existing bind groups for identical descriptors
+    bool bind_group_cache = true;
+    // Place small buffers in shared VkBuffers
+    bool buffer_suballocation = true;
+  };
+
   GFXDevice(VkDevice device,
+            uint32_t queue_family_index,
             RefPtr<GFXAdapter> adapter,
             WGPUStringView label,
             WGPUDeviceLostCallbackInfo device_lost_callback,
@@ -31,12 +56,42 @@ class GFXDevice : public RefCounted<GFXDevice>, public WGPUDeviceImpl {
   GFXDevice& operator=(const GFXDevice&) = delete;
 
   VkDevice GetVkHandle() const { return device_; }
+  GFXAdapter* GetAdapter() const { return adapter_.get(); }
   VmaAllocator GetAllocator() const { return allocator_; }
+  GFXDescriptorAllocator* GetDescriptorAllocator() const {
+    return descriptor_allocator_.get();
+  }
+  GFXBufferSuballocator* GetBufferSuballocator() const {
+    return buffer_suballocator_.get();
+  }
+  GFXBindGroupCache* GetBindGroupCache() const {
+    return bind_group_cache_.get();
+  }
+  GFXLayoutCache* GetLayoutCache() const { return layout_cache_.get(); }
+  GFXSamplerCache* GetSamplerCache() const { return sampler_cache_.get(); }
+  GFXPipelineCache* GetPipelineCache() const { return pipeline_cache_.get(); }
+  GFXShaderStore* GetShaderStore() const { return shader_store_.get(); }
+  GFXRenderPassCache* GetRenderPassCache() const {
+    return render_pass_cache_.get();
+  }
+  GFXWorkerPool* GetWorkerPool() const { return worker_pool_.get(); }
+  GFXCommandAllocator* GetCommandAllocator() const {
+    return command_allocator_.get();
+  }
+  GFXResourceTracker* GetResourceTracker() const {
+    return resource_tracker_.get();
+  }
+  GFXQueue* GetDefaultQueue() const { return queue_.get(); }
+  const Toggles& GetToggles() const { return toggles_; }
 
   void CallDeviceLostCallback(WGPUDeviceLostReason reason,
                               const std::string& message);
   void CallDeviceErrorCallback(WGPUErrorType type, const std::string& message);
 
+  // Writes the pipeline cache and the shader store to the directory named by
+  // the VKGFX_PIPELINE_CACHE_DIR environment variable, also done on Destroy.
+  bool SavePipelineCache();
+
  public:
   WGPUBindGroup CreateBindGroup(WGPUBindGroupDescriptor const* descriptor);
   WGPUBindGroupLayout CreateBindGroupLayout(
@@ -76,11 +131,28 @@ class GFXDevice : public RefCounted<GFXDevice>, public WGPUDeviceImpl {
 
  private:
   void CreateAllocatorInternal();
+  void ParseTogglesInternal();
+  void CreatePipelineCacheInternal();
 
   VkDevice device_;
 
   RefPtr<GFXAdapter> adapter_;
   VmaAllocator allocator_;
+  RefPtr<GFXQueue> queue_;
+  std::unique_ptr<GFXDescriptorAllocator> descriptor_allocator_;
+  std::unique_ptr<GFXBufferSuballocator> buffer_suballocator_;
+  std::unique_ptr<GFXBindGroupCache> bind_group_cache_;
+  std::unique_ptr<GFXLayoutCache> layout_cache_;
+  std::unique_ptr<GFXSamplerCache> sampler_cache_;
+  std::unique_ptr<GFXPipelineCache> pipeline_cache_;
+  std::unique_ptr<GFXShaderStore> shader_store_;
+  std::unique_ptr<GFXRenderPassCache> render_pass_cache_;
+  std::unique_ptr<GFXWorkerPool> worker_pool_;
+  std::unique_ptr<GFXPipelineCompiler> pipeline_compiler_;
+  std::unique_ptr<GFXResourceTracker> resource_tracker_;
+  std::unique_ptr<GFXCommandAllocator> command_allocator_;
+
+  Toggles toggles_;
 
   std::string label_ = "GFX.Device";
   WGPUDeviceLostCallbackInfo device_lost_callback_;
@@ -0,0 +1,352 @@
+// Copyright 2025 Admenri.
+// Use of this source code is governed by a MIT-style license that can be
+// found in the LICENSE file.
+
+#include "gfx/gfx_event_manager.h"
+
+#include <chrono>
+#include <vector>
+
+#include "gfx/common/log.h"
+#include "gfx/gfx_instance.h"
+
+namespace vkgfx {
+
+namespace {
+
+constexpr uint64_t kIndexMask = 0xFFFFFFFF;
+
+}  // namespace
+
+///////////////////////////////////////////////////////////////////////////////
+// GFXEventManager Implement
+
+GFXEventManager::~GFXEventManager() {
+  for (auto& chunk : chunks_)
+    delete[] chunk.load(std::memory_order_relaxed);
+}
+
+WGPUFuture GFXEventManager::RegisterEvent(WGPUCallbackMode mode) {
+  return RegisterEvent(mode, nullptr, 0, nullptr);
+}
+
+WGPUFuture GFXEventManager::RegisterEvent(WGPUCallbackMode mode,
+                                          GFXQueue* queue,
+                                          uint64_t serial,
+                                          Callback resolve) {
+  const uint32_t index = AcquireSlot();
+  if (index == UINT32_MAX) {
+    GFX_ERROR() << __FUNCTION__ << ": Too many pending events.";
+    return GFXInstance::kInvalidFuture;
+  }
+
+  // Generations stay within the 32 bits a future id has for them
+  Slot* slot = GetSlot(index);
+  uint64_t generation =
+      ((slot->state.load(std::memory_order_relaxed) >> 2) + 1) & kIndexMask;
+  if (!generation)
+    generation = 1;
+
+  slot->mode.store(mode, std::memory_order_relaxed);
+  slot->queue.store(queue, std::memory_order_relaxed);
+  slot->serial.store(serial, std::memory_order_relaxed);
+  slot->resolve = std::move(resolve);
+  slot->state.store(generation << 2 | kPending, std::memory_order_release);
+  return WGPUFuture{generation << 32 | (index + 1)};
+}
+
+void GFXEventManager::CompleteEvent(WGPUFuture future, Callback callback) {
+  uint32_t index;
+  uint64_t generation;
+  Slot* slot = LookupSlot(future, &index, &generation);
+  if (!slot)
+    return;
+
+  uint64_t state = generation << 2 | kPending;
+  if (!slot->state.compare_exchange_strong(state, generation << 2 | kBusy,
+                                           std::memory_order_acquire)) {
+    // Resolved already, the callback waiting to fire is replaced
+    state = generation << 2 | kCompleted;
+    if (!slot->state.compare_exchange_strong(state, generation << 2 | kBusy,
+                                             std::memory_order_acquire))
+      return;
+  }
+
+  slot->resolve = nullptr;
+  CompleteBusyEvent(index, slot, generation, std::move(callback));
+}
+
+void GFXEventManager::ResolveEvent(WGPUFuture future) {
+  uint32_t index;
+  uint64_t generation;
+  Slot* slot = LookupSlot(future, &index, &generation);
+  if (!slot)
+    return;
+
+  uint64_t state = generation << 2 | kPending;
+  if (!slot->state.compare_exchange_strong(state, generation << 2 | kBusy,
+                                           std::memory_order_acquire))
+    return;
+
+  Callback resolve = std::move(slot->resolve);
+  CompleteBusyEvent(index, slot, generation, std::move(resolve));
+}
+
+void GFXEventManager::ProcessEvents() {
+  const uint32_t slot_count = slot_count_.load(std::memory_order_acquire);
+  for (uint32_t index = 0; index < slot_count; ++index) {
+    Slot* slot = GetSlot(index);
+    uint64_t state = slot->state.load(std::memory_order_acquire);
+    if ((state & kStatusMask) != kCompleted ||
+        slot->mode.load(std::memory_order_relaxed) !=
+            WGPUCallbackMode_AllowProcessEvents)
+      continue;
+
+    const uint64_t generation = state >> 2;
+    if (!slot->state.compare_exchange_strong(state, generation << 2 | kBusy,
+                                             std::memory_order_acquire))
+      continue;
+
+    // Callbacks may re-enter the instance, nothing is held here
+    Callback callback = std::move(slot->callback);
+    ReleaseSlot(index, slot, generation);
+    if (callback)
+      callback();
+  }
+}
+
+WGPUWaitStatus GFXEventManager::WaitAny(size_t future_count,
+                                        WGPUFutureWaitInfo* futures,
+                                        uint64_t timeout_ns) {
+  if (PollFutures(future_count, futures))
+    return WGPUWaitStatus_Success;
+  if (!timeout_ns)
+    return WGPUWaitStatus_TimedOut;
+
+  const auto deadline = std::chrono::steady_clock::now() +
+                        std::chrono::nanoseconds(timeout_ns);
+  bool any_completed = false;
+  ++waiters_;
+  while (true) {
+    // Completions bump the epoch before looking for waiters, one after the
+    // poll below is never missed.
+    const uint32_t epoch = completion_epoch_;
+    any_completed = PollFutures(future_count, futures);
+    if (any_completed)
+      break;
+
+    std::unique_lock guard(wait_lock_);
+    if (!event_completed_.wait_until(guard, deadline, [this, epoch]() {
+          return completion_epoch_ != epoch;
+        })) {
+      guard.unlock();
+      any_completed = PollFutures(future_count, futures);
+      break;
+    }
+  }
+  --waiters_;
+
+  return any_completed ? WGPUWaitStatus_Success : WGPUWaitStatus_TimedOut;
+}
+
+WGPUWaitStatus GFXEventManager::Poll(size_t future_count,
+                                     WGPUFutureWaitInfo* futures,
+                                     const QueueProgress* progress,
+                                     size_t progress_count) {
+  return PollFutures(future_count, futures, progress, progress_count)
+             ? WGPUWaitStatus_Success
+             : WGPUWaitStatus_TimedOut;
+}
+
+bool GFXEventManager::GetPendingWaits(size_t future_count,
+                                      const WGPUFutureWaitInfo* futures,
+                                      std::vector<SerialWait>* waits) {
+  bool other_pending = false;
+  for (size_t i = 0; i < future_count; ++i) {
+    uint32_t index;
+    uint64_t generation;
+    Slot* slot = LookupSlot(futures[i].future, &index, &generation);
+    if (!slot)
+      continue;
+
+    const uint64_t state = slot->state.load(std::memory_order_acquire);
+    if (state != (generation << 2 | kPending) &&
+        state != (generation << 2 | kBusy))
+      continue;
+
+    GFXQueue* queue = slot->queue.load(std::memory_order_relaxed);
+    const uint64_t serial = slot->serial.load(std::memory_order_relaxed);
+    // Reused in between, the event fired already
+    if (slot->state.load(std::memory_order_acquire) >> 2 != generation)
+      continue;
+
+    if (queue)
+      waits->push_back({queue, serial});
+    else
+      other_pending = true;
+  }
+
+  return other_pending;
+}
+
+GFXEventManager::Slot* GFXEventManager::GetSlot(uint32_t index) const {
+  Slot* chunk = chunks_[index / kChunkSize].load(std::memory_order_acquire);
+  return chunk + index % kChunkSize;
+}
+
+GFXEventManager::Slot* GFXEventManager::LookupSlot(
+    WGPUFuture future,
+    uint32_t* index,
+    uint64_t* generation) const {
+  const uint64_t slot_id = future.id & kIndexMask;
+  *generation = future.id >> 32;
+  if (!slot_id || !*generation ||
+      slot_id > slot_count_.load(std::memory_order_acquire))
+    return nullptr;
+
+  *index = static_cast<uint32_t>(slot_id - 1);
+  return GetSlot(*index);
+}
+
+uint32_t GFXEventManager::AcquireSlot() {
+  // The tag changes on every pop and push, a slot popped and pushed back in
+  // between fails the exchange.
+  uint64_t head = free_head_.load(std::memory_order_acquire);
+  while (head & kIndexMask) {
+    const uint32_t index = static_cast<uint32_t>((head & kIndexMask) - 1);
+    const uint32_t next =
+        GetSlot(index)->next_free.load(std::memory_order_relaxed);
+    const uint64_t new_head = ((head >> 32) + 1) << 32 | next;
+    if (free_head_.compare_exchange_weak(head, new_head,
+                                         std::memory_order_acquire))
+      return index;
+  }
+
+  // Grows the table, the chunk is visible before the slot count
+  std::lock_guard guard(chunk_lock_);
+  const uint32_t index = slot_count_.load(std::memory_order_relaxed);
+  const uint32_t chunk_index = index / kChunkSize;
+  if (chunk_index == kMaxChunks)
+    return UINT32_MAX;
+
+  if (!chunks_[chunk_index].load(std::memory_order_relaxed))
+    chunks_[chunk_index].store(new Slot[kChunkSize],
+                               std::memory_order_release);
+  slot_count_.store(index + 1, std::memory_order_release);
+  return index;
+}
+
+void GFXEventManager::ReleaseSlot(uint32_t index,
+                                  Slot* slot,
+                                  uint64_t generation) {
+  slot->callback = nullptr;
+  slot->resolve = nullptr;
+  slot->queue.store(nullptr, std::memory_order_relaxed);
+  slot->state.store(generation << 2 | kFree, std::memory_order_release);
+
+  uint64_t head = free_head_.load(std::memory_order_relaxed);
+  uint64_t new_head;
+  do {
+    slot->next_free.store(static_cast<uint32_t>(head & kIndexMask),
+                          std::memory_order_relaxed);
+    new_head = ((head >> 32) + 1) << 32 | (index + 1);
+  } while (!free_head_.compare_exchange_weak(head, new_head,
+                                             std::memory_order_release,
+                                             std::memory_order_relaxed));
+}
+
+void GFXEventManager::CompleteBusyEvent(uint32_t index,
+                                        Slot* slot,
+                                        uint64_t generation,
+                                        Callback callback) {
+  // Spontaneous callbacks run on the completing thread
+  if (slot->mode.load(std::memory_order_relaxed) ==
+      WGPUCallbackMode_AllowSpontaneous) {
+    ReleaseSlot(index, slot, generation);
+    if (callback)
+      callback();
+    return;
+  }
+
+  slot->callback = std::move(callback);
+  slot->state.store(generation << 2 | kCompleted);
+  NotifyWaiters();
+}
+
+bool GFXEventManager::PollFuture(WGPUFutureWaitInfo* wait_info,
+                                 const QueueProgress* progress,
+                                 size_t progress_count) {
+  wait_info->completed = WGPU_FALSE;
+  if (wait_info->future.id == GFXInstance::kImmediateFuture.id) {
+    wait_info->completed = WGPU_TRUE;
+    return true;
+  }
+
+  uint32_t index;
+  uint64_t generation;
+  Slot* slot = LookupSlot(wait_info->future, &index, &generation);
+  if (!slot)
+    return false;
+
+  uint64_t state = slot->state.load(std::memory_order_acquire);
+  const uint64_t slot_generation = state >> 2;
+  if (slot_generation != generation || (state & kStatusMask) == kFree) {
+    // Already fired, either by an earlier wait or spontaneously
+    const bool fired = generation <= slot_generation;
+    wait_info->completed = fired ? WGPU_TRUE : WGPU_FALSE;
+    return fired;
+  }
+
+  if ((state & kStatusMask) == kPending) {
+    // Fired here once the queue progress covers its serial, whoever ticks
+    // the queue later finds it resolved.
+    GFXQueue* queue = slot->queue.load(std::memory_order_relaxed);
+    const uint64_t serial = slot->serial.load(std::memory_order_relaxed);
+    if (!queue)
+      return false;
+
+    const QueueProgress* it = progress;
+    const QueueProgress* end = progress + progress_count;
+    while (it != end && it->queue != queue)
+      ++it;
+    if (it == end || it->completed_serial < serial)
+      return false;
+  } else if ((state & kStatusMask) != kCompleted) {
+    return false;
+  }
+
+  // Another waiter firing it concurrently reports it instead
+  const bool resolving = (state & kStatusMask) == kPending;
+  if (!slot->state.compare_exchange_strong(state, generation << 2 | kBusy,
+                                           std::memory_order_acquire))
+    return false;
+
+  Callback callback = std::move(resolving ? slot->resolve : slot->callback);
+  ReleaseSlot(index, slot, generation);
+  wait_info->completed = WGPU_TRUE;
+  if (callback)
+    callback();
+  return true;
+}
+
+bool GFXEventManager::PollFutures(size_t future_count,
+                                  WGPUFutureWaitInfo* futures,
+                                  const QueueProgress* progress,
+                                  size_t progress_count) {
+  bool any_completed = false;
+  for (size_t i = 0; i < future_count; ++i)
+    any_completed |= PollFuture(&futures[i], progress, progress_count);
+  return any_completed;
+}
+
+void GFXEventManager::NotifyWaiters() {
+  ++completion_epoch_;
+  if (!waiters_)
+    return;
+
+  // Waiters check the epoch under the lock before sleeping
+  { std::lock_guard guard(wait_lock_); }
+  event_completed_.notify_all();
+}
+
+}  // namespace vkgfx
@@ -0,0 +1,162 @@
+// Copyright 2025 Admenri.
+// Use of this source code is governed by a MIT-style license that can be
+// found in the LICENSE file.
+
+#ifndef GFX_GFX_EVENT_MANAGER_H_
+#define GFX_GFX_EVENT_MANAGER_H_
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+#include "gfx/gfx_config.h"
+
+namespace vkgfx {
+
+class GFXQueue;
+
+// Instance level registry backing WGPUFuture.
+// An event is registered with the callback mode of its request and
+// completed later from any thread together with the user callback. The
+// callback then runs exactly once: immediately for AllowSpontaneous, or from
+// WaitAny / ProcessEvents as permitted by the mode.
+// Events resolved by GPU work also record the queue serial completing them
+// and a resolver producing their callback, so waiters can block on the queue
+// instead of polling it, and polls resolve them from the queue progress
+// alone.
+// Events live in a table of slots which never moves, a future id packs the
+// slot index with the generation of the slot, lookups are O(1). The status
+// and the generation of a slot change together in one atomic, so polling
+// and completing never lock.
+class GFXEventManager {
+ public:
+  using Callback = std::function<void()>;
+
+  struct SerialWait {
+    GFXQueue* queue;
+    uint64_t serial;
+  };
+
+  // Last serial known complete on |queue|, gathered by the poller.
+  struct QueueProgress {
+    GFXQueue* queue;
+    uint64_t completed_serial;
+  };
+
+  GFXEventManager() = default;
+  ~GFXEventManager();
+
+  GFXEventManager(const GFXEventManager&) = delete;
+  GFXEventManager& operator=(const GFXEventManager&) = delete;
+
+  WGPUFuture RegisterEvent(WGPUCallbackMode mode);
+  // Completed once |serial| completed on |queue|, with |resolve| as the
+  // callback, either by ResolveEvent or by a poll seeing the serial done.
+  // |queue| is only used as a key, it may be gone by the time it is waited
+  // on.
+  WGPUFuture RegisterEvent(WGPUCallbackMode mode,
+                           GFXQueue* queue,
+                           uint64_t serial,
+                           Callback resolve);
+  // Completes the event with |callback| instead of its resolver. An event
+  // completed but not fired yet gets |callback| in place of the stored one.
+  void CompleteEvent(WGPUFuture future, Callback callback);
+  // Completes the event with its resolver, unless it already was.
+  void ResolveEvent(WGPUFuture future);
+
+  // Runs the completed AllowProcessEvents callbacks.
+  void ProcessEvents();
+
+  // Runs the callbacks of completed |futures|, waiting up to |timeout_ns| for
+  // at least one of them.
+  WGPUWaitStatus WaitAny(size_t future_count,
+                         WGPUFutureWaitInfo* futures,
+                         uint64_t timeout_ns);
+
+  // Runs the callbacks of completed |futures| without waiting, and resolves
+  // those whose serial |progress| shows complete. Polling neither locks nor
+  // allocates, only the callbacks fired may.
+  WGPUWaitStatus Poll(size_t future_count,
+                      WGPUFutureWaitInfo* futures,
+                      const QueueProgress* progress,
+                      size_t progress_count);
+
+  // Queue serials the pending |futures| complete at are added to |waits|.
+  // Returns whether one of them is completed by another thread instead.
+  bool GetPendingWaits(size_t future_count,
+                       const WGPUFutureWaitInfo* futures,
+                       std::vector<SerialWait>* waits);
+
+ private:
+  enum Status : uint64_t {
+    kFree,
+    kPending,
+    // The callback is stored and waits for WaitAny or ProcessEvents
+    kCompleted,
+    // Owned by the thread completing or firing the event
+    kBusy,
+  };
+
+  static constexpr uint64_t kStatusMask = 3;
+  static constexpr uint32_t kChunkSize = 1024;
+  static constexpr uint32_t kMaxChunks = 4096;
+
+  struct Slot {
+    // Generation << 2 | Status
+    std::atomic<uint64_t> state = 0;
+    // Free list link, index + 1 of the next free slot
+    std::atomic<uint32_t> next_free = 0;
+    // Set on registration, polled without owning the slot
+    std::atomic<WGPUCallbackMode> mode = {};
+    std::atomic<GFXQueue*> queue = nullptr;
+    std::atomic<uint64_t> serial = 0;
+    // Only touched by the thread which set the slot busy
+    Callback callback;
+    // Set on registration, taken by the thread resolving the event
+    Callback resolve;
+  };
+
+  Slot* GetSlot(uint32_t index) const;
+  // Null if |future| was never registered here.
+  Slot* LookupSlot(WGPUFuture future,
+                   uint32_t* index,
+                   uint64_t* generation) const;
+  uint32_t AcquireSlot();
+  void ReleaseSlot(uint32_t index, Slot* slot, uint64_t generation);
+  // Runs or stores |callback| of the event the caller set busy.
+  void CompleteBusyEvent(uint32_t index,
+                         Slot* slot,
+                         uint64_t generation,
+                         Callback callback);
+
+  // Fills |wait_info.completed|, running the callback if it is now fired.
+  bool PollFuture(WGPUFutureWaitInfo* wait_info,
+                  const QueueProgress* progress,
+                  size_t progress_count);
+  bool PollFutures(size_t future_count,
+                   WGPUFutureWaitInfo* futures,
+                   const QueueProgress* progress = nullptr,
+                   size_t progress_count = 0);
+  void NotifyWaiters();
+
+  // Chunks are allocated under |chunk_lock_| and freed on destruction
+  std::array<std::atomic<Slot*>, kMaxChunks> chunks_ = {};
+  std::atomic<uint32_t> slot_count_ = 0;
+  std::mutex chunk_lock_;
+  // Lock free stack of released slots, tag << 32 | index + 1
+  std::atomic<uint64_t> free_head_ = 0;
+
+  // Timed waits sleep on |event_completed_|, completions only take the lock
+  // while somebody waits.
+  std::mutex wait_lock_;
+  std::condition_variable event_completed_;
+  std::atomic<uint32_t> waiters_ = 0;
+  std::atomic<uint32_t> completion_epoch_ = 0;
+};
+
+}  // namespace vkgfx
+
+#endif  // GFX_GFX_EVENT_MANAGER_H_
@@ -4,17 +4,28 @@
 
 #include "gfx/gfx_instance.h"
 
+#include <algorithm>
 #include <array>
+#include <chrono>
+#include <thread>
 #include <vector>
 
 #include "gfx/common/log.h"
 #include "gfx/common/platform.h"
 #include "gfx/gfx_adapter.h"
+#include "gfx/gfx_queue.h"
 #include "gfx/gfx_surface.h"
 #include "gfx/gfx_utils.h"
 
 namespace vkgfx {
 
+namespace {
+
+// Bounds the sleeps which cannot observe every pending future
+constexpr auto kPollInterval = std::chrono::milliseconds(1);
+
+}  // namespace
+
 ///////////////////////////////////////////////////////////////////////////////
 // GFXInstance Implement
 
@@ -29,6 +40,29 @@ GFXInstance::~GFXInstance() {
     vkDestroyInstance(instance_, nullptr);
 }
 
+void GFXInstance::RegisterQueue(GFXQueue* queue) {
+  for (auto& slot : queues_) {
+    GFXQueue* expected = nullptr;
+    if (slot.queue.compare_exchange_strong(expected, queue))
+      return;
+  }
+
+  GFX_ERROR() << __FUNCTION__ << ": Too many queues, the queue is not polled.";
+}
+
+void GFXInstance::UnregisterQueue(GFXQueue* queue) {
+  for (auto& slot : queues_) {
+    GFXQueue* expected = queue;
+    if (!slot.queue.compare_exchange_strong(expected, nullptr))
+      continue;
+
+    // Pollers only hold the slot while taking a reference
+    while (slot.readers)
+      std::this_thread::yield();
+    return;
+  }
+}
+
 WGPUSurface GFXInstance::CreateSurface(
     WGPUSurfaceDescriptor const* descriptor) {
   if (!descriptor)
@@ -74,7 +108,8 @@ WGPUBool GFXInstance::HasWGSLLanguageFeature(
 }
 
 void GFXInstance::ProcessEvents() {
-  // No-op
+  TickQueuesInternal();
+  event_manager_.ProcessEvents();
 }
 
 WGPUFuture GFXInstance::RequestAdapter(
@@ -129,12 +164,136 @@ WGPUWaitStatus GFXInstance::WaitAny(size_t futureCount,
                                     uint64_t timeoutNS) {
   if (!futures)
     return WGPUWaitStatus_Error;
+  if (timeoutNS && futureCount > kTimedWaitAnyMaxCount)
+    return WGPUWaitStatus_Error;
+
+  WGPUWaitStatus status = PollFuturesInternal(futureCount, futures);
+  if (status != WGPUWaitStatus_TimedOut || !timeoutNS)
+    return status;
+
+  // Timed waits tick the queues themselves, work waiting on them may need
+  // the pending queue writes submitted.
+  TickQueuesInternal();
+  status = event_manager_.WaitAny(futureCount, futures, 0);
+  if (status != WGPUWaitStatus_TimedOut)
+    return status;
+
+  const auto deadline = std::chrono::steady_clock::now() +
+                        std::chrono::nanoseconds(timeoutNS);
+  std::vector<GFXEventManager::SerialWait> waits;
+  while (true) {
+    auto remaining = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        deadline - std::chrono::steady_clock::now());
+    if (remaining <= std::chrono::nanoseconds::zero())
+      return WGPUWaitStatus_TimedOut;
+
+    waits.clear();
+    bool other_pending =
+        event_manager_.GetPendingWaits(futureCount, futures, &waits);
+    if (waits.empty()) {
+      // Only other threads complete what is pending
+      status =
+          event_manager_.WaitAny(futureCount, futures, remaining.count());
+    } else if (!other_pending) {
+      // Only GPU work is pending, sleep on the queues until the earliest
+      // serial completes, then let the queues run its tasks.
+      WaitQueueSerialsInternal(waits, remaining.count());
+      TickQueuesInternal();
+      status = event_manager_.WaitAny(futureCount, futures, 0);
+    } else {
+      // Both, nothing wakes up on either, poll the queues meanwhile
+      auto slice =
+          std::min<std::chrono::nanoseconds>(remaining, kPollInterval);
+      status = event_manager_.WaitAny(futureCount, futures, slice.count());
+      if (status == WGPUWaitStatus_TimedOut)
+        TickQueuesInternal();
+    }
+
+    if (status != WGPUWaitStatus_TimedOut)
+      return status;
+  }
+}
 
-  for (size_t i = 0; i < futureCount; ++i)
-    if (futures[i].future.id == kImmediateFuture.id)
-      futures[i].completed = WGPU_TRUE;
+GFXQueue* GFXInstance::AcquireQueueInternal(QueueSlot& slot) {
+  if (!slot.queue.load(std::memory_order_relaxed))
+    return nullptr;
+
+  // A queue being destroyed refuses the reference, UnregisterQueue keeps
+  // its memory around until the readers left.
+  ++slot.readers;
+  GFXQueue* queue = slot.queue;
+  if (queue && !queue->TryAddRef())
+    queue = nullptr;
+  --slot.readers;
+  return queue;
+}
+
+void GFXInstance::TickQueuesInternal() {
+  // Ticking runs callbacks which may register or release queues, a
+  // reference keeps each one alive while it is ticked.
+  for (auto& slot : queues_) {
+    if (GFXQueue* queue = AcquireQueueInternal(slot)) {
+      queue->Tick();
+      queue->Release();
+    }
+  }
+}
+
+WGPUWaitStatus GFXInstance::PollFuturesInternal(
+    size_t future_count,
+    WGPUFutureWaitInfo* futures) {
+  // Lock free: the queue stays registered while it is read, which keeps its
+  // timeline semaphore alive.
+  std::array<GFXEventManager::QueueProgress, kMaxQueues> progress;
+  size_t progress_count = 0;
+  for (auto& slot : queues_) {
+    if (!slot.queue.load(std::memory_order_relaxed))
+      continue;
+
+    ++slot.readers;
+    if (GFXQueue* queue = slot.queue)
+      progress[progress_count++] = {queue, queue->PollCompletedSerial()};
+    --slot.readers;
+  }
+
+  return event_manager_.Poll(future_count, futures, progress.data(),
+                             progress_count);
+}
+
+void GFXInstance::WaitQueueSerialsInternal(
+    const std::vector<GFXEventManager::SerialWait>& waits,
+    uint64_t timeout_ns) {
+  // Earliest serial per queue still alive
+  std::vector<std::pair<GFXQueue*, uint64_t>> targets;
+  for (auto& slot : queues_) {
+    GFXQueue* queue = AcquireQueueInternal(slot);
+    if (!queue)
+      continue;
+
+    uint64_t serial = std::numeric_limits<uint64_t>::max();
+    for (const auto& wait : waits)
+      if (wait.queue == queue)
+        serial = std::min(serial, wait.serial);
+
+    if (serial == std::numeric_limits<uint64_t>::max())
+      queue->Release();
+    else
+      targets.emplace_back(queue, serial);
+  }
+
+  if (targets.size() == 1) {
+    targets[0].first->WaitForSerial(targets[0].second, timeout_ns);
+  } else {
+    // Queues of different devices cannot be waited on at once
+    const uint64_t slice = std::min<uint64_t>(
+        timeout_ns, std::chrono::nanoseconds(kPollInterval).count());
+    for (const auto& target : targets)
+      if (target.first->WaitForSerial(target.second, slice))
+        break;
+  }
 
-  return WGPUWaitStatus_Success;
+  for (const auto& target : targets)
+    target.first->Release();
 }
 
 }  // namespace vkgfx
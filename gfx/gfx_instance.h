@@ -5,16 +5,22 @@
 #ifndef GFX_GFX_INSTANCE_H_
 #define GFX_GFX_INSTANCE_H_
 
+#include <array>
+#include <atomic>
 #include <limits>
 #include <utility>
+#include <vector>
 
 #include "gfx/common/refptr.h"
 #include "gfx/gfx_config.h"
+#include "gfx/gfx_event_manager.h"
 
 struct WGPUInstanceImpl {};
 
 namespace vkgfx {
 
+class GFXQueue;
+
 // https://gpuweb.github.io/gpuweb/#gpu
 class GFXInstance : public RefCounted<GFXInstance>, public WGPUInstanceImpl {
  public:
@@ -22,6 +28,8 @@ class GFXInstance : public RefCounted<GFXInstance>, public WGPUInstanceImpl {
   static constexpr WGPUFuture kImmediateFuture = {
       std::numeric_limits<uint64_t>::max(),
   };
+  // WGPUInstanceLimits::timedWaitAnyMaxCount
+  static constexpr size_t kTimedWaitAnyMaxCount = 1024;
 
   GFXInstance(VkInstance instance, VkDebugUtilsMessengerEXT debug_messenger);
   ~GFXInstance();
@@ -30,6 +38,14 @@ class GFXInstance : public RefCounted<GFXInstance>, public WGPUInstanceImpl {
   GFXInstance& operator=(const GFXInstance&) = delete;
 
   VkInstance GetVkHandle() const { return instance_; }
+  GFXEventManager* GetEventManager() { return &event_manager_; }
+
+  // Queues are ticked by ProcessEvents and timed waits, so futures waiting
+  // on GPU progress resolve without blocking the submitting thread. Polls
+  // only read their completed serials.
+  // Unregistering waits for pollers which may still be looking at |queue|.
+  void RegisterQueue(GFXQueue* queue);
+  void UnregisterQueue(GFXQueue* queue);
 
  public:
   WGPUSurface CreateSurface(WGPUSurfaceDescriptor const* descriptor);
@@ -43,9 +59,35 @@ class GFXInstance : public RefCounted<GFXInstance>, public WGPUInstanceImpl {
                          uint64_t timeoutNS);
 
  private:
+  // Registered queues, polling them takes no lock
+  static constexpr size_t kMaxQueues = 64;
+
+  struct QueueSlot {
+    std::atomic<GFXQueue*> queue = nullptr;
+    // Pollers between loading |queue| and referencing it
+    std::atomic<uint32_t> readers = 0;
+  };
+
+  // Referenced queue of |slot|, null if empty or being destroyed.
+  GFXQueue* AcquireQueueInternal(QueueSlot& slot);
+  void TickQueuesInternal();
+  // Polls |futures| against the progress of the queues, without ticking
+  // them.
+  WGPUWaitStatus PollFuturesInternal(size_t future_count,
+                                     WGPUFutureWaitInfo* futures);
+  // Blocks until one of |waits| completed on its queue or |timeout_ns|
+  // passed.
+  void WaitQueueSerialsInternal(
+      const std::vector<GFXEventManager::SerialWait>& waits,
+      uint64_t timeout_ns);
+
   VkInstance instance_;
 
   VkDebugUtilsMessengerEXT debug_messenger_;
+
+  GFXEventManager event_manager_;
+
+  std::array<QueueSlot, kMaxQueues> queues_;
 };
 
 }  // namespace vkgfx
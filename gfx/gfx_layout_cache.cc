@@ -0,0 +1,194 @@
+// Copyright 2025 Admenri.
+// Use of this source code is governed by a MIT-style license that can be
+// found in the LICENSE file.
+
+#include "gfx/gfx_layout_cache.h"
+
+#include <algorithm>
+
+#include "gfx/gfx_bind_group_layout.h"
+#include "gfx/gfx_pipeline_layout.h"
+#include "gfx/gfx_utils.h"
+
+namespace vkgfx {
+
+namespace {
+
+bool IsEqualLayoutEntry(const WGPUBindGroupLayoutEntry& lhs,
+                        const WGPUBindGroupLayoutEntry& rhs) {
+  return lhs.binding == rhs.binding && lhs.visibility == rhs.visibility &&
+         lhs.bindingArraySize == rhs.bindingArraySize &&
+         lhs.buffer.type == rhs.buffer.type &&
+         lhs.buffer.hasDynamicOffset == rhs.buffer.hasDynamicOffset &&
+         lhs.buffer.minBindingSize == rhs.buffer.minBindingSize &&
+         lhs.sampler.type == rhs.sampler.type &&
+         lhs.texture.sampleType == rhs.texture.sampleType &&
+         lhs.texture.viewDimension == rhs.texture.viewDimension &&
+         lhs.texture.multisampled == rhs.texture.multisampled &&
+         lhs.storageTexture.access == rhs.storageTexture.access &&
+         lhs.storageTexture.format == rhs.storageTexture.format &&
+         lhs.storageTexture.viewDimension == rhs.storageTexture.viewDimension;
+}
+
+}  // namespace
+
+///////////////////////////////////////////////////////////////////////////////
+// GFXLayoutCache Implement
+
+bool GFXLayoutCache::BindGroupLayoutKey::operator==(
+    const BindGroupLayoutKey& other) const {
+  if (hash != other.hash || entries.size() != other.entries.size())
+    return false;
+
+  for (size_t i = 0; i < entries.size(); ++i)
+    if (!IsEqualLayoutEntry(entries[i], other.entries[i]))
+      return false;
+
+  return true;
+}
+
+bool GFXLayoutCache::PipelineLayoutKey::operator==(
+    const PipelineLayoutKey& other) const {
+  return hash == other.hash && immediate_size == other.immediate_size &&
+         bind_group_layouts == other.bind_group_layouts;
+}
+
+// static
+GFXLayoutCache::BindGroupLayoutKey GFXLayoutCache::MakeBindGroupLayoutKey(
+    const WGPUBindGroupLayoutDescriptor* descriptor) {
+  BindGroupLayoutKey key;
+  key.entries.reserve(descriptor->entryCount);
+
+  for (size_t i = 0; i < descriptor->entryCount; ++i) {
+    WGPUBindGroupLayoutEntry entry = descriptor->entries[i];
+    entry.nextInChain = nullptr;
+    entry.buffer.nextInChain = nullptr;
+    entry.sampler.nextInChain = nullptr;
+    entry.texture.nextInChain = nullptr;
+    entry.storageTexture.nextInChain = nullptr;
+    key.entries.push_back(entry);
+  }
+
+  std::sort(key.entries.begin(), key.entries.end(),
+            [](const WGPUBindGroupLayoutEntry& lhs,
+               const WGPUBindGroupLayoutEntry& rhs) {
+              return lhs.binding < rhs.binding;
+            });
+
+  for (const auto& it : key.entries) {
+    HashCombine(&key.hash, it.binding);
+    HashCombine(&key.hash, static_cast<uint64_t>(it.visibility));
+    HashCombine(&key.hash, it.bindingArraySize);
+    HashCombine(&key.hash, static_cast<uint32_t>(it.buffer.type));
+    HashCombine(&key.hash, static_cast<uint32_t>(it.buffer.hasDynamicOffset));
+    HashCombine(&key.hash, it.buffer.minBindingSize);
+    HashCombine(&key.hash, static_cast<uint32_t>(it.sampler.type));
+    HashCombine(&key.hash, static_cast<uint32_t>(it.texture.sampleType));
+    HashCombine(&key.hash, static_cast<uint32_t>(it.texture.viewDimension));
+    HashCombine(&key.hash, static_cast<uint32_t>(it.texture.multisampled));
+    HashCombine(&key.hash, static_cast<uint32_t>(it.storageTexture.access));
+    HashCombine(&key.hash, static_cast<uint32_t>(it.storageTexture.format));
+    HashCombine(&key.hash,
+                static_cast<uint32_t>(it.storageTexture.viewDimension));
+  }
+
+  return key;
+}
+
+// static
+GFXLayoutCache::PipelineLayoutKey GFXLayoutCache::MakePipelineLayoutKey(
+    const std::vector<GFXBindGroupLayout*>& bind_group_layouts,
+    uint32_t immediate_size) {
+  PipelineLayoutKey key;
+  key.bind_group_layouts = bind_group_layouts;
+  key.immediate_size = immediate_size;
+
+  for (auto* it : key.bind_group_layouts)
+    HashCombine(&key.hash, static_cast<const void*>(it));
+  HashCombine(&key.hash, key.immediate_size);
+
+  return key;
+}
+
+GFXBindGroupLayout* GFXLayoutCache::FindBindGroupLayout(
+    const BindGroupLayoutKey& key) {
+  std::lock_guard guard(lock_);
+  return FindLocked(&bind_group_layouts_, key);
+}
+
+GFXPipelineLayout* GFXLayoutCache::FindPipelineLayout(
+    const PipelineLayoutKey& key) {
+  std::lock_guard guard(lock_);
+  return FindLocked(&pipeline_layouts_, key);
+}
+
+GFXBindGroupLayout* GFXLayoutCache::InsertBindGroupLayout(
+    BindGroupLayoutKey key,
+    GFXBindGroupLayout* layout) {
+  std::lock_guard guard(lock_);
+  return InsertLocked(&bind_group_layouts_, std::move(key), layout);
+}
+
+GFXPipelineLayout* GFXLayoutCache::InsertPipelineLayout(
+    PipelineLayoutKey key,
+    GFXPipelineLayout* layout) {
+  std::lock_guard guard(lock_);
+  return InsertLocked(&pipeline_layouts_, std::move(key), layout);
+}
+
+void GFXLayoutCache::RemoveBindGroupLayout(GFXBindGroupLayout* layout) {
+  std::lock_guard guard(lock_);
+  RemoveLocked(&bind_group_layouts_, layout);
+}
+
+void GFXLayoutCache::RemovePipelineLayout(GFXPipelineLayout* layout) {
+  std::lock_guard guard(lock_);
+  RemoveLocked(&pipeline_layouts_, layout);
+}
+
+// static
+template <typename Key, typename Ty>
+Ty* GFXLayoutCache::FindLocked(Table<Key, Ty>* table, const Key& key) {
+  auto it = table->objects.find(key);
+  if (it == table->objects.end())
+    return nullptr;
+
+  // The last reference may be released concurrently, treat it as a miss
+  if (!it->second->TryAddRef())
+    return nullptr;
+
+  return it->second;
+}
+
+// static
+template <typename Key, typename Ty>
+Ty* GFXLayoutCache::InsertLocked(Table<Key, Ty>* table, Key key, Ty* object) {
+  // Lost a creation race, hand out the winner to keep layouts unique
+  if (auto* interned = FindLocked(table, key))
+    return interned;
+
+  // Replaces a dying entry, whose removal is a no-op after this
+  auto it = table->objects.find(key);
+  if (it != table->objects.end()) {
+    table->keys.erase(it->second);
+    table->objects.erase(it);
+  }
+
+  table->objects.emplace(key, object);
+  table->keys.emplace(object, std::move(key));
+
+  return object;
+}
+
+// static
+template <typename Key, typename Ty>
+void GFXLayoutCache::RemoveLocked(Table<Key, Ty>* table, Ty* object) {
+  auto record = table->keys.find(object);
+  if (record == table->keys.end())
+    return;
+
+  table->objects.erase(record->second);
+  table->keys.erase(record);
+}
+
+}  // namespace vkgfx
@@ -0,0 +1,97 @@
+// Copyright 2025 Admenri.
+// Use of this source code is governed by a MIT-style license that can be
+// found in the LICENSE file.
+
+#ifndef GFX_GFX_LAYOUT_CACHE_H_
+#define GFX_GFX_LAYOUT_CACHE_H_
+
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "gfx/gfx_config.h"
+
+namespace vkgfx {
+
+class GFXBindGroupLayout;
+class GFXPipelineLayout;
+
+// Device level interning of bind group layouts and pipeline layouts.
+// Identical descriptors resolve to the same object, so layout compatibility
+// and bind group to layout matching reduce to pointer comparison. Like the
+// bind group cache the entries are weak, each layout removes itself on
+// destruction.
+class GFXLayoutCache {
+ public:
+  struct BindGroupLayoutKey {
+    // Sorted by binding, chained structs stripped
+    std::vector<WGPUBindGroupLayoutEntry> entries;
+    size_t hash = 0;
+
+    bool operator==(const BindGroupLayoutKey& other) const;
+  };
+
+  struct PipelineLayoutKey {
+    // Interned layouts, so pointer identity is content identity
+    std::vector<GFXBindGroupLayout*> bind_group_layouts;
+    uint32_t immediate_size = 0;
+    size_t hash = 0;
+
+    bool operator==(const PipelineLayoutKey& other) const;
+  };
+
+  GFXLayoutCache() = default;
+  ~GFXLayoutCache() = default;
+
+  GFXLayoutCache(const GFXLayoutCache&) = delete;
+  GFXLayoutCache& operator=(const GFXLayoutCache&) = delete;
+
+  static BindGroupLayoutKey MakeBindGroupLayoutKey(
+      const WGPUBindGroupLayoutDescriptor* descriptor);
+  static PipelineLayoutKey MakePipelineLayoutKey(
+      const std::vector<GFXBindGroupLayout*>& bind_group_layouts,
+      uint32_t immediate_size);
+
+  // Returns an interned layout with an extra reference, or null.
+  GFXBindGroupLayout* FindBindGroupLayout(const BindGroupLayoutKey& key);
+  GFXPipelineLayout* FindPipelineLayout(const PipelineLayoutKey& key);
+
+  // Publishes |layout| which must hold a reference already. If another
+  // thread interned an equal layout first, that layout is returned with an
+  // extra reference and the caller should drop its own.
+  GFXBindGroupLayout* InsertBindGroupLayout(BindGroupLayoutKey key,
+                                            GFXBindGroupLayout* layout);
+  GFXPipelineLayout* InsertPipelineLayout(PipelineLayoutKey key,
+                                          GFXPipelineLayout* layout);
+
+  // Called by layout destruction.
+  void RemoveBindGroupLayout(GFXBindGroupLayout* layout);
+  void RemovePipelineLayout(GFXPipelineLayout* layout);
+
+ private:
+  template <typename Key>
+  struct KeyHash {
+    size_t operator()(const Key& key) const { return key.hash; }
+  };
+
+  template <typename Key, typename Ty>
+  struct Table {
+    std::unordered_map<Key, Ty*, KeyHash<Key>> objects;
+    std::unordered_map<Ty*, Key> keys;
+  };
+
+  template <typename Key, typename Ty>
+  static Ty* FindLocked(Table<Key, Ty>* table, const Key& key);
+  template <typename Key, typename Ty>
+  static Ty* InsertLocked(Table<Key, Ty>* table, Key key, Ty* object);
+  template <typename Key, typename Ty>
+  static void RemoveLocked(Table<Key, Ty>* table, Ty* object);
+
+  std::mutex lock_;
+  Table<BindGroupLayoutKey, GFXBindGroupLayout> bind_group_layouts_;
+  Table<PipelineLayoutKey, GFXPipelineLayout> pipeline_layouts_;
+};
+
+}  // namespace vkgfx
+
+#endif  // GFX_GFX_LAYOUT_CACHE_H_
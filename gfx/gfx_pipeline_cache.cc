@@ -0,0 +1,241 @@
+// Copyright 2025 Admenri.
+// Use of this source code is governed by a MIT-style license that can be
+// found in the LICENSE file.
+
+#include "gfx/gfx_pipeline_cache.h"
+
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <string>
+
+#include "gfx/common/log.h"
+#include "gfx/common/platform.h"
+
+#if GFX_PLATFORM_IS(WINDOWS)
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace vkgfx {
+
+namespace {
+
+// FNV-1a, guards against truncated or torn files
+uint64_t HashData(const uint8_t* data, size_t size) {
+  uint64_t hash = 0xcbf29ce484222325ull;
+  for (size_t i = 0; i < size; ++i) {
+    hash ^= data[i];
+    hash *= 0x100000001b3ull;
+  }
+  return hash;
+}
+
+// Processes sharing the cache file, and saves within one, each write their
+// own file before renaming it over the cache.
+std::filesystem::path MakeTempPath(const std::filesystem::path& path) {
+  static std::atomic<uint32_t> save_count = 0;
+
+#if GFX_PLATFORM_IS(WINDOWS)
+  const uint64_t process_id = GetCurrentProcessId();
+#else
+  const uint64_t process_id = getpid();
+#endif
+
+  std::random_device random;
+  std::filesystem::path temp_path = path;
+  temp_path += "." + std::to_string(process_id) + "." +
+               std::to_string(random()) + "." +
+               std::to_string(save_count++) + ".tmp";
+  return temp_path;
+}
+
+}  // namespace
+
+///////////////////////////////////////////////////////////////////////////////
+// GFXPipelineCache Implement
+
+GFXPipelineCache::GFXPipelineCache(VkDevice device,
+                                   const VkPhysicalDeviceProperties& properties,
+                                   const std::filesystem::path& path)
+    : device_(device), properties_(properties), path_(path) {
+  LoadInternal();
+  main_cache_ = CreateCacheInternal();
+}
+
+GFXPipelineCache::~GFXPipelineCache() {
+  for (auto cache : caches_)
+    vkDestroyPipelineCache(device_, cache, nullptr);
+  if (main_cache_)
+    vkDestroyPipelineCache(device_, main_cache_, nullptr);
+}
+
+VkPipelineCache GFXPipelineCache::AcquireCache() {
+  std::lock_guard guard(lock_);
+  if (!free_caches_.empty()) {
+    VkPipelineCache cache = free_caches_.back();
+    free_caches_.pop_back();
+    return cache;
+  }
+
+  VkPipelineCache cache = CreateCacheInternal();
+  if (cache)
+    caches_.push_back(cache);
+  return cache;
+}
+
+void GFXPipelineCache::ReleaseCache(VkPipelineCache cache) {
+  if (!cache)
+    return;
+
+  std::lock_guard guard(lock_);
+  free_caches_.push_back(cache);
+}
+
+bool GFXPipelineCache::Save() {
+  if (path_.empty())
+    return false;
+
+  std::vector<uint8_t> data;
+  {
+    std::lock_guard guard(lock_);
+    if (!main_cache_)
+      return false;
+
+    // Only the destination of a merge needs external synchronization,
+    // leased caches are merged too.
+    if (!caches_.empty() &&
+        vkMergePipelineCaches(device_, main_cache_, caches_.size(),
+                              caches_.data()) != VK_SUCCESS) {
+      GFX_ERROR() << __FUNCTION__ << ": Failed to merge pipeline caches.";
+      return false;
+    }
+
+    size_t data_size = 0;
+    if (vkGetPipelineCacheData(device_, main_cache_, &data_size, nullptr) !=
+        VK_SUCCESS)
+      return false;
+
+    data.resize(data_size);
+    if (vkGetPipelineCacheData(device_, main_cache_, &data_size,
+                               data.data()) != VK_SUCCESS)
+      return false;
+    data.resize(data_size);
+  }
+
+  FileHeader header = MakeHeaderInternal(data);
+
+  // Readers never observe a partially written file
+  std::error_code error;
+  std::filesystem::create_directories(path_.parent_path(), error);
+
+  std::filesystem::path temp_path = MakeTempPath(path_);
+  {
+    std::ofstream stream(temp_path, std::ios::binary | std::ios::trunc);
+    if (!stream)
+      return false;
+
+    stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    stream.write(reinterpret_cast<const char*>(data.data()), data.size());
+    if (!stream.good()) {
+      stream.close();
+      std::filesystem::remove(temp_path, error);
+      return false;
+    }
+  }
+
+  std::filesystem::rename(temp_path, path_, error);
+  if (error) {
+    GFX_ERROR() << __FUNCTION__ << ": Failed to write " << path_.string()
+                << ", " << error.message();
+    std::filesystem::remove(temp_path, error);
+    return false;
+  }
+
+  return true;
+}
+
+void GFXPipelineCache::LoadInternal() {
+  if (path_.empty())
+    return;
+
+  std::error_code error;
+  const auto file_size = std::filesystem::file_size(path_, error);
+  if (error || file_size < sizeof(FileHeader))
+    return;
+
+  std::ifstream stream(path_, std::ios::binary);
+  if (!stream)
+    return;
+
+  FileHeader header;
+  if (!stream.read(reinterpret_cast<char*>(&header), sizeof(header)))
+    return;
+
+  if (header.data_size != file_size - sizeof(header)) {
+    GFX_WARNING() << "[PipelineCache] Truncated cache: " << path_.string();
+    return;
+  }
+
+  FileHeader expected_header = MakeHeaderInternal({});
+  if (header.magic != expected_header.magic ||
+      header.version != expected_header.version ||
+      header.vendor_id != expected_header.vendor_id ||
+      header.device_id != expected_header.device_id ||
+      header.driver_version != expected_header.driver_version ||
+      std::memcmp(header.pipeline_cache_uuid,
+                  expected_header.pipeline_cache_uuid, VK_UUID_SIZE)) {
+    GFX_INFO() << "[PipelineCache] Discarded stale cache: " << path_.string();
+    return;
+  }
+
+  std::vector<uint8_t> data(header.data_size);
+  if (!stream.read(reinterpret_cast<char*>(data.data()), data.size()) ||
+      HashData(data.data(), data.size()) != header.data_hash) {
+    GFX_WARNING() << "[PipelineCache] Corrupted cache: " << path_.string();
+    return;
+  }
+
+  initial_data_ = std::move(data);
+}
+
+VkPipelineCache GFXPipelineCache::CreateCacheInternal() {
+  VkPipelineCacheCreateInfo create_info = {
+      VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO};
+  create_info.initialDataSize = initial_data_.size();
+  create_info.pInitialData = initial_data_.data();
+
+  VkPipelineCache cache = VK_NULL_HANDLE;
+  if (vkCreatePipelineCache(device_, &create_info, nullptr, &cache) ==
+      VK_SUCCESS)
+    return cache;
+
+  // Drivers may still reject the blob, fall back to an empty cache
+  create_info.initialDataSize = 0;
+  create_info.pInitialData = nullptr;
+  if (vkCreatePipelineCache(device_, &create_info, nullptr, &cache) ==
+      VK_SUCCESS)
+    return cache;
+
+  GFX_ERROR() << __FUNCTION__ << ": Failed to create pipeline cache.";
+  return VK_NULL_HANDLE;
+}
+
+GFXPipelineCache::FileHeader GFXPipelineCache::MakeHeaderInternal(
+    const std::vector<uint8_t>& data) const {
+  FileHeader header = {};
+  header.magic = kFileMagic;
+  header.version = kFileVersion;
+  header.vendor_id = properties_.vendorID;
+  header.device_id = properties_.deviceID;
+  header.driver_version = properties_.driverVersion;
+  std::memcpy(header.pipeline_cache_uuid, properties_.pipelineCacheUUID,
+              VK_UUID_SIZE);
+  header.data_size = data.size();
+  header.data_hash = HashData(data.data(), data.size());
+  return header;
+}
+
+}  // namespace vkgfx
@@ -0,0 +1,77 @@
+// Copyright 2025 Admenri.
+// Use of this source code is governed by a MIT-style license that can be
+// found in the LICENSE file.
+
+#ifndef GFX_GFX_PIPELINE_CACHE_H_
+#define GFX_GFX_PIPELINE_CACHE_H_
+
+#include <filesystem>
+#include <mutex>
+#include <vector>
+
+#include "gfx/gfx_config.h"
+
+namespace vkgfx {
+
+// Device owned VkPipelineCache persisted across runs.
+// The file is seeded into every cache on creation and only accepted when its
+// header matches the vendor, device, driver version and pipeline cache UUID
+// of the current adapter. Pipeline creation leases a cache of its own to
+// avoid contention inside the driver, the pool only grows with the number of
+// concurrent creations. Save merges them into the main cache and writes the
+// result through a temporary file, unique per writer, and a rename.
+class GFXPipelineCache {
+ public:
+  // |path| may be empty for an in memory cache.
+  GFXPipelineCache(VkDevice device,
+                   const VkPhysicalDeviceProperties& properties,
+                   const std::filesystem::path& path);
+  ~GFXPipelineCache();
+
+  GFXPipelineCache(const GFXPipelineCache&) = delete;
+  GFXPipelineCache& operator=(const GFXPipelineCache&) = delete;
+
+  // Cache used by no other pipeline creation until released.
+  VkPipelineCache AcquireCache();
+  void ReleaseCache(VkPipelineCache cache);
+
+  // Merges the thread caches and writes the file, returns false on failure
+  // or without a backing file.
+  bool Save();
+
+ private:
+  struct FileHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t vendor_id;
+    uint32_t device_id;
+    uint32_t driver_version;
+    uint8_t pipeline_cache_uuid[VK_UUID_SIZE];
+    uint64_t data_size;
+    uint64_t data_hash;
+  };
+
+  static constexpr uint32_t kFileMagic = 0x43504B56;  // "VKPC"
+  static constexpr uint32_t kFileVersion = 1;
+
+  void LoadInternal();
+  VkPipelineCache CreateCacheInternal();
+  FileHeader MakeHeaderInternal(const std::vector<uint8_t>& data) const;
+
+  VkDevice device_;
+  VkPhysicalDeviceProperties properties_;
+  std::filesystem::path path_;
+
+  // Validated contents of the file, seeds every cache
+  std::vector<uint8_t> initial_data_;
+
+  std::mutex lock_;
+  VkPipelineCache main_cache_ = VK_NULL_HANDLE;
+  // Every leased cache, and those not leased right now
+  std::vector<VkPipelineCache> caches_;
+  std::vector<VkPipelineCache> free_caches_;
+};
+
+}  // namespace vkgfx
+
+#endif  // GFX_GFX_PIPELINE_CACHE_H_
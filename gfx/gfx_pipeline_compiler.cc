@@ -0,0 +1,153 @@
+// Copyright 2025 Admenri.
+// Use of this source code is governed by a MIT-style license that can be
+// found in the LICENSE file.
+
+#include "gfx/gfx_pipeline_compiler.h"
+
+#include "gfx/gfx_compute_pipeline.h"
+#include "gfx/gfx_device.h"
+#include "gfx/gfx_event_manager.h"
+#include "gfx/gfx_render_pipeline.h"
+#include "gfx/gfx_worker_pool.h"
+
+namespace vkgfx {
+
+namespace {
+
+// Builds the waiter of one async request, the user callback runs through the
+// event manager with its own reference to the pipeline.
+template <typename Pipeline, typename CallbackInfo>
+std::function<void(void*, WGPUCreatePipelineAsyncStatus, const std::string&)>
+MakeWaiter(GFXEventManager* event_manager,
+           WGPUFuture future,
+           CallbackInfo callback_info) {
+  return [event_manager, future, callback_info](
+             void* pipeline, WGPUCreatePipelineAsyncStatus status,
+             const std::string& message) {
+    auto* typed_pipeline = static_cast<Pipeline*>(pipeline);
+    if (typed_pipeline)
+      typed_pipeline->AddRef();
+
+    event_manager->CompleteEvent(future, [callback_info, typed_pipeline,
+                                          status, message]() {
+      if (callback_info.callback)
+        callback_info.callback(status, typed_pipeline,
+                               {message.c_str(), message.size()},
+                               callback_info.userdata1,
+                               callback_info.userdata2);
+    });
+  };
+}
+
+}  // namespace
+
+///////////////////////////////////////////////////////////////////////////////
+// GFXPipelineCompiler Implement
+
+GFXPipelineCompiler::GFXPipelineCompiler(GFXDevice* device,
+                                         GFXWorkerPool* worker_pool,
+                                         GFXEventManager* event_manager)
+    : device_(device),
+      worker_pool_(worker_pool),
+      event_manager_(event_manager) {}
+
+WGPUFuture GFXPipelineCompiler::CreateComputePipelineAsync(
+    const WGPUComputePipelineDescriptor* descriptor,
+    WGPUCreateComputePipelineAsyncCallbackInfo callback_info) {
+  WGPUFuture future = event_manager_->RegisterEvent(callback_info.mode);
+  auto waiter = MakeWaiter<GFXComputePipeline>(event_manager_, future,
+                                               callback_info);
+
+  GFXComputePipeline::CreateInfo create_info;
+  std::string error;
+  if (!GFXComputePipeline::CaptureCreateInfo(descriptor, &create_info,
+                                             &error)) {
+    waiter(nullptr, WGPUCreatePipelineAsyncStatus_ValidationError, error);
+    return future;
+  }
+
+  // The task keeps the device alive until the result is published
+  std::string key = "C" + create_info.key;
+  RefPtr<GFXDevice> device(device_);
+  auto task = [this, device, key, create_info]() {
+    std::string message;
+    auto* pipeline = GFXComputePipeline::Create(device, create_info, &message);
+    Finish(key, pipeline,
+           pipeline ? WGPUCreatePipelineAsyncStatus_Success
+                    : WGPUCreatePipelineAsyncStatus_InternalError,
+           message);
+    if (pipeline)
+      pipeline->Release();
+  };
+
+  Enqueue(key, std::move(waiter), std::move(task));
+  return future;
+}
+
+WGPUFuture GFXPipelineCompiler::CreateRenderPipelineAsync(
+    const WGPURenderPipelineDescriptor* descriptor,
+    WGPUCreateRenderPipelineAsyncCallbackInfo callback_info) {
+  WGPUFuture future = event_manager_->RegisterEvent(callback_info.mode);
+  auto waiter =
+      MakeWaiter<GFXRenderPipeline>(event_manager_, future, callback_info);
+
+  GFXRenderPipeline::CreateInfo create_info;
+  std::string error;
+  if (!GFXRenderPipeline::CaptureCreateInfo(descriptor, device_, &create_info,
+                                            &error)) {
+    waiter(nullptr, WGPUCreatePipelineAsyncStatus_ValidationError, error);
+    return future;
+  }
+
+  // The task keeps the device alive until the result is published
+  std::string key = "R" + create_info.key;
+  RefPtr<GFXDevice> device(device_);
+  auto task = [this, device, key, create_info]() {
+    std::string message;
+    auto* pipeline = GFXRenderPipeline::Create(device, create_info, &message);
+    Finish(key, pipeline,
+           pipeline ? WGPUCreatePipelineAsyncStatus_Success
+                    : WGPUCreatePipelineAsyncStatus_InternalError,
+           message);
+    if (pipeline)
+      pipeline->Release();
+  };
+
+  Enqueue(key, std::move(waiter), std::move(task));
+  return future;
+}
+
+void GFXPipelineCompiler::Enqueue(const std::string& key,
+                                  Waiter waiter,
+                                  std::function<void()> task) {
+  {
+    std::lock_guard guard(lock_);
+    auto& job = jobs_[key];
+    job.waiters.push_back(std::move(waiter));
+    if (job.waiters.size() > 1)
+      return;
+  }
+
+  worker_pool_->PostTask(std::move(task));
+}
+
+void GFXPipelineCompiler::Finish(const std::string& key,
+                                 void* pipeline,
+                                 WGPUCreatePipelineAsyncStatus status,
+                                 const std::string& message) {
+  std::vector<Waiter> waiters;
+  {
+    std::lock_guard guard(lock_);
+    auto it = jobs_.find(key);
+    if (it == jobs_.end())
+      return;
+
+    waiters = std::move(it->second.waiters);
+    jobs_.erase(it);
+  }
+
+  for (auto& waiter : waiters)
+    waiter(pipeline, status, message);
+}
+
+}  // namespace vkgfx
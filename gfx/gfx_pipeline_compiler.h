@@ -0,0 +1,74 @@
+// Copyright 2025 Admenri.
+// Use of this source code is governed by a MIT-style license that can be
+// found in the LICENSE file.
+
+#ifndef GFX_GFX_PIPELINE_COMPILER_H_
+#define GFX_GFX_PIPELINE_COMPILER_H_
+
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "gfx/gfx_config.h"
+
+namespace vkgfx {
+
+class GFXDevice;
+class GFXEventManager;
+class GFXWorkerPool;
+
+// Device owned front end of Create*PipelineAsync.
+// Descriptors are captured on the calling thread and compiled on the worker
+// pool, completion is reported through the instance event manager so the
+// returned futures work with WaitAny and ProcessEvents. Requests identical
+// to a compile in flight share its result instead of compiling again.
+class GFXPipelineCompiler {
+ public:
+  GFXPipelineCompiler(GFXDevice* device,
+                      GFXWorkerPool* worker_pool,
+                      GFXEventManager* event_manager);
+  ~GFXPipelineCompiler() = default;
+
+  GFXPipelineCompiler(const GFXPipelineCompiler&) = delete;
+  GFXPipelineCompiler& operator=(const GFXPipelineCompiler&) = delete;
+
+  WGPUFuture CreateComputePipelineAsync(
+      const WGPUComputePipelineDescriptor* descriptor,
+      WGPUCreateComputePipelineAsyncCallbackInfo callback_info);
+  WGPUFuture CreateRenderPipelineAsync(
+      const WGPURenderPipelineDescriptor* descriptor,
+      WGPUCreateRenderPipelineAsyncCallbackInfo callback_info);
+
+ private:
+  // Receives the compiled pipeline (borrowed) or null with the error.
+  using Waiter = std::function<void(void* pipeline,
+                                    WGPUCreatePipelineAsyncStatus status,
+                                    const std::string& message)>;
+
+  struct Job {
+    std::vector<Waiter> waiters;
+  };
+
+  // Joins the job of |key| or posts |task| as a new one, the task reports
+  // through Finish.
+  void Enqueue(const std::string& key,
+               Waiter waiter,
+               std::function<void()> task);
+  void Finish(const std::string& key,
+              void* pipeline,
+              WGPUCreatePipelineAsyncStatus status,
+              const std::string& message);
+
+  GFXDevice* device_;
+  GFXWorkerPool* worker_pool_;
+  GFXEventManager* event_manager_;
+
+  std::mutex lock_;
+  std::unordered_map<std::string, Job> jobs_;
+};
+
+}  // namespace vkgfx
+
+#endif  // GFX_GFX_PIPELINE_COMPILER_H_
@@ -9,9 +9,26 @@ namespace vkgfx {
 ///////////////////////////////////////////////////////////////////////////////
 // GFXPipelineLayout Implement
 
-GFXPipelineLayout::GFXPipelineLayout() {}
+GFXPipelineLayout::GFXPipelineLayout(
+    VkPipelineLayout layout,
+    std::vector<RefPtr<GFXBindGroupLayout>> bind_group_layouts,
+    uint32_t immediate_size,
+    RefPtr<GFXDevice> device,
+    WGPUStringView label)
+    : layout_(layout),
+      bind_group_layouts_(std::move(bind_group_layouts)),
+      immediate_size_(immediate_size),
+      device_(device) {
+  if (label.data && label.length)
+    label_ = std::string(label.data, label.length);
+}
 
-GFXPipelineLayout::~GFXPipelineLayout() {}
+GFXPipelineLayout::~GFXPipelineLayout() {
+  if (device_ && device_->GetLayoutCache())
+    device_->GetLayoutCache()->RemovePipelineLayout(this);
+  if (layout_ && device_)
+    vkDestroyPipelineLayout(device_->GetVkHandle(), layout_, nullptr);
+}
 
 void GFXPipelineLayout::SetLabel(WGPUStringView label) {
   label_ = std::string(label.data, label.length);
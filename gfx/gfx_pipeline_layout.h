@@ -5,7 +5,10 @@
 #ifndef GFX_GFX_PIPELINE_LAYOUT_H_
 #define GFX_GFX_PIPELINE_LAYOUT_H_
 
+#include <vector>
+
 #include "gfx/common/refptr.h"
+#include "gfx/gfx_bind_group_layout.h"
 #include "gfx/gfx_config.h"
 #include "gfx/gfx_device.h"
 
@@ -14,25 +17,42 @@ struct WGPUPipelineLayoutImpl {};
 namespace vkgfx {
 
 // https://gpuweb.github.io/gpuweb/#gpupipelinelayout
+// Pipeline layouts and their bind group layouts are interned by the device,
+// two layouts are compatible exactly when the pointers are equal.
 class GFXPipelineLayout : public RefCounted<GFXPipelineLayout>,
                           public WGPUPipelineLayoutImpl {
  public:
-  GFXPipelineLayout();
+  GFXPipelineLayout(VkPipelineLayout layout,
+                    std::vector<RefPtr<GFXBindGroupLayout>> bind_group_layouts,
+                    uint32_t immediate_size,
+                    RefPtr<GFXDevice> device,
+                    WGPUStringView label);
   ~GFXPipelineLayout();
 
   GFXPipelineLayout(const GFXPipelineLayout&) = delete;
   GFXPipelineLayout& operator=(const GFXPipelineLayout&) = delete;
 
   VkPipelineLayout GetVkHandle() const { return layout_; }
+  uint32_t GetBindGroupLayoutCount() const {
+    return bind_group_layouts_.size();
+  }
+  GFXBindGroupLayout* GetBindGroupLayout(uint32_t index) const {
+    return index < bind_group_layouts_.size()
+               ? bind_group_layouts_[index].get()
+               : nullptr;
+  }
+  uint32_t GetImmediateSize() const { return immediate_size_; }
 
   void SetLabel(WGPUStringView label);
 
  private:
   VkPipelineLayout layout_;
+  std::vector<RefPtr<GFXBindGroupLayout>> bind_group_layouts_;
+  uint32_t immediate_size_;
 
   RefPtr<GFXDevice> device_;
 
-  std::string label_;
+  std::string label_ = "GFX.PipelineLayout";
 };
 
 }  // namespace vkgfx
@@ -4,36 +4,1030 @@
 
 #include "gfx/gfx_queue.h"
 
+#include <algorithm>
+#include <cstring>
+
+#include "gfx/common/log.h"
+#include "gfx/gfx_buffer.h"
+#include "gfx/gfx_command_buffer.h"
+#include "gfx/gfx_instance.h"
+#include "gfx/gfx_row_copy.h"
+#include "gfx/gfx_texture.h"
+#include "gfx/gfx_utils.h"
+
 namespace vkgfx {
 
 ///////////////////////////////////////////////////////////////////////////////
 // GFXQueue Implement
 
-GFXQueue::GFXQueue() {}
+GFXQueue::GFXQueue(VkQueue queue, uint32_t family_index, GFXDevice* device)
+    : queue_(queue),
+      family_index_(family_index),
+      device_(device),
+      vk_device_(device->GetVkHandle()) {
+  VkCommandPoolCreateInfo pool_info = {
+      VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO};
+  pool_info.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT |
+                    VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+  pool_info.queueFamilyIndex = family_index_;
+  if (vkCreateCommandPool(device_->GetVkHandle(), &pool_info, nullptr,
+                          &command_pool_) != VK_SUCCESS)
+    GFX_ERROR() << __FUNCTION__ << ": Failed to create command pool.";
+
+  if (device_->GetAdapter()->SupportsTimelineSemaphore()) {
+    VkSemaphoreTypeCreateInfoKHR type_info = {
+        VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO_KHR};
+    type_info.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE_KHR;
+    type_info.initialValue = 0;
+    VkSemaphoreCreateInfo semaphore_info = {
+        VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO};
+    semaphore_info.pNext = &type_info;
+    // Falls back to fences on failure
+    if (vkCreateSemaphore(device_->GetVkHandle(), &semaphore_info, nullptr,
+                          &timeline_semaphore_) != VK_SUCCESS) {
+      GFX_ERROR() << __FUNCTION__ << ": Failed to create timeline semaphore.";
+      timeline_semaphore_ = VK_NULL_HANDLE;
+    }
+  }
+
+  staging_ring_ = std::make_unique<GFXStagingRing>(device_->GetAllocator());
+
+  device_->GetAdapter()->GetInstance()->RegisterQueue(this);
+}
+
+GFXQueue::~GFXQueue() {
+  Destroy();
+}
+
+void GFXQueue::SetInlineWriteThreshold(size_t threshold) {
+  std::lock_guard guard(lock_);
+  inline_write_threshold_ = std::min(threshold, kMaxInlineWriteSize);
+}
+
+void GFXQueue::SetSubmitThreadEnabled(bool enabled) {
+  std::lock_guard guard(lock_);
+  if (!device_ || enabled == !!submit_thread_)
+    return;
+
+  if (enabled)
+    submit_thread_ = std::make_unique<GFXSubmitThread>(queue_);
+  else
+    submit_thread_.reset();
+}
+
+void GFXQueue::ScheduleStagingUpload(GFXBuffer* buffer,
+                                     VkBuffer staging_buffer,
+                                     VmaAllocation staging_allocation) {
+  std::lock_guard guard(lock_);
+  VkCommandBuffer command_buffer = GetPendingCommandsLocked();
+  if (!command_buffer) {
+    if (device_)
+      vmaDestroyBuffer(device_->GetAllocator(), staging_buffer,
+                       staging_allocation);
+    return;
+  }
+
+  VkBufferCopy region = {};
+  region.dstOffset = buffer->GetOffset();
+  region.size = buffer->GetSize();
+  vkCmdCopyBuffer(command_buffer, staging_buffer, buffer->GetVkHandle(), 1,
+                  &region);
+
+  buffer->SetLastUsageSerial(last_submitted_serial_ + 1);
+  pending_buffers_.push_back(buffer);
+  pending_staging_buffers_.push_back({staging_buffer, staging_allocation});
+}
+
+uint64_t GFXQueue::PollCompletedSerial() const {
+  uint64_t completed_serial = completed_serial_;
+  uint64_t value = 0;
+  if (timeline_semaphore_ &&
+      vkGetSemaphoreCounterValueKHR(vk_device_, timeline_semaphore_,
+                                    &value) == VK_SUCCESS)
+    completed_serial = std::max(completed_serial, value);
+  return completed_serial;
+}
+
+void GFXQueue::DiscardPendingWrites(GFXBuffer* buffer) {
+  // The last reference may be the pending one, it goes without the lock
+  RefPtr<GFXBuffer> pending_buffer;
+  {
+    std::lock_guard guard(lock_);
+    auto it = pending_writes_.find(buffer);
+    if (it == pending_writes_.end())
+      return;
+
+    // Payloads stay in |write_data_| until the next Submit
+    pending_buffer = std::move(it->second.buffer);
+    pending_writes_.erase(it);
+    buffer->SetHasPendingWrites(false);
+  }
+}
+
+void GFXQueue::RunWhenCompleted(uint64_t serial, std::function<void()> task) {
+  {
+    std::lock_guard guard(lock_);
+    if (device_ && serial > completed_serial_) {
+      // Polls only read the queue progress, nothing else would submit the
+      // writes waited on.
+      if (serial > last_submitted_serial_)
+        SubmitLocked({});
+      serial_tasks_.emplace(serial, std::move(task));
+      return;
+    }
+  }
+
+  task();
+}
+
+bool GFXQueue::WaitForSerial(uint64_t serial, uint64_t timeout_ns) {
+  VkDevice vk_device;
+  VkSemaphore semaphore;
+  std::vector<VkFence> fences;
+  {
+    std::lock_guard guard(lock_);
+    if (!device_ || serial <= completed_serial_)
+      return true;
+
+    // Waiting on writes not submitted yet, same as Tick
+    if (serial > last_submitted_serial_ && !SubmitLocked({}))
+      return false;
+
+    vk_device = device_->GetVkHandle();
+    semaphore = timeline_semaphore_;
+    if (!semaphore) {
+      // Completion is in order, any later fence will do
+      for (const auto& submission : in_flight_)
+        if (submission.serial >= serial)
+          fences.push_back(submission.fence);
+      if (fences.empty())
+        return true;
+    }
+    ++serial_waiters_;
+  }
+
+  VkResult result;
+  if (semaphore) {
+    VkSemaphoreWaitInfoKHR wait_info = {
+        VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO_KHR};
+    wait_info.semaphoreCount = 1;
+    wait_info.pSemaphores = &semaphore;
+    wait_info.pValues = &serial;
+    result = vkWaitSemaphoresKHR(vk_device, &wait_info, timeout_ns);
+  } else {
+    result = vkWaitForFences(vk_device, fences.size(), fences.data(),
+                             VK_FALSE, timeout_ns);
+  }
+
+  {
+    std::lock_guard guard(lock_);
+    if (!--serial_waiters_)
+      serial_waiters_done_.notify_all();
+  }
+
+  // A lost device never completes anything, let the caller tick it
+  return result != VK_TIMEOUT;
+}
+
+void GFXQueue::Tick() {
+  {
+    std::lock_guard guard(lock_);
+    TickLocked();
+
+    // Somebody waits on writes not submitted yet, an empty submission still
+    // signals its serial.
+    if (device_ && !serial_tasks_.empty() &&
+        serial_tasks_.rbegin()->first > last_submitted_serial_)
+      SubmitLocked({});
+  }
+
+  RunReadyTasks();
+}
+
+void GFXQueue::Destroy() {
+  std::unique_lock guard(lock_);
+  if (!device_)
+    return;
+
+  device_->GetAdapter()->GetInstance()->UnregisterQueue(this);
+
+  VkDevice vk_device = device_->GetVkHandle();
+  // Takes |queue_| back once everything handed over was submitted
+  submit_thread_.reset();
+  vkQueueWaitIdle(queue_);
+  // Everything they wait on is signaled now
+  serial_waiters_done_.wait(guard, [this]() { return !serial_waiters_; });
+  TickLocked();
 
-GFXQueue::~GFXQueue() {}
+  // The device is idle, waiters of unsubmitted work are released too
+  for (auto& it : serial_tasks_)
+    ready_tasks_.push_back(std::move(it.second));
+  serial_tasks_.clear();
+
+  // Writes never submitted are dropped
+  if (pending_commands_) {
+    vkEndCommandBuffer(pending_commands_);
+    free_command_buffers_.push_back(pending_commands_);
+    pending_commands_ = VK_NULL_HANDLE;
+  }
+  pending_buffers_.clear();
+  pending_textures_.clear();
+  for (auto& it : pending_writes_)
+    if (it.second.buffer)
+      it.second.buffer->SetHasPendingWrites(false);
+  pending_writes_.clear();
+  write_data_.clear();
+  for (const auto& it : pending_staging_buffers_)
+    vmaDestroyBuffer(device_->GetAllocator(), it.buffer, it.allocation);
+  pending_staging_buffers_.clear();
+
+  for (auto fence : free_fences_)
+    vkDestroyFence(vk_device, fence, nullptr);
+  free_fences_.clear();
+  if (timeline_semaphore_)
+    vkDestroySemaphore(vk_device, timeline_semaphore_, nullptr);
+  timeline_semaphore_ = VK_NULL_HANDLE;
+
+  // Frees the command buffers along with the pool
+  if (command_pool_)
+    vkDestroyCommandPool(vk_device, command_pool_, nullptr);
+  command_pool_ = VK_NULL_HANDLE;
+  free_command_buffers_.clear();
+
+  staging_ring_.reset();
+  device_ = nullptr;
+
+  guard.unlock();
+  RunReadyTasks();
+}
 
 WGPUFuture GFXQueue::OnSubmittedWorkDone(
     WGPUQueueWorkDoneCallbackInfo callbackInfo) {
-  return WGPUFuture();
+  GFXEventManager* event_manager = nullptr;
+  uint64_t serial = 0;
+  {
+    std::lock_guard guard(lock_);
+    if (device_) {
+      event_manager = device_->GetAdapter()->GetInstance()->GetEventManager();
+      serial = last_submitted_serial_;
+    }
+  }
+
+  if (!event_manager) {
+    if (callbackInfo.callback) {
+      std::string message = "OnSubmittedWorkDone: Queue is destroyed.";
+      callbackInfo.callback(WGPUQueueWorkDoneStatus_Error,
+                            {message.c_str(), message.size()},
+                            callbackInfo.userdata1, callbackInfo.userdata2);
+    }
+    return GFXInstance::kImmediateFuture;
+  }
+
+  // Pending queue writes are not part of the submitted work
+  WGPUFuture future = event_manager->RegisterEvent(
+      callbackInfo.mode, this, serial, [callbackInfo]() {
+        if (callbackInfo.callback)
+          callbackInfo.callback(WGPUQueueWorkDoneStatus_Success, {},
+                                callbackInfo.userdata1,
+                                callbackInfo.userdata2);
+      });
+  RunWhenCompleted(serial, [event_manager, future]() {
+    event_manager->ResolveEvent(future);
+  });
+  return future;
 }
 
 void GFXQueue::SetLabel(WGPUStringView label) {
   label_ = std::string(label.data, label.length);
 }
 
-void GFXQueue::Submit(size_t commandCount, WGPUCommandBuffer const* commands) {}
+void GFXQueue::Submit(size_t commandCount, WGPUCommandBuffer const* commands) {
+  {
+    std::lock_guard guard(lock_);
+    if (!device_)
+      return;
+
+    TickLocked();
+
+    std::vector<RefPtr<GFXCommandBuffer>> command_buffers;
+    for (size_t i = 0; i < commandCount; ++i) {
+      auto* command_buffer = static_cast<GFXCommandBuffer*>(commands[i]);
+      if (!command_buffer || !command_buffer->GetVkHandle())
+        continue;
+
+      if (!command_buffer->MarkSubmitted(last_submitted_serial_ + 1)) {
+        device_->CallDeviceErrorCallback(
+            WGPUErrorType_Validation,
+            "Submit: Command buffer was already submitted.");
+        continue;
+      }
+      command_buffers.push_back(command_buffer);
+    }
+
+    SubmitLocked(command_buffers);
+  }
+
+  RunReadyTasks();
+}
 
 void GFXQueue::WriteBuffer(WGPUBuffer buffer,
                            uint64_t bufferOffset,
                            void const* data,
-                           size_t size) {}
+                           size_t size) {
+  if (!device_)
+    return;
+
+  auto* buffer_impl = static_cast<GFXBuffer*>(buffer);
+  if (!buffer_impl) {
+    device_->CallDeviceErrorCallback(WGPUErrorType_Validation,
+                                     "WriteBuffer: Invalid buffer.");
+    return;
+  }
+
+  if (!buffer_impl->GetVkHandle()) {
+    device_->CallDeviceErrorCallback(WGPUErrorType_Validation,
+                                     "WriteBuffer: Buffer is destroyed.");
+    return;
+  }
+
+  if (!(buffer_impl->GetUsage() & WGPUBufferUsage_CopyDst)) {
+    device_->CallDeviceErrorCallback(
+        WGPUErrorType_Validation,
+        "WriteBuffer: Buffer usage does not contain CopyDst.");
+    return;
+  }
+
+  if (bufferOffset % 4 || size % 4) {
+    device_->CallDeviceErrorCallback(
+        WGPUErrorType_Validation,
+        "WriteBuffer: Offset and size must be multiples of 4.");
+    return;
+  }
+
+  if (bufferOffset > buffer_impl->GetSize() ||
+      size > buffer_impl->GetSize() - bufferOffset) {
+    device_->CallDeviceErrorCallback(
+        WGPUErrorType_Validation,
+        "WriteBuffer: Write range exceeds the buffer size.");
+    return;
+  }
+
+  if (buffer_impl->GetMapState() != WGPUBufferMapState_Unmapped) {
+    device_->CallDeviceErrorCallback(WGPUErrorType_Validation,
+                                     "WriteBuffer: Buffer is mapped.");
+    return;
+  }
+
+  if (!size)
+    return;
+
+  // Recorded on Submit, later writes overwrite earlier ones
+  std::lock_guard guard(lock_);
+  if (lost_)
+    return;
+
+  auto& pending_writes = pending_writes_[buffer_impl];
+  if (!pending_writes.buffer) {
+    pending_writes.buffer = buffer_impl;
+    buffer_impl->SetHasPendingWrites(true);
+  }
+  buffer_impl->SetLastUsageSerial(last_submitted_serial_ + 1);
+  InsertWriteRangeLocked(&pending_writes.ranges, bufferOffset,
+                         static_cast<const uint8_t*>(data), size);
+}
 
 void GFXQueue::WriteTexture(WGPUTexelCopyTextureInfo const* destination,
                             void const* data,
                             size_t dataSize,
                             WGPUTexelCopyBufferLayout const* dataLayout,
-                            WGPUExtent3D const* writeSize) {}
+                            WGPUExtent3D const* writeSize) {
+  if (!device_)
+    return;
+
+  if (!destination || !destination->texture || !dataLayout || !writeSize) {
+    device_->CallDeviceErrorCallback(WGPUErrorType_Validation,
+                                     "WriteTexture: Invalid argument.");
+    return;
+  }
+
+  auto* texture = static_cast<GFXTexture*>(destination->texture);
+  if (!texture->GetVkHandle()) {
+    device_->CallDeviceErrorCallback(WGPUErrorType_Validation,
+                                     "WriteTexture: Texture is destroyed.");
+    return;
+  }
+
+  if (!(texture->GetUsage() & WGPUTextureUsage_CopyDst) ||
+      texture->GetSampleCount() != 1) {
+    device_->CallDeviceErrorCallback(
+        WGPUErrorType_Validation,
+        "WriteTexture: Texture is not a single sampled CopyDst texture.");
+    return;
+  }
+
+  // Only depth16unorm has a writable depth aspect
+  WGPUTextureFormat format = texture->GetFormat();
+  TexelBlockInfo block;
+  bool depth_aspect = destination->aspect == WGPUTextureAspect_DepthOnly ||
+                      format == WGPUTextureFormat_Depth16Unorm ||
+                      format == WGPUTextureFormat_Depth32Float;
+  if (!GetTexelBlockInfo(format, destination->aspect, &block) ||
+      (depth_aspect && format != WGPUTextureFormat_Depth16Unorm)) {
+    device_->CallDeviceErrorCallback(
+        WGPUErrorType_Validation,
+        "WriteTexture: Texture aspect cannot be written.");
+    return;
+  }
+
+  // Extent of the destination mip level
+  uint32_t mip_level = destination->mipLevel;
+  if (mip_level >= texture->GetMipLevelCount()) {
+    device_->CallDeviceErrorCallback(WGPUErrorType_Validation,
+                                     "WriteTexture: Invalid mip level.");
+    return;
+  }
+
+  bool is_3d = texture->GetDimension() == WGPUTextureDimension_3D;
+  uint64_t mip_width = std::max(texture->GetWidth() >> mip_level, 1u);
+  uint64_t mip_height = std::max(texture->GetHeight() >> mip_level, 1u);
+  uint64_t mip_depth =
+      is_3d ? std::max(texture->GetDepthOrArrayLayers() >> mip_level, 1u)
+            : texture->GetDepthOrArrayLayers();
+
+  const WGPUOrigin3D& origin = destination->origin;
+  if (origin.x + uint64_t(writeSize->width) > mip_width ||
+      origin.y + uint64_t(writeSize->height) > mip_height ||
+      origin.z + uint64_t(writeSize->depthOrArrayLayers) > mip_depth ||
+      origin.x % block.width || origin.y % block.height ||
+      writeSize->width % block.width || writeSize->height % block.height) {
+    device_->CallDeviceErrorCallback(
+        WGPUErrorType_Validation,
+        "WriteTexture: Copy region is out of bounds or not block aligned.");
+    return;
+  }
+
+  uint64_t width_in_blocks = writeSize->width / block.width;
+  uint64_t height_in_blocks = writeSize->height / block.height;
+  uint64_t depth = writeSize->depthOrArrayLayers;
+  uint64_t row_bytes = width_in_blocks * block.byte_size;
+
+  uint64_t bytes_per_row = dataLayout->bytesPerRow;
+  uint64_t rows_per_image = dataLayout->rowsPerImage;
+  if (bytes_per_row == WGPU_COPY_STRIDE_UNDEFINED) {
+    if (height_in_blocks > 1 || depth > 1) {
+      device_->CallDeviceErrorCallback(
+          WGPUErrorType_Validation,
+          "WriteTexture: bytesPerRow is required for multiple rows.");
+      return;
+    }
+    bytes_per_row = row_bytes;
+  }
+  if (rows_per_image == WGPU_COPY_STRIDE_UNDEFINED) {
+    if (depth > 1) {
+      device_->CallDeviceErrorCallback(
+          WGPUErrorType_Validation,
+          "WriteTexture: rowsPerImage is required for multiple images.");
+      return;
+    }
+    rows_per_image = height_in_blocks;
+  }
+
+  if (bytes_per_row < row_bytes || rows_per_image < height_in_blocks) {
+    device_->CallDeviceErrorCallback(
+        WGPUErrorType_Validation,
+        "WriteTexture: Data layout is smaller than the copy size.");
+    return;
+  }
+
+  if (!row_bytes || !height_in_blocks || !depth)
+    return;
+
+  uint64_t required_size = dataLayout->offset +
+                           bytes_per_row * rows_per_image * (depth - 1) +
+                           bytes_per_row * (height_in_blocks - 1) + row_bytes;
+  if (required_size > dataSize) {
+    device_->CallDeviceErrorCallback(
+        WGPUErrorType_Validation,
+        "WriteTexture: Data is smaller than the copy requires.");
+    return;
+  }
+
+  // Rows are repacked to the pitch the copy prefers, aligned for streaming
+  // stores and a multiple of every block size.
+  const auto& limits =
+      device_->GetAdapter()->GetDeviceInfo().properties.properties.limits;
+  VkDeviceSize pitch_alignment = std::max<VkDeviceSize>(
+      limits.optimalBufferCopyRowPitchAlignment, GFXStagingRing::kAlignment);
+  VkDeviceSize staging_row_pitch =
+      (row_bytes + pitch_alignment - 1) / pitch_alignment * pitch_alignment;
+  VkDeviceSize staging_image_pitch = staging_row_pitch * height_in_blocks;
+
+  // The region is reserved before its submission is known, so the repack
+  // runs without holding the queue lock. The submission recording the copy
+  // tags it afterwards.
+  GFXStagingRing::Allocation staging;
+  {
+    std::lock_guard guard(lock_);
+    if (lost_ || !staging_ring_)
+      return;
+
+    if (!staging_ring_->Allocate(staging_image_pitch * depth,
+                                 GFXStagingRing::kUnsubmittedSerial,
+                                 &staging)) {
+      device_->CallDeviceErrorCallback(
+          WGPUErrorType_OutOfMemory,
+          "WriteTexture: Failed to allocate staging memory.");
+      return;
+    }
+  }
+
+  RowCopyLayout copy_layout;
+  copy_layout.dst = staging.mapped_data;
+  copy_layout.dst_row_pitch = staging_row_pitch;
+  copy_layout.dst_image_pitch = staging_image_pitch;
+  copy_layout.src = static_cast<const uint8_t*>(data) + dataLayout->offset;
+  copy_layout.src_row_pitch = bytes_per_row;
+  copy_layout.src_image_pitch = bytes_per_row * rows_per_image;
+  copy_layout.row_bytes = row_bytes;
+  copy_layout.rows_per_image = height_in_blocks;
+  copy_layout.image_count = depth;
+  CopyRowsParallel(copy_layout, device_->GetWorkerPool());
+
+  std::lock_guard guard(lock_);
+  if (!staging_ring_)
+    return;
+
+  staging_ring_->AssignSerial(staging, last_submitted_serial_ + 1);
+  // Destroyed while the rows were repacked, the region is simply recycled
+  if (lost_ || !texture->GetVkHandle())
+    return;
+
+  staging_ring_->Flush(staging, staging_image_pitch * depth);
+
+  VkCommandBuffer command_buffer = GetPendingCommandsLocked();
+  if (!command_buffer)
+    return;
+
+  // Only the written subresources move, later writes to the same texels
+  // wait for earlier ones.
+  ImageRange range;
+  range.base_mip_level = mip_level;
+  range.mip_level_count = 1;
+  range.base_array_layer = is_3d ? 0 : origin.z;
+  range.array_layer_count = is_3d ? 1 : depth;
+
+  ImageAccess access;
+  access.layout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+  access.stages = VK_PIPELINE_STAGE_TRANSFER_BIT;
+  access.access = VK_ACCESS_TRANSFER_WRITE_BIT;
+
+  GFXBarrierBatch barriers;
+  texture->GetState()->Transition(range, access, &barriers);
+  barriers.Record(command_buffer);
+
+  VkImageAspectFlags aspect =
+      ToVulkanImageAspect(destination->aspect, format);
+
+  VkBufferImageCopy region = {};
+  region.bufferOffset = staging.offset;
+  region.bufferRowLength =
+      staging_row_pitch / block.byte_size * block.width;
+  region.bufferImageHeight = height_in_blocks * block.height;
+  region.imageSubresource.aspectMask = aspect;
+  region.imageSubresource.mipLevel = mip_level;
+  region.imageSubresource.baseArrayLayer = is_3d ? 0 : origin.z;
+  region.imageSubresource.layerCount = is_3d ? 1 : depth;
+  region.imageOffset = {static_cast<int32_t>(origin.x),
+                        static_cast<int32_t>(origin.y),
+                        static_cast<int32_t>(is_3d ? origin.z : 0)};
+  region.imageExtent = {writeSize->width, writeSize->height,
+                        static_cast<uint32_t>(is_3d ? depth : 1)};
+  vkCmdCopyBufferToImage(command_buffer, staging.buffer,
+                         texture->GetVkHandle(),
+                         VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+
+  texture->SetLastUsageSerial(last_submitted_serial_ + 1);
+  pending_textures_.push_back(texture);
+}
+
+void GFXQueue::InsertWriteRangeLocked(WriteRanges* ranges,
+                                      uint64_t offset,
+                                      const uint8_t* data,
+                                      size_t size) {
+  uint64_t begin = offset;
+  uint64_t end = offset + size;
+
+  // First range overlapping or touching [begin, end)
+  auto first = std::lower_bound(
+      ranges->begin(), ranges->end(), begin,
+      [](const WriteRange& range, uint64_t value) {
+        return range.offset + range.size < value;
+      });
+
+  auto last = first;
+  uint64_t merged_begin = begin;
+  uint64_t merged_end = end;
+  while (last != ranges->end() && last->offset <= end) {
+    merged_begin = std::min(merged_begin, last->offset);
+    merged_end = std::max(merged_end, last->offset + last->size);
+    ++last;
+  }
+
+  if (first == last) {
+    const size_t data_offset = write_data_.size();
+    write_data_.insert(write_data_.end(), data, data + size);
+    ranges->insert(first, {begin, size, data_offset});
+    return;
+  }
+
+  // Appending to the range written last grows its payload in place, others
+  // are gathered at the end of the arena.
+  auto it = first;
+  size_t data_offset = write_data_.size();
+  if (first->offset == merged_begin &&
+      first->data_offset + first->size == write_data_.size()) {
+    data_offset = first->data_offset;
+    ++it;
+  }
+  write_data_.resize(data_offset + (merged_end - merged_begin));
+
+  uint8_t* merged = write_data_.data() + data_offset;
+  for (; it != last; ++it)
+    std::memcpy(merged + (it->offset - merged_begin),
+                write_data_.data() + it->data_offset, it->size);
+  std::memcpy(merged + (begin - merged_begin), data, size);
+
+  *first = {merged_begin, merged_end - merged_begin, data_offset};
+  ranges->erase(first + 1, last);
+}
+
+VkCommandBuffer GFXQueue::GetPendingCommandsLocked() {
+  if (pending_commands_)
+    return pending_commands_;
+
+  VkCommandBuffer command_buffer = AcquireCommandBufferLocked();
+  if (!command_buffer)
+    return VK_NULL_HANDLE;
+
+  // Writes land after all previously submitted work
+  VkMemoryBarrier barrier = {VK_STRUCTURE_TYPE_MEMORY_BARRIER};
+  barrier.srcAccessMask = VK_ACCESS_MEMORY_WRITE_BIT;
+  barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+  vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                       VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 1, &barrier, 0,
+                       nullptr, 0, nullptr);
+
+  pending_commands_ = command_buffer;
+  return pending_commands_;
+}
+
+VkCommandBuffer GFXQueue::AcquireCommandBufferLocked() {
+  if (!device_ || !command_pool_)
+    return VK_NULL_HANDLE;
+
+  VkCommandBuffer command_buffer = VK_NULL_HANDLE;
+  if (!free_command_buffers_.empty()) {
+    command_buffer = free_command_buffers_.back();
+    free_command_buffers_.pop_back();
+  } else {
+    VkCommandBufferAllocateInfo allocate_info = {
+        VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO};
+    allocate_info.commandPool = command_pool_;
+    allocate_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    allocate_info.commandBufferCount = 1;
+    if (vkAllocateCommandBuffers(device_->GetVkHandle(), &allocate_info,
+                                 &command_buffer) != VK_SUCCESS) {
+      GFX_ERROR() << __FUNCTION__ << ": Failed to allocate command buffer.";
+      return VK_NULL_HANDLE;
+    }
+  }
+
+  VkCommandBufferBeginInfo begin_info = {
+      VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO};
+  begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+  vkBeginCommandBuffer(command_buffer, &begin_info);
+  return command_buffer;
+}
+
+bool GFXQueue::FlushPendingWritesLocked() {
+  // Every pending range holds a payload
+  if (write_data_.empty())
+    return true;
+
+  bool has_commands = pending_commands_ != VK_NULL_HANDLE;
+  VkCommandBuffer command_buffer = GetPendingCommandsLocked();
+  if (!command_buffer)
+    return false;
+
+  // Coalesced writes win over uploads recorded earlier
+  if (has_commands) {
+    VkMemoryBarrier barrier = {VK_STRUCTURE_TYPE_MEMORY_BARRIER};
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 1, &barrier, 0,
+                         nullptr, 0, nullptr);
+  }
+
+  // Consumed by the submission being built
+  uint64_t serial = last_submitted_serial_ + 1;
+  bool success = true;
+
+  std::vector<VkBufferCopy> regions;
+  for (auto it = pending_writes_.begin(); it != pending_writes_.end();) {
+    // Not written since the last submission, the entry goes
+    if (it->second.ranges.empty()) {
+      it = pending_writes_.erase(it);
+      continue;
+    }
+
+    auto* buffer = it->second.buffer.get();
+    auto& ranges = it->second.ranges;
+
+    // Small ranges are carried by the command buffer itself
+    VkDeviceSize staging_size = 0;
+    for (const auto& range : ranges) {
+      if (range.size <= inline_write_threshold_)
+        vkCmdUpdateBuffer(command_buffer, buffer->GetVkHandle(),
+                          buffer->GetOffset() + range.offset, range.size,
+                          write_data_.data() + range.data_offset);
+      else
+        staging_size += range.size;
+    }
+
+    buffer->SetHasPendingWrites(false);
+    pending_buffers_.push_back(std::move(it->second.buffer));
+    ++it;
+
+    GFXStagingRing::Allocation staging;
+    if (staging_size &&
+        !staging_ring_->Allocate(staging_size, serial, &staging)) {
+      device_->CallDeviceErrorCallback(
+          WGPUErrorType_OutOfMemory,
+          "WriteBuffer: Failed to allocate staging memory.");
+      success = false;
+      staging_size = 0;
+    }
+
+    // Every remaining range of the buffer in a single copy
+    regions.clear();
+    VkDeviceSize staging_offset = 0;
+    for (const auto& range : ranges) {
+      if (!staging_size || range.size <= inline_write_threshold_)
+        continue;
+
+      std::memcpy(staging.mapped_data + staging_offset,
+                  write_data_.data() + range.data_offset, range.size);
+
+      VkBufferCopy region = {};
+      region.srcOffset = staging.offset + staging_offset;
+      region.dstOffset = buffer->GetOffset() + range.offset;
+      region.size = range.size;
+      regions.push_back(region);
+      staging_offset += range.size;
+    }
+    ranges.clear();
+
+    if (regions.empty())
+      continue;
+
+    staging_ring_->Flush(staging, staging_size);
+    vkCmdCopyBuffer(command_buffer, staging.buffer, buffer->GetVkHandle(),
+                    regions.size(), regions.data());
+  }
+
+  write_data_.clear();
+  if (write_data_.capacity() > kMaxRetainedWriteData)
+    write_data_.shrink_to_fit();
+  return success;
+}
+
+bool GFXQueue::SubmitLocked(
+    const std::vector<RefPtr<GFXCommandBuffer>>& command_buffers) {
+  if (lost_)
+    return false;
+
+  VkDevice vk_device = device_->GetVkHandle();
+
+  FlushPendingWritesLocked();
+
+  Submission submission = {};
+  submission.serial = last_submitted_serial_ + 1;
+
+  // Mapped reads of buffers written by this submission, only MapRead
+  // buffers are read back by the host.
+  bool host_read = false;
+
+  std::vector<VkCommandBuffer> submit_command_buffers;
+  if (pending_commands_) {
+    for (const auto& buffer : pending_buffers_)
+      host_read |= !!(buffer->GetUsage() & WGPUBufferUsage_MapRead);
+
+    // Make the writes visible to the command buffers of this submission
+    VkMemoryBarrier barrier = {VK_STRUCTURE_TYPE_MEMORY_BARRIER};
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask =
+        VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+    vkCmdPipelineBarrier(pending_commands_, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 1, &barrier, 0,
+                         nullptr, 0, nullptr);
+    vkEndCommandBuffer(pending_commands_);
+
+    submit_command_buffers.push_back(pending_commands_);
+    submission.queue_command_buffers.push_back(pending_commands_);
+    submission.buffers = std::move(pending_buffers_);
+    submission.textures = std::move(pending_textures_);
+    submission.staging_buffers = std::move(pending_staging_buffers_);
+    pending_commands_ = VK_NULL_HANDLE;
+    pending_buffers_.clear();
+    pending_textures_.clear();
+    pending_staging_buffers_.clear();
+  }
+  for (const auto& command_buffer : command_buffers) {
+    // Encoders tracked their resources from an unknown state, bring them
+    // in line with what the command buffers before them left.
+    GFXBarrierBatch barriers;
+    for (const auto& usage : command_buffer->GetBuffers()) {
+      usage.buffer->GetState()->Stitch(usage.buffer.get(), usage.state,
+                                       &barriers);
+      usage.buffer->SetLastUsageSerial(submission.serial);
+      host_read |= !!(usage.buffer->GetUsage() & WGPUBufferUsage_MapRead);
+    }
+    for (const auto& usage : command_buffer->GetTextures()) {
+      usage.texture->GetState()->Stitch(*usage.state, &barriers);
+      usage.texture->SetLastUsageSerial(submission.serial);
+    }
+    for (const auto& group : command_buffer->GetBindGroups())
+      group->SetLastUsageSerial(submission.serial);
+    for (const auto& pipeline : command_buffer->GetComputePipelines())
+      pipeline->SetLastUsageSerial(submission.serial);
+    for (const auto& pipeline : command_buffer->GetRenderPipelines())
+      pipeline->SetLastUsageSerial(submission.serial);
+
+    if (!barriers.IsEmpty()) {
+      VkCommandBuffer barrier_commands = AcquireCommandBufferLocked();
+      if (barrier_commands) {
+        barriers.Record(barrier_commands);
+        vkEndCommandBuffer(barrier_commands);
+        submit_command_buffers.push_back(barrier_commands);
+        submission.queue_command_buffers.push_back(barrier_commands);
+      }
+    }
+
+    submit_command_buffers.push_back(command_buffer->GetVkHandle());
+  }
+  submission.command_buffers = command_buffers;
+
+  // The fence or semaphore signal only covers device domain writes, the
+  // host reads them after MapAsync once they are made host visible.
+  if (host_read) {
+    VkCommandBuffer host_commands = AcquireCommandBufferLocked();
+    if (host_commands) {
+      VkMemoryBarrier barrier = {VK_STRUCTURE_TYPE_MEMORY_BARRIER};
+      barrier.srcAccessMask = VK_ACCESS_MEMORY_WRITE_BIT;
+      barrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+      vkCmdPipelineBarrier(host_commands, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                           VK_PIPELINE_STAGE_HOST_BIT, 0, 1, &barrier, 0,
+                           nullptr, 0, nullptr);
+      vkEndCommandBuffer(host_commands);
+      submit_command_buffers.push_back(host_commands);
+      submission.queue_command_buffers.push_back(host_commands);
+    }
+  }
+
+  // Fences are only needed without a timeline semaphore. Waiters may still
+  // hold retired ones, new fences are created meanwhile.
+  if (!timeline_semaphore_ && !free_fences_.empty() && !serial_waiters_) {
+    submission.fence = free_fences_.back();
+    free_fences_.pop_back();
+    vkResetFences(vk_device, 1, &submission.fence);
+  } else if (!timeline_semaphore_) {
+    VkFenceCreateInfo fence_info = {VK_STRUCTURE_TYPE_FENCE_CREATE_INFO};
+    if (vkCreateFence(vk_device, &fence_info, nullptr, &submission.fence) !=
+        VK_SUCCESS) {
+      GFX_ERROR() << __FUNCTION__ << ": Failed to create fence.";
+      return false;
+    }
+  }
+
+  // Queue writes, stitching barriers and command buffers go out in one
+  // batch, the submit thread merges it further with the batches queued
+  // next to it.
+  if (submit_thread_) {
+    submit_thread_->Push({std::move(submit_command_buffers),
+                          submission.fence, timeline_semaphore_,
+                          submission.serial});
+    last_submitted_serial_ = submission.serial;
+    in_flight_.push_back(std::move(submission));
+    return true;
+  }
+
+  VkSubmitInfo submit_info = {VK_STRUCTURE_TYPE_SUBMIT_INFO};
+  submit_info.commandBufferCount = submit_command_buffers.size();
+  submit_info.pCommandBuffers = submit_command_buffers.data();
+  VkTimelineSemaphoreSubmitInfoKHR timeline_info = {
+      VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO_KHR};
+  if (timeline_semaphore_) {
+    timeline_info.signalSemaphoreValueCount = 1;
+    timeline_info.pSignalSemaphoreValues = &submission.serial;
+    submit_info.pNext = &timeline_info;
+    submit_info.signalSemaphoreCount = 1;
+    submit_info.pSignalSemaphores = &timeline_semaphore_;
+  }
+  VkResult result = vkQueueSubmit(queue_, 1, &submit_info, submission.fence);
+  if (result != VK_SUCCESS) {
+    MarkLostLocked(result);
+    if (submission.fence)
+      free_fences_.push_back(submission.fence);
+    for (auto command_buffer : submission.queue_command_buffers) {
+      vkResetCommandBuffer(command_buffer, 0);
+      free_command_buffers_.push_back(command_buffer);
+    }
+    for (const auto& it : submission.staging_buffers)
+      vmaDestroyBuffer(device_->GetAllocator(), it.buffer, it.allocation);
+    return false;
+  }
+
+  last_submitted_serial_ = submission.serial;
+  in_flight_.push_back(std::move(submission));
+  return true;
+}
+
+void GFXQueue::MarkLostLocked(VkResult result) {
+  GFX_ERROR() << __FUNCTION__ << ": vkQueueSubmit failed (" << result << ").";
+  if (lost_)
+    return;
+
+  lost_ = true;
+  device_->CallDeviceLostCallback(WGPUDeviceLostReason_Unknown,
+                                  "Queue submission failed.");
+}
+
+uint64_t GFXQueue::QueryCompletedSerialLocked() {
+  VkDevice vk_device = device_->GetVkHandle();
+  if (timeline_semaphore_) {
+    uint64_t value = 0;
+    if (vkGetSemaphoreCounterValueKHR(vk_device, timeline_semaphore_,
+                                      &value) != VK_SUCCESS)
+      return completed_serial_;
+    return value;
+  }
+
+  // A signaled fence completes every submission before it too
+  for (size_t i = in_flight_.size(); i > 0; --i)
+    if (vkGetFenceStatus(vk_device, in_flight_[i - 1].fence) == VK_SUCCESS)
+      return in_flight_[i - 1].serial;
+  return completed_serial_;
+}
+
+void GFXQueue::TickLocked() {
+  if (!device_)
+    return;
+
+  if (submit_thread_) {
+    VkResult result = submit_thread_->TakeError();
+    if (result != VK_SUCCESS)
+      MarkLostLocked(result);
+  }
+
+  const uint64_t completed_serial = QueryCompletedSerialLocked();
+  while (!in_flight_.empty() &&
+         in_flight_.front().serial <= completed_serial) {
+    auto& submission = in_flight_.front();
+    completed_serial_ = submission.serial;
+    if (submission.fence)
+      free_fences_.push_back(submission.fence);
+    for (auto command_buffer : submission.queue_command_buffers) {
+      vkResetCommandBuffer(command_buffer, 0);
+      free_command_buffers_.push_back(command_buffer);
+    }
+    for (const auto& it : submission.staging_buffers)
+      vmaDestroyBuffer(device_->GetAllocator(), it.buffer, it.allocation);
+
+    in_flight_.pop_front();
+  }
+
+  if (staging_ring_)
+    staging_ring_->Tick(completed_serial_);
+  if (device_->GetResourceTracker())
+    device_->GetResourceTracker()->Tick(completed_serial_);
+
+  auto ready_end = serial_tasks_.upper_bound(completed_serial_);
+  for (auto it = serial_tasks_.begin(); it != ready_end; ++it)
+    ready_tasks_.push_back(std::move(it->second));
+  serial_tasks_.erase(serial_tasks_.begin(), ready_end);
+}
+
+void GFXQueue::RunReadyTasks() {
+  std::vector<std::function<void()>> tasks;
+  {
+    std::lock_guard guard(lock_);
+    tasks.swap(ready_tasks_);
+  }
+
+  for (auto& task : tasks)
+    task();
+}
 
 }  // namespace vkgfx
 
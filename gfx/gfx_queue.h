@@ -5,24 +5,94 @@
 #ifndef GFX_GFX_QUEUE_H_
 #define GFX_GFX_QUEUE_H_
 
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
 #include "gfx/common/refptr.h"
 #include "gfx/gfx_config.h"
 #include "gfx/gfx_device.h"
+#include "gfx/gfx_staging_ring.h"
+#include "gfx/gfx_submit_thread.h"
 
 struct WGPUQueueImpl {};
 
 namespace vkgfx {
 
+class GFXBuffer;
+class GFXCommandBuffer;
+class GFXTexture;
+
 // https://gpuweb.github.io/gpuweb/#gpuqueue
 class GFXQueue : public RefCounted<GFXQueue>, public WGPUQueueImpl {
  public:
-  GFXQueue();
+  // vkCmdUpdateBuffer limit
+  static constexpr size_t kMaxInlineWriteSize = 65536;
+
+  GFXQueue(VkQueue queue, uint32_t family_index, GFXDevice* device);
   ~GFXQueue();
 
   GFXQueue(const GFXQueue&) = delete;
   GFXQueue& operator=(const GFXQueue&) = delete;
 
   VkQueue GetVkHandle() const { return queue_; }
+  uint32_t GetFamilyIndex() const { return family_index_; }
+
+  // Serial of the next submission, and of the last one known complete.
+  // Lock free, encoders on any thread query them. Serials grow by one per
+  // submission and are signaled on a timeline semaphore when the device
+  // supports it, with a fence per submission otherwise.
+  uint64_t GetPendingSerial() const { return last_submitted_serial_ + 1; }
+  uint64_t GetCompletedSerial() const { return completed_serial_; }
+  // Last serial the GPU finished as of now, read from the timeline semaphore
+  // without locking. Only valid while the queue is registered with the
+  // instance, falls back to the serial retired by Tick with fences.
+  uint64_t PollCompletedSerial() const;
+
+  // Coalesced write ranges up to |threshold| bytes are recorded inline with
+  // vkCmdUpdateBuffer instead of going through staging memory. 0, the
+  // default until bench_queue_write measured a better one, disables the
+  // inline path.
+  void SetInlineWriteThreshold(size_t threshold);
+
+  // Hands vkQueueSubmit over to a dedicated thread owning the VkQueue, so
+  // Submit returns once the work is queued. Disabling waits for the thread
+  // to submit what it was given.
+  void SetSubmitThreadEnabled(bool enabled);
+
+  // Copies |staging_buffer| over the whole of |buffer| ahead of the next
+  // submission, then destroys it once the copy executed.
+  void ScheduleStagingUpload(GFXBuffer* buffer,
+                             VkBuffer staging_buffer,
+                             VmaAllocation staging_allocation);
+
+  // Drops the writes to |buffer| not submitted yet, called when the buffer
+  // is destroyed.
+  void DiscardPendingWrites(GFXBuffer* buffer);
+
+  // Runs |task| once the submission |serial| completed, from the thread
+  // ticking the queue, or right away if it already did. Waiting on the
+  // pending serial submits the pending queue writes.
+  void RunWhenCompleted(uint64_t serial, std::function<void()> task);
+
+  // Blocks until the submission |serial| completed on the GPU or
+  // |timeout_ns| passed, without holding the queue lock. Returns false on
+  // timeout. Tasks waiting on |serial| still need a Tick to run.
+  bool WaitForSerial(uint64_t serial, uint64_t timeout_ns);
+
+  // Polls submissions in flight, recycles what they used and runs the tasks
+  // waiting on them.
+  void Tick();
+
+  // Waits for all submitted work and releases the Vulkan objects of the
+  // queue, called on device destruction.
+  void Destroy();
 
   WGPUFuture OnSubmittedWorkDone(WGPUQueueWorkDoneCallbackInfo callbackInfo);
   void SetLabel(WGPUStringView label);
@@ -38,11 +108,115 @@ class GFXQueue : public RefCounted<GFXQueue>, public WGPUQueueImpl {
                     WGPUExtent3D const* writeSize);
 
  private:
+  struct StagingBuffer {
+    VkBuffer buffer;
+    VmaAllocation allocation;
+  };
+
+  struct Submission {
+    uint64_t serial;
+    // Null with a timeline semaphore
+    VkFence fence;
+    // Queue writes and barriers between command buffers, from |command_pool_|
+    std::vector<VkCommandBuffer> queue_command_buffers;
+    // Destinations of queue writes, alive until the copies executed
+    std::vector<RefPtr<GFXBuffer>> buffers;
+    std::vector<RefPtr<GFXTexture>> textures;
+    std::vector<StagingBuffer> staging_buffers;
+    // Submitted command buffers, their pools are released on completion
+    std::vector<RefPtr<GFXCommandBuffer>> command_buffers;
+  };
+
+  // Write payloads kept allocated across submissions, a larger arena left
+  // by a burst of writes is released.
+  static constexpr size_t kMaxRetainedWriteData = 4 * 1024 * 1024;
+
+  struct WriteRange {
+    uint64_t offset;
+    uint64_t size;
+    // Payload in |write_data_|
+    size_t data_offset;
+  };
+
+  // Disjoint, non adjacent ranges sorted by buffer offset
+  using WriteRanges = std::vector<WriteRange>;
+
+  struct PendingWrites {
+    RefPtr<GFXBuffer> buffer;
+    WriteRanges ranges;
+  };
+
+  // Merges the write into |ranges|, the payload is appended to |write_data_|.
+  void InsertWriteRangeLocked(WriteRanges* ranges,
+                              uint64_t offset,
+                              const uint8_t* data,
+                              size_t size);
+
+  // Queue writes are recorded here and submitted ahead of the command
+  // buffers of the next Submit.
+  VkCommandBuffer GetPendingCommandsLocked();
+  // Begun command buffer from |command_pool_|.
+  VkCommandBuffer AcquireCommandBufferLocked();
+  bool FlushPendingWritesLocked();
+  bool SubmitLocked(
+      const std::vector<RefPtr<GFXCommandBuffer>>& command_buffers);
+  // A failed submission left buffer and texture states stitched for work
+  // which never executes, so the queue stops submitting and tracking
+  // altogether and reports the device lost.
+  void MarkLostLocked(VkResult result);
+  // Last serial the GPU finished, without retiring anything.
+  uint64_t QueryCompletedSerialLocked();
+  void TickLocked();
+  // Called without the lock, tasks may reenter the queue
+  void RunReadyTasks();
+
   VkQueue queue_;
+  uint32_t family_index_;
+
+  // The device owns the queue, cleared by Destroy
+  GFXDevice* device_;
+  // Kept for lock free polls, which may race with Destroy
+  VkDevice vk_device_;
+
+  std::mutex lock_;
+  VkCommandPool command_pool_ = VK_NULL_HANDLE;
+  std::vector<VkCommandBuffer> free_command_buffers_;
+  // Fences are reset when reused, so a retired one stays signaled for
+  // waiters which picked it up before
+  std::vector<VkFence> free_fences_;
+  VkSemaphore timeline_semaphore_ = VK_NULL_HANDLE;
+  // Threads blocked in WaitForSerial, no fence is reused and nothing is
+  // destroyed while there are any
+  uint32_t serial_waiters_ = 0;
+  std::condition_variable serial_waiters_done_;
+
+  VkCommandBuffer pending_commands_ = VK_NULL_HANDLE;
+  std::vector<RefPtr<GFXBuffer>> pending_buffers_;
+  std::vector<RefPtr<GFXTexture>> pending_textures_;
+  std::vector<StagingBuffer> pending_staging_buffers_;
+  // Buffer writes since the last Submit, merged per buffer. Entries of the
+  // buffers written again stay around with their range storage.
+  std::unordered_map<GFXBuffer*, PendingWrites> pending_writes_;
+  // Payloads of the pending writes, superseded bytes are only reclaimed on
+  // Submit.
+  std::vector<uint8_t> write_data_;
+  std::deque<Submission> in_flight_;
+  bool lost_ = false;
+  // Written under the lock
+  std::atomic<uint64_t> last_submitted_serial_ = 0;
+  std::atomic<uint64_t> completed_serial_ = 0;
+
+  std::unique_ptr<GFXStagingRing> staging_ring_;
+  // Set while the submit thread owns |queue_|
+  std::unique_ptr<GFXSubmitThread> submit_thread_;
 
-  RefPtr<GFXDevice> device_;
+  // Tasks keyed by the serial they wait on, moved to |ready_tasks_| by
+  // TickLocked.
+  std::multimap<uint64_t, std::function<void()>> serial_tasks_;
+  std::vector<std::function<void()>> ready_tasks_;
+  size_t inline_write_threshold_ = 0;
 
-  std::string label_;
+  std::string label_ = "GFX.Queue";
 };
 
 }  // namespace vkgfx
@@ -0,0 +1,366 @@
+// Copyright 2025 Admenri.
+// Use of this source code is governed by a MIT-style license that can be
+// found in the LICENSE file.
+
+#include "gfx/gfx_render_pass_cache.h"
+
+#include <algorithm>
+
+#include "gfx/common/log.h"
+#include "gfx/gfx_resource_track.h"
+#include "gfx/gfx_texture_view.h"
+#include "gfx/gfx_utils.h"
+
+namespace vkgfx {
+
+///////////////////////////////////////////////////////////////////////////////
+// GFXRenderPassCache Implement
+
+GFXRenderPassCache::GFXRenderPassCache(VkDevice device,
+                                       bool imageless_framebuffer)
+    : device_(device), imageless_framebuffer_(imageless_framebuffer) {}
+
+GFXRenderPassCache::~GFXRenderPassCache() {
+  for (auto& it : framebuffers_)
+    vkDestroyFramebuffer(device_, it.second.handle, nullptr);
+  for (auto& it : render_passes_)
+    vkDestroyRenderPass(device_, it.second, nullptr);
+}
+
+// static
+GFXRenderPassCache::RenderPassKey GFXRenderPassCache::MakeRenderPassKey(
+    const WGPURenderPassDescriptor* descriptor) {
+  RenderPassKey key;
+  key.color_count =
+      std::min<uint32_t>(descriptor->colorAttachmentCount,
+                         kMaxColorAttachments);
+
+  GFXTextureView* sample_view = nullptr;
+  for (uint32_t i = 0; i < key.color_count; ++i) {
+    const auto& attachment = descriptor->colorAttachments[i];
+    auto* view = static_cast<GFXTextureView*>(attachment.view);
+    if (!view) {
+      key.color_formats[i] = VK_FORMAT_UNDEFINED;
+      continue;
+    }
+
+    sample_view = sample_view ? sample_view : view;
+    key.color_formats[i] = ToVulkanPixelFormat(view->GetFormat());
+    key.color_load_ops[i] = ToVulkanLoadOp(attachment.loadOp);
+    key.color_store_ops[i] = ToVulkanStoreOp(attachment.storeOp);
+    key.color_resolves[i] = attachment.resolveTarget ? VK_TRUE : VK_FALSE;
+  }
+
+  if (const auto* attachment = descriptor->depthStencilAttachment) {
+    auto* view = static_cast<GFXTextureView*>(attachment->view);
+    sample_view = sample_view ? sample_view : view;
+    key.depth_stencil_format = ToVulkanPixelFormat(view->GetFormat());
+
+    // Read only aspects keep their contents
+    key.depth_load_op = attachment->depthReadOnly
+                            ? VK_ATTACHMENT_LOAD_OP_LOAD
+                            : ToVulkanLoadOp(attachment->depthLoadOp);
+    key.depth_store_op = attachment->depthReadOnly
+                             ? VK_ATTACHMENT_STORE_OP_STORE
+                             : ToVulkanStoreOp(attachment->depthStoreOp);
+    if (ToVulkanImageAspect(WGPUTextureAspect_All, view->GetFormat()) &
+        VK_IMAGE_ASPECT_STENCIL_BIT) {
+      key.stencil_load_op = attachment->stencilReadOnly
+                                ? VK_ATTACHMENT_LOAD_OP_LOAD
+                                : ToVulkanLoadOp(attachment->stencilLoadOp);
+      key.stencil_store_op = attachment->stencilReadOnly
+                                 ? VK_ATTACHMENT_STORE_OP_STORE
+                                 : ToVulkanStoreOp(attachment->stencilStoreOp);
+    }
+    key.depth_stencil_read_only =
+        attachment->depthReadOnly && attachment->stencilReadOnly;
+  }
+
+  if (sample_view)
+    key.sample_count =
+        ToVulkanSampleCount(sample_view->GetTexture()->GetSampleCount());
+
+  return key;
+}
+
+// static
+void GFXRenderPassCache::CollectAttachments(
+    const WGPURenderPassDescriptor* descriptor,
+    std::vector<GFXTextureView*>* attachments) {
+  const uint32_t color_count =
+      std::min<uint32_t>(descriptor->colorAttachmentCount,
+                         kMaxColorAttachments);
+
+  attachments->clear();
+  for (uint32_t i = 0; i < color_count; ++i) {
+    if (auto* view = descriptor->colorAttachments[i].view)
+      attachments->push_back(static_cast<GFXTextureView*>(view));
+  }
+
+  for (uint32_t i = 0; i < color_count; ++i) {
+    const auto& attachment = descriptor->colorAttachments[i];
+    if (attachment.view && attachment.resolveTarget)
+      attachments->push_back(
+          static_cast<GFXTextureView*>(attachment.resolveTarget));
+  }
+
+  if (const auto* attachment = descriptor->depthStencilAttachment)
+    attachments->push_back(static_cast<GFXTextureView*>(attachment->view));
+}
+
+VkRenderPass GFXRenderPassCache::GetRenderPass(const RenderPassKey& key) {
+  std::string key_data;
+  AppendKey(&key_data, key);
+
+  std::lock_guard guard(lock_);
+  auto& render_pass = render_passes_[key_data];
+  if (!render_pass)
+    render_pass = CreateRenderPassInternal(key);
+
+  return render_pass;
+}
+
+VkFramebuffer GFXRenderPassCache::GetFramebuffer(
+    VkRenderPass render_pass,
+    const std::vector<GFXTextureView*>& attachments) {
+  // Attachments share the extent of the render area
+  uint32_t width = 1, height = 1;
+  if (!attachments.empty()) {
+    auto* view = attachments.front();
+    width = std::max(view->GetTexture()->GetWidth() >> view->GetBaseMipLevel(),
+                     1u);
+    height = std::max(
+        view->GetTexture()->GetHeight() >> view->GetBaseMipLevel(), 1u);
+  }
+
+  std::string key;
+  AppendKey(&key, render_pass);
+  AppendKey(&key, width);
+  AppendKey(&key, height);
+  for (auto* view : attachments) {
+    if (imageless_framebuffer_) {
+      AppendKey(&key, view->GetVkUsage());
+      AppendKey(&key, ToVulkanPixelFormat(view->GetFormat()));
+      AppendKey(&key, view->GetArrayLayerCount());
+    } else {
+      AppendKey(&key, view->GetVkHandle());
+    }
+  }
+
+  std::lock_guard guard(lock_);
+  auto it = framebuffers_.find(key);
+  if (it != framebuffers_.end())
+    return it->second.handle;
+
+  std::vector<VkImageView> views;
+  std::vector<VkFormat> formats;
+  std::vector<VkFramebufferAttachmentImageInfo> image_infos;
+  views.reserve(attachments.size());
+  formats.reserve(attachments.size());
+  image_infos.reserve(attachments.size());
+  for (auto* view : attachments) {
+    views.push_back(view->GetVkHandle());
+    formats.push_back(ToVulkanPixelFormat(view->GetFormat()));
+
+    VkFramebufferAttachmentImageInfo image_info = {
+        VK_STRUCTURE_TYPE_FRAMEBUFFER_ATTACHMENT_IMAGE_INFO};
+    image_info.usage = view->GetVkUsage();
+    image_info.width = width;
+    image_info.height = height;
+    image_info.layerCount = view->GetArrayLayerCount();
+    image_info.viewFormatCount = 1;
+    image_info.pViewFormats = &formats.back();
+    image_infos.push_back(image_info);
+  }
+
+  VkFramebufferCreateInfo create_info = {
+      VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO};
+  create_info.renderPass = render_pass;
+  create_info.attachmentCount = attachments.size();
+  create_info.width = width;
+  create_info.height = height;
+  create_info.layers = 1;
+
+  VkFramebufferAttachmentsCreateInfo attachments_info = {
+      VK_STRUCTURE_TYPE_FRAMEBUFFER_ATTACHMENTS_CREATE_INFO};
+  if (imageless_framebuffer_) {
+    attachments_info.attachmentImageInfoCount = image_infos.size();
+    attachments_info.pAttachmentImageInfos = image_infos.data();
+    create_info.flags = VK_FRAMEBUFFER_CREATE_IMAGELESS_BIT;
+    NextChainBuilder(&create_info).Add(&attachments_info);
+  } else {
+    create_info.pAttachments = views.data();
+  }
+
+  VkFramebuffer framebuffer = VK_NULL_HANDLE;
+  if (vkCreateFramebuffer(device_, &create_info, nullptr, &framebuffer) !=
+      VK_SUCCESS) {
+    GFX_ERROR() << __FUNCTION__ << ": Failed to create framebuffer.";
+    return VK_NULL_HANDLE;
+  }
+
+  auto& entry = framebuffers_[key];
+  entry.handle = framebuffer;
+  if (!imageless_framebuffer_) {
+    for (auto view : views)
+      view_index_.emplace(view, key);
+    entry.views = std::move(views);
+  }
+
+  return framebuffer;
+}
+
+void GFXRenderPassCache::EvictImageView(VkImageView view,
+                                        uint64_t serial,
+                                        GFXResourceTracker* tracker) {
+  std::vector<VkFramebuffer> evicted;
+  {
+    std::lock_guard guard(lock_);
+    auto range = view_index_.equal_range(view);
+    if (range.first == range.second)
+      return;
+
+    std::vector<std::string> keys;
+    for (auto it = range.first; it != range.second; ++it)
+      keys.push_back(it->second);
+
+    for (const auto& key : keys) {
+      auto it = framebuffers_.find(key);
+      if (it == framebuffers_.end())
+        continue;
+
+      // Drop the index entries of every view of this framebuffer
+      for (auto attached_view : it->second.views) {
+        auto attached_range = view_index_.equal_range(attached_view);
+        for (auto iter = attached_range.first; iter != attached_range.second;
+             ++iter) {
+          if (iter->second == key) {
+            view_index_.erase(iter);
+            break;
+          }
+        }
+      }
+
+      evicted.push_back(it->second.handle);
+      framebuffers_.erase(it);
+    }
+  }
+
+  // Pending render passes may still reference them
+  for (auto framebuffer : evicted) {
+    if (tracker)
+      tracker->ReleaseFramebuffer(framebuffer, serial);
+    else
+      vkDestroyFramebuffer(device_, framebuffer, nullptr);
+  }
+}
+
+VkRenderPass GFXRenderPassCache::CreateRenderPassInternal(
+    const RenderPassKey& key) {
+  std::vector<VkAttachmentDescription> attachments;
+  std::vector<VkAttachmentReference> color_references;
+  std::vector<VkAttachmentReference> resolve_references;
+  bool has_resolve = false;
+
+  for (uint32_t i = 0; i < key.color_count; ++i) {
+    if (key.color_formats[i] == VK_FORMAT_UNDEFINED) {
+      color_references.push_back(VkAttachmentReference{
+          VK_ATTACHMENT_UNUSED, VK_IMAGE_LAYOUT_UNDEFINED});
+      continue;
+    }
+
+    VkAttachmentDescription attachment = {};
+    attachment.format = key.color_formats[i];
+    attachment.samples = key.sample_count;
+    attachment.loadOp = key.color_load_ops[i];
+    attachment.storeOp = key.color_store_ops[i];
+    attachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+    attachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    attachment.initialLayout =
+        attachment.loadOp == VK_ATTACHMENT_LOAD_OP_LOAD
+            ? VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL
+            : VK_IMAGE_LAYOUT_UNDEFINED;
+    attachment.finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    color_references.push_back(
+        VkAttachmentReference{static_cast<uint32_t>(attachments.size()),
+                              VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL});
+    attachments.push_back(attachment);
+  }
+
+  for (uint32_t i = 0; i < key.color_count; ++i) {
+    if (key.color_formats[i] == VK_FORMAT_UNDEFINED ||
+        !key.color_resolves[i]) {
+      resolve_references.push_back(VkAttachmentReference{
+          VK_ATTACHMENT_UNUSED, VK_IMAGE_LAYOUT_UNDEFINED});
+      continue;
+    }
+
+    VkAttachmentDescription attachment = {};
+    attachment.format = key.color_formats[i];
+    attachment.samples = VK_SAMPLE_COUNT_1_BIT;
+    attachment.loadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+    attachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+    attachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+    attachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    attachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    attachment.finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    resolve_references.push_back(
+        VkAttachmentReference{static_cast<uint32_t>(attachments.size()),
+                              VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL});
+    attachments.push_back(attachment);
+    has_resolve = true;
+  }
+
+  VkAttachmentReference depth_stencil_reference = {VK_ATTACHMENT_UNUSED,
+                                                   VK_IMAGE_LAYOUT_UNDEFINED};
+  if (key.depth_stencil_format != VK_FORMAT_UNDEFINED) {
+    const VkImageLayout layout =
+        key.depth_stencil_read_only
+            ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL
+            : VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+    VkAttachmentDescription attachment = {};
+    attachment.format = key.depth_stencil_format;
+    attachment.samples = key.sample_count;
+    attachment.loadOp = key.depth_load_op;
+    attachment.storeOp = key.depth_store_op;
+    attachment.stencilLoadOp = key.stencil_load_op;
+    attachment.stencilStoreOp = key.stencil_store_op;
+    attachment.initialLayout =
+        key.depth_load_op == VK_ATTACHMENT_LOAD_OP_LOAD ||
+                key.stencil_load_op == VK_ATTACHMENT_LOAD_OP_LOAD
+            ? layout
+            : VK_IMAGE_LAYOUT_UNDEFINED;
+    attachment.finalLayout = layout;
+    depth_stencil_reference.attachment = attachments.size();
+    depth_stencil_reference.layout = layout;
+    attachments.push_back(attachment);
+  }
+
+  VkSubpassDescription subpass = {};
+  subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+  subpass.colorAttachmentCount = color_references.size();
+  subpass.pColorAttachments = color_references.data();
+  if (has_resolve)
+    subpass.pResolveAttachments = resolve_references.data();
+  if (depth_stencil_reference.attachment != VK_ATTACHMENT_UNUSED)
+    subpass.pDepthStencilAttachment = &depth_stencil_reference;
+
+  VkRenderPassCreateInfo create_info = {
+      VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO};
+  create_info.attachmentCount = attachments.size();
+  create_info.pAttachments = attachments.data();
+  create_info.subpassCount = 1;
+  create_info.pSubpasses = &subpass;
+
+  VkRenderPass render_pass = VK_NULL_HANDLE;
+  if (vkCreateRenderPass(device_, &create_info, nullptr, &render_pass) !=
+      VK_SUCCESS) {
+    GFX_ERROR() << __FUNCTION__ << ": Failed to create render pass.";
+    return VK_NULL_HANDLE;
+  }
+
+  return render_pass;
+}
+
+}  // namespace vkgfx
@@ -0,0 +1,103 @@
+// Copyright 2025 Admenri.
+// Use of this source code is governed by a MIT-style license that can be
+// found in the LICENSE file.
+
+#ifndef GFX_GFX_RENDER_PASS_CACHE_H_
+#define GFX_GFX_RENDER_PASS_CACHE_H_
+
+#include <array>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "gfx/gfx_config.h"
+
+namespace vkgfx {
+
+class GFXResourceTracker;
+class GFXTextureView;
+
+// Device level cache of VkRenderPass and VkFramebuffer objects.
+// Render passes are keyed on attachment formats, sample count and load/store
+// ops and live as long as the device. Framebuffers are keyed on the render
+// pass and extent plus either the attachment image descriptions, when
+// VK_KHR_imageless_framebuffer is enabled so one framebuffer serves every
+// swapchain image, or the image views themselves, in which case they are
+// evicted when one of those views is destroyed.
+//
+// Attachment order is: color attachments without holes, then their resolve
+// targets in the same order, then the depth stencil attachment.
+class GFXRenderPassCache {
+ public:
+  static constexpr uint32_t kMaxColorAttachments = 8;
+
+  // Plain 32-bit fields only, compared and hashed as bytes.
+  struct RenderPassKey {
+    uint32_t color_count = 0;
+    // VK_FORMAT_UNDEFINED marks a hole
+    std::array<VkFormat, kMaxColorAttachments> color_formats = {};
+    std::array<VkAttachmentLoadOp, kMaxColorAttachments> color_load_ops = {};
+    std::array<VkAttachmentStoreOp, kMaxColorAttachments> color_store_ops = {};
+    std::array<VkBool32, kMaxColorAttachments> color_resolves = {};
+    VkFormat depth_stencil_format = VK_FORMAT_UNDEFINED;
+    VkAttachmentLoadOp depth_load_op = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+    VkAttachmentStoreOp depth_store_op = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    VkAttachmentLoadOp stencil_load_op = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+    VkAttachmentStoreOp stencil_store_op = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    VkBool32 depth_stencil_read_only = VK_FALSE;
+    VkSampleCountFlagBits sample_count = VK_SAMPLE_COUNT_1_BIT;
+  };
+
+  GFXRenderPassCache(VkDevice device, bool imageless_framebuffer);
+  ~GFXRenderPassCache();
+
+  GFXRenderPassCache(const GFXRenderPassCache&) = delete;
+  GFXRenderPassCache& operator=(const GFXRenderPassCache&) = delete;
+
+  // Describe the attachments of a render pass begin.
+  static RenderPassKey MakeRenderPassKey(
+      const WGPURenderPassDescriptor* descriptor);
+  static void CollectAttachments(const WGPURenderPassDescriptor* descriptor,
+                                 std::vector<GFXTextureView*>* attachments);
+
+  bool IsImagelessFramebuffer() const { return imageless_framebuffer_; }
+
+  // Returns a render pass owned by the cache, or null on failure.
+  VkRenderPass GetRenderPass(const RenderPassKey& key);
+
+  // Returns a framebuffer owned by the cache for |attachments| in attachment
+  // order, or null on failure. Imageless framebuffers need the views again
+  // in VkRenderPassAttachmentBeginInfo.
+  VkFramebuffer GetFramebuffer(
+      VkRenderPass render_pass,
+      const std::vector<GFXTextureView*>& attachments);
+
+  // Drops the framebuffers built on |view|, called on view destruction.
+  // They are destroyed once |serial|, the last use of the view, completed,
+  // through |tracker| when there is one.
+  void EvictImageView(VkImageView view,
+                      uint64_t serial,
+                      GFXResourceTracker* tracker);
+
+ private:
+  struct Framebuffer {
+    VkFramebuffer handle = VK_NULL_HANDLE;
+    // Empty for imageless framebuffers
+    std::vector<VkImageView> views;
+  };
+
+  VkRenderPass CreateRenderPassInternal(const RenderPassKey& key);
+
+  VkDevice device_;
+  bool imageless_framebuffer_;
+
+  std::mutex lock_;
+  std::unordered_map<std::string, VkRenderPass> render_passes_;
+  std::unordered_map<std::string, Framebuffer> framebuffers_;
+  std::unordered_multimap<VkImageView, std::string> view_index_;
+};
+
+}  // namespace vkgfx
+
+#endif  // GFX_GFX_RENDER_PASS_CACHE_H_
@@ -4,35 +4,260 @@
 
 #include "gfx/gfx_render_pass_encoder.h"
 
+#include <algorithm>
+
+#include "gfx/gfx_buffer.h"
+#include "gfx/gfx_queue.h"
+#include "gfx/gfx_render_pass_cache.h"
+#include "gfx/gfx_utils.h"
+
 namespace vkgfx {
 
 ///////////////////////////////////////////////////////////////////////////////
 // GFXRenderPassEncoder Implement
 
-GFXRenderPassEncoder::GFXRenderPassEncoder() {}
+GFXRenderPassEncoder::GFXRenderPassEncoder(
+    RefPtr<GFXCommandEncoder> encoder,
+    const WGPURenderPassDescriptor& descriptor,
+    const Target& target)
+    : encoder_(encoder), target_(target), is_child_(false) {
+  if (descriptor.label.data && descriptor.label.length)
+    label_ = std::string(descriptor.label.data, descriptor.label.length);
+
+  // Same order as GFXRenderPassCache::CollectAttachments
+  const uint32_t color_count =
+      std::min<uint32_t>(descriptor.colorAttachmentCount,
+                         GFXRenderPassCache::kMaxColorAttachments);
+  for (uint32_t i = 0; i < color_count; ++i) {
+    const auto& attachment = descriptor.colorAttachments[i];
+    if (!attachment.view)
+      continue;
+
+    VkAccessFlags access = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    if (attachment.loadOp == WGPULoadOp_Load)
+      access |= VK_ACCESS_COLOR_ATTACHMENT_READ_BIT;
+    attachments_.push_back(
+        {static_cast<GFXTextureView*>(attachment.view),
+         {VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+          VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, access}});
+
+    VkClearValue clear_value = {};
+    clear_value.color.float32[0] = attachment.clearValue.r;
+    clear_value.color.float32[1] = attachment.clearValue.g;
+    clear_value.color.float32[2] = attachment.clearValue.b;
+    clear_value.color.float32[3] = attachment.clearValue.a;
+    clear_values_.push_back(clear_value);
+  }
+
+  for (uint32_t i = 0; i < color_count; ++i) {
+    const auto& attachment = descriptor.colorAttachments[i];
+    if (!attachment.view || !attachment.resolveTarget)
+      continue;
+
+    attachments_.push_back(
+        {static_cast<GFXTextureView*>(attachment.resolveTarget),
+         {VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+          VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+          VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT}});
+    clear_values_.push_back(VkClearValue{});
+  }
+
+  if (const auto* attachment = descriptor.depthStencilAttachment) {
+    bool read_only = attachment->depthReadOnly && attachment->stencilReadOnly;
+    VkAccessFlags access = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT;
+    if (!read_only)
+      access |= VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+    attachments_.push_back(
+        {static_cast<GFXTextureView*>(attachment->view),
+         {read_only ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL
+                    : VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+          VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT |
+              VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+          access}});
+
+    VkClearValue clear_value = {};
+    clear_value.depthStencil.depth = attachment->depthClearValue;
+    clear_value.depthStencil.stencil = attachment->stencilClearValue;
+    clear_values_.push_back(clear_value);
+  }
+}
 
-GFXRenderPassEncoder::~GFXRenderPassEncoder() {}
+GFXRenderPassEncoder::GFXRenderPassEncoder(RefPtr<GFXCommandEncoder> encoder,
+                                           const Target& target,
+                                           const std::string& label)
+    : encoder_(encoder), target_(target), is_child_(true), label_(label) {}
+
+GFXRenderPassEncoder::~GFXRenderPassEncoder() {
+  // Never executed, the pass did not end
+  auto* command_allocator = encoder_->GetDevice()->GetCommandAllocator();
+  if (allocation_.frame && command_allocator)
+    command_allocator->Release(allocation_, 0);
+}
 
 void GFXRenderPassEncoder::BeginOcclusionQuery(uint32_t queryIndex) {}
 
 void GFXRenderPassEncoder::Draw(uint32_t vertexCount,
                                 uint32_t instanceCount,
                                 uint32_t firstVertex,
-                                uint32_t firstInstance) {}
+                                uint32_t firstInstance) {
+  VkCommandBuffer command_buffer = PrepareDraw("Draw", nullptr, 0, 0);
+  if (!command_buffer)
+    return;
+
+  vkCmdDraw(command_buffer, vertexCount, instanceCount, firstVertex,
+            firstInstance);
+}
 
 void GFXRenderPassEncoder::DrawIndexed(uint32_t indexCount,
                                        uint32_t instanceCount,
                                        uint32_t firstIndex,
                                        int32_t baseVertex,
-                                       uint32_t firstInstance) {}
+                                       uint32_t firstInstance) {
+  VkCommandBuffer command_buffer = PrepareDraw("DrawIndexed", nullptr, 0, 0);
+  if (!command_buffer)
+    return;
+
+  vkCmdDrawIndexed(command_buffer, indexCount, instanceCount, firstIndex,
+                   baseVertex, firstInstance);
+}
 
 void GFXRenderPassEncoder::DrawIndexedIndirect(WGPUBuffer indirectBuffer,
-                                               uint64_t indirectOffset) {}
+                                               uint64_t indirectOffset) {
+  auto* buffer_impl = static_cast<GFXBuffer*>(indirectBuffer);
+  VkCommandBuffer command_buffer =
+      PrepareDraw("DrawIndexedIndirect", buffer_impl, indirectOffset,
+                  kDrawIndexedIndirectSize);
+  if (!command_buffer)
+    return;
+
+  vkCmdDrawIndexedIndirect(command_buffer, buffer_impl->GetVkHandle(),
+                           buffer_impl->GetOffset() + indirectOffset, 1, 0);
+}
 
 void GFXRenderPassEncoder::DrawIndirect(WGPUBuffer indirectBuffer,
-                                        uint64_t indirectOffset) {}
+                                        uint64_t indirectOffset) {
+  auto* buffer_impl = static_cast<GFXBuffer*>(indirectBuffer);
+  VkCommandBuffer command_buffer = PrepareDraw(
+      "DrawIndirect", buffer_impl, indirectOffset, kDrawIndirectSize);
+  if (!command_buffer)
+    return;
+
+  vkCmdDrawIndirect(command_buffer, buffer_impl->GetVkHandle(),
+                    buffer_impl->GetOffset() + indirectOffset, 1, 0);
+}
 
-void GFXRenderPassEncoder::End() {}
+void GFXRenderPassEncoder::End() {
+  auto* device = encoder_->GetDevice();
+  if (ended_) {
+    device->CallDeviceErrorCallback(WGPUErrorType_Validation,
+                                    "End: Pass is already ended.");
+    return;
+  }
+
+  for (const auto& child : children_) {
+    if (!child->ended_) {
+      device->CallDeviceErrorCallback(
+          WGPUErrorType_Validation,
+          "End: Every encoder split from the pass must end first.");
+      return;
+    }
+  }
+
+  ended_ = true;
+  if (allocation_.command_buffer &&
+      vkEndCommandBuffer(allocation_.command_buffer) != VK_SUCCESS)
+    device->CallDeviceErrorCallback(WGPUErrorType_OutOfMemory,
+                                    "End: Failed to end command buffer.");
+
+  // Children are executed by the pass they were split from
+  if (is_child_)
+    return;
+
+  std::vector<GFXRenderPassEncoder*> recorders = {this};
+  for (const auto& child : children_)
+    recorders.push_back(child.get());
+
+  // Usages inside the pass are synchronized before it begins
+  GFXBarrierBatch barriers;
+  auto* buffer_usage = encoder_->GetBufferUsage();
+  for (auto* recorder : recorders) {
+    for (const auto& it : recorder->buffer_uses_)
+      buffer_usage->Use(it.buffer.get(), it.offset, it.size, it.access,
+                        &barriers);
+    for (const auto& it : recorder->bound_groups_)
+      encoder_->RetainBindGroup(it.get());
+    recorder->bound_groups_.clear();
+    for (const auto& it : recorder->bound_pipelines_)
+      encoder_->RetainPipeline(it.get());
+    recorder->bound_pipelines_.clear();
+  }
+
+  // Textures the shaders read or write, in the layout of their descriptors
+  auto* texture_usage = encoder_->GetTextureUsage();
+  for (auto* recorder : recorders) {
+    for (const auto& it : recorder->texture_uses_) {
+      auto* view = it.view.get();
+      texture_usage->Transition(
+          view->GetTexture(),
+          {view->GetBaseMipLevel(), view->GetMipLevelCount(),
+           view->GetBaseArrayLayer(), view->GetArrayLayerCount()},
+          it.access, &barriers);
+    }
+  }
+
+  for (const auto& it : attachments_) {
+    auto* view = it.view.get();
+    texture_usage->Transition(
+        view->GetTexture(),
+        {view->GetBaseMipLevel(), 1, view->GetBaseArrayLayer(),
+         view->GetArrayLayerCount()},
+        it.access, &barriers);
+  }
+
+  VkCommandBuffer command_buffer = encoder_->GetVkHandle();
+  barriers.Record(command_buffer);
+
+  VkRenderPassBeginInfo begin_info = {
+      VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO};
+  begin_info.renderPass = target_.render_pass;
+  begin_info.framebuffer = target_.framebuffer;
+  begin_info.renderArea.extent = target_.extent;
+  begin_info.clearValueCount = clear_values_.size();
+  begin_info.pClearValues = clear_values_.data();
+
+  std::vector<VkImageView> views;
+  VkRenderPassAttachmentBeginInfo attachment_info = {
+      VK_STRUCTURE_TYPE_RENDER_PASS_ATTACHMENT_BEGIN_INFO};
+  if (device->GetRenderPassCache()->IsImagelessFramebuffer()) {
+    for (const auto& it : attachments_)
+      views.push_back(it.view->GetVkHandle());
+    attachment_info.attachmentCount = views.size();
+    attachment_info.pAttachments = views.data();
+    NextChainBuilder(&begin_info).Add(&attachment_info);
+  }
+
+  vkCmdBeginRenderPass(command_buffer, &begin_info,
+                       VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+
+  // The command encoder releases the secondaries from now on
+  std::vector<VkCommandBuffer> secondaries;
+  for (auto* recorder : recorders) {
+    if (!recorder->allocation_.command_buffer)
+      continue;
+
+    secondaries.push_back(recorder->allocation_.command_buffer);
+    encoder_->AddSecondary(recorder->allocation_);
+    recorder->allocation_ = {};
+  }
+  if (!secondaries.empty())
+    vkCmdExecuteCommands(command_buffer, secondaries.size(),
+                         secondaries.data());
+
+  vkCmdEndRenderPass(command_buffer);
+
+  children_.clear();
+  encoder_->EndPass();
+}
 
 void GFXRenderPassEncoder::EndOcclusionQuery() {}
 
@@ -48,39 +273,331 @@ void GFXRenderPassEncoder::PushDebugGroup(WGPUStringView groupLabel) {}
 void GFXRenderPassEncoder::SetBindGroup(uint32_t groupIndex,
                                         WGPUBindGroup group,
                                         size_t dynamicOffsetCount,
-                                        uint32_t const* dynamicOffsets) {}
+                                        uint32_t const* dynamicOffsets) {
+  if (groupIndex >= bind_groups_.size())
+    bind_groups_.resize(groupIndex + 1);
+
+  auto& state = bind_groups_[groupIndex];
+  state.group = static_cast<GFXBindGroup*>(group);
+  state.dynamic_offsets.assign(dynamicOffsets,
+                               dynamicOffsets + dynamicOffsetCount);
+  state.dirty = true;
+  state.tracked = false;
+}
 
-void GFXRenderPassEncoder::SetBlendConstant(WGPUColor const* color) {}
+void GFXRenderPassEncoder::SetBlendConstant(WGPUColor const* color) {
+  VkCommandBuffer command_buffer = GetCommandBuffer("SetBlendConstant");
+  if (!command_buffer || !color)
+    return;
+
+  const float constants[4] = {
+      static_cast<float>(color->r), static_cast<float>(color->g),
+      static_cast<float>(color->b), static_cast<float>(color->a)};
+  vkCmdSetBlendConstants(command_buffer, constants);
+}
 
 void GFXRenderPassEncoder::SetIndexBuffer(WGPUBuffer buffer,
                                           WGPUIndexFormat format,
                                           uint64_t offset,
-                                          uint64_t size) {}
+                                          uint64_t size) {
+  VkCommandBuffer command_buffer = GetCommandBuffer("SetIndexBuffer");
+  if (!command_buffer)
+    return;
+
+  auto* buffer_impl = static_cast<GFXBuffer*>(buffer);
+  if (!buffer_impl || !(buffer_impl->GetUsage() & WGPUBufferUsage_Index) ||
+      offset > buffer_impl->GetSize()) {
+    encoder_->GetDevice()->CallDeviceErrorCallback(
+        WGPUErrorType_Validation,
+        "SetIndexBuffer: Invalid index buffer range.");
+    return;
+  }
+
+  if (size == WGPU_WHOLE_SIZE)
+    size = buffer_impl->GetSize() - offset;
+  if (size > buffer_impl->GetSize() - offset) {
+    encoder_->GetDevice()->CallDeviceErrorCallback(
+        WGPUErrorType_Validation,
+        "SetIndexBuffer: Invalid index buffer range.");
+    return;
+  }
+
+  UseBuffer(buffer_impl, offset, size,
+            {VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, VK_ACCESS_INDEX_READ_BIT});
+  vkCmdBindIndexBuffer(command_buffer, buffer_impl->GetVkHandle(),
+                       buffer_impl->GetOffset() + offset,
+                       format == WGPUIndexFormat_Uint16 ? VK_INDEX_TYPE_UINT16
+                                                        : VK_INDEX_TYPE_UINT32);
+}
 
 void GFXRenderPassEncoder::SetLabel(WGPUStringView label) {
   label_ = std::string(label.data, label.length);
 }
 
-void GFXRenderPassEncoder::SetPipeline(WGPURenderPipeline pipeline) {}
+void GFXRenderPassEncoder::SetPipeline(WGPURenderPipeline pipeline) {
+  VkCommandBuffer command_buffer = GetCommandBuffer("SetPipeline");
+  if (!command_buffer)
+    return;
+
+  pipeline_ = static_cast<GFXRenderPipeline*>(pipeline);
+  if (!pipeline_)
+    return;
+
+  if (bound_pipelines_.empty() || bound_pipelines_.back() != pipeline_)
+    bound_pipelines_.push_back(pipeline_);
+  vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
+                    pipeline_->GetVkPipeline());
+
+  // Sets are rebound against the layout of the new pipeline
+  for (auto& state : bind_groups_)
+    state.dirty = true;
+}
 
 void GFXRenderPassEncoder::SetScissorRect(uint32_t x,
                                           uint32_t y,
                                           uint32_t width,
-                                          uint32_t height) {}
+                                          uint32_t height) {
+  VkCommandBuffer command_buffer = GetCommandBuffer("SetScissorRect");
+  if (!command_buffer)
+    return;
+
+  VkRect2D scissor = {};
+  scissor.offset.x = static_cast<int32_t>(x);
+  scissor.offset.y = static_cast<int32_t>(y);
+  scissor.extent.width = width;
+  scissor.extent.height = height;
+  vkCmdSetScissor(command_buffer, 0, 1, &scissor);
+}
 
-void GFXRenderPassEncoder::SetStencilReference(uint32_t reference) {}
+void GFXRenderPassEncoder::SetStencilReference(uint32_t reference) {
+  VkCommandBuffer command_buffer = GetCommandBuffer("SetStencilReference");
+  if (!command_buffer)
+    return;
+
+  vkCmdSetStencilReference(command_buffer, VK_STENCIL_FACE_FRONT_AND_BACK,
+                           reference);
+}
 
 void GFXRenderPassEncoder::SetVertexBuffer(uint32_t slot,
                                            WGPUBuffer buffer,
                                            uint64_t offset,
-                                           uint64_t size) {}
+                                           uint64_t size) {
+  VkCommandBuffer command_buffer = GetCommandBuffer("SetVertexBuffer");
+  if (!command_buffer)
+    return;
+
+  // Unbinding leaves the slot to the next draw validation
+  auto* buffer_impl = static_cast<GFXBuffer*>(buffer);
+  if (!buffer_impl)
+    return;
+
+  if (size == WGPU_WHOLE_SIZE && offset <= buffer_impl->GetSize())
+    size = buffer_impl->GetSize() - offset;
+  if (!(buffer_impl->GetUsage() & WGPUBufferUsage_Vertex) ||
+      offset > buffer_impl->GetSize() ||
+      size > buffer_impl->GetSize() - offset) {
+    encoder_->GetDevice()->CallDeviceErrorCallback(
+        WGPUErrorType_Validation,
+        "SetVertexBuffer: Invalid vertex buffer range.");
+    return;
+  }
+
+  UseBuffer(buffer_impl, offset, size,
+            {VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+             VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT});
+
+  VkBuffer vk_buffer = buffer_impl->GetVkHandle();
+  VkDeviceSize vk_offset = buffer_impl->GetOffset() + offset;
+  vkCmdBindVertexBuffers(command_buffer, slot, 1, &vk_buffer, &vk_offset);
+}
 
 void GFXRenderPassEncoder::SetViewport(float x,
                                        float y,
                                        float width,
                                        float height,
                                        float minDepth,
-                                       float maxDepth) {}
+                                       float maxDepth) {
+  VkCommandBuffer command_buffer = GetCommandBuffer("SetViewport");
+  if (!command_buffer)
+    return;
+
+  VkViewport viewport = {x, y, width, height, minDepth, maxDepth};
+  vkCmdSetViewport(command_buffer, 0, 1, &viewport);
+}
+
+void GFXRenderPassEncoder::Split(size_t count,
+                                 WGPURenderPassEncoder* children) {
+  if (is_child_ || ended_) {
+    encoder_->GetDevice()->CallDeviceErrorCallback(
+        WGPUErrorType_Validation,
+        "Split: Only a pass still being recorded can be split.");
+    return;
+  }
+
+  for (size_t i = 0; i < count; ++i) {
+    auto* child = new GFXRenderPassEncoder(encoder_, target_, label_);
+    children_.push_back(child);
+    children[i] = AdaptExternalRefCounted(child);
+  }
+}
+
+VkCommandBuffer GFXRenderPassEncoder::GetCommandBuffer(
+    const char* function) {
+  auto* device = encoder_->GetDevice();
+  if (ended_ || !children_.empty()) {
+    device->CallDeviceErrorCallback(
+        WGPUErrorType_Validation,
+        std::string(function) + ": Pass already ended or split.");
+    return VK_NULL_HANDLE;
+  }
+
+  if (allocation_.command_buffer)
+    return allocation_.command_buffer;
+
+  VkCommandBufferInheritanceInfo inheritance = {
+      VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO};
+  inheritance.renderPass = target_.render_pass;
+  inheritance.subpass = 0;
+  inheritance.framebuffer = target_.framebuffer;
+
+  // Allocated on the recording thread, pools are per thread
+  auto* queue = device->GetDefaultQueue();
+  auto* command_allocator = device->GetCommandAllocator();
+  if (!queue || !command_allocator ||
+      !command_allocator->Allocate(queue->GetPendingSerial(),
+                                   queue->GetCompletedSerial(), &allocation_,
+                                   &inheritance)) {
+    allocation_ = {};
+    device->CallDeviceErrorCallback(
+        WGPUErrorType_OutOfMemory,
+        std::string(function) + ": Failed to allocate command buffer.");
+    return VK_NULL_HANDLE;
+  }
+
+  // Secondary command buffers inherit no dynamic state, start from the
+  // defaults of a pass.
+  VkCommandBuffer command_buffer = allocation_.command_buffer;
+  VkViewport viewport = {0.0f,
+                         0.0f,
+                         static_cast<float>(target_.extent.width),
+                         static_cast<float>(target_.extent.height),
+                         0.0f,
+                         1.0f};
+  vkCmdSetViewport(command_buffer, 0, 1, &viewport);
+  VkRect2D scissor = {{0, 0}, target_.extent};
+  vkCmdSetScissor(command_buffer, 0, 1, &scissor);
+  const float blend_constants[4] = {};
+  vkCmdSetBlendConstants(command_buffer, blend_constants);
+  vkCmdSetStencilReference(command_buffer, VK_STENCIL_FACE_FRONT_AND_BACK, 0);
+
+  return command_buffer;
+}
+
+void GFXRenderPassEncoder::UseBuffer(GFXBuffer* buffer,
+                                     uint64_t offset,
+                                     uint64_t size,
+                                     const BufferAccess& access) {
+  // Rebinding the same range every draw is common
+  if (!buffer_uses_.empty()) {
+    const auto& last = buffer_uses_.back();
+    if (last.buffer.get() == buffer && last.offset == offset &&
+        last.size == size && last.access.stages == access.stages &&
+        last.access.access == access.access)
+      return;
+  }
+
+  buffer_uses_.push_back({buffer, offset, size, access});
+}
+
+void GFXRenderPassEncoder::UseTexture(GFXTextureView* view,
+                                      const ImageAccess& access) {
+  // Rebinding the same texture every draw is common
+  if (!texture_uses_.empty()) {
+    const auto& last = texture_uses_.back();
+    if (last.view.get() == view && last.access.layout == access.layout &&
+        last.access.stages == access.stages &&
+        last.access.access == access.access)
+      return;
+  }
+
+  texture_uses_.push_back({view, access});
+}
+
+VkCommandBuffer GFXRenderPassEncoder::PrepareDraw(const char* function,
+                                                  GFXBuffer* indirect_buffer,
+                                                  uint64_t indirect_offset,
+                                                  uint64_t indirect_size) {
+  VkCommandBuffer command_buffer = GetCommandBuffer(function);
+  if (!command_buffer)
+    return VK_NULL_HANDLE;
+
+  auto* device = encoder_->GetDevice();
+  if (!pipeline_) {
+    device->CallDeviceErrorCallback(
+        WGPUErrorType_Validation, std::string(function) + ": No pipeline set.");
+    return VK_NULL_HANDLE;
+  }
+
+  if (indirect_size &&
+      (!indirect_buffer ||
+       !(indirect_buffer->GetUsage() & WGPUBufferUsage_Indirect) ||
+       indirect_offset % 4 || indirect_offset > indirect_buffer->GetSize() ||
+       indirect_buffer->GetSize() - indirect_offset < indirect_size)) {
+    device->CallDeviceErrorCallback(
+        WGPUErrorType_Validation,
+        std::string(function) + ": Invalid indirect buffer range.");
+    return VK_NULL_HANDLE;
+  }
+
+  for (auto& state : bind_groups_) {
+    if (state.tracked || !state.group)
+      continue;
+
+    size_t dynamic_index = 0;
+    for (const auto& binding : state.group->GetBufferBindings()) {
+      uint64_t offset = binding.offset;
+      if (binding.has_dynamic_offset &&
+          dynamic_index < state.dynamic_offsets.size())
+        offset += state.dynamic_offsets[dynamic_index++];
+
+      UseBuffer(binding.buffer, offset, binding.size,
+                GFXBufferUsageTracker::GetBindingAccess(
+                    binding.type, VK_PIPELINE_STAGE_VERTEX_SHADER_BIT |
+                                      VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT));
+    }
+    for (const auto& binding : state.group->GetTextureBindings())
+      UseTexture(binding.view,
+                 {binding.layout,
+                  VK_PIPELINE_STAGE_VERTEX_SHADER_BIT |
+                      VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                  binding.access});
+    state.tracked = true;
+  }
+
+  if (indirect_size)
+    UseBuffer(indirect_buffer, indirect_offset, indirect_size,
+              {VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT,
+               VK_ACCESS_INDIRECT_COMMAND_READ_BIT});
+
+  VkPipelineLayout layout = pipeline_->GetLayout()->GetVkHandle();
+  for (uint32_t i = 0; i < bind_groups_.size(); ++i) {
+    auto& state = bind_groups_[i];
+    if (!state.dirty || !state.group)
+      continue;
+
+    VkDescriptorSet set = state.group->GetVkHandle();
+    vkCmdBindDescriptorSets(
+        command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, layout, i, 1, &set,
+        static_cast<uint32_t>(state.dynamic_offsets.size()),
+        state.dynamic_offsets.data());
+    state.dirty = false;
+
+    if (bound_groups_.empty() || bound_groups_.back() != state.group)
+      bound_groups_.push_back(state.group);
+  }
+
+  return command_buffer;
+}
 
 }  // namespace vkgfx
 
@@ -5,18 +5,50 @@
 #ifndef GFX_GFX_RENDER_PASS_ENCODER_H_
 #define GFX_GFX_RENDER_PASS_ENCODER_H_
 
+#include <string>
+#include <vector>
+
 #include "gfx/common/refptr.h"
+#include "gfx/gfx_bind_group.h"
+#include "gfx/gfx_buffer_state.h"
+#include "gfx/gfx_command_allocator.h"
+#include "gfx/gfx_command_encoder.h"
 #include "gfx/gfx_config.h"
+#include "gfx/gfx_render_pipeline.h"
+#include "gfx/gfx_texture_state.h"
+#include "gfx/gfx_texture_view.h"
 
 struct WGPURenderPassEncoderImpl {};
 
 namespace vkgfx {
 
 // https://gpuweb.github.io/gpuweb/#gpurenderpassencoder
+// Pass contents are recorded into secondary command buffers continuing the
+// render pass, allocated from the pool of the recording thread on the first
+// command. Split hands out child encoders, each recording on its own thread;
+// End on the pass then begins the render pass in the primary command buffer
+// and executes the commands recorded on the pass itself followed by the
+// children in order. Usages are collected per encoder and only applied to
+// the trackers of the command encoder on End, since no barrier can be
+// recorded inside the render pass.
 class GFXRenderPassEncoder : public RefCounted<GFXRenderPassEncoder>,
                              public WGPURenderPassEncoderImpl {
  public:
-  GFXRenderPassEncoder();
+  // Render pass and framebuffer the pass and its children record for
+  struct Target {
+    VkRenderPass render_pass = VK_NULL_HANDLE;
+    VkFramebuffer framebuffer = VK_NULL_HANDLE;
+    VkExtent2D extent = {};
+  };
+
+  // Begins the pass |descriptor| describes on |encoder|.
+  GFXRenderPassEncoder(RefPtr<GFXCommandEncoder> encoder,
+                       const WGPURenderPassDescriptor& descriptor,
+                       const Target& target);
+  // Child encoder of a split pass.
+  GFXRenderPassEncoder(RefPtr<GFXCommandEncoder> encoder,
+                       const Target& target,
+                       const std::string& label);
   ~GFXRenderPassEncoder();
 
   GFXRenderPassEncoder(const GFXRenderPassEncoder&) = delete;
@@ -64,7 +96,80 @@ class GFXRenderPassEncoder : public RefCounted<GFXRenderPassEncoder>,
                    float minDepth,
                    float maxDepth);
 
+  // Extension: fills |children| with |count| encoders recording the rest of
+  // the pass, executed in order after the commands recorded on the pass so
+  // far. Children start from the default pass state, may be recorded on any
+  // thread and must all end before the pass does; the pass itself records
+  // nothing after splitting.
+  void Split(size_t count, WGPURenderPassEncoder* children);
+
  private:
+  // Vertex, instance, first vertex and first instance
+  static constexpr uint64_t kDrawIndirectSize = 4 * sizeof(uint32_t);
+  // Index, instance, first index, base vertex and first instance
+  static constexpr uint64_t kDrawIndexedIndirectSize = 5 * sizeof(uint32_t);
+
+  struct BindGroupState {
+    RefPtr<GFXBindGroup> group;
+    std::vector<uint32_t> dynamic_offsets;
+    bool dirty = false;
+    // Resources already collected with the current offsets
+    bool tracked = false;
+  };
+
+  struct BufferUse {
+    RefPtr<GFXBuffer> buffer;
+    uint64_t offset;
+    uint64_t size;
+    BufferAccess access;
+  };
+
+  struct TextureUse {
+    RefPtr<GFXTextureView> view;
+    ImageAccess access;
+  };
+
+  struct Attachment {
+    RefPtr<GFXTextureView> view;
+    ImageAccess access;
+  };
+
+  // Returns the secondary command buffer of the encoder, null with a
+  // validation error once it ended or split.
+  VkCommandBuffer GetCommandBuffer(const char* function);
+  void UseBuffer(GFXBuffer* buffer,
+                 uint64_t offset,
+                 uint64_t size,
+                 const BufferAccess& access);
+  void UseTexture(GFXTextureView* view, const ImageAccess& access);
+  // Collects the buffers and textures the draw uses, then binds the
+  // descriptor sets changed since the last draw.
+  VkCommandBuffer PrepareDraw(const char* function,
+                              GFXBuffer* indirect_buffer,
+                              uint64_t indirect_offset,
+                              uint64_t indirect_size);
+
+  RefPtr<GFXCommandEncoder> encoder_;
+  Target target_;
+  bool is_child_;
+  // Secondary command buffer, handed to the command encoder on End
+  GFXCommandAllocator::Allocation allocation_;
+  RefPtr<GFXRenderPipeline> pipeline_;
+  // Indexed by group, grown by SetBindGroup
+  std::vector<BindGroupState> bind_groups_;
+  // Every group bound, handed to the command encoder on End
+  std::vector<RefPtr<GFXBindGroup>> bound_groups_;
+  // Every pipeline set, handed to the command encoder on End
+  std::vector<RefPtr<GFXRenderPipeline>> bound_pipelines_;
+  std::vector<BufferUse> buffer_uses_;
+  std::vector<TextureUse> texture_uses_;
+  bool ended_ = false;
+
+  // Pass only, in attachment order
+  std::vector<Attachment> attachments_;
+  std::vector<VkClearValue> clear_values_;
+  std::vector<RefPtr<GFXRenderPassEncoder>> children_;
+
   std::string label_;
 };
 
@@ -4,17 +4,410 @@
 
 #include "gfx/gfx_render_pipeline.h"
 
+#include <array>
+
+#include "gfx/gfx_pipeline_cache.h"
+#include "gfx/gfx_render_pass_cache.h"
+#include "gfx/gfx_utils.h"
+
 namespace vkgfx {
 
+namespace {
+
+VkStencilOpState ToVulkanStencilFace(const WGPUStencilFaceState& face,
+                                     uint32_t read_mask,
+                                     uint32_t write_mask) {
+  VkStencilOpState state = {};
+  state.failOp = ToVulkanStencilOp(face.failOp);
+  state.passOp = ToVulkanStencilOp(face.passOp);
+  state.depthFailOp = ToVulkanStencilOp(face.depthFailOp);
+  state.compareOp = face.compare == WGPUCompareFunction_Undefined
+                        ? VK_COMPARE_OP_ALWAYS
+                        : ToVulkanCompareOp(face.compare);
+  state.compareMask = read_mask;
+  state.writeMask = write_mask;
+  // Dynamic state
+  state.reference = 0;
+  return state;
+}
+
+}  // namespace
+
 ///////////////////////////////////////////////////////////////////////////////
 // GFXRenderPipeline Implement
 
-GFXRenderPipeline::GFXRenderPipeline() {}
+// static
+bool GFXRenderPipeline::CaptureCreateInfo(
+    const WGPURenderPipelineDescriptor* descriptor,
+    GFXDevice* device,
+    CreateInfo* create_info,
+    std::string* error) {
+  if (!descriptor->layout) {
+    *error = "Implicit pipeline layouts are not supported.";
+    return false;
+  }
+
+  if (!descriptor->vertex.module) {
+    *error = "Missing vertex shader module.";
+    return false;
+  }
+
+  if (descriptor->vertex.constantCount ||
+      (descriptor->fragment && descriptor->fragment->constantCount)) {
+    *error = "Pipeline overridable constants are not supported.";
+    return false;
+  }
+
+  create_info->layout = static_cast<GFXPipelineLayout*>(descriptor->layout);
+  create_info->label = FromWGPUStringView(descriptor->label);
+
+  // Vertex state
+  const auto& vertex = descriptor->vertex;
+  create_info->vertex_module = static_cast<GFXShaderModule*>(vertex.module);
+  create_info->vertex_entry_point = FromWGPUStringView(vertex.entryPoint);
+  if (!create_info->vertex_module->ResolveEntryPoint(
+          VK_SHADER_STAGE_VERTEX_BIT, &create_info->vertex_entry_point)) {
+    *error = "Invalid vertex entry point.";
+    return false;
+  }
+
+  for (size_t i = 0; i < vertex.bufferCount; ++i) {
+    const auto& buffer = vertex.buffers[i];
+    if (buffer.stepMode == WGPUVertexStepMode_VertexBufferNotUsed)
+      continue;
+
+    VkVertexInputBindingDescription binding = {};
+    binding.binding = i;
+    binding.stride = buffer.arrayStride;
+    binding.inputRate = buffer.stepMode == WGPUVertexStepMode_Instance
+                            ? VK_VERTEX_INPUT_RATE_INSTANCE
+                            : VK_VERTEX_INPUT_RATE_VERTEX;
+    create_info->vertex_bindings.push_back(binding);
+
+    for (size_t j = 0; j < buffer.attributeCount; ++j) {
+      const auto& attribute = buffer.attributes[j];
+
+      VkVertexInputAttributeDescription vk_attribute = {};
+      vk_attribute.location = attribute.shaderLocation;
+      vk_attribute.binding = i;
+      vk_attribute.format = ToVulkanVertexFormat(attribute.format);
+      vk_attribute.offset = attribute.offset;
+      create_info->vertex_attributes.push_back(vk_attribute);
+    }
+  }
+
+  // Primitive state
+  const auto& primitive = descriptor->primitive;
+  create_info->topology = ToVulkanPrimitiveTopology(primitive.topology);
+  create_info->primitive_restart =
+      create_info->topology == VK_PRIMITIVE_TOPOLOGY_LINE_STRIP ||
+      create_info->topology == VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP;
+  create_info->depth_clamp =
+      primitive.unclippedDepth &&
+      device->GetAdapter()->GetDeviceInfo().features.features.depthClamp;
+  create_info->cull_mode = ToVulkanCullMode(primitive.cullMode);
+  create_info->front_face = ToVulkanFrontFace(primitive.frontFace);
+
+  // Multisample state, a zeroed struct means defaults
+  const auto& multisample = descriptor->multisample;
+  if (multisample.count) {
+    create_info->sample_count = ToVulkanSampleCount(multisample.count);
+    create_info->sample_mask = multisample.mask;
+    create_info->alpha_to_coverage = multisample.alphaToCoverageEnabled;
+  }
+
+  // Depth stencil state
+  if (const auto* depth_stencil = descriptor->depthStencil) {
+    create_info->depth_stencil_format =
+        ToVulkanPixelFormat(depth_stencil->format);
+    create_info->depth_write =
+        depth_stencil->depthWriteEnabled == WGPUOptionalBool_True;
+    create_info->depth_compare =
+        depth_stencil->depthCompare == WGPUCompareFunction_Undefined
+            ? VK_COMPARE_OP_ALWAYS
+            : ToVulkanCompareOp(depth_stencil->depthCompare);
+    create_info->depth_test =
+        create_info->depth_write ||
+        create_info->depth_compare != VK_COMPARE_OP_ALWAYS;
+
+    create_info->stencil_front = ToVulkanStencilFace(
+        depth_stencil->stencilFront, depth_stencil->stencilReadMask,
+        depth_stencil->stencilWriteMask);
+    create_info->stencil_back = ToVulkanStencilFace(
+        depth_stencil->stencilBack, depth_stencil->stencilReadMask,
+        depth_stencil->stencilWriteMask);
+    create_info->stencil_test =
+        !!(ToVulkanImageAspect(WGPUTextureAspect_All, depth_stencil->format) &
+           VK_IMAGE_ASPECT_STENCIL_BIT);
+
+    create_info->depth_bias = depth_stencil->depthBias;
+    create_info->depth_bias_slope_scale = depth_stencil->depthBiasSlopeScale;
+    create_info->depth_bias_clamp = depth_stencil->depthBiasClamp;
+  }
+
+  // Fragment state
+  if (const auto* fragment = descriptor->fragment) {
+    if (!fragment->module) {
+      *error = "Missing fragment shader module.";
+      return false;
+    }
+
+    create_info->fragment_module =
+        static_cast<GFXShaderModule*>(fragment->module);
+    create_info->fragment_entry_point =
+        FromWGPUStringView(fragment->entryPoint);
+    if (!create_info->fragment_module->ResolveEntryPoint(
+            VK_SHADER_STAGE_FRAGMENT_BIT,
+            &create_info->fragment_entry_point)) {
+      *error = "Invalid fragment entry point.";
+      return false;
+    }
+
+    if (fragment->targetCount > GFXRenderPassCache::kMaxColorAttachments) {
+      *error = "Too many color targets.";
+      return false;
+    }
+
+    for (size_t i = 0; i < fragment->targetCount; ++i) {
+      const auto& target = fragment->targets[i];
+      create_info->color_formats.push_back(ToVulkanPixelFormat(target.format));
+
+      VkPipelineColorBlendAttachmentState blend_state = {};
+      blend_state.colorWriteMask = ToVulkanColorWriteMask(target.writeMask);
+      if (target.blend) {
+        const auto& color = target.blend->color;
+        const auto& alpha = target.blend->alpha;
+        blend_state.blendEnable = VK_TRUE;
+        blend_state.srcColorBlendFactor = ToVulkanBlendFactor(color.srcFactor);
+        blend_state.dstColorBlendFactor =
+            color.dstFactor == WGPUBlendFactor_Undefined
+                ? VK_BLEND_FACTOR_ZERO
+                : ToVulkanBlendFactor(color.dstFactor);
+        blend_state.colorBlendOp = ToVulkanBlendOp(color.operation);
+        blend_state.srcAlphaBlendFactor = ToVulkanBlendFactor(alpha.srcFactor);
+        blend_state.dstAlphaBlendFactor =
+            alpha.dstFactor == WGPUBlendFactor_Undefined
+                ? VK_BLEND_FACTOR_ZERO
+                : ToVulkanBlendFactor(alpha.dstFactor);
+        blend_state.alphaBlendOp = ToVulkanBlendOp(alpha.operation);
+      }
+      create_info->color_blends.push_back(blend_state);
+    }
+  }
+
+  // Layouts and shader handles are interned and identify content, the
+  // Vulkan description structs below are made of 32-bit fields only.
+  VkShaderModule fragment_shader = VK_NULL_HANDLE;
+  if (create_info->fragment_module)
+    fragment_shader = create_info->fragment_module->GetVkHandle();
 
-GFXRenderPipeline::~GFXRenderPipeline() {}
+  std::string& key = create_info->key;
+  AppendKey(&key, static_cast<const void*>(create_info->layout.get()));
+  AppendKey(&key, create_info->vertex_module->GetVkHandle());
+  AppendKey(&key, std::string_view(create_info->vertex_entry_point));
+  AppendKey(&key, fragment_shader);
+  AppendKey(&key, std::string_view(create_info->fragment_entry_point));
+  AppendKey(&key, create_info->vertex_bindings.size());
+  for (const auto& it : create_info->vertex_bindings)
+    AppendKey(&key, it);
+  AppendKey(&key, create_info->vertex_attributes.size());
+  for (const auto& it : create_info->vertex_attributes)
+    AppendKey(&key, it);
+  AppendKey(&key, create_info->topology);
+  AppendKey(&key, create_info->primitive_restart);
+  AppendKey(&key, create_info->depth_clamp);
+  AppendKey(&key, create_info->cull_mode);
+  AppendKey(&key, create_info->front_face);
+  AppendKey(&key, create_info->depth_bias);
+  AppendKey(&key, create_info->depth_bias_slope_scale);
+  AppendKey(&key, create_info->depth_bias_clamp);
+  AppendKey(&key, create_info->sample_count);
+  AppendKey(&key, create_info->sample_mask);
+  AppendKey(&key, create_info->alpha_to_coverage);
+  AppendKey(&key, create_info->depth_test);
+  AppendKey(&key, create_info->depth_write);
+  AppendKey(&key, create_info->depth_compare);
+  AppendKey(&key, create_info->stencil_test);
+  AppendKey(&key, create_info->stencil_front);
+  AppendKey(&key, create_info->stencil_back);
+  AppendKey(&key, create_info->color_formats.size());
+  for (const auto& it : create_info->color_formats)
+    AppendKey(&key, it);
+  for (const auto& it : create_info->color_blends)
+    AppendKey(&key, it);
+  AppendKey(&key, create_info->depth_stencil_format);
+
+  return true;
+}
+
+// static
+GFXRenderPipeline* GFXRenderPipeline::Create(RefPtr<GFXDevice> device,
+                                             const CreateInfo& create_info,
+                                             std::string* error) {
+  VkDevice vk_device = device->GetVkHandle();
+
+  // Load/store ops and layouts do not affect render pass compatibility
+  GFXRenderPassCache::RenderPassKey render_pass_key;
+  render_pass_key.color_count = create_info.color_formats.size();
+  for (size_t i = 0; i < create_info.color_formats.size(); ++i) {
+    render_pass_key.color_formats[i] = create_info.color_formats[i];
+    render_pass_key.color_load_ops[i] = VK_ATTACHMENT_LOAD_OP_LOAD;
+    render_pass_key.color_store_ops[i] = VK_ATTACHMENT_STORE_OP_STORE;
+  }
+  render_pass_key.depth_stencil_format = create_info.depth_stencil_format;
+  render_pass_key.sample_count = create_info.sample_count;
+
+  VkRenderPass render_pass =
+      device->GetRenderPassCache()->GetRenderPass(render_pass_key);
+  if (!render_pass) {
+    *error = "Failed to create compatible render pass.";
+    return nullptr;
+  }
+
+  // Shader stages
+  std::array<VkPipelineShaderStageCreateInfo, 2> stages = {};
+  uint32_t stage_count = 0;
+  stages[stage_count].sType =
+      VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+  stages[stage_count].stage = VK_SHADER_STAGE_VERTEX_BIT;
+  stages[stage_count].module = create_info.vertex_module->GetVkHandle();
+  stages[stage_count].pName = create_info.vertex_entry_point.c_str();
+  ++stage_count;
+  if (create_info.fragment_module) {
+    stages[stage_count].sType =
+        VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    stages[stage_count].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+    stages[stage_count].module = create_info.fragment_module->GetVkHandle();
+    stages[stage_count].pName = create_info.fragment_entry_point.c_str();
+    ++stage_count;
+  }
+
+  VkPipelineVertexInputStateCreateInfo vertex_input = {
+      VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO};
+  vertex_input.vertexBindingDescriptionCount =
+      create_info.vertex_bindings.size();
+  vertex_input.pVertexBindingDescriptions =
+      create_info.vertex_bindings.data();
+  vertex_input.vertexAttributeDescriptionCount =
+      create_info.vertex_attributes.size();
+  vertex_input.pVertexAttributeDescriptions =
+      create_info.vertex_attributes.data();
+
+  VkPipelineInputAssemblyStateCreateInfo input_assembly = {
+      VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO};
+  input_assembly.topology = create_info.topology;
+  input_assembly.primitiveRestartEnable = create_info.primitive_restart;
+
+  // Viewport and scissor are dynamic
+  VkPipelineViewportStateCreateInfo viewport = {
+      VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO};
+  viewport.viewportCount = 1;
+  viewport.scissorCount = 1;
+
+  VkPipelineRasterizationStateCreateInfo rasterization = {
+      VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO};
+  rasterization.depthClampEnable = create_info.depth_clamp;
+  rasterization.polygonMode = VK_POLYGON_MODE_FILL;
+  rasterization.cullMode = create_info.cull_mode;
+  rasterization.frontFace = create_info.front_face;
+  rasterization.depthBiasEnable =
+      create_info.depth_bias != 0.0f ||
+      create_info.depth_bias_slope_scale != 0.0f;
+  rasterization.depthBiasConstantFactor = create_info.depth_bias;
+  rasterization.depthBiasSlopeFactor = create_info.depth_bias_slope_scale;
+  rasterization.depthBiasClamp = create_info.depth_bias_clamp;
+  rasterization.lineWidth = 1.0f;
+
+  VkPipelineMultisampleStateCreateInfo multisample = {
+      VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO};
+  multisample.rasterizationSamples = create_info.sample_count;
+  multisample.pSampleMask = &create_info.sample_mask;
+  multisample.alphaToCoverageEnable = create_info.alpha_to_coverage;
+
+  VkPipelineDepthStencilStateCreateInfo depth_stencil = {
+      VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO};
+  depth_stencil.depthTestEnable = create_info.depth_test;
+  depth_stencil.depthWriteEnable = create_info.depth_write;
+  depth_stencil.depthCompareOp = create_info.depth_compare;
+  depth_stencil.stencilTestEnable = create_info.stencil_test;
+  depth_stencil.front = create_info.stencil_front;
+  depth_stencil.back = create_info.stencil_back;
+
+  VkPipelineColorBlendStateCreateInfo color_blend = {
+      VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO};
+  color_blend.attachmentCount = create_info.color_blends.size();
+  color_blend.pAttachments = create_info.color_blends.data();
+
+  static constexpr std::array<VkDynamicState, 4> kDynamicStates = {
+      VK_DYNAMIC_STATE_VIEWPORT,
+      VK_DYNAMIC_STATE_SCISSOR,
+      VK_DYNAMIC_STATE_BLEND_CONSTANTS,
+      VK_DYNAMIC_STATE_STENCIL_REFERENCE,
+  };
+
+  VkPipelineDynamicStateCreateInfo dynamic_state = {
+      VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO};
+  dynamic_state.dynamicStateCount = kDynamicStates.size();
+  dynamic_state.pDynamicStates = kDynamicStates.data();
+
+  VkGraphicsPipelineCreateInfo pipeline_info = {
+      VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO};
+  pipeline_info.stageCount = stage_count;
+  pipeline_info.pStages = stages.data();
+  pipeline_info.pVertexInputState = &vertex_input;
+  pipeline_info.pInputAssemblyState = &input_assembly;
+  pipeline_info.pViewportState = &viewport;
+  pipeline_info.pRasterizationState = &rasterization;
+  pipeline_info.pMultisampleState = &multisample;
+  pipeline_info.pDepthStencilState = &depth_stencil;
+  pipeline_info.pColorBlendState = &color_blend;
+  pipeline_info.pDynamicState = &dynamic_state;
+  pipeline_info.layout = create_info.layout->GetVkHandle();
+  pipeline_info.renderPass = render_pass;
+  pipeline_info.subpass = 0;
+
+  VkPipelineCache pipeline_cache = VK_NULL_HANDLE;
+  if (device->GetPipelineCache())
+    pipeline_cache = device->GetPipelineCache()->AcquireCache();
+
+  VkPipeline pipeline = VK_NULL_HANDLE;
+  VkResult result = vkCreateGraphicsPipelines(
+      vk_device, pipeline_cache, 1, &pipeline_info, nullptr, &pipeline);
+  if (pipeline_cache)
+    device->GetPipelineCache()->ReleaseCache(pipeline_cache);
+  if (result != VK_SUCCESS) {
+    *error = "Failed to create render pipeline.";
+    return nullptr;
+  }
+
+  return AdaptExternalRefCounted(new GFXRenderPipeline(
+      pipeline, create_info.layout, device, create_info.label));
+}
+
+GFXRenderPipeline::GFXRenderPipeline(VkPipeline pipeline,
+                                     RefPtr<GFXPipelineLayout> layout,
+                                     RefPtr<GFXDevice> device,
+                                     const std::string& label)
+    : pipeline_(pipeline),
+      layout_(layout),
+      device_(device) {
+  if (!label.empty())
+    label_ = label;
+}
+
+GFXRenderPipeline::~GFXRenderPipeline() {
+  if (!pipeline_ || !device_)
+    return;
+
+  // Command buffers binding it may still execute
+  if (auto* tracker = device_->GetResourceTracker())
+    tracker->ReleasePipeline(pipeline_, last_usage_serial_);
+  else
+    vkDestroyPipeline(device_->GetVkHandle(), pipeline_, nullptr);
+}
 
 WGPUBindGroupLayout GFXRenderPipeline::GetBindGroupLayout(uint32_t groupIndex) {
-  return WGPUBindGroupLayout();
+  return AdaptExternalRefCounted(layout_->GetBindGroupLayout(groupIndex));
 }
 
 void GFXRenderPipeline::SetLabel(WGPUStringView label) {
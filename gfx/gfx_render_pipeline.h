@@ -5,8 +5,15 @@
 #ifndef GFX_GFX_PIPELINE_H_
 #define GFX_GFX_PIPELINE_H_
 
+#include <atomic>
+#include <string>
+#include <vector>
+
 #include "gfx/common/refptr.h"
 #include "gfx/gfx_config.h"
+#include "gfx/gfx_device.h"
+#include "gfx/gfx_pipeline_layout.h"
+#include "gfx/gfx_shader_module.h"
 
 struct WGPURenderPipelineImpl {};
 
@@ -16,17 +23,86 @@ namespace vkgfx {
 class GFXRenderPipeline : public RefCounted<GFXRenderPipeline>,
                           public WGPURenderPipelineImpl {
  public:
-  GFXRenderPipeline();
+  // Self contained copy of a descriptor in Vulkan terms, compiled on any
+  // thread.
+  struct CreateInfo {
+    RefPtr<GFXPipelineLayout> layout;
+
+    RefPtr<GFXShaderModule> vertex_module;
+    std::string vertex_entry_point;
+    RefPtr<GFXShaderModule> fragment_module;
+    std::string fragment_entry_point;
+
+    std::vector<VkVertexInputBindingDescription> vertex_bindings;
+    std::vector<VkVertexInputAttributeDescription> vertex_attributes;
+
+    VkPrimitiveTopology topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+    VkBool32 primitive_restart = VK_FALSE;
+    VkBool32 depth_clamp = VK_FALSE;
+    VkCullModeFlags cull_mode = VK_CULL_MODE_NONE;
+    VkFrontFace front_face = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+    float depth_bias = 0.0f;
+    float depth_bias_slope_scale = 0.0f;
+    float depth_bias_clamp = 0.0f;
+
+    VkSampleCountFlagBits sample_count = VK_SAMPLE_COUNT_1_BIT;
+    VkSampleMask sample_mask = ~0u;
+    VkBool32 alpha_to_coverage = VK_FALSE;
+
+    VkBool32 depth_test = VK_FALSE;
+    VkBool32 depth_write = VK_FALSE;
+    VkCompareOp depth_compare = VK_COMPARE_OP_ALWAYS;
+    VkBool32 stencil_test = VK_FALSE;
+    VkStencilOpState stencil_front = {};
+    VkStencilOpState stencil_back = {};
+
+    // Unused color targets have VK_FORMAT_UNDEFINED
+    std::vector<VkFormat> color_formats;
+    std::vector<VkPipelineColorBlendAttachmentState> color_blends;
+    VkFormat depth_stencil_format = VK_FORMAT_UNDEFINED;
+
+    std::string label;
+    // Identity of the descriptor, merges identical async requests
+    std::string key;
+  };
+
+  static bool CaptureCreateInfo(const WGPURenderPipelineDescriptor* descriptor,
+                                GFXDevice* device,
+                                CreateInfo* create_info,
+                                std::string* error);
+  // Returns a pipeline holding one reference, or null with |error|.
+  static GFXRenderPipeline* Create(RefPtr<GFXDevice> device,
+                                   const CreateInfo& create_info,
+                                   std::string* error);
+
+  GFXRenderPipeline(VkPipeline pipeline,
+                    RefPtr<GFXPipelineLayout> layout,
+                    RefPtr<GFXDevice> device,
+                    const std::string& label);
   ~GFXRenderPipeline();
 
   GFXRenderPipeline(const GFXRenderPipeline&) = delete;
   GFXRenderPipeline& operator=(const GFXRenderPipeline&) = delete;
 
+  VkPipeline GetVkPipeline() const { return pipeline_; }
+  GFXPipelineLayout* GetLayout() const { return layout_.get(); }
+
+  // Serial of the last submission binding the pipeline, it is destroyed
+  // once that completed.
+  uint64_t GetLastUsageSerial() const { return last_usage_serial_; }
+  void SetLastUsageSerial(uint64_t serial) { last_usage_serial_ = serial; }
+
   WGPUBindGroupLayout GetBindGroupLayout(uint32_t groupIndex);
   void SetLabel(WGPUStringView label);
 
  private:
-  std::string label_;
+  VkPipeline pipeline_;
+  RefPtr<GFXPipelineLayout> layout_;
+  std::atomic<uint64_t> last_usage_serial_ = 0;
+
+  RefPtr<GFXDevice> device_;
+
+  std::string label_ = "GFX.RenderPipeline";
 };
 
 }  // namespace vkgfx
@@ -4,4 +4,155 @@
 
 #include "gfx/gfx_resource_track.h"
 
-namespace vkgfx {}
+#include <algorithm>
+
+#include "gfx/gfx_bind_group_layout.h"
+#include "gfx/gfx_sampler_cache.h"
+
+namespace vkgfx {
+
+///////////////////////////////////////////////////////////////////////////////
+// GFXResourceTracker Implement
+
+GFXResourceTracker::GFXResourceTracker(VkDevice device,
+                                       VmaAllocator allocator)
+    : device_(device), allocator_(allocator) {}
+
+GFXResourceTracker::~GFXResourceTracker() {
+  for (const auto& it : pending_objects_)
+    DestroyInternal(it.second);
+}
+
+void GFXResourceTracker::ReleaseBuffer(VkBuffer buffer,
+                                       VmaAllocation allocation,
+                                       uint64_t serial) {
+  Object object = {ObjectType::kBuffer};
+  object.buffer = buffer;
+  object.allocation = allocation;
+  ReleaseInternal(std::move(object), serial);
+}
+
+void GFXResourceTracker::ReleaseImage(VkImage image,
+                                      VmaAllocation allocation,
+                                      uint64_t serial) {
+  Object object = {ObjectType::kImage};
+  object.image = image;
+  object.allocation = allocation;
+  ReleaseInternal(std::move(object), serial);
+}
+
+void GFXResourceTracker::ReleaseImageView(VkImageView view, uint64_t serial) {
+  Object object = {ObjectType::kImageView};
+  object.view = view;
+  ReleaseInternal(std::move(object), serial);
+}
+
+void GFXResourceTracker::ReleaseSuballocation(
+    GFXBufferSuballocator* suballocator,
+    const GFXBufferSuballocator::Allocation& allocation,
+    uint64_t serial) {
+  Object object = {ObjectType::kSuballocation};
+  object.suballocator = suballocator;
+  object.suballocation = allocation;
+  ReleaseInternal(std::move(object), serial);
+}
+
+void GFXResourceTracker::ReleaseDescriptorSet(
+    GFXDescriptorAllocator* descriptor_allocator,
+    GFXBindGroupLayout* layout,
+    const GFXDescriptorAllocator::Allocation& allocation,
+    uint64_t serial) {
+  Object object = {ObjectType::kDescriptorSet};
+  object.descriptor_allocator = descriptor_allocator;
+  object.layout = layout;
+  object.descriptor_set = allocation;
+  ReleaseInternal(std::move(object), serial);
+}
+
+void GFXResourceTracker::ReleaseSampler(GFXSamplerCache* sampler_cache,
+                                        VkSampler sampler,
+                                        uint64_t serial) {
+  Object object = {ObjectType::kSampler};
+  object.sampler_cache = sampler_cache;
+  object.sampler = sampler;
+  ReleaseInternal(std::move(object), serial);
+}
+
+void GFXResourceTracker::ReleaseFramebuffer(VkFramebuffer framebuffer,
+                                            uint64_t serial) {
+  Object object = {ObjectType::kFramebuffer};
+  object.framebuffer = framebuffer;
+  ReleaseInternal(std::move(object), serial);
+}
+
+void GFXResourceTracker::ReleasePipeline(VkPipeline pipeline,
+                                         uint64_t serial) {
+  Object object = {ObjectType::kPipeline};
+  object.pipeline = pipeline;
+  ReleaseInternal(std::move(object), serial);
+}
+
+void GFXResourceTracker::Tick(uint64_t completed_serial) {
+  std::vector<Object> objects;
+  {
+    std::lock_guard guard(lock_);
+    completed_serial_ = std::max(completed_serial_, completed_serial);
+
+    auto ready_end = pending_objects_.upper_bound(completed_serial_);
+    for (auto it = pending_objects_.begin(); it != ready_end; ++it)
+      objects.push_back(std::move(it->second));
+    pending_objects_.erase(pending_objects_.begin(), ready_end);
+  }
+
+  for (const auto& object : objects)
+    DestroyInternal(object);
+}
+
+size_t GFXResourceTracker::GetPendingCount() {
+  std::lock_guard guard(lock_);
+  return pending_objects_.size();
+}
+
+void GFXResourceTracker::ReleaseInternal(Object&& object, uint64_t serial) {
+  {
+    std::lock_guard guard(lock_);
+    if (serial > completed_serial_) {
+      pending_objects_.emplace(serial, std::move(object));
+      return;
+    }
+  }
+
+  DestroyInternal(object);
+}
+
+void GFXResourceTracker::DestroyInternal(const Object& object) {
+  switch (object.type) {
+    case ObjectType::kBuffer:
+      vmaDestroyBuffer(allocator_, object.buffer, object.allocation);
+      break;
+    case ObjectType::kImage:
+      vmaDestroyImage(allocator_, object.image, object.allocation);
+      break;
+    case ObjectType::kImageView:
+      vkDestroyImageView(device_, object.view, nullptr);
+      break;
+    case ObjectType::kSuballocation:
+      object.suballocator->Free(object.suballocation);
+      break;
+    case ObjectType::kDescriptorSet:
+      object.descriptor_allocator->Free(object.layout.get(),
+                                        object.descriptor_set);
+      break;
+    case ObjectType::kSampler:
+      object.sampler_cache->DestroySampler(object.sampler);
+      break;
+    case ObjectType::kFramebuffer:
+      vkDestroyFramebuffer(device_, object.framebuffer, nullptr);
+      break;
+    case ObjectType::kPipeline:
+      vkDestroyPipeline(device_, object.pipeline, nullptr);
+      break;
+  }
+}
+
+}  // namespace vkgfx
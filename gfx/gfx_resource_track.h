@@ -5,10 +5,103 @@
 #ifndef GFX_GFX_RESOURCE_TRACK_H_
 #define GFX_GFX_RESOURCE_TRACK_H_
 
+#include <map>
+#include <mutex>
+#include <vector>
+
+#include "gfx/common/refptr.h"
+#include "gfx/gfx_buffer_suballocator.h"
+#include "gfx/gfx_config.h"
+#include "gfx/gfx_descriptor_allocator.h"
+
+#include "vma/vma.h"
+
 namespace vkgfx {
 
+class GFXBindGroupLayout;
+class GFXSamplerCache;
+
+// Device level deferred destruction of Vulkan objects.
+// A released object is tagged with the serial of the last submission using
+// it and destroyed once that serial completed, in batches from Tick which the
+// queue calls on Submit and ProcessEvents. Objects whose serial already
+// completed are destroyed right away.
+class GFXResourceTracker {
+ public:
+  GFXResourceTracker(VkDevice device, VmaAllocator allocator);
+  // Destroys everything still tracked, the device must be idle.
+  ~GFXResourceTracker();
+
+  GFXResourceTracker(const GFXResourceTracker&) = delete;
+  GFXResourceTracker& operator=(const GFXResourceTracker&) = delete;
+
+  void ReleaseBuffer(VkBuffer buffer,
+                     VmaAllocation allocation,
+                     uint64_t serial);
+  void ReleaseImage(VkImage image, VmaAllocation allocation, uint64_t serial);
+  void ReleaseImageView(VkImageView view, uint64_t serial);
+  void ReleaseSuballocation(GFXBufferSuballocator* suballocator,
+                            const GFXBufferSuballocator::Allocation& allocation,
+                            uint64_t serial);
+  // The set goes back to the free list of |descriptor_allocator|, |layout|
+  // is kept alive until then.
+  void ReleaseDescriptorSet(
+      GFXDescriptorAllocator* descriptor_allocator,
+      GFXBindGroupLayout* layout,
+      const GFXDescriptorAllocator::Allocation& allocation,
+      uint64_t serial);
+  // Destroyed through |sampler_cache|, which counts it until then.
+  void ReleaseSampler(GFXSamplerCache* sampler_cache,
+                      VkSampler sampler,
+                      uint64_t serial);
+  void ReleaseFramebuffer(VkFramebuffer framebuffer, uint64_t serial);
+  void ReleasePipeline(VkPipeline pipeline, uint64_t serial);
+
+  // Destroys every object released with a serial up to |completed_serial|.
+  void Tick(uint64_t completed_serial);
+
+  size_t GetPendingCount();
+
+ private:
+  enum class ObjectType {
+    kBuffer,
+    kImage,
+    kImageView,
+    kSuballocation,
+    kDescriptorSet,
+    kSampler,
+    kFramebuffer,
+    kPipeline,
+  };
+
+  struct Object {
+    ObjectType type;
+    VkBuffer buffer = VK_NULL_HANDLE;
+    VkImage image = VK_NULL_HANDLE;
+    VkImageView view = VK_NULL_HANDLE;
+    VmaAllocation allocation = VK_NULL_HANDLE;
+    GFXBufferSuballocator* suballocator = nullptr;
+    GFXBufferSuballocator::Allocation suballocation;
+    GFXDescriptorAllocator* descriptor_allocator = nullptr;
+    RefPtr<GFXBindGroupLayout> layout;
+    GFXDescriptorAllocator::Allocation descriptor_set;
+    GFXSamplerCache* sampler_cache = nullptr;
+    VkSampler sampler = VK_NULL_HANDLE;
+    VkFramebuffer framebuffer = VK_NULL_HANDLE;
+    VkPipeline pipeline = VK_NULL_HANDLE;
+  };
+
+  void ReleaseInternal(Object&& object, uint64_t serial);
+  void DestroyInternal(const Object& object);
+
+  VkDevice device_;
+  VmaAllocator allocator_;
 
+  std::mutex lock_;
+  uint64_t completed_serial_ = 0;
+  std::multimap<uint64_t, Object> pending_objects_;
+};
 
-}
+}  // namespace vkgfx
 
-#endif // GFX_GFX_RESOURCE_TRACK_H_
+#endif  // GFX_GFX_RESOURCE_TRACK_H_
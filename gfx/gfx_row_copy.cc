@@ -0,0 +1,245 @@
+// Copyright 2025 Admenri.
+// Use of this source code is governed by a MIT-style license that can be
+// found in the LICENSE file.
+
+#include "gfx/gfx_row_copy.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <memory>
+#include <mutex>
+
+#include "gfx/gfx_worker_pool.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define GFX_ROW_COPY_SSE2 1
+#include <emmintrin.h>
+#endif
+
+// AVX2 is compiled in for every x86 build and picked at runtime, the rest of
+// the file keeps the baseline instruction set.
+#if defined(GFX_ROW_COPY_SSE2) && \
+    (defined(_MSC_VER) || defined(__GNUC__) || defined(__clang__))
+#define GFX_ROW_COPY_AVX2 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+// MSVC emits any intrinsic regardless of the target architecture
+#define GFX_TARGET_AVX2
+#else
+#include <cpuid.h>
+#define GFX_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace vkgfx {
+
+namespace {
+
+// Rows handed out to a thread at a time
+constexpr size_t kBandSize = 1024 * 1024;
+
+using StreamRowFunction = void (*)(uint8_t* dst,
+                                   const uint8_t* src,
+                                   size_t size);
+
+void StreamRow(uint8_t* dst, const uint8_t* src, size_t size) {
+  size_t i = 0;
+
+#if defined(GFX_ROW_COPY_SSE2)
+  // Streaming stores need aligned destinations
+  if (reinterpret_cast<uintptr_t>(dst) & 15) {
+    std::memcpy(dst, src, size);
+    return;
+  }
+
+  for (; i + 16 <= size; i += 16)
+    _mm_stream_si128(
+        reinterpret_cast<__m128i*>(dst + i),
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)));
+#endif
+
+  if (i < size)
+    std::memcpy(dst + i, src + i, size - i);
+}
+
+#if defined(GFX_ROW_COPY_AVX2)
+GFX_TARGET_AVX2 void StreamRowAVX2(uint8_t* dst,
+                                   const uint8_t* src,
+                                   size_t size) {
+  size_t i = 0;
+
+  // Streaming stores need aligned destinations
+  if (reinterpret_cast<uintptr_t>(dst) & 15) {
+    std::memcpy(dst, src, size);
+    return;
+  }
+
+  if ((reinterpret_cast<uintptr_t>(dst) & 31) && size >= 16) {
+    _mm_stream_si128(reinterpret_cast<__m128i*>(dst),
+                     _mm_loadu_si128(reinterpret_cast<const __m128i*>(src)));
+    i = 16;
+  }
+
+  for (; i + 64 <= size; i += 64) {
+    __m256i v0 =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+    __m256i v1 =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i + 32));
+    _mm256_stream_si256(reinterpret_cast<__m256i*>(dst + i), v0);
+    _mm256_stream_si256(reinterpret_cast<__m256i*>(dst + i + 32), v1);
+  }
+
+  for (; i + 16 <= size; i += 16)
+    _mm_stream_si128(
+        reinterpret_cast<__m128i*>(dst + i),
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)));
+
+  if (i < size)
+    std::memcpy(dst + i, src + i, size - i);
+}
+
+// AVX2 needs the CPU to support it and the OS to save the YMM registers.
+bool HasAVX2() {
+  uint32_t regs[4] = {};
+#if defined(_MSC_VER) && !defined(__clang__)
+  int info[4];
+  __cpuid(info, 0);
+  if (info[0] < 7)
+    return false;
+  __cpuid(info, 1);
+  regs[2] = info[2];
+#else
+  if (__get_cpuid_max(0, nullptr) < 7)
+    return false;
+  __cpuid(1, regs[0], regs[1], regs[2], regs[3]);
+#endif
+
+  constexpr uint32_t kOSXSAVE = 1u << 27;
+  constexpr uint32_t kAVX = 1u << 28;
+  if ((regs[2] & (kOSXSAVE | kAVX)) != (kOSXSAVE | kAVX))
+    return false;
+
+  // XMM and YMM state enabled in XCR0
+#if defined(_MSC_VER) && !defined(__clang__)
+  const uint64_t xcr0 = _xgetbv(0);
+  __cpuidex(info, 7, 0);
+  regs[1] = info[1];
+#else
+  uint32_t xcr0_low, xcr0_high;
+  __asm__("xgetbv" : "=a"(xcr0_low), "=d"(xcr0_high) : "c"(0));
+  const uint64_t xcr0 = xcr0_low;
+  __cpuid_count(7, 0, regs[0], regs[1], regs[2], regs[3]);
+#endif
+  if ((xcr0 & 6) != 6)
+    return false;
+
+  constexpr uint32_t kAVX2 = 1u << 5;
+  return regs[1] & kAVX2;
+}
+#endif
+
+StreamRowFunction GetStreamRow() {
+#if defined(GFX_ROW_COPY_AVX2)
+  static const StreamRowFunction stream_row =
+      HasAVX2() ? StreamRowAVX2 : StreamRow;
+  return stream_row;
+#else
+  return StreamRow;
+#endif
+}
+
+void CopyRowRange(const RowCopyLayout& layout,
+                  size_t first_row,
+                  size_t row_count) {
+  StreamRowFunction stream_row = GetStreamRow();
+  for (size_t row = first_row; row < first_row + row_count; ++row) {
+    size_t image = row / layout.rows_per_image;
+    size_t image_row = row % layout.rows_per_image;
+    stream_row(layout.dst + image * layout.dst_image_pitch +
+                   image_row * layout.dst_row_pitch,
+               layout.src + image * layout.src_image_pitch +
+                   image_row * layout.src_row_pitch,
+               layout.row_bytes);
+  }
+
+#if defined(GFX_ROW_COPY_SSE2)
+  // Streaming stores are weakly ordered, publish them before returning
+  _mm_sfence();
+#endif
+}
+
+// Shared with the worker tasks, which may start after the copy finished
+struct ParallelCopy {
+  RowCopyLayout layout;
+  size_t total_rows = 0;
+  size_t rows_per_band = 0;
+  size_t band_count = 0;
+  std::atomic<size_t> next_band{0};
+
+  std::mutex lock;
+  std::condition_variable bands_done;
+  size_t done_band_count = 0;
+
+  void Run() {
+    size_t done = 0;
+    for (size_t band = next_band.fetch_add(1); band < band_count;
+         band = next_band.fetch_add(1)) {
+      size_t first_row = band * rows_per_band;
+      CopyRowRange(layout, first_row,
+                   std::min(rows_per_band, total_rows - first_row));
+      ++done;
+    }
+
+    if (!done)
+      return;
+
+    std::lock_guard guard(lock);
+    done_band_count += done;
+    if (done_band_count == band_count)
+      bands_done.notify_all();
+  }
+};
+
+}  // namespace
+
+void CopyRows(const RowCopyLayout& layout) {
+  CopyRowRange(layout, 0,
+               static_cast<size_t>(layout.rows_per_image) * layout.image_count);
+}
+
+void CopyRowsParallel(const RowCopyLayout& layout,
+                      GFXWorkerPool* worker_pool) {
+  size_t total_rows =
+      static_cast<size_t>(layout.rows_per_image) * layout.image_count;
+  if (!worker_pool || !layout.row_bytes ||
+      total_rows * layout.row_bytes <= kParallelCopyThreshold) {
+    CopyRows(layout);
+    return;
+  }
+
+  auto copy = std::make_shared<ParallelCopy>();
+  copy->layout = layout;
+  copy->total_rows = total_rows;
+  copy->rows_per_band = std::max<size_t>(kBandSize / layout.row_bytes, 1);
+  copy->band_count =
+      (total_rows + copy->rows_per_band - 1) / copy->rows_per_band;
+
+  // The calling thread takes bands too, so a busy pool only slows it down
+  size_t task_count = std::min<size_t>(worker_pool->GetThreadCount(),
+                                       copy->band_count - 1);
+  for (size_t i = 0; i < task_count; ++i)
+    worker_pool->PostTask([copy]() { copy->Run(); });
+
+  copy->Run();
+
+  std::unique_lock guard(copy->lock);
+  copy->bands_done.wait(guard, [&copy]() {
+    return copy->done_band_count == copy->band_count;
+  });
+}
+
+}  // namespace vkgfx
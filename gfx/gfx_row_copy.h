@@ -0,0 +1,48 @@
+// Copyright 2025 Admenri.
+// Use of this source code is governed by a MIT-style license that can be
+// found in the LICENSE file.
+
+#ifndef GFX_GFX_ROW_COPY_H_
+#define GFX_GFX_ROW_COPY_H_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace vkgfx {
+
+class GFXWorkerPool;
+
+// Smaller copies are not worth waking up worker threads for
+constexpr size_t kParallelCopyThreshold = 4 * 1024 * 1024;
+
+// Strided copy of |image_count| images of |rows_per_image| rows each, used to
+// repack texel data into staging memory with the row pitch a buffer to image
+// copy expects.
+struct RowCopyLayout {
+  uint8_t* dst = nullptr;
+  size_t dst_row_pitch = 0;
+  size_t dst_image_pitch = 0;
+
+  const uint8_t* src = nullptr;
+  size_t src_row_pitch = 0;
+  size_t src_image_pitch = 0;
+
+  size_t row_bytes = 0;
+  uint32_t rows_per_image = 0;
+  uint32_t image_count = 0;
+};
+
+// Copies with non temporal stores so write combined staging memory is not
+// pulled into the cache: AVX2 when the CPU supports it, SSE2 on other x86
+// CPUs and memcpy elsewhere. Destination rows should be 16 byte aligned.
+void CopyRows(const RowCopyLayout& layout);
+
+// Splits copies above kParallelCopyThreshold bytes into row bands shared
+// between the calling thread and |worker_pool|, returns once all rows are
+// written.
+void CopyRowsParallel(const RowCopyLayout& layout,
+                      GFXWorkerPool* worker_pool);
+
+}  // namespace vkgfx
+
+#endif  // GFX_GFX_ROW_COPY_H_
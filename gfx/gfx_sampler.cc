@@ -20,8 +20,13 @@ GFXSampler::GFXSampler(VkSampler sampler,
 }
 
 GFXSampler::~GFXSampler() {
-  if (sampler_)
-    vkDestroySampler(device_->GetVkHandle(), sampler_, nullptr);
+  if (device_->GetBindGroupCache())
+    device_->GetBindGroupCache()->EvictResource(this);
+
+  // Shared handle, owned by the device sampler cache
+  if (sampler_ && device_->GetSamplerCache())
+    device_->GetSamplerCache()->Release(sampler_, last_usage_serial_,
+                                        device_->GetResourceTracker());
 }
 
 void GFXSampler::SetLabel(WGPUStringView label) {
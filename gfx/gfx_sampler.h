@@ -5,6 +5,8 @@
 #ifndef GFX_GFX_SAMPLER_H_
 #define GFX_GFX_SAMPLER_H_
 
+#include <atomic>
+
 #include "gfx/common/refptr.h"
 #include "gfx/gfx_config.h"
 #include "gfx/gfx_device.h"
@@ -22,10 +24,16 @@ class GFXSampler : public RefCounted<GFXSampler>, public WGPUSamplerImpl {
   GFXSampler(const GFXSampler&) = delete;
   GFXSampler& operator=(const GFXSampler&) = delete;
 
+  VkSampler GetVkHandle() const { return sampler_; }
+  // Serial of the last submission using the sampler through a bind group
+  uint64_t GetLastUsageSerial() const { return last_usage_serial_; }
+  void SetLastUsageSerial(uint64_t serial) { last_usage_serial_ = serial; }
+
   void SetLabel(WGPUStringView label);
 
  private:
   VkSampler sampler_;
+  std::atomic<uint64_t> last_usage_serial_ = 0;
 
   RefPtr<GFXDevice> device_;
 
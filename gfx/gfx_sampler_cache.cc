@@ -0,0 +1,164 @@
+// Copyright 2025 Admenri.
+// Use of this source code is governed by a MIT-style license that can be
+// found in the LICENSE file.
+
+#include "gfx/gfx_sampler_cache.h"
+
+#include <algorithm>
+
+#include "gfx/common/log.h"
+#include "gfx/gfx_resource_track.h"
+#include "gfx/gfx_utils.h"
+
+namespace vkgfx {
+
+///////////////////////////////////////////////////////////////////////////////
+// GFXSamplerCache Implement
+
+bool GFXSamplerCache::Key::operator==(const Key& other) const {
+  return hash == other.hash && mag_filter == other.mag_filter &&
+         min_filter == other.min_filter && mipmap_mode == other.mipmap_mode &&
+         address_mode_u == other.address_mode_u &&
+         address_mode_v == other.address_mode_v &&
+         address_mode_w == other.address_mode_w && min_lod == other.min_lod &&
+         max_lod == other.max_lod &&
+         anisotropy_enable == other.anisotropy_enable &&
+         max_anisotropy == other.max_anisotropy &&
+         compare_enable == other.compare_enable &&
+         compare_op == other.compare_op;
+}
+
+GFXSamplerCache::GFXSamplerCache(VkDevice device, uint32_t max_sampler_count)
+    : device_(device), max_sampler_count_(max_sampler_count) {}
+
+GFXSamplerCache::~GFXSamplerCache() {
+  for (auto& it : samplers_)
+    vkDestroySampler(device_, it.second.sampler, nullptr);
+}
+
+// static
+GFXSamplerCache::Key GFXSamplerCache::MakeKey(
+    const VkSamplerCreateInfo& create_info) {
+  Key key;
+  key.mag_filter = create_info.magFilter;
+  key.min_filter = create_info.minFilter;
+  key.mipmap_mode = create_info.mipmapMode;
+  key.address_mode_u = create_info.addressModeU;
+  key.address_mode_v = create_info.addressModeV;
+  key.address_mode_w = create_info.addressModeW;
+  key.min_lod = create_info.minLod;
+  key.max_lod = create_info.maxLod;
+  key.anisotropy_enable = create_info.anisotropyEnable;
+  key.max_anisotropy = create_info.anisotropyEnable
+                           ? create_info.maxAnisotropy
+                           : 1.0f;
+  key.compare_enable = create_info.compareEnable;
+  key.compare_op = create_info.compareEnable ? create_info.compareOp
+                                             : VK_COMPARE_OP_NEVER;
+
+  HashCombine(&key.hash, static_cast<uint32_t>(key.mag_filter));
+  HashCombine(&key.hash, static_cast<uint32_t>(key.min_filter));
+  HashCombine(&key.hash, static_cast<uint32_t>(key.mipmap_mode));
+  HashCombine(&key.hash, static_cast<uint32_t>(key.address_mode_u));
+  HashCombine(&key.hash, static_cast<uint32_t>(key.address_mode_v));
+  HashCombine(&key.hash, static_cast<uint32_t>(key.address_mode_w));
+  HashCombine(&key.hash, key.min_lod);
+  HashCombine(&key.hash, key.max_lod);
+  HashCombine(&key.hash, key.anisotropy_enable);
+  HashCombine(&key.hash, key.max_anisotropy);
+  HashCombine(&key.hash, key.compare_enable);
+  HashCombine(&key.hash, static_cast<uint32_t>(key.compare_op));
+
+  return key;
+}
+
+VkResult GFXSamplerCache::Acquire(const VkSamplerCreateInfo& create_info,
+                                  VkSampler* sampler) {
+  Key key = MakeKey(create_info);
+
+  std::lock_guard guard(lock_);
+  auto it = samplers_.find(key);
+  if (it != samplers_.end()) {
+    ++it->second.ref_count;
+    ++stats_.hits;
+    *sampler = it->second.sampler;
+    return VK_SUCCESS;
+  }
+
+  ++stats_.misses;
+  if (max_sampler_count_ && stats_.live_samplers >= max_sampler_count_) {
+    GFX_ERROR() << __FUNCTION__ << ": Sampler allocation limit reached ("
+                << max_sampler_count_ << ").";
+    return VK_ERROR_TOO_MANY_OBJECTS;
+  }
+
+  // Create from the normalized key so equal keys get equal samplers
+  VkSamplerCreateInfo normalized_info = {VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO};
+  normalized_info.magFilter = key.mag_filter;
+  normalized_info.minFilter = key.min_filter;
+  normalized_info.mipmapMode = key.mipmap_mode;
+  normalized_info.addressModeU = key.address_mode_u;
+  normalized_info.addressModeV = key.address_mode_v;
+  normalized_info.addressModeW = key.address_mode_w;
+  normalized_info.minLod = key.min_lod;
+  normalized_info.maxLod = key.max_lod;
+  normalized_info.anisotropyEnable = key.anisotropy_enable;
+  normalized_info.maxAnisotropy = key.max_anisotropy;
+  normalized_info.compareEnable = key.compare_enable;
+  normalized_info.compareOp = key.compare_op;
+
+  VkSampler new_sampler = VK_NULL_HANDLE;
+  VkResult result =
+      vkCreateSampler(device_, &normalized_info, nullptr, &new_sampler);
+  if (result != VK_SUCCESS)
+    return result;
+
+  ++stats_.live_samplers;
+  samplers_.emplace(key, Entry{new_sampler, 1, 0});
+  keys_.emplace(new_sampler, std::move(key));
+
+  *sampler = new_sampler;
+  return VK_SUCCESS;
+}
+
+void GFXSamplerCache::Release(VkSampler sampler,
+                              uint64_t serial,
+                              GFXResourceTracker* tracker) {
+  uint64_t last_usage_serial;
+  {
+    std::lock_guard guard(lock_);
+    auto key = keys_.find(sampler);
+    if (key == keys_.end())
+      return;
+
+    auto it = samplers_.find(key->second);
+    it->second.last_usage_serial =
+        std::max(it->second.last_usage_serial, serial);
+    if (--it->second.ref_count)
+      return;
+
+    // Equal keys create a new sampler from now on
+    last_usage_serial = it->second.last_usage_serial;
+    samplers_.erase(it);
+    keys_.erase(key);
+  }
+
+  if (tracker)
+    tracker->ReleaseSampler(this, sampler, last_usage_serial);
+  else
+    DestroySampler(sampler);
+}
+
+void GFXSamplerCache::DestroySampler(VkSampler sampler) {
+  vkDestroySampler(device_, sampler, nullptr);
+
+  std::lock_guard guard(lock_);
+  --stats_.live_samplers;
+}
+
+GFXSamplerCache::Stats GFXSamplerCache::GetStats() {
+  std::lock_guard guard(lock_);
+  return stats_;
+}
+
+}  // namespace vkgfx
@@ -0,0 +1,94 @@
+// Copyright 2025 Admenri.
+// Use of this source code is governed by a MIT-style license that can be
+// found in the LICENSE file.
+
+#ifndef GFX_GFX_SAMPLER_CACHE_H_
+#define GFX_GFX_SAMPLER_CACHE_H_
+
+#include <mutex>
+#include <unordered_map>
+
+#include "gfx/gfx_config.h"
+
+namespace vkgfx {
+
+class GFXResourceTracker;
+
+// Device level cache of VkSampler objects keyed on the normalized create
+// info. Samplers differing only in their label share one refcounted handle,
+// which keeps the live count well under maxSamplerAllocationCount.
+class GFXSamplerCache {
+ public:
+  struct Key {
+    VkFilter mag_filter = VK_FILTER_NEAREST;
+    VkFilter min_filter = VK_FILTER_NEAREST;
+    VkSamplerMipmapMode mipmap_mode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+    VkSamplerAddressMode address_mode_u = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+    VkSamplerAddressMode address_mode_v = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+    VkSamplerAddressMode address_mode_w = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+    float min_lod = 0.0f;
+    float max_lod = 0.0f;
+    VkBool32 anisotropy_enable = VK_FALSE;
+    float max_anisotropy = 1.0f;
+    VkBool32 compare_enable = VK_FALSE;
+    VkCompareOp compare_op = VK_COMPARE_OP_NEVER;
+    size_t hash = 0;
+
+    bool operator==(const Key& other) const;
+  };
+
+  struct Stats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint32_t live_samplers = 0;
+  };
+
+  GFXSamplerCache(VkDevice device, uint32_t max_sampler_count);
+  ~GFXSamplerCache();
+
+  GFXSamplerCache(const GFXSamplerCache&) = delete;
+  GFXSamplerCache& operator=(const GFXSamplerCache&) = delete;
+
+  static Key MakeKey(const VkSamplerCreateInfo& create_info);
+
+  // Returns a sampler for |create_info| holding one reference. Fails with
+  // VK_ERROR_TOO_MANY_OBJECTS once the driver sampler limit is reached.
+  VkResult Acquire(const VkSamplerCreateInfo& create_info, VkSampler* sampler);
+
+  // Drops one reference held by work submitted up to |serial|. The sampler
+  // is destroyed with the last reference once the latest of those serials
+  // completed, through |tracker| when there is one. It counts against the
+  // sampler limit until then.
+  void Release(VkSampler sampler,
+               uint64_t serial,
+               GFXResourceTracker* tracker);
+
+  // Destroys a sampler whose last reference was released, called by the
+  // tracker once no submission uses it anymore.
+  void DestroySampler(VkSampler sampler);
+
+  Stats GetStats();
+
+ private:
+  struct KeyHash {
+    size_t operator()(const Key& key) const { return key.hash; }
+  };
+
+  struct Entry {
+    VkSampler sampler = VK_NULL_HANDLE;
+    uint32_t ref_count = 0;
+    uint64_t last_usage_serial = 0;
+  };
+
+  VkDevice device_;
+  uint32_t max_sampler_count_;
+
+  std::mutex lock_;
+  std::unordered_map<Key, Entry, KeyHash> samplers_;
+  std::unordered_map<VkSampler, Key> keys_;
+  Stats stats_;
+};
+
+}  // namespace vkgfx
+
+#endif  // GFX_GFX_SAMPLER_CACHE_H_
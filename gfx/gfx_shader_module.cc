@@ -7,11 +7,45 @@
 namespace vkgfx {
 
 ///////////////////////////////////////////////////////////////////////////////
-// GFXSampler Implement
+// GFXShaderModule Implement
 
-GFXShaderModule::GFXShaderModule() {}
+GFXShaderModule::GFXShaderModule(const GFXShaderStore::Module* module,
+                                 RefPtr<GFXDevice> device,
+                                 WGPUStringView label)
+    : module_(module), device_(device) {
+  if (label.data && label.length)
+    label_ = std::string(label.data, label.length);
+}
+
+GFXShaderModule::~GFXShaderModule() {
+  if (module_ && device_->GetShaderStore())
+    device_->GetShaderStore()->Release(module_);
+}
+
+bool GFXShaderModule::ResolveEntryPoint(VkShaderStageFlagBits stage,
+                                        std::string* name) const {
+  const std::string* candidate = nullptr;
+  for (const auto& it : module_->entry_points) {
+    if (it.stage != stage)
+      continue;
 
-GFXShaderModule::~GFXShaderModule() {}
+    if (!name->empty()) {
+      if (it.name == *name)
+        return true;
+    } else if (candidate) {
+      // Ambiguous, the name is required
+      return false;
+    } else {
+      candidate = &it.name;
+    }
+  }
+
+  if (!candidate)
+    return false;
+
+  *name = *candidate;
+  return true;
+}
 
 WGPUFuture GFXShaderModule::GetCompilationInfo(
     WGPUCompilationInfoCallbackInfo callbackInfo) {
@@ -5,9 +5,12 @@
 #ifndef GFX_GFX_SHADER_MODULE_H_
 #define GFX_GFX_SHADER_MODULE_H_
 
+#include <string>
+
 #include "gfx/common/refptr.h"
 #include "gfx/gfx_config.h"
 #include "gfx/gfx_device.h"
+#include "gfx/gfx_shader_store.h"
 
 struct WGPUShaderModuleImpl {};
 
@@ -17,21 +20,30 @@ namespace vkgfx {
 class GFXShaderModule : public RefCounted<GFXShaderModule>,
                         public WGPUShaderModuleImpl {
  public:
-  GFXShaderModule();
+  GFXShaderModule(const GFXShaderStore::Module* module,
+                  RefPtr<GFXDevice> device,
+                  WGPUStringView label);
   ~GFXShaderModule();
 
   GFXShaderModule(const GFXShaderModule&) = delete;
   GFXShaderModule& operator=(const GFXShaderModule&) = delete;
 
+  VkShaderModule GetVkHandle() const { return module_->handle; }
+
+  // Checks that |name| is an entry point of |stage|, an empty name selects
+  // the only entry point of that stage.
+  bool ResolveEntryPoint(VkShaderStageFlagBits stage, std::string* name) const;
+
   WGPUFuture GetCompilationInfo(WGPUCompilationInfoCallbackInfo callbackInfo);
   void SetLabel(WGPUStringView label);
 
  private:
-  VkShaderModule shader_;
+  // Shared handle and reflection, owned by the device shader store
+  const GFXShaderStore::Module* module_;
 
   RefPtr<GFXDevice> device_;
 
-  std::string label_;
+  std::string label_ = "GFX.ShaderModule";
 };
 
 }  // namespace vkgfx
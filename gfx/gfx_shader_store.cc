@@ -0,0 +1,531 @@
+// Copyright 2025 Admenri.
+// Use of this source code is governed by a MIT-style license that can be
+// found in the LICENSE file.
+
+#include "gfx/gfx_shader_store.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <string>
+
+#include "gfx/common/log.h"
+#include "gfx/common/platform.h"
+
+#if GFX_PLATFORM_IS(WINDOWS)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace vkgfx {
+
+namespace {
+
+constexpr uint32_t kSpirvMagic = 0x07230203;
+// Vulkan 1.1 consumes SPIR-V up to 1.3
+constexpr uint32_t kSpirvMaxVersion = 0x00010300;
+constexpr uint32_t kSpirvHeaderWords = 5;
+constexpr uint32_t kSpirvOpEntryPoint = 15;
+constexpr uint32_t kSpirvExecutionModelVertex = 0;
+constexpr uint32_t kSpirvExecutionModelFragment = 4;
+constexpr uint32_t kSpirvExecutionModelGLCompute = 5;
+
+constexpr std::array<uint32_t, 64> kSha256RoundConstants = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1,
+    0x923f82a4, 0xab1c5ed5, 0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+    0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174, 0xe49b69c1, 0xefbe4786,
+    0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147,
+    0x06ca6351, 0x14292967, 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+    0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85, 0xa2bfe8a1, 0xa81a664b,
+    0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a,
+    0x5b9cca4f, 0x682e6ff3, 0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+    0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+uint32_t RotateRight(uint32_t value, uint32_t count) {
+  return (value >> count) | (value << (32 - count));
+}
+
+void Sha256Block(const uint8_t* block, std::array<uint32_t, 8>* state) {
+  std::array<uint32_t, 64> w;
+  for (uint32_t i = 0; i < 16; ++i)
+    w[i] = (uint32_t(block[i * 4]) << 24) | (uint32_t(block[i * 4 + 1]) << 16) |
+           (uint32_t(block[i * 4 + 2]) << 8) | uint32_t(block[i * 4 + 3]);
+  for (uint32_t i = 16; i < 64; ++i) {
+    uint32_t s0 = RotateRight(w[i - 15], 7) ^ RotateRight(w[i - 15], 18) ^
+                  (w[i - 15] >> 3);
+    uint32_t s1 = RotateRight(w[i - 2], 17) ^ RotateRight(w[i - 2], 19) ^
+                  (w[i - 2] >> 10);
+    w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+  }
+
+  auto [a, b, c, d, e, f, g, h] = *state;
+  for (uint32_t i = 0; i < 64; ++i) {
+    uint32_t s1 = RotateRight(e, 6) ^ RotateRight(e, 11) ^ RotateRight(e, 25);
+    uint32_t ch = (e & f) ^ (~e & g);
+    uint32_t t1 = h + s1 + ch + kSha256RoundConstants[i] + w[i];
+    uint32_t s0 = RotateRight(a, 2) ^ RotateRight(a, 13) ^ RotateRight(a, 22);
+    uint32_t maj = (a & b) ^ (a & c) ^ (b & c);
+    uint32_t t2 = s0 + maj;
+    h = g;
+    g = f;
+    f = e;
+    e = d + t1;
+    d = c;
+    c = b;
+    b = a;
+    a = t1 + t2;
+  }
+
+  (*state)[0] += a;
+  (*state)[1] += b;
+  (*state)[2] += c;
+  (*state)[3] += d;
+  (*state)[4] += e;
+  (*state)[5] += f;
+  (*state)[6] += g;
+  (*state)[7] += h;
+}
+
+GFXShaderStore::Digest Sha256(const uint8_t* data, size_t size) {
+  std::array<uint32_t, 8> state = {
+      0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+      0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19,
+  };
+
+  size_t offset = 0;
+  for (; offset + 64 <= size; offset += 64)
+    Sha256Block(data + offset, &state);
+
+  // Padding: 0x80, zeros, then the big endian bit length
+  std::array<uint8_t, 128> tail = {};
+  size_t tail_size = size - offset;
+  std::memcpy(tail.data(), data + offset, tail_size);
+  tail[tail_size] = 0x80;
+  size_t padded_size = tail_size + 9 <= 64 ? 64 : 128;
+  uint64_t bit_length = uint64_t(size) * 8;
+  for (uint32_t i = 0; i < 8; ++i)
+    tail[padded_size - 1 - i] = uint8_t(bit_length >> (i * 8));
+  for (size_t i = 0; i < padded_size; i += 64)
+    Sha256Block(tail.data() + i, &state);
+
+  GFXShaderStore::Digest digest;
+  for (uint32_t i = 0; i < 8; ++i) {
+    digest[i * 4] = uint8_t(state[i] >> 24);
+    digest[i * 4 + 1] = uint8_t(state[i] >> 16);
+    digest[i * 4 + 2] = uint8_t(state[i] >> 8);
+    digest[i * 4 + 3] = uint8_t(state[i]);
+  }
+  return digest;
+}
+
+// Validates the instruction stream and collects the entry points of the
+// stages WebGPU can use.
+bool ReflectSPIRV(const uint32_t* code,
+                  size_t word_count,
+                  std::vector<GFXShaderStore::EntryPoint>* entry_points,
+                  std::string* error) {
+  if (word_count < kSpirvHeaderWords || code[0] != kSpirvMagic) {
+    *error = "Invalid SPIR-V header.";
+    return false;
+  }
+
+  if (code[1] > kSpirvMaxVersion) {
+    *error = "Unsupported SPIR-V version.";
+    return false;
+  }
+
+  size_t offset = kSpirvHeaderWords;
+  while (offset < word_count) {
+    const uint32_t instruction_words = code[offset] >> 16;
+    const uint32_t opcode = code[offset] & 0xFFFF;
+    if (!instruction_words || instruction_words > word_count - offset) {
+      *error = "Malformed SPIR-V instruction stream.";
+      return false;
+    }
+
+    // OpEntryPoint ExecutionModel %id "name" interfaces...
+    if (opcode == kSpirvOpEntryPoint && instruction_words >= 4) {
+      const auto* name = reinterpret_cast<const char*>(code + offset + 3);
+      const size_t name_capacity = (instruction_words - 3) * sizeof(uint32_t);
+
+      GFXShaderStore::EntryPoint entry_point;
+      entry_point.name = std::string(name, strnlen(name, name_capacity));
+      switch (code[offset + 1]) {
+        case kSpirvExecutionModelVertex:
+          entry_point.stage = VK_SHADER_STAGE_VERTEX_BIT;
+          entry_points->push_back(std::move(entry_point));
+          break;
+        case kSpirvExecutionModelFragment:
+          entry_point.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+          entry_points->push_back(std::move(entry_point));
+          break;
+        case kSpirvExecutionModelGLCompute:
+          entry_point.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+          entry_points->push_back(std::move(entry_point));
+          break;
+        default:
+          break;
+      }
+    }
+
+    offset += instruction_words;
+  }
+
+  return true;
+}
+
+}  // namespace
+
+///////////////////////////////////////////////////////////////////////////////
+// GFXShaderStore::MappedFile Implement
+
+// Read only view of a whole file.
+class GFXShaderStore::MappedFile {
+ public:
+  static std::unique_ptr<MappedFile> Open(const std::filesystem::path& path);
+  ~MappedFile();
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  const uint8_t* GetData() const { return data_; }
+  size_t GetSize() const { return size_; }
+
+ private:
+  MappedFile() = default;
+
+  const uint8_t* data_ = nullptr;
+  size_t size_ = 0;
+#if GFX_PLATFORM_IS(WINDOWS)
+  HANDLE file_ = INVALID_HANDLE_VALUE;
+  HANDLE mapping_ = nullptr;
+#endif
+};
+
+// static
+std::unique_ptr<GFXShaderStore::MappedFile> GFXShaderStore::MappedFile::Open(
+    const std::filesystem::path& path) {
+  std::error_code error;
+  const auto file_size = std::filesystem::file_size(path, error);
+  if (error || !file_size)
+    return nullptr;
+
+  std::unique_ptr<MappedFile> mapped_file(new MappedFile);
+  mapped_file->size_ = file_size;
+
+#if GFX_PLATFORM_IS(WINDOWS)
+  mapped_file->file_ =
+      CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                  OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (mapped_file->file_ == INVALID_HANDLE_VALUE)
+    return nullptr;
+
+  mapped_file->mapping_ = CreateFileMappingW(
+      mapped_file->file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if (!mapped_file->mapping_)
+    return nullptr;
+
+  mapped_file->data_ = static_cast<const uint8_t*>(
+      MapViewOfFile(mapped_file->mapping_, FILE_MAP_READ, 0, 0, 0));
+#else
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0)
+    return nullptr;
+
+  // The mapping stays valid after the descriptor is closed
+  void* data = mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (data != MAP_FAILED)
+    mapped_file->data_ = static_cast<const uint8_t*>(data);
+#endif
+
+  if (!mapped_file->data_)
+    return nullptr;
+
+  return mapped_file;
+}
+
+GFXShaderStore::MappedFile::~MappedFile() {
+#if GFX_PLATFORM_IS(WINDOWS)
+  if (data_)
+    UnmapViewOfFile(data_);
+  if (mapping_)
+    CloseHandle(mapping_);
+  if (file_ != INVALID_HANDLE_VALUE)
+    CloseHandle(file_);
+#else
+  if (data_)
+    munmap(const_cast<uint8_t*>(data_), size_);
+#endif
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// GFXShaderStore Implement
+
+GFXShaderStore::GFXShaderStore(VkDevice device,
+                               const std::filesystem::path& path)
+    : device_(device), path_(path) {
+  MapInternal();
+}
+
+GFXShaderStore::~GFXShaderStore() {
+  for (auto& it : modules_)
+    vkDestroyShaderModule(device_, it.second.module->handle, nullptr);
+}
+
+// static
+GFXShaderStore::Digest GFXShaderStore::HashCode(const uint32_t* code,
+                                                size_t word_count) {
+  return Sha256(reinterpret_cast<const uint8_t*>(code),
+                word_count * sizeof(uint32_t));
+}
+
+const GFXShaderStore::Module* GFXShaderStore::Acquire(const uint32_t* code,
+                                                      size_t word_count,
+                                                      std::string* error) {
+  const Digest digest = HashCode(code, word_count);
+
+  std::lock_guard guard(lock_);
+  auto it = modules_.find(digest);
+  if (it != modules_.end()) {
+    ++stats_.hits;
+    ++it->second.ref_count;
+    return it->second.module.get();
+  }
+
+  ++stats_.misses;
+  auto module = std::make_unique<Module>();
+  module->digest = digest;
+
+  // Modules seen before were validated already
+  auto reflection = reflections_.find(digest);
+  if (reflection != reflections_.end()) {
+    module->entry_points = reflection->second;
+  } else if (FindInBlobInternal(digest, &module->entry_points)) {
+    ++stats_.blob_hits;
+    reflections_.emplace(digest, module->entry_points);
+  } else {
+    if (!ReflectSPIRV(code, word_count, &module->entry_points, error))
+      return nullptr;
+    reflections_.emplace(digest, module->entry_points);
+  }
+
+  VkShaderModuleCreateInfo create_info = {
+      VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO};
+  create_info.codeSize = word_count * sizeof(uint32_t);
+  create_info.pCode = code;
+  if (vkCreateShaderModule(device_, &create_info, nullptr, &module->handle) !=
+      VK_SUCCESS) {
+    *error = "Failed to create shader module.";
+    return nullptr;
+  }
+
+  ++stats_.live_modules;
+  auto& entry = modules_[digest];
+  entry.module = std::move(module);
+  entry.ref_count = 1;
+  return entry.module.get();
+}
+
+void GFXShaderStore::Release(const Module* module) {
+  std::lock_guard guard(lock_);
+  auto it = modules_.find(module->digest);
+  if (it == modules_.end() || --it->second.ref_count)
+    return;
+
+  vkDestroyShaderModule(device_, it->second.module->handle, nullptr);
+  modules_.erase(it);
+  --stats_.live_modules;
+}
+
+bool GFXShaderStore::Save() {
+  if (path_.empty())
+    return false;
+
+  std::lock_guard guard(lock_);
+
+  // Union of the mapped blob and this run, ordered by digest
+  auto reflections = reflections_;
+  if (blob_) {
+    const auto* header =
+        reinterpret_cast<const FileHeader*>(blob_->GetData());
+    const auto* records =
+        reinterpret_cast<const FileRecord*>(header + 1);
+    for (uint32_t i = 0; i < header->record_count; ++i) {
+      Digest digest;
+      std::memcpy(digest.data(), records[i].digest, digest.size());
+      if (reflections.count(digest))
+        continue;
+
+      std::vector<EntryPoint> entry_points;
+      if (FindInBlobInternal(digest, &entry_points))
+        reflections.emplace(digest, std::move(entry_points));
+    }
+  }
+
+  std::vector<FileRecord> records;
+  std::vector<FileEntryPoint> entry_points;
+  std::string strings;
+  for (const auto& it : reflections) {
+    FileRecord record = {};
+    std::memcpy(record.digest, it.first.data(), it.first.size());
+    record.first_entry_point = entry_points.size();
+    record.entry_point_count = it.second.size();
+    records.push_back(record);
+
+    for (const auto& entry_point : it.second) {
+      entry_points.push_back(FileEntryPoint{
+          static_cast<uint32_t>(entry_point.stage),
+          static_cast<uint32_t>(strings.size()),
+          static_cast<uint32_t>(entry_point.name.size())});
+      strings += entry_point.name;
+    }
+  }
+
+  FileHeader header = {};
+  header.magic = kFileMagic;
+  header.version = kFileVersion;
+  header.record_count = records.size();
+  header.entry_point_count = entry_points.size();
+  header.string_size = strings.size();
+
+  // Readers never observe a partially written file
+  std::error_code error;
+  std::filesystem::create_directories(path_.parent_path(), error);
+
+  // Named per process and save, concurrent writers never share it
+  static std::atomic<uint32_t> save_count = 0;
+#if GFX_PLATFORM_IS(WINDOWS)
+  const uint64_t process_id = GetCurrentProcessId();
+#else
+  const uint64_t process_id = getpid();
+#endif
+  std::random_device random;
+  std::filesystem::path temp_path = path_;
+  temp_path += "." + std::to_string(process_id) + "." +
+               std::to_string(random()) + "." +
+               std::to_string(save_count++) + ".tmp";
+  {
+    std::ofstream stream(temp_path, std::ios::binary | std::ios::trunc);
+    if (!stream)
+      return false;
+
+    stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    stream.write(reinterpret_cast<const char*>(records.data()),
+                 records.size() * sizeof(FileRecord));
+    stream.write(reinterpret_cast<const char*>(entry_points.data()),
+                 entry_points.size() * sizeof(FileEntryPoint));
+    stream.write(strings.data(), strings.size());
+    if (!stream.good()) {
+      stream.close();
+      std::filesystem::remove(temp_path, error);
+      return false;
+    }
+  }
+
+  // A mapped file cannot be replaced on every platform
+  blob_.reset();
+  reflections_ = std::move(reflections);
+
+  std::filesystem::rename(temp_path, path_, error);
+  if (error) {
+    GFX_ERROR() << __FUNCTION__ << ": Failed to write " << path_.string()
+                << ", " << error.message();
+    std::filesystem::remove(temp_path, error);
+    return false;
+  }
+
+  MapInternal();
+  return true;
+}
+
+GFXShaderStore::Stats GFXShaderStore::GetStats() {
+  std::lock_guard guard(lock_);
+  return stats_;
+}
+
+void GFXShaderStore::MapInternal() {
+  if (path_.empty())
+    return;
+
+  auto blob = MappedFile::Open(path_);
+  if (!blob || blob->GetSize() < sizeof(FileHeader))
+    return;
+
+  const auto* header = reinterpret_cast<const FileHeader*>(blob->GetData());
+  if (header->magic != kFileMagic || header->version != kFileVersion) {
+    GFX_INFO() << "[ShaderStore] Discarded stale store: " << path_.string();
+    return;
+  }
+
+  const uint64_t expected_size =
+      sizeof(FileHeader) +
+      uint64_t(header->record_count) * sizeof(FileRecord) +
+      uint64_t(header->entry_point_count) * sizeof(FileEntryPoint) +
+      header->string_size;
+  if (blob->GetSize() != expected_size) {
+    GFX_WARNING() << "[ShaderStore] Truncated store: " << path_.string();
+    return;
+  }
+
+  blob_ = std::move(blob);
+}
+
+bool GFXShaderStore::FindInBlobInternal(
+    const Digest& digest,
+    std::vector<EntryPoint>* entry_points) const {
+  if (!blob_)
+    return false;
+
+  // Sections were bounds checked when mapping
+  const auto* header = reinterpret_cast<const FileHeader*>(blob_->GetData());
+  const auto* records = reinterpret_cast<const FileRecord*>(header + 1);
+  const auto* file_entry_points =
+      reinterpret_cast<const FileEntryPoint*>(records + header->record_count);
+  const auto* strings = reinterpret_cast<const char*>(
+      file_entry_points + header->entry_point_count);
+
+  const auto* records_end = records + header->record_count;
+  const auto* record = std::lower_bound(
+      records, records_end, digest,
+      [](const FileRecord& record, const Digest& digest) {
+        return std::memcmp(record.digest, digest.data(), digest.size()) < 0;
+      });
+  if (record == records_end ||
+      std::memcmp(record->digest, digest.data(), digest.size()))
+    return false;
+
+  if (uint64_t(record->first_entry_point) + record->entry_point_count >
+      header->entry_point_count)
+    return false;
+
+  entry_points->clear();
+  for (uint32_t i = 0; i < record->entry_point_count; ++i) {
+    const auto& file_entry_point =
+        file_entry_points[record->first_entry_point + i];
+    if (uint64_t(file_entry_point.name_offset) +
+            file_entry_point.name_length >
+        header->string_size)
+      return false;
+
+    EntryPoint entry_point;
+    entry_point.name = std::string(strings + file_entry_point.name_offset,
+                                   file_entry_point.name_length);
+    entry_point.stage =
+        static_cast<VkShaderStageFlagBits>(file_entry_point.stage);
+    entry_points->push_back(std::move(entry_point));
+  }
+
+  return true;
+}
+
+}  // namespace vkgfx
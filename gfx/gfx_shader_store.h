@@ -0,0 +1,121 @@
+// Copyright 2025 Admenri.
+// Use of this source code is governed by a MIT-style license that can be
+// found in the LICENSE file.
+
+#ifndef GFX_GFX_SHADER_STORE_H_
+#define GFX_GFX_SHADER_STORE_H_
+
+#include <array>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "gfx/gfx_config.h"
+
+namespace vkgfx {
+
+// Device level content addressed store of SPIR-V modules.
+// Modules are keyed on the SHA-256 of their words, identical code shares one
+// refcounted VkShaderModule. The validation and entry point reflection of
+// every module seen is optionally persisted to a sorted blob which is mapped
+// on the next run, known digests then skip the SPIR-V walk entirely.
+class GFXShaderStore {
+ public:
+  using Digest = std::array<uint8_t, 32>;
+
+  struct EntryPoint {
+    std::string name;
+    VkShaderStageFlagBits stage;
+  };
+
+  struct Module {
+    Digest digest;
+    VkShaderModule handle = VK_NULL_HANDLE;
+    std::vector<EntryPoint> entry_points;
+  };
+
+  struct Stats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    // Misses whose reflection came from the blob
+    uint64_t blob_hits = 0;
+    uint32_t live_modules = 0;
+  };
+
+  // |path| may be empty for an in memory store.
+  GFXShaderStore(VkDevice device, const std::filesystem::path& path);
+  ~GFXShaderStore();
+
+  GFXShaderStore(const GFXShaderStore&) = delete;
+  GFXShaderStore& operator=(const GFXShaderStore&) = delete;
+
+  static Digest HashCode(const uint32_t* code, size_t word_count);
+
+  // Returns the module of |code| holding one reference, or null with |error|
+  // for invalid SPIR-V.
+  const Module* Acquire(const uint32_t* code,
+                        size_t word_count,
+                        std::string* error);
+
+  // Drops one reference, the module is destroyed with the last one.
+  void Release(const Module* module);
+
+  // Writes the reflection of every module seen, returns false on failure or
+  // without a backing file.
+  bool Save();
+
+  Stats GetStats();
+
+ private:
+  struct FileHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t record_count;
+    uint32_t entry_point_count;
+    uint64_t string_size;
+  };
+
+  // Digest sorted, followed by the entry points and the name strings.
+  struct FileRecord {
+    uint8_t digest[32];
+    uint32_t first_entry_point;
+    uint32_t entry_point_count;
+  };
+
+  struct FileEntryPoint {
+    uint32_t stage;
+    uint32_t name_offset;
+    uint32_t name_length;
+  };
+
+  static constexpr uint32_t kFileMagic = 0x53534B56;  // "VKSS"
+  static constexpr uint32_t kFileVersion = 1;
+
+  class MappedFile;
+
+  struct Entry {
+    std::unique_ptr<Module> module;
+    uint32_t ref_count = 0;
+  };
+
+  void MapInternal();
+  bool FindInBlobInternal(const Digest& digest,
+                          std::vector<EntryPoint>* entry_points) const;
+
+  VkDevice device_;
+  std::filesystem::path path_;
+
+  std::mutex lock_;
+  std::unique_ptr<MappedFile> blob_;
+  std::map<Digest, Entry> modules_;
+  // Reflection gathered this run, merged into the blob on Save
+  std::map<Digest, std::vector<EntryPoint>> reflections_;
+  Stats stats_;
+};
+
+}  // namespace vkgfx
+
+#endif  // GFX_GFX_SHADER_STORE_H_
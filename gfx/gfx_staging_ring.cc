@@ -0,0 +1,253 @@
+// Copyright 2025 Admenri.
+// Use of this source code is governed by a MIT-style license that can be
+// found in the LICENSE file.
+
+#include "gfx/gfx_staging_ring.h"
+
+#include <algorithm>
+
+#include "gfx/common/log.h"
+
+namespace vkgfx {
+
+namespace {
+
+VkDeviceSize AlignUp(VkDeviceSize value, VkDeviceSize alignment) {
+  return (value + alignment - 1) & ~(alignment - 1);
+}
+
+}  // namespace
+
+///////////////////////////////////////////////////////////////////////////////
+// GFXStagingRing Implement
+
+GFXStagingRing::GFXStagingRing(VmaAllocator allocator)
+    : allocator_(allocator) {}
+
+GFXStagingRing::~GFXStagingRing() {
+  // The queue waits for idle before releasing the ring
+  for (auto& ring : retired_rings_)
+    DestroyRingInternal(ring.get());
+  if (ring_)
+    DestroyRingInternal(ring_.get());
+}
+
+bool GFXStagingRing::Allocate(VkDeviceSize size,
+                              uint64_t serial,
+                              Allocation* allocation) {
+  size = AlignUp(std::max<VkDeviceSize>(size, 1), kAlignment);
+
+  VkDeviceSize offset = 0;
+  if (!ring_ || !TryAllocateInternal(ring_.get(), size, serial, &offset)) {
+    // Grow: the current ring drains in the background
+    VkDeviceSize new_size = ring_ ? ring_->size * 2 : kInitialSize;
+    while (new_size < size)
+      new_size *= 2;
+
+    auto new_ring = CreateRingInternal(new_size);
+    if (!new_ring)
+      return false;
+
+    if (ring_) {
+      if (ring_->in_flight.empty())
+        DestroyRingInternal(ring_.get());
+      else
+        retired_rings_.push_back(std::move(ring_));
+      ++stats_.grow_count;
+    }
+
+    ring_ = std::move(new_ring);
+    high_water_ = 0;
+    underused_since_ = {};
+    TryAllocateInternal(ring_.get(), size, serial, &offset);
+  }
+
+  high_water_ = std::max(high_water_, GetUsedBytes(ring_.get()));
+
+  allocation->buffer = ring_->buffer;
+  allocation->offset = offset;
+  allocation->size = size;
+  allocation->mapped_data = ring_->mapped_data + offset;
+  return true;
+}
+
+void GFXStagingRing::AssignSerial(const Allocation& allocation,
+                                  uint64_t serial) {
+  Ring* ring = FindRingInternal(allocation.buffer);
+  if (!ring)
+    return;
+
+  // Unsubmitted regions are never merged, the end identifies them
+  const VkDeviceSize end = allocation.offset + allocation.size;
+  for (auto& region : ring->in_flight) {
+    if (region.serial == kUnsubmittedSerial && region.end == end) {
+      region.serial = serial;
+      return;
+    }
+  }
+}
+
+void GFXStagingRing::Flush(const Allocation& allocation, VkDeviceSize size) {
+  if (Ring* ring = FindRingInternal(allocation.buffer))
+    vmaFlushAllocation(allocator_, ring->allocation, allocation.offset, size);
+}
+
+void GFXStagingRing::Tick(uint64_t completed_serial) {
+  for (auto it = retired_rings_.begin(); it != retired_rings_.end();) {
+    RetireInternal(it->get(), completed_serial);
+    if ((*it)->in_flight.empty()) {
+      DestroyRingInternal(it->get());
+      it = retired_rings_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+
+  if (!ring_)
+    return;
+
+  RetireInternal(ring_.get(), completed_serial);
+
+  // Shrink a ring which stayed under a quarter full for a while
+  if (ring_->size <= kInitialSize || high_water_ >= ring_->size / 4) {
+    high_water_ = GetUsedBytes(ring_.get());
+    underused_since_ = {};
+    return;
+  }
+
+  const auto now = std::chrono::steady_clock::now();
+  if (underused_since_ == std::chrono::steady_clock::time_point())
+    underused_since_ = now;
+  if (now - underused_since_ < kShrinkDelay)
+    return;
+
+  auto new_ring = CreateRingInternal(ring_->size / 2);
+  if (!new_ring)
+    return;
+
+  if (ring_->in_flight.empty())
+    DestroyRingInternal(ring_.get());
+  else
+    retired_rings_.push_back(std::move(ring_));
+
+  ring_ = std::move(new_ring);
+  high_water_ = 0;
+  underused_since_ = {};
+  ++stats_.shrink_count;
+}
+
+GFXStagingRing::Stats GFXStagingRing::GetStats() const {
+  Stats stats = stats_;
+  if (ring_) {
+    stats.capacity = ring_->size;
+    stats.used_bytes = GetUsedBytes(ring_.get());
+  }
+
+  for (const auto& ring : retired_rings_) {
+    stats.capacity += ring->size;
+    stats.used_bytes += GetUsedBytes(ring.get());
+  }
+
+  return stats;
+}
+
+GFXStagingRing::Ring* GFXStagingRing::FindRingInternal(VkBuffer buffer) {
+  if (ring_ && ring_->buffer == buffer)
+    return ring_.get();
+
+  for (auto& ring : retired_rings_)
+    if (ring->buffer == buffer)
+      return ring.get();
+  return nullptr;
+}
+
+std::unique_ptr<GFXStagingRing::Ring> GFXStagingRing::CreateRingInternal(
+    VkDeviceSize size) {
+  auto ring = std::make_unique<Ring>();
+  ring->size = size;
+
+  VkBufferCreateInfo buffer_info = {VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO};
+  buffer_info.size = size;
+  buffer_info.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+
+  VmaAllocationCreateInfo allocation_info = {};
+  allocation_info.usage = VMA_MEMORY_USAGE_AUTO_PREFER_HOST;
+  allocation_info.flags =
+      VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT |
+      VMA_ALLOCATION_CREATE_MAPPED_BIT;
+
+  VmaAllocationInfo allocation_result = {};
+  if (vmaCreateBuffer(allocator_, &buffer_info, &allocation_info,
+                      &ring->buffer, &ring->allocation,
+                      &allocation_result) != VK_SUCCESS) {
+    GFX_ERROR() << __FUNCTION__ << ": Failed to create staging ring of "
+                << size << " bytes.";
+    return nullptr;
+  }
+  ring->mapped_data = static_cast<uint8_t*>(allocation_result.pMappedData);
+
+  return ring;
+}
+
+void GFXStagingRing::DestroyRingInternal(Ring* ring) {
+  if (ring->buffer)
+    vmaDestroyBuffer(allocator_, ring->buffer, ring->allocation);
+}
+
+// static
+bool GFXStagingRing::TryAllocateInternal(Ring* ring,
+                                         VkDeviceSize size,
+                                         uint64_t serial,
+                                         VkDeviceSize* offset) {
+  if (size > ring->size)
+    return false;
+
+  if (ring->in_flight.empty())
+    ring->head = ring->tail = 0;
+
+  // Regions never close the gap to the tail completely, so head == tail
+  // always means an empty ring.
+  VkDeviceSize start = AlignUp(ring->head, kAlignment);
+  if (ring->head >= ring->tail) {
+    // Free space is [head, size) followed by [0, tail)
+    if (start + size > ring->size) {
+      if (size >= ring->tail)
+        return false;
+      start = 0;
+    }
+  } else if (start + size >= ring->tail) {
+    return false;
+  }
+
+  ring->head = start + size;
+  if (!ring->in_flight.empty() && serial != kUnsubmittedSerial &&
+      ring->in_flight.back().serial == serial)
+    ring->in_flight.back().end = ring->head;
+  else
+    ring->in_flight.push_back(Region{serial, ring->head});
+
+  *offset = start;
+  return true;
+}
+
+// static
+void GFXStagingRing::RetireInternal(Ring* ring, uint64_t completed_serial) {
+  while (!ring->in_flight.empty() &&
+         ring->in_flight.front().serial <= completed_serial) {
+    ring->tail = ring->in_flight.front().end;
+    ring->in_flight.pop_front();
+  }
+}
+
+// static
+VkDeviceSize GFXStagingRing::GetUsedBytes(const Ring* ring) {
+  if (ring->in_flight.empty())
+    return 0;
+
+  if (ring->head > ring->tail)
+    return ring->head - ring->tail;
+
+  return ring->size - ring->tail + ring->head;
+}
+
+}  // namespace vkgfx
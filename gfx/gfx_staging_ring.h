@@ -0,0 +1,119 @@
+// Copyright 2025 Admenri.
+// Use of this source code is governed by a MIT-style license that can be
+// found in the LICENSE file.
+
+#ifndef GFX_GFX_STAGING_RING_H_
+#define GFX_GFX_STAGING_RING_H_
+
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include "gfx/gfx_config.h"
+
+#include "vma/vma.h"
+
+namespace vkgfx {
+
+// Queue owned ring of persistently mapped, host visible upload memory.
+// Every region is tagged with the serial of the submission consuming it and
+// becomes reusable once that serial completed. When a write does not fit the
+// ring is replaced by one twice as large, the old ring is released after its
+// last submission; a ring left mostly unused for a while is halved again, so
+// no VkBuffer is ever created per write.
+// Not thread safe, the queue serializes access.
+class GFXStagingRing {
+ public:
+  static constexpr VkDeviceSize kInitialSize = 4 * 1024 * 1024;
+  static constexpr VkDeviceSize kAlignment = 16;
+  // Serial of regions written before the submission consuming them is known,
+  // nothing after them is recycled until AssignSerial tags them.
+  static constexpr uint64_t kUnsubmittedSerial = UINT64_MAX;
+
+  struct Allocation {
+    VkBuffer buffer = VK_NULL_HANDLE;
+    VkDeviceSize offset = 0;
+    // Aligned size of the region
+    VkDeviceSize size = 0;
+    uint8_t* mapped_data = nullptr;
+  };
+
+  struct Stats {
+    VkDeviceSize capacity = 0;
+    VkDeviceSize used_bytes = 0;
+    uint32_t grow_count = 0;
+    uint32_t shrink_count = 0;
+  };
+
+  explicit GFXStagingRing(VmaAllocator allocator);
+  ~GFXStagingRing();
+
+  GFXStagingRing(const GFXStagingRing&) = delete;
+  GFXStagingRing& operator=(const GFXStagingRing&) = delete;
+
+  // Reserves |size| bytes consumed by the submission |serial|, serials must
+  // not decrease between calls apart from kUnsubmittedSerial.
+  bool Allocate(VkDeviceSize size, uint64_t serial, Allocation* allocation);
+
+  // Tags |allocation|, reserved with kUnsubmittedSerial, with the submission
+  // consuming it. The region can be written in between without the queue
+  // serializing the writes.
+  void AssignSerial(const Allocation& allocation, uint64_t serial);
+
+  // Makes host writes to |allocation| visible, no-op on coherent memory.
+  void Flush(const Allocation& allocation, VkDeviceSize size);
+
+  // Recycles every region used by submissions up to |completed_serial|.
+  void Tick(uint64_t completed_serial);
+
+  Stats GetStats() const;
+
+ private:
+  // Time spent under a quarter full before the ring is halved. Tick runs on
+  // every poll, counting calls would shrink faster the more the app polls.
+  static constexpr std::chrono::seconds kShrinkDelay{2};
+
+  struct Region {
+    uint64_t serial;
+    VkDeviceSize end;
+  };
+
+  struct Ring {
+    VkBuffer buffer = VK_NULL_HANDLE;
+    VmaAllocation allocation = VK_NULL_HANDLE;
+    uint8_t* mapped_data = nullptr;
+    VkDeviceSize size = 0;
+
+    // Next write position and start of the oldest region in flight
+    VkDeviceSize head = 0;
+    VkDeviceSize tail = 0;
+    std::deque<Region> in_flight;
+  };
+
+  // Ring |buffer| belongs to, the current one or a retired one.
+  Ring* FindRingInternal(VkBuffer buffer);
+  std::unique_ptr<Ring> CreateRingInternal(VkDeviceSize size);
+  void DestroyRingInternal(Ring* ring);
+  static bool TryAllocateInternal(Ring* ring,
+                                  VkDeviceSize size,
+                                  uint64_t serial,
+                                  VkDeviceSize* offset);
+  static void RetireInternal(Ring* ring, uint64_t completed_serial);
+  static VkDeviceSize GetUsedBytes(const Ring* ring);
+
+  VmaAllocator allocator_;
+
+  std::unique_ptr<Ring> ring_;
+  // Replaced rings waiting for their last submission
+  std::vector<std::unique_ptr<Ring>> retired_rings_;
+
+  VkDeviceSize high_water_ = 0;
+  // Empty while the ring is not underused
+  std::chrono::steady_clock::time_point underused_since_;
+  Stats stats_;
+};
+
+}  // namespace vkgfx
+
+#endif  // GFX_GFX_STAGING_RING_H_
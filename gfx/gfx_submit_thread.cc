@@ -0,0 +1,152 @@
+// Copyright 2025 Admenri.
+// Use of this source code is governed by a MIT-style license that can be
+// found in the LICENSE file.
+
+#include "gfx/gfx_submit_thread.h"
+
+#include "gfx/common/log.h"
+
+namespace vkgfx {
+
+///////////////////////////////////////////////////////////////////////////////
+// GFXSubmitThread Implement
+
+GFXSubmitThread::GFXSubmitThread(VkQueue queue)
+    : queue_(queue), head_(&stub_), tail_(&stub_) {
+  thread_ = std::thread(&GFXSubmitThread::ThreadMain, this);
+}
+
+GFXSubmitThread::~GFXSubmitThread() {
+  stopping_ = true;
+  ++wake_;
+  wake_.notify_one();
+  thread_.join();
+}
+
+void GFXSubmitThread::Push(Batch batch) {
+  auto* node = new Node;
+  node->batch = std::move(batch);
+  PushNode(node);
+
+  ++wake_;
+  wake_.notify_one();
+}
+
+void GFXSubmitThread::PushNode(Node* node) {
+  node->next.store(nullptr, std::memory_order_relaxed);
+  Node* prev = head_.exchange(node, std::memory_order_acq_rel);
+  prev->next.store(node, std::memory_order_release);
+}
+
+GFXSubmitThread::Node* GFXSubmitThread::PopNode() {
+  Node* tail = tail_;
+  Node* next = tail->next.load(std::memory_order_acquire);
+  if (tail == &stub_) {
+    if (!next)
+      return nullptr;
+
+    tail_ = next;
+    tail = next;
+    next = next->next.load(std::memory_order_acquire);
+  }
+
+  if (next) {
+    tail_ = next;
+    return tail;
+  }
+
+  // A producer swapped the head but did not link its node yet
+  if (tail != head_.load(std::memory_order_acquire))
+    return nullptr;
+
+  // Last node, put the stub behind it so it can be handed out
+  PushNode(&stub_);
+  next = tail->next.load(std::memory_order_acquire);
+  if (next) {
+    tail_ = next;
+    return tail;
+  }
+
+  return nullptr;
+}
+
+void GFXSubmitThread::SubmitInternal(const std::vector<Node*>& nodes) {
+  std::vector<VkSubmitInfo> submit_infos;
+  // Referenced by |submit_infos|, must not reallocate
+  std::vector<VkTimelineSemaphoreSubmitInfoKHR> timeline_infos;
+  submit_infos.reserve(nodes.size());
+  timeline_infos.reserve(nodes.size());
+  for (auto* node : nodes) {
+    auto& batch = node->batch;
+    VkSubmitInfo submit_info = {VK_STRUCTURE_TYPE_SUBMIT_INFO};
+    submit_info.commandBufferCount = batch.command_buffers.size();
+    submit_info.pCommandBuffers = batch.command_buffers.data();
+    if (batch.semaphore) {
+      auto& timeline_info = timeline_infos.emplace_back();
+      timeline_info = {VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO_KHR};
+      timeline_info.signalSemaphoreValueCount = 1;
+      timeline_info.pSignalSemaphoreValues = &batch.serial;
+      submit_info.pNext = &timeline_info;
+      submit_info.signalSemaphoreCount = 1;
+      submit_info.pSignalSemaphores = &batch.semaphore;
+    }
+    submit_infos.push_back(submit_info);
+  }
+
+  const auto& last_batch = nodes.back()->batch;
+  VkResult result = vkQueueSubmit(queue_, submit_infos.size(),
+                                  submit_infos.data(), last_batch.fence);
+
+  // Fence waiters do not know about merging, every fence gets signaled
+  for (size_t i = 0; i + 1 < nodes.size(); ++i)
+    if (nodes[i]->batch.fence)
+      vkQueueSubmit(queue_, 0, nullptr, nodes[i]->batch.fence);
+
+  if (result == VK_SUCCESS)
+    return;
+
+  GFX_ERROR() << __FUNCTION__ << ": vkQueueSubmit failed (" << result
+              << ").";
+  VkResult expected = VK_SUCCESS;
+  error_.compare_exchange_strong(expected, result);
+
+  // Still signal the last serial so nobody waits on work which never runs
+  VkTimelineSemaphoreSubmitInfoKHR timeline_info = {
+      VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO_KHR};
+  VkSubmitInfo signal_info = {VK_STRUCTURE_TYPE_SUBMIT_INFO};
+  if (last_batch.semaphore) {
+    timeline_info.signalSemaphoreValueCount = 1;
+    timeline_info.pSignalSemaphoreValues = &last_batch.serial;
+    signal_info.pNext = &timeline_info;
+    signal_info.signalSemaphoreCount = 1;
+    signal_info.pSignalSemaphores = &last_batch.semaphore;
+  }
+  vkQueueSubmit(queue_, 1, &signal_info, last_batch.fence);
+}
+
+void GFXSubmitThread::ThreadMain() {
+  std::vector<Node*> nodes;
+  for (;;) {
+    uint32_t wake = wake_;
+    // Pushes before the stop request are visible to the drain below
+    bool stopping = stopping_;
+
+    nodes.clear();
+    while (Node* node = PopNode())
+      nodes.push_back(node);
+
+    if (!nodes.empty()) {
+      SubmitInternal(nodes);
+      for (auto* node : nodes)
+        delete node;
+      continue;
+    }
+
+    if (stopping)
+      return;
+
+    wake_.wait(wake);
+  }
+}
+
+}  // namespace vkgfx
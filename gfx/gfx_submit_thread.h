@@ -0,0 +1,75 @@
+// Copyright 2025 Admenri.
+// Use of this source code is governed by a MIT-style license that can be
+// found in the LICENSE file.
+
+#ifndef GFX_GFX_SUBMIT_THREAD_H_
+#define GFX_GFX_SUBMIT_THREAD_H_
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "gfx/gfx_config.h"
+
+namespace vkgfx {
+
+// Thread owning a VkQueue, so vkQueueSubmit never runs on API threads.
+// Batches are handed over through an intrusive lock free MPSC queue and
+// submitted in push order. Batches queued up while the thread was busy go
+// out together in one vkQueueSubmit, each signaling its timeline value if
+// it has one. A vkQueueSubmit only takes one fence, the fences of the other
+// batches are signaled by empty submissions behind it.
+class GFXSubmitThread {
+ public:
+  struct Batch {
+    std::vector<VkCommandBuffer> command_buffers;
+    VkFence fence = VK_NULL_HANDLE;
+    // Timeline semaphore set to |serial| once the batch executed
+    VkSemaphore semaphore = VK_NULL_HANDLE;
+    uint64_t serial = 0;
+  };
+
+  explicit GFXSubmitThread(VkQueue queue);
+  // Submits every batch pushed so far, then joins the thread. Nothing may
+  // be pushed concurrently.
+  ~GFXSubmitThread();
+
+  GFXSubmitThread(const GFXSubmitThread&) = delete;
+  GFXSubmitThread& operator=(const GFXSubmitThread&) = delete;
+
+  // Lock free, the order of pushes is the submission order.
+  void Push(Batch batch);
+
+  // First vkQueueSubmit failure since the last call, VK_SUCCESS if none.
+  VkResult TakeError() { return error_.exchange(VK_SUCCESS); }
+
+ private:
+  struct Node {
+    std::atomic<Node*> next = nullptr;
+    Batch batch;
+  };
+
+  void PushNode(Node* node);
+  // Consumer only, null when empty or a push is still being linked.
+  Node* PopNode();
+  void SubmitInternal(const std::vector<Node*>& nodes);
+  void ThreadMain();
+
+  VkQueue queue_;
+
+  // Producers swap |head_|, the thread alone walks from |tail_|
+  std::atomic<Node*> head_;
+  Node* tail_;
+  Node stub_;
+
+  // Bumped after every push and on shutdown, the thread sleeps on it
+  std::atomic<uint32_t> wake_ = 0;
+  std::atomic<bool> stopping_ = false;
+  std::atomic<VkResult> error_ = VK_SUCCESS;
+
+  std::thread thread_;
+};
+
+}  // namespace vkgfx
+
+#endif  // GFX_GFX_SUBMIT_THREAD_H_
@@ -4,6 +4,7 @@
 
 #include "gfx/gfx_texture.h"
 
+#include "gfx/gfx_texture_view.h"
 #include "gfx/gfx_utils.h"
 
 namespace vkgfx {
@@ -13,11 +14,25 @@ namespace vkgfx {
 
 GFXTexture::GFXTexture(VkImage image,
                        VmaAllocation allocation,
-                       RefPtr<GFXDevice> device,
-                       WGPUStringView label)
-    : image_(image), allocation_(allocation), device_(device) {
-  if (label.data && label.length)
-    label_ = std::string(label.data, label.length);
+                       const WGPUTextureDescriptor& descriptor,
+                       RefPtr<GFXDevice> device)
+    : image_(image),
+      allocation_(allocation),
+      size_(descriptor.size),
+      format_(descriptor.format),
+      dimension_(descriptor.dimension),
+      mip_level_count_(descriptor.mipLevelCount),
+      sample_count_(descriptor.sampleCount),
+      usage_(descriptor.usage),
+      state_(image,
+             ToVulkanImageAspect(WGPUTextureAspect_All, descriptor.format),
+             descriptor.mipLevelCount,
+             descriptor.dimension == WGPUTextureDimension_3D
+                 ? 1
+                 : descriptor.size.depthOrArrayLayers),
+      device_(device) {
+  if (descriptor.label.data && descriptor.label.length)
+    label_ = std::string(descriptor.label.data, descriptor.label.length);
 }
 
 GFXTexture::~GFXTexture() {
@@ -26,12 +41,91 @@ GFXTexture::~GFXTexture() {
 
 WGPUTextureView GFXTexture::CreateView(
     WGPUTextureViewDescriptor const* descriptor) {
-  return WGPUTextureView();
+  if (!image_ || !device_)
+    return nullptr;
+
+  // Resolve default values
+  WGPUTextureViewDescriptor view_descriptor = {};
+  if (descriptor)
+    view_descriptor = *descriptor;
+
+  const uint32_t array_layers =
+      dimension_ == WGPUTextureDimension_3D ? 1 : size_.depthOrArrayLayers;
+
+  if (view_descriptor.format == WGPUTextureFormat_Undefined)
+    view_descriptor.format = format_;
+  if (view_descriptor.mipLevelCount == WGPU_MIP_LEVEL_COUNT_UNDEFINED)
+    view_descriptor.mipLevelCount =
+        mip_level_count_ - view_descriptor.baseMipLevel;
+  if (view_descriptor.arrayLayerCount == WGPU_ARRAY_LAYER_COUNT_UNDEFINED)
+    view_descriptor.arrayLayerCount =
+        array_layers - view_descriptor.baseArrayLayer;
+  if (view_descriptor.usage == WGPUTextureUsage_None)
+    view_descriptor.usage = usage_;
+
+  if (view_descriptor.dimension == WGPUTextureViewDimension_Undefined) {
+    switch (dimension_) {
+      case WGPUTextureDimension_1D:
+        view_descriptor.dimension = WGPUTextureViewDimension_1D;
+        break;
+      default:
+      case WGPUTextureDimension_2D:
+        view_descriptor.dimension = view_descriptor.arrayLayerCount == 1
+                                        ? WGPUTextureViewDimension_2D
+                                        : WGPUTextureViewDimension_2DArray;
+        break;
+      case WGPUTextureDimension_3D:
+        view_descriptor.dimension = WGPUTextureViewDimension_3D;
+        break;
+    }
+  }
+
+  VkImageViewCreateInfo create_info = {
+      VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO};
+  create_info.image = image_;
+  create_info.viewType =
+      ToVulkanTextureViewDimension(view_descriptor.dimension);
+  create_info.format = ToVulkanPixelFormat(view_descriptor.format);
+  create_info.components = {
+      VK_COMPONENT_SWIZZLE_IDENTITY, VK_COMPONENT_SWIZZLE_IDENTITY,
+      VK_COMPONENT_SWIZZLE_IDENTITY, VK_COMPONENT_SWIZZLE_IDENTITY};
+  create_info.subresourceRange.aspectMask =
+      ToVulkanImageAspect(view_descriptor.aspect, view_descriptor.format);
+  create_info.subresourceRange.baseMipLevel = view_descriptor.baseMipLevel;
+  create_info.subresourceRange.levelCount = view_descriptor.mipLevelCount;
+  create_info.subresourceRange.baseArrayLayer = view_descriptor.baseArrayLayer;
+  create_info.subresourceRange.layerCount = view_descriptor.arrayLayerCount;
+
+  VkImageViewUsageCreateInfo usage_create_info = {
+      VK_STRUCTURE_TYPE_IMAGE_VIEW_USAGE_CREATE_INFO};
+  if (view_descriptor.usage != usage_) {
+    usage_create_info.usage =
+        ToVulkanImageUsage(view_descriptor.usage, view_descriptor.format);
+    NextChainBuilder(&create_info).Add(&usage_create_info);
+  }
+
+  VkImageView view;
+  if (vkCreateImageView(device_->GetVkHandle(), &create_info, nullptr,
+                        &view) != VK_SUCCESS)
+    return nullptr;
+
+  return AdaptExternalRefCounted(
+      new GFXTextureView(view, view_descriptor, this, device_));
 }
 
 void GFXTexture::Destroy() {
-  if (image_ && device_ && allocation_)
-    vmaDestroyImage(device_->GetAllocator(), image_, allocation_);
+  // Cached bind groups must not hand out views of a destroyed texture
+  if (device_ && device_->GetBindGroupCache())
+    device_->GetBindGroupCache()->EvictResource(this);
+
+  // Submissions still using the image keep it alive
+  if (image_ && device_ && allocation_) {
+    if (device_->GetResourceTracker())
+      device_->GetResourceTracker()->ReleaseImage(image_, allocation_,
+                                                  last_usage_serial_);
+    else
+      vmaDestroyImage(device_->GetAllocator(), image_, allocation_);
+  }
 
   image_ = nullptr;
   device_.reset();
@@ -39,35 +133,35 @@ void GFXTexture::Destroy() {
 }
 
 uint32_t GFXTexture::GetDepthOrArrayLayers() {
-  return 0;
+  return size_.depthOrArrayLayers;
 }
 
 WGPUTextureDimension GFXTexture::GetDimension() {
-  return WGPUTextureDimension();
+  return dimension_;
 }
 
 WGPUTextureFormat GFXTexture::GetFormat() {
-  return WGPUTextureFormat();
+  return format_;
 }
 
 uint32_t GFXTexture::GetHeight() {
-  return 0;
+  return size_.height;
 }
 
 uint32_t GFXTexture::GetMipLevelCount() {
-  return 0;
+  return mip_level_count_;
 }
 
 uint32_t GFXTexture::GetSampleCount() {
-  return 0;
+  return sample_count_;
 }
 
 WGPUTextureUsage GFXTexture::GetUsage() {
-  return WGPUTextureUsage();
+  return usage_;
 }
 
 uint32_t GFXTexture::GetWidth() {
-  return 0;
+  return size_.width;
 }
 
 void GFXTexture::SetLabel(WGPUStringView label) {
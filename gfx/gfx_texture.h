@@ -5,9 +5,12 @@
 #ifndef GFX_GFX_TEXTURE_H_
 #define GFX_GFX_TEXTURE_H_
 
+#include <atomic>
+
 #include "gfx/common/refptr.h"
 #include "gfx/gfx_config.h"
 #include "gfx/gfx_device.h"
+#include "gfx/gfx_texture_state.h"
 
 #include "vma/vma.h"
 
@@ -20,13 +23,24 @@ class GFXTexture : public RefCounted<GFXTexture>, public WGPUTextureImpl {
  public:
   GFXTexture(VkImage image,
              VmaAllocation allocation,
-             RefPtr<GFXDevice> device,
-             WGPUStringView label);
+             const WGPUTextureDescriptor& descriptor,
+             RefPtr<GFXDevice> device);
   ~GFXTexture();
 
   GFXTexture(const GFXTexture&) = delete;
   GFXTexture& operator=(const GFXTexture&) = delete;
 
+  VkImage GetVkHandle() const { return image_; }
+  RefPtr<GFXDevice> GetDevice() const { return device_; }
+
+  // Layouts and pending accesses of the subresources, updated under the
+  // queue lock by whoever records a usage of the image.
+  GFXTextureState* GetState() { return &state_; }
+
+  // Serial of the last queue submission using the image.
+  uint64_t GetLastUsageSerial() const { return last_usage_serial_; }
+  void SetLastUsageSerial(uint64_t serial) { last_usage_serial_ = serial; }
+
   WGPUTextureView CreateView(WGPUTextureViewDescriptor const* descriptor);
   void Destroy();
   uint32_t GetDepthOrArrayLayers();
@@ -42,6 +56,14 @@ class GFXTexture : public RefCounted<GFXTexture>, public WGPUTextureImpl {
  private:
   VkImage image_;
   VmaAllocation allocation_;
+  WGPUExtent3D size_;
+  WGPUTextureFormat format_;
+  WGPUTextureDimension dimension_;
+  uint32_t mip_level_count_;
+  uint32_t sample_count_;
+  WGPUTextureUsage usage_;
+  GFXTextureState state_;
+  std::atomic<uint64_t> last_usage_serial_ = 0;
 
   RefPtr<GFXDevice> device_;
 
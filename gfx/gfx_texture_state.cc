@@ -0,0 +1,314 @@
+// Copyright 2025 Admenri.
+// Use of this source code is governed by a MIT-style license that can be
+// found in the LICENSE file.
+
+#include "gfx/gfx_texture_state.h"
+
+#include <algorithm>
+
+#include "gfx/gfx_texture.h"
+
+namespace vkgfx {
+
+///////////////////////////////////////////////////////////////////////////////
+// GFXTextureState Implement
+
+bool GFXTextureState::State::operator==(const State& other) const {
+  return layout == other.layout && write_stages == other.write_stages &&
+         write_access == other.write_access &&
+         read_stages == other.read_stages &&
+         read_access == other.read_access &&
+         entry_layout == other.entry_layout &&
+         entry_stages == other.entry_stages &&
+         entry_access == other.entry_access && entry_open == other.entry_open;
+}
+
+bool GFXTextureState::Dependency::operator==(const Dependency& other) const {
+  return old_layout == other.old_layout && src_stages == other.src_stages &&
+         src_access == other.src_access;
+}
+
+GFXTextureState::GFXTextureState(VkImage image,
+                                 VkImageAspectFlags aspects,
+                                 uint32_t mip_level_count,
+                                 uint32_t array_layer_count,
+                                 VkImageLayout initial_layout)
+    : image_(image),
+      aspects_(aspects),
+      mip_level_count_(mip_level_count),
+      array_layer_count_(array_layer_count) {
+  state_.layout = initial_layout;
+}
+
+void GFXTextureState::Transition(const ImageRange& range,
+                                 const ImageAccess& access,
+                                 GFXBarrierBatch* batch) {
+  bool whole_image = range.base_mip_level == 0 &&
+                     range.mip_level_count == mip_level_count_ &&
+                     range.base_array_layer == 0 &&
+                     range.array_layer_count == array_layer_count_;
+  if (whole_image && IsCompressed()) {
+    Dependency dependency;
+    if (UpdateState(&state_, access, &dependency))
+      AddBarrierInternal(dependency, range, access, batch);
+    return;
+  }
+
+  if (IsCompressed())
+    subresources_.assign(mip_level_count_ * array_layer_count_, state_);
+
+  // Runs of layers sharing a dependency, extended over the mip levels
+  // below when those run over the same layers.
+  std::vector<PendingBarrier> barriers;
+  std::vector<PendingBarrier> level_runs;
+  uint32_t mip_end = range.base_mip_level + range.mip_level_count;
+  uint32_t layer_end = range.base_array_layer + range.array_layer_count;
+  for (uint32_t mip = range.base_mip_level; mip < mip_end; ++mip) {
+    level_runs.clear();
+    for (uint32_t layer = range.base_array_layer; layer < layer_end; ++layer) {
+      Dependency dependency;
+      if (!UpdateState(&GetSubresource(mip, layer), access, &dependency))
+        continue;
+
+      if (!level_runs.empty()) {
+        auto& last = level_runs.back();
+        if (last.dependency == dependency &&
+            last.range.base_array_layer + last.range.array_layer_count ==
+                layer) {
+          ++last.range.array_layer_count;
+          continue;
+        }
+      }
+      level_runs.push_back({dependency, {mip, 1, layer, 1}});
+    }
+
+    for (const auto& run : level_runs) {
+      auto it = std::find_if(
+          barriers.begin(), barriers.end(), [&](const PendingBarrier& other) {
+            const auto& other_range = other.range;
+            return other.dependency == run.dependency &&
+                   other_range.base_mip_level + other_range.mip_level_count ==
+                       mip &&
+                   other_range.base_array_layer ==
+                       run.range.base_array_layer &&
+                   other_range.array_layer_count ==
+                       run.range.array_layer_count;
+          });
+      if (it != barriers.end())
+        ++it->range.mip_level_count;
+      else
+        barriers.push_back(run);
+    }
+  }
+
+  for (const auto& it : barriers)
+    AddBarrierInternal(it.dependency, it.range, access, batch);
+
+  CompressInternal();
+}
+
+void GFXTextureState::Stitch(const GFXTextureState& next,
+                             GFXBarrierBatch* batch) {
+  if (next.IsCompressed()) {
+    StitchInternal({0, mip_level_count_, 0, array_layer_count_}, next.state_,
+                   batch);
+    return;
+  }
+
+  // Runs of layers |next| left in the same state share their transition
+  for (uint32_t mip = 0; mip < mip_level_count_; ++mip) {
+    uint32_t run_begin = 0;
+    for (uint32_t layer = 1; layer <= array_layer_count_; ++layer) {
+      const State& state = next.GetSubresource(mip, run_begin);
+      if (layer < array_layer_count_ &&
+          next.GetSubresource(mip, layer) == state)
+        continue;
+
+      StitchInternal({mip, 1, run_begin, layer - run_begin}, state, batch);
+      run_begin = layer;
+    }
+  }
+}
+
+VkImageLayout GFXTextureState::GetLayout(uint32_t mip_level,
+                                         uint32_t array_layer) const {
+  if (IsCompressed())
+    return state_.layout;
+
+  return subresources_[mip_level * array_layer_count_ + array_layer].layout;
+}
+
+// static
+bool GFXTextureState::UpdateState(State* state,
+                                  const ImageAccess& access,
+                                  Dependency* dependency) {
+  bool writes = access.access & kWriteAccessMask;
+
+  if (state->layout == kUnknownLayout) {
+    // First usage in a command buffer, Stitch synchronizes it on submit
+    state->entry_layout = access.layout;
+    state->entry_stages = access.stages;
+    state->entry_access = access.access;
+    state->entry_open = !writes;
+
+    state->layout = access.layout;
+    if (writes) {
+      state->write_stages = access.stages;
+      state->write_access = access.access & kWriteAccessMask;
+      state->read_stages = 0;
+      state->read_access = 0;
+    } else {
+      state->write_stages = 0;
+      state->write_access = 0;
+      state->read_stages = access.stages;
+      state->read_access = access.access;
+    }
+    return false;
+  }
+
+  bool layout_change = state->layout != access.layout;
+  if (state->entry_open) {
+    // Reads following the first usage are covered by the same barrier
+    if (!writes && !layout_change) {
+      state->entry_stages |= access.stages;
+      state->entry_access |= access.access;
+    } else {
+      state->entry_open = false;
+    }
+  }
+
+  if (!writes && !layout_change) {
+    // Reads wait for the last write once per stage and access
+    bool visible = !state->write_stages ||
+                   (!(access.stages & ~state->read_stages) &&
+                    !(access.access & ~state->read_access));
+    dependency->old_layout = state->layout;
+    dependency->src_stages = state->write_stages;
+    dependency->src_access = state->write_access;
+    state->read_stages |= access.stages;
+    state->read_access |= access.access;
+    return !visible;
+  }
+
+  // Writes and transitions wait for every access since the last write
+  bool idle = !state->write_stages && !state->read_stages;
+  dependency->old_layout = state->layout;
+  dependency->src_stages = state->write_stages | state->read_stages;
+  dependency->src_access = state->write_access;
+
+  state->layout = access.layout;
+  state->write_stages = access.stages;
+  if (writes) {
+    state->write_access = access.access & kWriteAccessMask;
+    state->read_stages = 0;
+    state->read_access = 0;
+  } else {
+    state->write_access = 0;
+    state->read_stages = access.stages;
+    state->read_access = access.access;
+  }
+
+  return layout_change || !idle;
+}
+
+void GFXTextureState::AddBarrierInternal(const Dependency& dependency,
+                                         const ImageRange& range,
+                                         const ImageAccess& access,
+                                         GFXBarrierBatch* batch) {
+  VkImageMemoryBarrier barrier = {VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER};
+  barrier.srcAccessMask = dependency.src_access;
+  barrier.dstAccessMask = access.access;
+  barrier.oldLayout = dependency.old_layout;
+  barrier.newLayout = access.layout;
+  barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  barrier.image = image_;
+  barrier.subresourceRange.aspectMask = aspects_;
+  barrier.subresourceRange.baseMipLevel = range.base_mip_level;
+  barrier.subresourceRange.levelCount = range.mip_level_count;
+  barrier.subresourceRange.baseArrayLayer = range.base_array_layer;
+  barrier.subresourceRange.layerCount = range.array_layer_count;
+  batch->AddImageBarrier(barrier, dependency.src_stages, access.stages);
+}
+
+void GFXTextureState::StitchInternal(const ImageRange& range,
+                                     const State& next,
+                                     GFXBarrierBatch* batch) {
+  // Not used by the command buffer
+  if (next.layout == kUnknownLayout)
+    return;
+
+  Transition(range, {next.entry_layout, next.entry_stages, next.entry_access},
+             batch);
+
+  // Only read in the entry layout, the transition above left the state
+  // the command buffer ends with.
+  if (next.entry_open)
+    return;
+
+  State exit = next;
+  exit.entry_layout = kUnknownLayout;
+  exit.entry_stages = 0;
+  exit.entry_access = 0;
+  exit.entry_open = false;
+
+  if (IsCompressed() && range.mip_level_count == mip_level_count_ &&
+      range.array_layer_count == array_layer_count_) {
+    state_ = exit;
+    return;
+  }
+
+  if (IsCompressed())
+    subresources_.assign(mip_level_count_ * array_layer_count_, state_);
+
+  uint32_t mip_end = range.base_mip_level + range.mip_level_count;
+  uint32_t layer_end = range.base_array_layer + range.array_layer_count;
+  for (uint32_t mip = range.base_mip_level; mip < mip_end; ++mip)
+    for (uint32_t layer = range.base_array_layer; layer < layer_end; ++layer)
+      GetSubresource(mip, layer) = exit;
+
+  CompressInternal();
+}
+
+void GFXTextureState::CompressInternal() {
+  // Collapse back once the subresources agree again
+  if (std::all_of(subresources_.begin(), subresources_.end(),
+                  [&](const State& it) { return it == subresources_[0]; })) {
+    state_ = subresources_[0];
+    subresources_.clear();
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// GFXTextureUsageTracker Implement
+
+void GFXTextureUsageTracker::Transition(GFXTexture* texture,
+                                        const ImageRange& range,
+                                        const ImageAccess& access,
+                                        GFXBarrierBatch* batch) {
+  auto& usage = textures_[texture];
+  if (!usage.state) {
+    // Image, aspects and extents of the texture state never change
+    const GFXTextureState* texture_state = texture->GetState();
+    usage.texture = texture;
+    usage.state = std::make_unique<GFXTextureState>(
+        texture_state->GetImage(), texture_state->GetAspects(),
+        texture_state->GetMipLevelCount(),
+        texture_state->GetArrayLayerCount(),
+        GFXTextureState::kUnknownLayout);
+  }
+
+  usage.state->Transition(range, access, batch);
+}
+
+std::vector<GFXTextureUsageTracker::TextureUsage>
+GFXTextureUsageTracker::TakeUsages() {
+  std::vector<TextureUsage> usages;
+  usages.reserve(textures_.size());
+  for (auto& it : textures_)
+    usages.push_back(std::move(it.second));
+  textures_.clear();
+  return usages;
+}
+
+}  // namespace vkgfx
@@ -0,0 +1,180 @@
+// Copyright 2025 Admenri.
+// Use of this source code is governed by a MIT-style license that can be
+// found in the LICENSE file.
+
+#ifndef GFX_GFX_TEXTURE_STATE_H_
+#define GFX_GFX_TEXTURE_STATE_H_
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "gfx/common/refptr.h"
+#include "gfx/gfx_barrier_batch.h"
+#include "gfx/gfx_config.h"
+
+namespace vkgfx {
+
+class GFXTexture;
+
+// Layout, stages and accesses one usage of an image needs.
+struct ImageAccess {
+  VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+  VkPipelineStageFlags stages = 0;
+  VkAccessFlags access = 0;
+};
+
+// Mip levels and array layers touched by a usage, aspects are tracked
+// together.
+struct ImageRange {
+  uint32_t base_mip_level = 0;
+  uint32_t mip_level_count = 0;
+  uint32_t base_array_layer = 0;
+  uint32_t array_layer_count = 0;
+};
+
+// Per subresource synchronization state of a texture.
+// The state is kept as a single entry while every subresource agrees, so
+// whole image usage costs O(1), and only expanded to one entry per mip level
+// and array layer once a usage touches part of the image. Transitions append
+// the barriers a usage needs to a batch: read after read in an already
+// visible layout needs none, adjacent subresources with the same transition
+// share one barrier.
+// States recorded by command encoders start out in kUnknownLayout: the first
+// usage of a subresource records no barrier but is remembered, together with
+// the reads in the same layout following it, for Stitch to synchronize once
+// the state before the command buffer is known.
+class GFXTextureState {
+ public:
+  // Layout of subresources whose state is set by an earlier command buffer
+  static constexpr VkImageLayout kUnknownLayout = VK_IMAGE_LAYOUT_MAX_ENUM;
+
+  GFXTextureState(VkImage image,
+                  VkImageAspectFlags aspects,
+                  uint32_t mip_level_count,
+                  uint32_t array_layer_count,
+                  VkImageLayout initial_layout = VK_IMAGE_LAYOUT_UNDEFINED);
+  ~GFXTextureState() = default;
+
+  GFXTextureState(const GFXTextureState&) = delete;
+  GFXTextureState& operator=(const GFXTextureState&) = delete;
+
+  // Moves |range| to |access|, appending the barriers required to |batch|.
+  void Transition(const ImageRange& range,
+                  const ImageAccess& access,
+                  GFXBarrierBatch* batch);
+
+  // Appends to |batch| what |next|, recorded from kUnknownLayout, needs to
+  // run after this state, then takes over the subresources |next| wrote or
+  // transitioned.
+  void Stitch(const GFXTextureState& next, GFXBarrierBatch* batch);
+
+  VkImageLayout GetLayout(uint32_t mip_level, uint32_t array_layer) const;
+  bool IsCompressed() const { return subresources_.empty(); }
+
+  VkImage GetImage() const { return image_; }
+  VkImageAspectFlags GetAspects() const { return aspects_; }
+  uint32_t GetMipLevelCount() const { return mip_level_count_; }
+  uint32_t GetArrayLayerCount() const { return array_layer_count_; }
+
+ private:
+  struct State {
+    VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+    // Last write, layout transitions count as writes with no access
+    VkPipelineStageFlags write_stages = 0;
+    VkAccessFlags write_access = 0;
+    // Reads since the last write which already waited for it
+    VkPipelineStageFlags read_stages = 0;
+    VkAccessFlags read_access = 0;
+    // First usage out of kUnknownLayout, and the reads in the same layout
+    // following it
+    VkImageLayout entry_layout = kUnknownLayout;
+    VkPipelineStageFlags entry_stages = 0;
+    VkAccessFlags entry_access = 0;
+    bool entry_open = false;
+
+    bool operator==(const State& other) const;
+  };
+
+  // Source half of a barrier, subresources sharing it are merged
+  struct Dependency {
+    VkImageLayout old_layout;
+    VkPipelineStageFlags src_stages;
+    VkAccessFlags src_access;
+
+    bool operator==(const Dependency& other) const;
+  };
+
+  struct PendingBarrier {
+    Dependency dependency;
+    ImageRange range;
+  };
+
+  // Applies |access| to |state|, returns true with |dependency| filled if a
+  // barrier is needed first.
+  static bool UpdateState(State* state,
+                          const ImageAccess& access,
+                          Dependency* dependency);
+
+  void AddBarrierInternal(const Dependency& dependency,
+                          const ImageRange& range,
+                          const ImageAccess& access,
+                          GFXBarrierBatch* batch);
+  void StitchInternal(const ImageRange& range,
+                      const State& next,
+                      GFXBarrierBatch* batch);
+  void CompressInternal();
+  State& GetSubresource(uint32_t mip_level, uint32_t array_layer) {
+    return subresources_[mip_level * array_layer_count_ + array_layer];
+  }
+  const State& GetSubresource(uint32_t mip_level,
+                              uint32_t array_layer) const {
+    if (IsCompressed())
+      return state_;
+    return subresources_[mip_level * array_layer_count_ + array_layer];
+  }
+
+  VkImage image_;
+  VkImageAspectFlags aspects_;
+  uint32_t mip_level_count_;
+  uint32_t array_layer_count_;
+
+  // Shared state while compressed
+  State state_;
+  // Mip major state of every subresource, empty while compressed
+  std::vector<State> subresources_;
+};
+
+// Textures used by one command encoder, each tracked from kUnknownLayout
+// without any lock. GFXQueue::Submit stitches the states into the ones of the
+// textures.
+class GFXTextureUsageTracker {
+ public:
+  struct TextureUsage {
+    RefPtr<GFXTexture> texture;
+    std::unique_ptr<GFXTextureState> state;
+  };
+
+  GFXTextureUsageTracker() = default;
+  ~GFXTextureUsageTracker() = default;
+
+  GFXTextureUsageTracker(const GFXTextureUsageTracker&) = delete;
+  GFXTextureUsageTracker& operator=(const GFXTextureUsageTracker&) = delete;
+
+  // Moves |range| of |texture| to |access|, appending the barriers required
+  // to |batch|.
+  void Transition(GFXTexture* texture,
+                  const ImageRange& range,
+                  const ImageAccess& access,
+                  GFXBarrierBatch* batch);
+
+  // Every texture used so far, once each, with the state it was left in.
+  std::vector<TextureUsage> TakeUsages();
+
+ private:
+  std::unordered_map<GFXTexture*, TextureUsage> textures_;
+};
+
+}  // namespace vkgfx
+
+#endif  // GFX_GFX_TEXTURE_STATE_H_
@@ -4,14 +4,51 @@
 
 #include "gfx/gfx_texture_view.h"
 
+#include "gfx/gfx_utils.h"
+
 namespace vkgfx {
 
 ///////////////////////////////////////////////////////////////////////////////
 // GFXTextureView Implement
 
-GFXTextureView::GFXTextureView() {}
+GFXTextureView::GFXTextureView(VkImageView view,
+                               const WGPUTextureViewDescriptor& descriptor,
+                               RefPtr<GFXTexture> texture,
+                               RefPtr<GFXDevice> device)
+    : view_(view),
+      format_(descriptor.format),
+      base_mip_level_(descriptor.baseMipLevel),
+      mip_level_count_(descriptor.mipLevelCount),
+      base_array_layer_(descriptor.baseArrayLayer),
+      array_layer_count_(descriptor.arrayLayerCount),
+      texture_(texture),
+      device_(device) {
+  // Same derivation as the image and VkImageViewUsageCreateInfo
+  if (descriptor.usage == texture_->GetUsage())
+    usage_ = ToVulkanImageUsage(texture_->GetUsage(), texture_->GetFormat());
+  else
+    usage_ = ToVulkanImageUsage(descriptor.usage, descriptor.format);
+
+  if (descriptor.label.data && descriptor.label.length)
+    label_ = std::string(descriptor.label.data, descriptor.label.length);
+}
+
+GFXTextureView::~GFXTextureView() {
+  if (device_->GetBindGroupCache())
+    device_->GetBindGroupCache()->EvictResource(this);
+
+  // Views are only used by the GPU along with their texture, so are the
+  // framebuffers built on them
+  const uint64_t serial = texture_->GetLastUsageSerial();
+  if (view_ && device_->GetRenderPassCache())
+    device_->GetRenderPassCache()->EvictImageView(
+        view_, serial, device_->GetResourceTracker());
 
-GFXTextureView::~GFXTextureView() {}
+  if (view_ && device_->GetResourceTracker())
+    device_->GetResourceTracker()->ReleaseImageView(view_, serial);
+  else if (view_)
+    vkDestroyImageView(device_->GetVkHandle(), view_, nullptr);
+}
 
 void GFXTextureView::SetLabel(WGPUStringView label) {
   label_ = std::string(label.data, label.length);
@@ -7,6 +7,8 @@
 
 #include "gfx/common/refptr.h"
 #include "gfx/gfx_config.h"
+#include "gfx/gfx_device.h"
+#include "gfx/gfx_texture.h"
 
 struct WGPUTextureViewImpl {};
 
@@ -16,18 +18,40 @@ namespace vkgfx {
 class GFXTextureView : public RefCounted<GFXTextureView>,
                        public WGPUTextureViewImpl {
  public:
-  GFXTextureView();
+  GFXTextureView(VkImageView view,
+                 const WGPUTextureViewDescriptor& descriptor,
+                 RefPtr<GFXTexture> texture,
+                 RefPtr<GFXDevice> device);
   ~GFXTextureView();
 
   GFXTextureView(const GFXTextureView&) = delete;
   GFXTextureView& operator=(const GFXTextureView&) = delete;
 
+  VkImageView GetVkHandle() const { return view_; }
+  GFXTexture* GetTexture() const { return texture_.get(); }
+  WGPUTextureFormat GetFormat() const { return format_; }
+  uint32_t GetBaseMipLevel() const { return base_mip_level_; }
+  uint32_t GetMipLevelCount() const { return mip_level_count_; }
+  uint32_t GetBaseArrayLayer() const { return base_array_layer_; }
+  uint32_t GetArrayLayerCount() const { return array_layer_count_; }
+  // Effective usage of the view, the image usage unless restricted
+  VkImageUsageFlags GetVkUsage() const { return usage_; }
+
   void SetLabel(WGPUStringView label);
 
  private:
   VkImageView view_;
+  WGPUTextureFormat format_;
+  uint32_t base_mip_level_;
+  uint32_t mip_level_count_;
+  uint32_t base_array_layer_;
+  uint32_t array_layer_count_;
+  VkImageUsageFlags usage_;
+
+  RefPtr<GFXTexture> texture_;
+  RefPtr<GFXDevice> device_;
 
-  std::string label_;
+  std::string label_ = "GFX.TextureView";
 };
 
 }  // namespace vkgfx
@@ -67,6 +67,37 @@ VkImageUsageFlags ToVulkanImageUsage(WGPUTextureUsage usage,
   return flags;
 }
 
+VkImageAspectFlags ToVulkanImageAspect(WGPUTextureAspect aspect,
+                                       WGPUTextureFormat format) {
+  VkImageAspectFlags format_aspects = 0;
+  switch (format) {
+    case WGPUTextureFormat_Stencil8:
+      format_aspects = VK_IMAGE_ASPECT_STENCIL_BIT;
+      break;
+    case WGPUTextureFormat_Depth16Unorm:
+    case WGPUTextureFormat_Depth24Plus:
+    case WGPUTextureFormat_Depth32Float:
+      format_aspects = VK_IMAGE_ASPECT_DEPTH_BIT;
+      break;
+    case WGPUTextureFormat_Depth24PlusStencil8:
+    case WGPUTextureFormat_Depth32FloatStencil8:
+      format_aspects = VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT;
+      break;
+    default:
+      format_aspects = VK_IMAGE_ASPECT_COLOR_BIT;
+      break;
+  }
+
+  switch (aspect) {
+    case WGPUTextureAspect_DepthOnly:
+      return format_aspects & VK_IMAGE_ASPECT_DEPTH_BIT;
+    case WGPUTextureAspect_StencilOnly:
+      return format_aspects & VK_IMAGE_ASPECT_STENCIL_BIT;
+    default:
+      return format_aspects;
+  }
+}
+
 VkCompareOp ToVulkanCompareOp(WGPUCompareFunction op) {
   switch (op) {
     case WGPUCompareFunction_Never:
@@ -99,9 +130,9 @@ VkSamplerAddressMode ToVulkanSamplerAddressMode(WGPUAddressMode mode) {
     case WGPUAddressMode_MirrorRepeat:
       return VK_SAMPLER_ADDRESS_MODE_MIRRORED_REPEAT;
     case WGPUAddressMode_ClampToEdge:
-      return VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
     case WGPUAddressMode_Undefined:
-      break;
+      // Default of GPUSamplerDescriptor
+      return VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
   }
   return VkSamplerAddressMode();
 }
@@ -423,6 +454,409 @@ VkImageViewType ToVulkanTextureViewDimension(
       return VK_IMAGE_VIEW_TYPE_3D;
     case WGPUTextureViewDimension_2DArray:
       return VK_IMAGE_VIEW_TYPE_2D_ARRAY;
+    case WGPUTextureViewDimension_Cube:
+      return VK_IMAGE_VIEW_TYPE_CUBE;
+    case WGPUTextureViewDimension_CubeArray:
+      return VK_IMAGE_VIEW_TYPE_CUBE_ARRAY;
+  }
+}
+
+VkFormat ToVulkanVertexFormat(WGPUVertexFormat format) {
+  switch (format) {
+    case WGPUVertexFormat_Uint8:
+      return VK_FORMAT_R8_UINT;
+    case WGPUVertexFormat_Uint8x2:
+      return VK_FORMAT_R8G8_UINT;
+    case WGPUVertexFormat_Uint8x4:
+      return VK_FORMAT_R8G8B8A8_UINT;
+    case WGPUVertexFormat_Sint8:
+      return VK_FORMAT_R8_SINT;
+    case WGPUVertexFormat_Sint8x2:
+      return VK_FORMAT_R8G8_SINT;
+    case WGPUVertexFormat_Sint8x4:
+      return VK_FORMAT_R8G8B8A8_SINT;
+    case WGPUVertexFormat_Unorm8:
+      return VK_FORMAT_R8_UNORM;
+    case WGPUVertexFormat_Unorm8x2:
+      return VK_FORMAT_R8G8_UNORM;
+    case WGPUVertexFormat_Unorm8x4:
+      return VK_FORMAT_R8G8B8A8_UNORM;
+    case WGPUVertexFormat_Snorm8:
+      return VK_FORMAT_R8_SNORM;
+    case WGPUVertexFormat_Snorm8x2:
+      return VK_FORMAT_R8G8_SNORM;
+    case WGPUVertexFormat_Snorm8x4:
+      return VK_FORMAT_R8G8B8A8_SNORM;
+    case WGPUVertexFormat_Uint16:
+      return VK_FORMAT_R16_UINT;
+    case WGPUVertexFormat_Uint16x2:
+      return VK_FORMAT_R16G16_UINT;
+    case WGPUVertexFormat_Uint16x4:
+      return VK_FORMAT_R16G16B16A16_UINT;
+    case WGPUVertexFormat_Sint16:
+      return VK_FORMAT_R16_SINT;
+    case WGPUVertexFormat_Sint16x2:
+      return VK_FORMAT_R16G16_SINT;
+    case WGPUVertexFormat_Sint16x4:
+      return VK_FORMAT_R16G16B16A16_SINT;
+    case WGPUVertexFormat_Unorm16:
+      return VK_FORMAT_R16_UNORM;
+    case WGPUVertexFormat_Unorm16x2:
+      return VK_FORMAT_R16G16_UNORM;
+    case WGPUVertexFormat_Unorm16x4:
+      return VK_FORMAT_R16G16B16A16_UNORM;
+    case WGPUVertexFormat_Snorm16:
+      return VK_FORMAT_R16_SNORM;
+    case WGPUVertexFormat_Snorm16x2:
+      return VK_FORMAT_R16G16_SNORM;
+    case WGPUVertexFormat_Snorm16x4:
+      return VK_FORMAT_R16G16B16A16_SNORM;
+    case WGPUVertexFormat_Float16:
+      return VK_FORMAT_R16_SFLOAT;
+    case WGPUVertexFormat_Float16x2:
+      return VK_FORMAT_R16G16_SFLOAT;
+    case WGPUVertexFormat_Float16x4:
+      return VK_FORMAT_R16G16B16A16_SFLOAT;
+    case WGPUVertexFormat_Float32:
+      return VK_FORMAT_R32_SFLOAT;
+    case WGPUVertexFormat_Float32x2:
+      return VK_FORMAT_R32G32_SFLOAT;
+    case WGPUVertexFormat_Float32x3:
+      return VK_FORMAT_R32G32B32_SFLOAT;
+    case WGPUVertexFormat_Float32x4:
+      return VK_FORMAT_R32G32B32A32_SFLOAT;
+    case WGPUVertexFormat_Uint32:
+      return VK_FORMAT_R32_UINT;
+    case WGPUVertexFormat_Uint32x2:
+      return VK_FORMAT_R32G32_UINT;
+    case WGPUVertexFormat_Uint32x3:
+      return VK_FORMAT_R32G32B32_UINT;
+    case WGPUVertexFormat_Uint32x4:
+      return VK_FORMAT_R32G32B32A32_UINT;
+    case WGPUVertexFormat_Sint32:
+      return VK_FORMAT_R32_SINT;
+    case WGPUVertexFormat_Sint32x2:
+      return VK_FORMAT_R32G32_SINT;
+    case WGPUVertexFormat_Sint32x3:
+      return VK_FORMAT_R32G32B32_SINT;
+    case WGPUVertexFormat_Sint32x4:
+      return VK_FORMAT_R32G32B32A32_SINT;
+    case WGPUVertexFormat_Unorm10_10_10_2:
+      return VK_FORMAT_A2B10G10R10_UNORM_PACK32;
+    case WGPUVertexFormat_Unorm8x4BGRA:
+      return VK_FORMAT_B8G8R8A8_UNORM;
+    default:
+      return VK_FORMAT_UNDEFINED;
+  }
+}
+
+VkPrimitiveTopology ToVulkanPrimitiveTopology(WGPUPrimitiveTopology topology) {
+  switch (topology) {
+    case WGPUPrimitiveTopology_PointList:
+      return VK_PRIMITIVE_TOPOLOGY_POINT_LIST;
+    case WGPUPrimitiveTopology_LineList:
+      return VK_PRIMITIVE_TOPOLOGY_LINE_LIST;
+    case WGPUPrimitiveTopology_LineStrip:
+      return VK_PRIMITIVE_TOPOLOGY_LINE_STRIP;
+    case WGPUPrimitiveTopology_TriangleStrip:
+      return VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP;
+    default:
+    case WGPUPrimitiveTopology_TriangleList:
+      return VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+  }
+}
+
+VkCullModeFlags ToVulkanCullMode(WGPUCullMode mode) {
+  switch (mode) {
+    case WGPUCullMode_Front:
+      return VK_CULL_MODE_FRONT_BIT;
+    case WGPUCullMode_Back:
+      return VK_CULL_MODE_BACK_BIT;
+    default:
+    case WGPUCullMode_None:
+      return VK_CULL_MODE_NONE;
+  }
+}
+
+VkFrontFace ToVulkanFrontFace(WGPUFrontFace face) {
+  switch (face) {
+    case WGPUFrontFace_CW:
+      return VK_FRONT_FACE_CLOCKWISE;
+    default:
+    case WGPUFrontFace_CCW:
+      return VK_FRONT_FACE_COUNTER_CLOCKWISE;
+  }
+}
+
+VkStencilOp ToVulkanStencilOp(WGPUStencilOperation op) {
+  switch (op) {
+    case WGPUStencilOperation_Zero:
+      return VK_STENCIL_OP_ZERO;
+    case WGPUStencilOperation_Replace:
+      return VK_STENCIL_OP_REPLACE;
+    case WGPUStencilOperation_Invert:
+      return VK_STENCIL_OP_INVERT;
+    case WGPUStencilOperation_IncrementClamp:
+      return VK_STENCIL_OP_INCREMENT_AND_CLAMP;
+    case WGPUStencilOperation_DecrementClamp:
+      return VK_STENCIL_OP_DECREMENT_AND_CLAMP;
+    case WGPUStencilOperation_IncrementWrap:
+      return VK_STENCIL_OP_INCREMENT_AND_WRAP;
+    case WGPUStencilOperation_DecrementWrap:
+      return VK_STENCIL_OP_DECREMENT_AND_WRAP;
+    default:
+    case WGPUStencilOperation_Keep:
+      return VK_STENCIL_OP_KEEP;
+  }
+}
+
+VkBlendFactor ToVulkanBlendFactor(WGPUBlendFactor factor) {
+  switch (factor) {
+    case WGPUBlendFactor_Zero:
+      return VK_BLEND_FACTOR_ZERO;
+    case WGPUBlendFactor_Src:
+      return VK_BLEND_FACTOR_SRC_COLOR;
+    case WGPUBlendFactor_OneMinusSrc:
+      return VK_BLEND_FACTOR_ONE_MINUS_SRC_COLOR;
+    case WGPUBlendFactor_SrcAlpha:
+      return VK_BLEND_FACTOR_SRC_ALPHA;
+    case WGPUBlendFactor_OneMinusSrcAlpha:
+      return VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+    case WGPUBlendFactor_Dst:
+      return VK_BLEND_FACTOR_DST_COLOR;
+    case WGPUBlendFactor_OneMinusDst:
+      return VK_BLEND_FACTOR_ONE_MINUS_DST_COLOR;
+    case WGPUBlendFactor_DstAlpha:
+      return VK_BLEND_FACTOR_DST_ALPHA;
+    case WGPUBlendFactor_OneMinusDstAlpha:
+      return VK_BLEND_FACTOR_ONE_MINUS_DST_ALPHA;
+    case WGPUBlendFactor_SrcAlphaSaturated:
+      return VK_BLEND_FACTOR_SRC_ALPHA_SATURATE;
+    case WGPUBlendFactor_Constant:
+      return VK_BLEND_FACTOR_CONSTANT_COLOR;
+    case WGPUBlendFactor_OneMinusConstant:
+      return VK_BLEND_FACTOR_ONE_MINUS_CONSTANT_COLOR;
+    case WGPUBlendFactor_Src1:
+      return VK_BLEND_FACTOR_SRC1_COLOR;
+    case WGPUBlendFactor_OneMinusSrc1:
+      return VK_BLEND_FACTOR_ONE_MINUS_SRC1_COLOR;
+    case WGPUBlendFactor_Src1Alpha:
+      return VK_BLEND_FACTOR_SRC1_ALPHA;
+    case WGPUBlendFactor_OneMinusSrc1Alpha:
+      return VK_BLEND_FACTOR_ONE_MINUS_SRC1_ALPHA;
+    default:
+    case WGPUBlendFactor_One:
+      return VK_BLEND_FACTOR_ONE;
+  }
+}
+
+VkBlendOp ToVulkanBlendOp(WGPUBlendOperation op) {
+  switch (op) {
+    case WGPUBlendOperation_Subtract:
+      return VK_BLEND_OP_SUBTRACT;
+    case WGPUBlendOperation_ReverseSubtract:
+      return VK_BLEND_OP_REVERSE_SUBTRACT;
+    case WGPUBlendOperation_Min:
+      return VK_BLEND_OP_MIN;
+    case WGPUBlendOperation_Max:
+      return VK_BLEND_OP_MAX;
+    default:
+    case WGPUBlendOperation_Add:
+      return VK_BLEND_OP_ADD;
+  }
+}
+
+VkColorComponentFlags ToVulkanColorWriteMask(WGPUColorWriteMask mask) {
+  VkColorComponentFlags flags = 0;
+
+  if (mask & WGPUColorWriteMask_Red) {
+    flags |= VK_COLOR_COMPONENT_R_BIT;
+  }
+  if (mask & WGPUColorWriteMask_Green) {
+    flags |= VK_COLOR_COMPONENT_G_BIT;
+  }
+  if (mask & WGPUColorWriteMask_Blue) {
+    flags |= VK_COLOR_COMPONENT_B_BIT;
+  }
+  if (mask & WGPUColorWriteMask_Alpha) {
+    flags |= VK_COLOR_COMPONENT_A_BIT;
+  }
+
+  return flags;
+}
+
+VkAttachmentLoadOp ToVulkanLoadOp(WGPULoadOp op) {
+  switch (op) {
+    case WGPULoadOp_Load:
+      return VK_ATTACHMENT_LOAD_OP_LOAD;
+    case WGPULoadOp_Clear:
+      return VK_ATTACHMENT_LOAD_OP_CLEAR;
+    default:
+    case WGPULoadOp_Undefined:
+      return VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+  }
+}
+
+VkAttachmentStoreOp ToVulkanStoreOp(WGPUStoreOp op) {
+  switch (op) {
+    case WGPUStoreOp_Store:
+      return VK_ATTACHMENT_STORE_OP_STORE;
+    default:
+    case WGPUStoreOp_Discard:
+    case WGPUStoreOp_Undefined:
+      return VK_ATTACHMENT_STORE_OP_DONT_CARE;
+  }
+}
+
+bool GetTexelBlockInfo(WGPUTextureFormat format,
+                       WGPUTextureAspect aspect,
+                       TexelBlockInfo* info) {
+  auto set_info = [info](uint32_t byte_size, uint32_t width = 1,
+                         uint32_t height = 1) {
+    info->width = width;
+    info->height = height;
+    info->byte_size = byte_size;
+    return true;
+  };
+
+  // Combined formats copy one aspect at a time
+  switch (format) {
+    case WGPUTextureFormat_Stencil8:
+      return aspect != WGPUTextureAspect_DepthOnly && set_info(1);
+    case WGPUTextureFormat_Depth16Unorm:
+      return aspect != WGPUTextureAspect_StencilOnly && set_info(2);
+    case WGPUTextureFormat_Depth32Float:
+      return aspect != WGPUTextureAspect_StencilOnly && set_info(4);
+    case WGPUTextureFormat_Depth24Plus:
+      return false;
+    case WGPUTextureFormat_Depth24PlusStencil8:
+      return aspect == WGPUTextureAspect_StencilOnly && set_info(1);
+    case WGPUTextureFormat_Depth32FloatStencil8:
+      if (aspect == WGPUTextureAspect_StencilOnly)
+        return set_info(1);
+      return aspect == WGPUTextureAspect_DepthOnly && set_info(4);
+    default:
+      break;
+  }
+
+  switch (format) {
+    case WGPUTextureFormat_R8Unorm:
+    case WGPUTextureFormat_R8Snorm:
+    case WGPUTextureFormat_R8Uint:
+    case WGPUTextureFormat_R8Sint:
+      return set_info(1);
+    case WGPUTextureFormat_R16Uint:
+    case WGPUTextureFormat_R16Sint:
+    case WGPUTextureFormat_R16Unorm:
+    case WGPUTextureFormat_R16Snorm:
+    case WGPUTextureFormat_R16Float:
+    case WGPUTextureFormat_RG8Unorm:
+    case WGPUTextureFormat_RG8Snorm:
+    case WGPUTextureFormat_RG8Uint:
+    case WGPUTextureFormat_RG8Sint:
+      return set_info(2);
+    case WGPUTextureFormat_R32Float:
+    case WGPUTextureFormat_R32Uint:
+    case WGPUTextureFormat_R32Sint:
+    case WGPUTextureFormat_RG16Uint:
+    case WGPUTextureFormat_RG16Sint:
+    case WGPUTextureFormat_RG16Unorm:
+    case WGPUTextureFormat_RG16Snorm:
+    case WGPUTextureFormat_RG16Float:
+    case WGPUTextureFormat_RGBA8Unorm:
+    case WGPUTextureFormat_RGBA8UnormSrgb:
+    case WGPUTextureFormat_RGBA8Snorm:
+    case WGPUTextureFormat_RGBA8Uint:
+    case WGPUTextureFormat_RGBA8Sint:
+    case WGPUTextureFormat_BGRA8Unorm:
+    case WGPUTextureFormat_BGRA8UnormSrgb:
+    case WGPUTextureFormat_RGB10A2Uint:
+    case WGPUTextureFormat_RGB10A2Unorm:
+    case WGPUTextureFormat_RG11B10Ufloat:
+    case WGPUTextureFormat_RGB9E5Ufloat:
+      return set_info(4);
+    case WGPUTextureFormat_RG32Float:
+    case WGPUTextureFormat_RG32Uint:
+    case WGPUTextureFormat_RG32Sint:
+    case WGPUTextureFormat_RGBA16Uint:
+    case WGPUTextureFormat_RGBA16Sint:
+    case WGPUTextureFormat_RGBA16Unorm:
+    case WGPUTextureFormat_RGBA16Snorm:
+    case WGPUTextureFormat_RGBA16Float:
+      return set_info(8);
+    case WGPUTextureFormat_RGBA32Float:
+    case WGPUTextureFormat_RGBA32Uint:
+    case WGPUTextureFormat_RGBA32Sint:
+      return set_info(16);
+    case WGPUTextureFormat_BC1RGBAUnorm:
+    case WGPUTextureFormat_BC1RGBAUnormSrgb:
+    case WGPUTextureFormat_BC4RUnorm:
+    case WGPUTextureFormat_BC4RSnorm:
+    case WGPUTextureFormat_ETC2RGB8Unorm:
+    case WGPUTextureFormat_ETC2RGB8UnormSrgb:
+    case WGPUTextureFormat_ETC2RGB8A1Unorm:
+    case WGPUTextureFormat_ETC2RGB8A1UnormSrgb:
+    case WGPUTextureFormat_EACR11Unorm:
+    case WGPUTextureFormat_EACR11Snorm:
+      return set_info(8, 4, 4);
+    case WGPUTextureFormat_BC2RGBAUnorm:
+    case WGPUTextureFormat_BC2RGBAUnormSrgb:
+    case WGPUTextureFormat_BC3RGBAUnorm:
+    case WGPUTextureFormat_BC3RGBAUnormSrgb:
+    case WGPUTextureFormat_BC5RGUnorm:
+    case WGPUTextureFormat_BC5RGSnorm:
+    case WGPUTextureFormat_BC6HRGBUfloat:
+    case WGPUTextureFormat_BC6HRGBFloat:
+    case WGPUTextureFormat_BC7RGBAUnorm:
+    case WGPUTextureFormat_BC7RGBAUnormSrgb:
+    case WGPUTextureFormat_ETC2RGBA8Unorm:
+    case WGPUTextureFormat_ETC2RGBA8UnormSrgb:
+    case WGPUTextureFormat_EACRG11Unorm:
+    case WGPUTextureFormat_EACRG11Snorm:
+    case WGPUTextureFormat_ASTC4x4Unorm:
+    case WGPUTextureFormat_ASTC4x4UnormSrgb:
+      return set_info(16, 4, 4);
+    case WGPUTextureFormat_ASTC5x4Unorm:
+    case WGPUTextureFormat_ASTC5x4UnormSrgb:
+      return set_info(16, 5, 4);
+    case WGPUTextureFormat_ASTC5x5Unorm:
+    case WGPUTextureFormat_ASTC5x5UnormSrgb:
+      return set_info(16, 5, 5);
+    case WGPUTextureFormat_ASTC6x5Unorm:
+    case WGPUTextureFormat_ASTC6x5UnormSrgb:
+      return set_info(16, 6, 5);
+    case WGPUTextureFormat_ASTC6x6Unorm:
+    case WGPUTextureFormat_ASTC6x6UnormSrgb:
+      return set_info(16, 6, 6);
+    case WGPUTextureFormat_ASTC8x5Unorm:
+    case WGPUTextureFormat_ASTC8x5UnormSrgb:
+      return set_info(16, 8, 5);
+    case WGPUTextureFormat_ASTC8x6Unorm:
+    case WGPUTextureFormat_ASTC8x6UnormSrgb:
+      return set_info(16, 8, 6);
+    case WGPUTextureFormat_ASTC8x8Unorm:
+    case WGPUTextureFormat_ASTC8x8UnormSrgb:
+      return set_info(16, 8, 8);
+    case WGPUTextureFormat_ASTC10x5Unorm:
+    case WGPUTextureFormat_ASTC10x5UnormSrgb:
+      return set_info(16, 10, 5);
+    case WGPUTextureFormat_ASTC10x6Unorm:
+    case WGPUTextureFormat_ASTC10x6UnormSrgb:
+      return set_info(16, 10, 6);
+    case WGPUTextureFormat_ASTC10x8Unorm:
+    case WGPUTextureFormat_ASTC10x8UnormSrgb:
+      return set_info(16, 10, 8);
+    case WGPUTextureFormat_ASTC10x10Unorm:
+    case WGPUTextureFormat_ASTC10x10UnormSrgb:
+      return set_info(16, 10, 10);
+    case WGPUTextureFormat_ASTC12x10Unorm:
+    case WGPUTextureFormat_ASTC12x10UnormSrgb:
+      return set_info(16, 12, 10);
+    case WGPUTextureFormat_ASTC12x12Unorm:
+    case WGPUTextureFormat_ASTC12x12UnormSrgb:
+      return set_info(16, 12, 12);
+    default:
+      return false;
   }
 }
 
@@ -8,6 +8,7 @@
 #include <functional>
 #include <string>
 #include <string_view>
+#include <type_traits>
 
 #include "gfx/gfx_config.h"
 
@@ -17,6 +18,8 @@ namespace vkgfx {
 VkSampleCountFlagBits ToVulkanSampleCount(uint32_t samples);
 VkImageUsageFlags ToVulkanImageUsage(WGPUTextureUsage usage,
                                      WGPUTextureFormat format);
+VkImageAspectFlags ToVulkanImageAspect(WGPUTextureAspect aspect,
+                                       WGPUTextureFormat format);
 
 // Constants convert
 VkCompareOp ToVulkanCompareOp(WGPUCompareFunction op);
@@ -29,6 +32,45 @@ VkBufferUsageFlags ToVulkanBufferUsage(WGPUBufferUsage usage);
 VkFormat ToVulkanPixelFormat(WGPUTextureFormat format);
 VkImageViewType ToVulkanTextureViewDimension(
     WGPUTextureViewDimension dimension);
+VkFormat ToVulkanVertexFormat(WGPUVertexFormat format);
+VkPrimitiveTopology ToVulkanPrimitiveTopology(WGPUPrimitiveTopology topology);
+VkCullModeFlags ToVulkanCullMode(WGPUCullMode mode);
+VkFrontFace ToVulkanFrontFace(WGPUFrontFace face);
+VkStencilOp ToVulkanStencilOp(WGPUStencilOperation op);
+VkBlendFactor ToVulkanBlendFactor(WGPUBlendFactor factor);
+VkBlendOp ToVulkanBlendOp(WGPUBlendOperation op);
+VkColorComponentFlags ToVulkanColorWriteMask(WGPUColorWriteMask mask);
+VkAttachmentLoadOp ToVulkanLoadOp(WGPULoadOp op);
+VkAttachmentStoreOp ToVulkanStoreOp(WGPUStoreOp op);
+
+// Texel block layout of |aspect| of |format| in buffer copies, false for
+// aspects without a defined buffer layout (e.g. depth24plus).
+struct TexelBlockInfo {
+  uint32_t width = 1;
+  uint32_t height = 1;
+  uint32_t byte_size = 0;
+};
+bool GetTexelBlockInfo(WGPUTextureFormat format,
+                       WGPUTextureAspect aspect,
+                       TexelBlockInfo* info);
+
+// Hash combine utility
+template <typename Ty>
+inline void HashCombine(size_t* seed, const Ty& value) {
+  *seed ^= std::hash<Ty>()(value) + 0x9e3779b9 + (*seed << 6) + (*seed >> 2);
+}
+
+// Binary key utility, |value| must have no padding bytes
+template <typename Ty>
+inline void AppendKey(std::string* key, const Ty& value) {
+  static_assert(std::is_trivially_copyable_v<Ty>);
+  key->append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+inline void AppendKey(std::string* key, std::string_view value) {
+  AppendKey(key, value.size());
+  key->append(value);
+}
 
 // External ref_counted adapt
 template <class Ty>
@@ -57,6 +99,10 @@ inline std::string_view FromWGPUStringView(const WGPUStringView& view) {
   if (!view.data || !view.length)
     return std::string_view();
 
+  // Null terminated
+  if (view.length == WGPU_STRLEN)
+    return std::string_view(view.data);
+
   return std::string_view(view.data, view.length);
 }
 
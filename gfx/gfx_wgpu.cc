@@ -138,7 +138,7 @@ void GetInstanceFeatures(WGPUSupportedInstanceFeatures* features) {
 
 // static
 WGPUStatus GetInstanceLimits(WGPUInstanceLimits* limits) {
-  limits->timedWaitAnyMaxCount = std::numeric_limits<size_t>::max();
+  limits->timedWaitAnyMaxCount = GFXInstance::kTimedWaitAnyMaxCount;
   return WGPUStatus_Success;
 }
 
@@ -0,0 +1,68 @@
+// Copyright 2025 Admenri.
+// Use of this source code is governed by a MIT-style license that can be
+// found in the LICENSE file.
+
+#include "gfx/gfx_worker_pool.h"
+
+#include <algorithm>
+
+namespace vkgfx {
+
+///////////////////////////////////////////////////////////////////////////////
+// GFXWorkerPool Implement
+
+GFXWorkerPool::GFXWorkerPool(uint32_t thread_count)
+    : state_(std::make_shared<State>()) {
+  for (uint32_t i = 0; i < std::max<uint32_t>(thread_count, 1); ++i)
+    threads_.emplace_back(&GFXWorkerPool::WorkerMain, state_);
+}
+
+GFXWorkerPool::~GFXWorkerPool() {
+  {
+    std::lock_guard guard(state_->lock);
+    state_->stopping = true;
+  }
+  state_->task_posted.notify_all();
+
+  for (auto& it : threads_) {
+    if (it.get_id() == std::this_thread::get_id())
+      it.detach();
+    else
+      it.join();
+  }
+}
+
+void GFXWorkerPool::PostTask(Task task) {
+  {
+    std::lock_guard guard(state_->lock);
+    state_->tasks.push_back(std::move(task));
+  }
+  state_->task_posted.notify_one();
+}
+
+// static
+uint32_t GFXWorkerPool::GetDefaultThreadCount() {
+  const uint32_t core_count = std::thread::hardware_concurrency();
+  return std::clamp<uint32_t>(core_count / 2, 1, 4);
+}
+
+// static
+void GFXWorkerPool::WorkerMain(std::shared_ptr<State> state) {
+  for (;;) {
+    Task task;
+    {
+      std::unique_lock guard(state->lock);
+      state->task_posted.wait(
+          guard, [&]() { return state->stopping || !state->tasks.empty(); });
+      if (state->tasks.empty())
+        return;
+
+      task = std::move(state->tasks.front());
+      state->tasks.pop_front();
+    }
+
+    task();
+  }
+}
+
+}  // namespace vkgfx
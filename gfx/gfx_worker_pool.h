@@ -0,0 +1,55 @@
+// Copyright 2025 Admenri.
+// Use of this source code is governed by a MIT-style license that can be
+// found in the LICENSE file.
+
+#ifndef GFX_GFX_WORKER_POOL_H_
+#define GFX_GFX_WORKER_POOL_H_
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace vkgfx {
+
+// Fixed size pool of background threads for CPU heavy device work such as
+// pipeline compilation. Tasks queued before destruction still run.
+class GFXWorkerPool {
+ public:
+  using Task = std::function<void()>;
+
+  explicit GFXWorkerPool(uint32_t thread_count);
+  ~GFXWorkerPool();
+
+  GFXWorkerPool(const GFXWorkerPool&) = delete;
+  GFXWorkerPool& operator=(const GFXWorkerPool&) = delete;
+
+  uint32_t GetThreadCount() const { return threads_.size(); }
+
+  void PostTask(Task task);
+
+  // Default size, leaves the remaining cores to the application
+  static uint32_t GetDefaultThreadCount();
+
+ private:
+  // Shared with the threads, a pool released from one of its own tasks
+  // detaches that thread instead of joining it.
+  struct State {
+    std::mutex lock;
+    std::condition_variable task_posted;
+    std::deque<Task> tasks;
+    bool stopping = false;
+  };
+
+  static void WorkerMain(std::shared_ptr<State> state);
+
+  std::shared_ptr<State> state_;
+  std::vector<std::thread> threads_;
+};
+
+}  // namespace vkgfx
+
+#endif  // GFX_GFX_WORKER_POOL_H_
@@ -0,0 +1,221 @@
+#include <array>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include "gfx/gfx_bind_group.h"
+#include "gfx/gfx_bind_group_layout.h"
+#include "gfx/gfx_buffer.h"
+#include "gfx/gfx_descriptor_allocator.h"
+#include "gfx/gfx_device.h"
+#include "gfx/gfx_sampler.h"
+#include "webgpu/webgpu_cpp.hpp"
+
+namespace {
+
+constexpr uint32_t kBufferBindingCount = 8;
+constexpr uint32_t kSamplerBindingCount = 4;
+constexpr uint32_t kBindingCount = kBufferBindingCount + kSamplerBindingCount;
+constexpr uint32_t kIterations = 100000;
+// Bind groups written per timed batch, each needs a fresh descriptor set
+constexpr uint32_t kBatchSize = 1000;
+
+template <typename Fn>
+double MeasureNanosecondsPerWrite(Fn&& fn) {
+  auto begin = std::chrono::steady_clock::now();
+  for (uint32_t i = 0; i < kIterations; ++i)
+    fn();
+  auto end = std::chrono::steady_clock::now();
+
+  return std::chrono::duration<double, std::nano>(end - begin).count() /
+         kIterations;
+}
+
+}  // namespace
+
+int main() {
+  auto instance = wgpu::CreateInstance(nullptr);
+
+  wgpu::Adapter adapter = nullptr;
+  instance.RequestAdapter(
+      nullptr,
+      {
+          .callback =
+              [](WGPURequestAdapterStatus status, WGPUAdapter adapter,
+                 WGPUStringView message, void* userdata1, void* userdata2) {
+                *reinterpret_cast<wgpu::Adapter*>(userdata1) =
+                    wgpu::Adapter::Acquire(adapter);
+              },
+          .userdata1 = &adapter,
+      });
+
+  wgpu::Device device = nullptr;
+  adapter.RequestDevice(
+      nullptr,
+      {
+          .callback =
+              [](WGPURequestDeviceStatus status, WGPUDevice device,
+                 WGPUStringView message, void* userdata1, void* userdata2) {
+                *reinterpret_cast<wgpu::Device*>(userdata1) =
+                    wgpu::Device::Acquire(device);
+              },
+          .userdata1 = &device,
+      });
+
+  // Layout: uniform buffers followed by filtering samplers
+  std::array<WGPUBindGroupLayoutEntry, kBindingCount> layout_entries = {};
+  for (uint32_t i = 0; i < kBindingCount; ++i) {
+    auto& entry = layout_entries[i];
+    entry.binding = i;
+    entry.visibility = WGPUShaderStage_Compute;
+    if (i < kBufferBindingCount)
+      entry.buffer.type = WGPUBufferBindingType_Uniform;
+    else
+      entry.sampler.type = WGPUSamplerBindingType_Filtering;
+  }
+
+  WGPUBindGroupLayoutDescriptor layout_descriptor = {};
+  layout_descriptor.entryCount = layout_entries.size();
+  layout_descriptor.entries = layout_entries.data();
+  WGPUBindGroupLayout layout =
+      wgpuDeviceCreateBindGroupLayout(device.Get(), &layout_descriptor);
+
+  WGPUBufferDescriptor buffer_descriptor = {};
+  buffer_descriptor.usage = WGPUBufferUsage_Uniform;
+  buffer_descriptor.size = 256 * kBufferBindingCount;
+  WGPUBuffer buffer = wgpuDeviceCreateBuffer(device.Get(), &buffer_descriptor);
+
+  WGPUSamplerDescriptor sampler_descriptor = {};
+  sampler_descriptor.lodMaxClamp = 32.0f;
+  sampler_descriptor.maxAnisotropy = 1;
+  WGPUSampler sampler =
+      wgpuDeviceCreateSampler(device.Get(), &sampler_descriptor);
+
+  auto* device_impl = static_cast<vkgfx::GFXDevice*>(device.Get());
+  auto* layout_impl = static_cast<vkgfx::GFXBindGroupLayout*>(layout);
+  auto* buffer_impl = static_cast<vkgfx::GFXBuffer*>(buffer);
+  auto* sampler_impl = static_cast<vkgfx::GFXSampler*>(sampler);
+
+  vkgfx::GFXDescriptorAllocator::Allocation allocation;
+  if (!device_impl->GetDescriptorAllocator()->Allocate(layout_impl,
+                                                       &allocation)) {
+    std::cout << "[Bench] Failed to allocate descriptor set.\n";
+    return 1;
+  }
+
+  VkDevice vk_device = device_impl->GetVkHandle();
+  // The buffer may be suballocated, descriptors address its own range
+  const VkDeviceSize buffer_offset = buffer_impl->GetOffset();
+
+  // Baseline: write info arrays and vkUpdateDescriptorSets. Both sides fill
+  // fixed arrays, so only the update itself differs.
+  std::array<VkDescriptorBufferInfo, kBufferBindingCount> buffer_infos;
+  std::array<VkDescriptorImageInfo, kSamplerBindingCount> image_infos;
+  std::array<VkWriteDescriptorSet, kBindingCount> write_infos;
+  double write_sets_ns = MeasureNanosecondsPerWrite([&]() {
+    for (uint32_t i = 0; i < kBindingCount; ++i) {
+      auto& write_info = write_infos[i];
+      write_info = {VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET};
+      write_info.dstSet = allocation.set;
+      write_info.dstBinding = i;
+      write_info.descriptorCount = 1;
+      if (i < kBufferBindingCount) {
+        write_info.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        buffer_infos[i] = {buffer_impl->GetVkHandle(),
+                           buffer_offset + 256 * i, 256};
+        write_info.pBufferInfo = &buffer_infos[i];
+      } else {
+        write_info.descriptorType = VK_DESCRIPTOR_TYPE_SAMPLER;
+        image_infos[i - kBufferBindingCount] = {sampler_impl->GetVkHandle(),
+                                                VK_NULL_HANDLE,
+                                                VK_IMAGE_LAYOUT_UNDEFINED};
+        write_info.pImageInfo = &image_infos[i - kBufferBindingCount];
+      }
+    }
+
+    vkUpdateDescriptorSets(vk_device, write_infos.size(), write_infos.data(),
+                           0, nullptr);
+  });
+
+  // Template: flat payload and vkUpdateDescriptorSetWithTemplate
+  std::array<vkgfx::GFXBindGroupLayout::DescriptorInfo, kBindingCount>
+      payload;
+  double template_ns = MeasureNanosecondsPerWrite([&]() {
+    for (uint32_t i = 0; i < kBindingCount; ++i) {
+      if (i < kBufferBindingCount) {
+        payload[i].buffer = {buffer_impl->GetVkHandle(),
+                             buffer_offset + 256 * i, 256};
+      } else {
+        payload[i].image = {sampler_impl->GetVkHandle(), VK_NULL_HANDLE,
+                            VK_IMAGE_LAYOUT_UNDEFINED};
+      }
+    }
+
+    vkUpdateDescriptorSetWithTemplate(vk_device, allocation.set,
+                                      layout_impl->GetUpdateTemplate(),
+                                      payload.data());
+  });
+
+  // GFXBindGroup::Write, validation and tracking included. Sets are
+  // allocated and released outside of the timed loop.
+  std::array<WGPUBindGroupEntry, kBindingCount> entries = {};
+  for (uint32_t i = 0; i < kBindingCount; ++i) {
+    entries[i].binding = i;
+    if (i < kBufferBindingCount) {
+      entries[i].buffer = buffer;
+      entries[i].offset = 256 * i;
+      entries[i].size = 256;
+    } else {
+      entries[i].sampler = sampler;
+    }
+  }
+
+  WGPUBindGroupDescriptor bind_group_descriptor = {};
+  bind_group_descriptor.layout = layout;
+  bind_group_descriptor.entryCount = entries.size();
+  bind_group_descriptor.entries = entries.data();
+
+  std::vector<std::unique_ptr<vkgfx::GFXBindGroup>> bind_groups(kBatchSize);
+  std::chrono::steady_clock::duration bind_group_time = {};
+  for (uint32_t batch = 0; batch < kIterations / kBatchSize; ++batch) {
+    for (auto& bind_group : bind_groups) {
+      vkgfx::GFXDescriptorAllocator::Allocation set_allocation;
+      if (!device_impl->GetDescriptorAllocator()->Allocate(layout_impl,
+                                                           &set_allocation)) {
+        std::cout << "[Bench] Failed to allocate descriptor set.\n";
+        return 1;
+      }
+      bind_group = std::make_unique<vkgfx::GFXBindGroup>(
+          set_allocation, layout_impl, device_impl, WGPUStringView{});
+    }
+
+    auto begin = std::chrono::steady_clock::now();
+    for (auto& bind_group : bind_groups)
+      bind_group->Write(&bind_group_descriptor);
+    bind_group_time += std::chrono::steady_clock::now() - begin;
+
+    for (auto& bind_group : bind_groups)
+      bind_group.reset();
+  }
+  double bind_group_ns =
+      std::chrono::duration<double, std::nano>(bind_group_time).count() /
+      (kIterations / kBatchSize * kBatchSize);
+
+  std::cout << "[Bench] " << kBindingCount << " bindings, " << kIterations
+            << " writes\n";
+  std::cout << "[Bench] vkUpdateDescriptorSets: " << write_sets_ns
+            << " ns/write\n";
+  std::cout << "[Bench] vkUpdateDescriptorSetWithTemplate: " << template_ns
+            << " ns/write\n";
+  std::cout << "[Bench] GFXBindGroup::Write: " << bind_group_ns
+            << " ns/write\n";
+
+  device_impl->GetDescriptorAllocator()->Free(layout_impl, allocation);
+
+  wgpuSamplerRelease(sampler);
+  wgpuBufferRelease(buffer);
+  wgpuBindGroupLayoutRelease(layout);
+
+  return 0;
+}
@@ -0,0 +1,156 @@
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <vector>
+
+#include "gfx/gfx_adapter.h"
+#include "gfx/gfx_device.h"
+#include "gfx/gfx_pipeline_cache.h"
+#include "webgpu/webgpu_cpp.hpp"
+
+// Cold vs warm compute pipeline creation through GFXPipelineCache.
+// Intended to run on lavapipe (VK_ICD_FILENAMES=.../lvp_icd.*.json) where
+// shader compilation dominates pipeline creation.
+
+namespace {
+
+constexpr uint32_t kPipelineCount = 64;
+
+// Empty GLSL450 compute entry point "main" with the given local size, each
+// size is a distinct shader for the driver.
+std::vector<uint32_t> MakeComputeShader(uint32_t local_size_x) {
+  return {
+      0x07230203, 0x00010000, 0, 5, 0,
+      // OpCapability Shader
+      0x00020011, 1,
+      // OpMemoryModel Logical GLSL450
+      0x0003000E, 0, 1,
+      // OpEntryPoint GLCompute %3 "main"
+      0x0005000F, 5, 3, 0x6E69616D, 0,
+      // OpExecutionMode %3 LocalSize x 1 1
+      0x00060010, 3, 17, local_size_x, 1, 1,
+      // %1 = OpTypeVoid
+      0x00020013, 1,
+      // %2 = OpTypeFunction %1
+      0x00030021, 2, 1,
+      // %3 = OpFunction %1 None %2
+      0x00050036, 1, 3, 0, 2,
+      // %4 = OpLabel
+      0x000200F8, 4,
+      // OpReturn
+      0x000100FD,
+      // OpFunctionEnd
+      0x00010038,
+  };
+}
+
+double CreatePipelines(VkDevice device,
+                       VkPipelineLayout layout,
+                       vkgfx::GFXPipelineCache* cache) {
+  auto begin = std::chrono::steady_clock::now();
+  for (uint32_t i = 0; i < kPipelineCount; ++i) {
+    auto code = MakeComputeShader(i + 1);
+
+    VkShaderModuleCreateInfo module_info = {
+        VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO};
+    module_info.codeSize = code.size() * sizeof(uint32_t);
+    module_info.pCode = code.data();
+
+    VkShaderModule module;
+    vkCreateShaderModule(device, &module_info, nullptr, &module);
+
+    VkComputePipelineCreateInfo pipeline_info = {
+        VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO};
+    pipeline_info.stage.sType =
+        VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    pipeline_info.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    pipeline_info.stage.module = module;
+    pipeline_info.stage.pName = "main";
+    pipeline_info.layout = layout;
+
+    VkPipeline pipeline;
+    VkPipelineCache pipeline_cache = cache->AcquireCache();
+    vkCreateComputePipelines(device, pipeline_cache, 1, &pipeline_info,
+                             nullptr, &pipeline);
+    cache->ReleaseCache(pipeline_cache);
+
+    vkDestroyPipeline(device, pipeline, nullptr);
+    vkDestroyShaderModule(device, module, nullptr);
+  }
+  auto end = std::chrono::steady_clock::now();
+
+  return std::chrono::duration<double, std::milli>(end - begin).count();
+}
+
+}  // namespace
+
+int main() {
+  auto instance = wgpu::CreateInstance(nullptr);
+
+  wgpu::Adapter adapter = nullptr;
+  instance.RequestAdapter(
+      nullptr,
+      {
+          .callback =
+              [](WGPURequestAdapterStatus status, WGPUAdapter adapter,
+                 WGPUStringView message, void* userdata1, void* userdata2) {
+                *reinterpret_cast<wgpu::Adapter*>(userdata1) =
+                    wgpu::Adapter::Acquire(adapter);
+              },
+          .userdata1 = &adapter,
+      });
+
+  wgpu::Device device = nullptr;
+  adapter.RequestDevice(
+      nullptr,
+      {
+          .callback =
+              [](WGPURequestDeviceStatus status, WGPUDevice device,
+                 WGPUStringView message, void* userdata1, void* userdata2) {
+                *reinterpret_cast<wgpu::Device*>(userdata1) =
+                    wgpu::Device::Acquire(device);
+              },
+          .userdata1 = &device,
+      });
+
+  auto* adapter_impl = static_cast<vkgfx::GFXAdapter*>(adapter.Get());
+  auto* device_impl = static_cast<vkgfx::GFXDevice*>(device.Get());
+  const auto& properties =
+      adapter_impl->GetDeviceInfo().properties.properties;
+  VkDevice vk_device = device_impl->GetVkHandle();
+
+  VkPipelineLayoutCreateInfo layout_info = {
+      VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO};
+  VkPipelineLayout layout;
+  vkCreatePipelineLayout(vk_device, &layout_info, nullptr, &layout);
+
+  auto cache_path = std::filesystem::temp_directory_path() /
+                    "vkgfx_bench_pipeline_cache.bin";
+  std::filesystem::remove(cache_path);
+
+  double cold_ms = 0.0;
+  {
+    vkgfx::GFXPipelineCache cache(vk_device, properties, cache_path);
+    cold_ms = CreatePipelines(vk_device, layout, &cache);
+    if (!cache.Save()) {
+      std::cout << "[Bench] Failed to save pipeline cache.\n";
+      return 1;
+    }
+  }
+
+  double warm_ms = 0.0;
+  {
+    vkgfx::GFXPipelineCache cache(vk_device, properties, cache_path);
+    warm_ms = CreatePipelines(vk_device, layout, &cache);
+  }
+
+  std::cout << "[Bench] " << properties.deviceName << ", " << kPipelineCount
+            << " compute pipelines\n";
+  std::cout << "[Bench] Cold: " << cold_ms << " ms\n";
+  std::cout << "[Bench] Warm: " << warm_ms << " ms\n";
+
+  vkDestroyPipelineLayout(vk_device, layout, nullptr);
+  std::filesystem::remove(cache_path);
+
+  return 0;
+}
@@ -0,0 +1,101 @@
+#include <chrono>
+#include <iostream>
+
+#include "gfx/gfx_adapter.h"
+#include "gfx/gfx_queue.h"
+#include "webgpu/webgpu_cpp.hpp"
+
+// Time the calling thread spends in Queue::Submit with vkQueueSubmit on the
+// calling thread vs handed to the submit thread. Each frame submits
+// kSubmitsPerFrame small command buffers one by one, then waits for them
+// outside of the measured time. The wait polls the queue, vkDeviceWaitIdle
+// would race with the submit thread.
+
+namespace {
+
+constexpr uint32_t kSubmitsPerFrame = 16;
+constexpr uint32_t kFrames = 200;
+
+double MeasureMicrosecondsPerSubmit(wgpu::Device& device,
+                                    wgpu::Queue& queue,
+                                    wgpu::Buffer& buffer) {
+  auto* queue_impl = static_cast<vkgfx::GFXQueue*>(queue.Get());
+  std::chrono::steady_clock::duration submit_time = {};
+  for (uint32_t frame = 0; frame < kFrames; ++frame) {
+    for (uint32_t i = 0; i < kSubmitsPerFrame; ++i) {
+      wgpu::CommandEncoder encoder = device.CreateCommandEncoder();
+      encoder.ClearBuffer(buffer, 0, 256);
+      wgpu::CommandBuffer commands = encoder.Finish();
+
+      auto begin = std::chrono::steady_clock::now();
+      queue.Submit(1, &commands);
+      submit_time += std::chrono::steady_clock::now() - begin;
+    }
+
+    uint64_t last_serial = queue_impl->GetPendingSerial() - 1;
+    while (queue_impl->GetCompletedSerial() < last_serial)
+      queue_impl->Tick();
+  }
+
+  return std::chrono::duration<double, std::micro>(submit_time).count() /
+         (kFrames * kSubmitsPerFrame);
+}
+
+}  // namespace
+
+int main() {
+  auto instance = wgpu::CreateInstance(nullptr);
+
+  wgpu::Adapter adapter = nullptr;
+  instance.RequestAdapter(
+      nullptr,
+      {
+          .callback =
+              [](WGPURequestAdapterStatus status, WGPUAdapter adapter,
+                 WGPUStringView message, void* userdata1, void* userdata2) {
+                *reinterpret_cast<wgpu::Adapter*>(userdata1) =
+                    wgpu::Adapter::Acquire(adapter);
+              },
+          .userdata1 = &adapter,
+      });
+
+  wgpu::Device device = nullptr;
+  adapter.RequestDevice(
+      nullptr,
+      {
+          .callback =
+              [](WGPURequestDeviceStatus status, WGPUDevice device,
+                 WGPUStringView message, void* userdata1, void* userdata2) {
+                *reinterpret_cast<wgpu::Device*>(userdata1) =
+                    wgpu::Device::Acquire(device);
+              },
+          .userdata1 = &device,
+      });
+
+  auto* adapter_impl = static_cast<vkgfx::GFXAdapter*>(adapter.Get());
+  wgpu::Queue queue = device.GetQueue();
+  auto* queue_impl = static_cast<vkgfx::GFXQueue*>(queue.Get());
+
+  wgpu::BufferDescriptor buffer_descriptor;
+  buffer_descriptor.usage = wgpu::BufferUsage::CopyDst;
+  buffer_descriptor.size = 256;
+  wgpu::Buffer buffer = device.CreateBuffer(&buffer_descriptor);
+
+  std::cout << "[Bench] "
+            << adapter_impl->GetDeviceInfo().properties.properties.deviceName
+            << ", " << kSubmitsPerFrame << " submits x " << kFrames
+            << " frames\n";
+
+  queue_impl->SetSubmitThreadEnabled(false);
+  double direct_us = MeasureMicrosecondsPerSubmit(device, queue, buffer);
+
+  queue_impl->SetSubmitThreadEnabled(true);
+  double threaded_us = MeasureMicrosecondsPerSubmit(device, queue, buffer);
+  queue_impl->SetSubmitThreadEnabled(false);
+
+  std::cout << "[Bench] Submit: calling thread: " << direct_us
+            << " us/submit, submit thread: " << threaded_us
+            << " us/submit\n";
+
+  return 0;
+}
@@ -0,0 +1,107 @@
+#include <array>
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+#include "gfx/gfx_adapter.h"
+#include "gfx/gfx_device.h"
+#include "gfx/gfx_queue.h"
+#include "webgpu/webgpu_cpp.hpp"
+
+// Queue write throughput through vkCmdUpdateBuffer vs the staging ring, per
+// write size. Each frame records kWritesPerFrame writes into ranges spaced
+// apart so the queue cannot coalesce them, submits and waits for the device,
+// so GPU side cost is included.
+
+namespace {
+
+constexpr std::array<size_t, 8> kWriteSizes = {
+    16, 64, 256, 1024, 4096, 16384, 32768, 65536,
+};
+constexpr uint32_t kWritesPerFrame = 64;
+constexpr uint32_t kFrames = 100;
+
+double MeasureNanosecondsPerWrite(VkDevice device,
+                                  wgpu::Queue& queue,
+                                  wgpu::Buffer& buffer,
+                                  size_t write_size) {
+  std::vector<uint8_t> data(write_size, 0x5A);
+
+  auto begin = std::chrono::steady_clock::now();
+  for (uint32_t frame = 0; frame < kFrames; ++frame) {
+    for (uint32_t i = 0; i < kWritesPerFrame; ++i)
+      queue.WriteBuffer(buffer, i * 2 * write_size, data.data(), write_size);
+    queue.Submit(0, nullptr);
+    vkDeviceWaitIdle(device);
+  }
+  auto end = std::chrono::steady_clock::now();
+
+  return std::chrono::duration<double, std::nano>(end - begin).count() /
+         (kFrames * kWritesPerFrame);
+}
+
+}  // namespace
+
+int main() {
+  auto instance = wgpu::CreateInstance(nullptr);
+
+  wgpu::Adapter adapter = nullptr;
+  instance.RequestAdapter(
+      nullptr,
+      {
+          .callback =
+              [](WGPURequestAdapterStatus status, WGPUAdapter adapter,
+                 WGPUStringView message, void* userdata1, void* userdata2) {
+                *reinterpret_cast<wgpu::Adapter*>(userdata1) =
+                    wgpu::Adapter::Acquire(adapter);
+              },
+          .userdata1 = &adapter,
+      });
+
+  wgpu::Device device = nullptr;
+  adapter.RequestDevice(
+      nullptr,
+      {
+          .callback =
+              [](WGPURequestDeviceStatus status, WGPUDevice device,
+                 WGPUStringView message, void* userdata1, void* userdata2) {
+                *reinterpret_cast<wgpu::Device*>(userdata1) =
+                    wgpu::Device::Acquire(device);
+              },
+          .userdata1 = &device,
+      });
+
+  auto* adapter_impl = static_cast<vkgfx::GFXAdapter*>(adapter.Get());
+  auto* device_impl = static_cast<vkgfx::GFXDevice*>(device.Get());
+  VkDevice vk_device = device_impl->GetVkHandle();
+
+  wgpu::Queue queue = device.GetQueue();
+  auto* queue_impl = static_cast<vkgfx::GFXQueue*>(queue.Get());
+
+  wgpu::BufferDescriptor buffer_descriptor;
+  buffer_descriptor.usage =
+      wgpu::BufferUsage::Uniform | wgpu::BufferUsage::CopyDst;
+  buffer_descriptor.size = kWriteSizes.back() * 2 * kWritesPerFrame;
+  wgpu::Buffer buffer = device.CreateBuffer(&buffer_descriptor);
+
+  std::cout << "[Bench] "
+            << adapter_impl->GetDeviceInfo().properties.properties.deviceName
+            << ", " << kWritesPerFrame << " writes x " << kFrames
+            << " frames\n";
+
+  for (size_t write_size : kWriteSizes) {
+    queue_impl->SetInlineWriteThreshold(vkgfx::GFXQueue::kMaxInlineWriteSize);
+    double inline_ns =
+        MeasureNanosecondsPerWrite(vk_device, queue, buffer, write_size);
+
+    queue_impl->SetInlineWriteThreshold(0);
+    double staging_ns =
+        MeasureNanosecondsPerWrite(vk_device, queue, buffer, write_size);
+
+    std::cout << "[Bench] " << write_size
+              << " bytes: vkCmdUpdateBuffer: " << inline_ns
+              << " ns/write, staging: " << staging_ns << " ns/write\n";
+  }
+
+  return 0;
+}
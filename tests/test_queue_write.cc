@@ -0,0 +1,220 @@
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "gfx/gfx_queue.h"
+#include "webgpu/webgpu_cpp.hpp"
+
+// Queue writes coalesced until Submit. Overlapping and adjacent writes, with
+// and without small ones recorded inline, must leave the bytes of the latest
+// write; a buffer destroyed before Submit must
+// neither be written nor accept new writes.
+
+namespace {
+
+constexpr uint64_t kBufferSize = 256 * 1024;
+
+uint32_t g_validation_errors = 0;
+
+struct Context {
+  WGPUInstance instance;
+  WGPUDevice device;
+  WGPUQueue queue;
+  WGPUBuffer readback_buffer;
+};
+
+// Writes |value| over [offset, offset + size) of |buffer| and |expected|.
+void Write(const Context& context,
+           WGPUBuffer buffer,
+           std::vector<uint8_t>* expected,
+           uint64_t offset,
+           uint64_t size,
+           uint8_t value) {
+  std::vector<uint8_t> data(size, value);
+  wgpuQueueWriteBuffer(context.queue, buffer, offset, data.data(), size);
+  std::memset(expected->data() + offset, value, size);
+}
+
+// Copies |buffer| to the readback buffer and compares it with |expected|.
+bool CheckContents(const Context& context,
+                   const char* name,
+                   WGPUBuffer buffer,
+                   const std::vector<uint8_t>& expected) {
+  WGPUCommandEncoder encoder =
+      wgpuDeviceCreateCommandEncoder(context.device, nullptr);
+  wgpuCommandEncoderCopyBufferToBuffer(encoder, buffer, 0,
+                                       context.readback_buffer, 0,
+                                       kBufferSize);
+  WGPUCommandBuffer command_buffer =
+      wgpuCommandEncoderFinish(encoder, nullptr);
+  wgpuQueueSubmit(context.queue, 1, &command_buffer);
+  wgpuCommandBufferRelease(command_buffer);
+  wgpuCommandEncoderRelease(encoder);
+
+  WGPUBufferMapCallbackInfo callback_info = {};
+  callback_info.mode = WGPUCallbackMode_WaitAnyOnly;
+  callback_info.callback = [](WGPUMapAsyncStatus status, WGPUStringView,
+                              void* userdata1, void*) {
+    *static_cast<WGPUMapAsyncStatus*>(userdata1) = status;
+  };
+  WGPUMapAsyncStatus map_status = WGPUMapAsyncStatus_Error;
+  callback_info.userdata1 = &map_status;
+
+  WGPUFutureWaitInfo wait_info = {};
+  wait_info.future = wgpuBufferMapAsync(context.readback_buffer,
+                                        WGPUMapMode_Read, 0, kBufferSize,
+                                        callback_info);
+  wgpuInstanceWaitAny(context.instance, 1, &wait_info, UINT64_MAX);
+  if (map_status != WGPUMapAsyncStatus_Success) {
+    std::cout << "[Test] " << name << ": Failed to map the result.\n";
+    return false;
+  }
+
+  const auto* bytes = static_cast<const uint8_t*>(
+      wgpuBufferGetConstMappedRange(context.readback_buffer, 0, kBufferSize));
+  bool match = true;
+  for (uint64_t i = 0; i < kBufferSize; ++i) {
+    if (bytes[i] != expected[i]) {
+      std::cout << "[Test] " << name << ": Byte " << i << " is "
+                << static_cast<uint32_t>(bytes[i]) << ", expected "
+                << static_cast<uint32_t>(expected[i]) << ".\n";
+      match = false;
+      break;
+    }
+  }
+  wgpuBufferUnmap(context.readback_buffer);
+
+  return match;
+}
+
+WGPUBuffer CreateBuffer(const Context& context) {
+  WGPUBufferDescriptor buffer_descriptor = {};
+  buffer_descriptor.usage = WGPUBufferUsage_CopyDst | WGPUBufferUsage_CopySrc;
+  buffer_descriptor.size = kBufferSize;
+  return wgpuDeviceCreateBuffer(context.device, &buffer_descriptor);
+}
+
+}  // namespace
+
+int main() {
+  auto instance = wgpu::CreateInstance(nullptr);
+
+  wgpu::Adapter adapter = nullptr;
+  instance.RequestAdapter(
+      nullptr,
+      {
+          .callback =
+              [](WGPURequestAdapterStatus status, WGPUAdapter adapter,
+                 WGPUStringView message, void* userdata1, void* userdata2) {
+                *reinterpret_cast<wgpu::Adapter*>(userdata1) =
+                    wgpu::Adapter::Acquire(adapter);
+              },
+          .userdata1 = &adapter,
+      });
+
+  // Validation errors are counted, only the rejected write may raise one
+  WGPUDeviceDescriptor device_descriptor = {};
+  device_descriptor.uncapturedErrorCallbackInfo.callback =
+      [](WGPUDevice const* device, WGPUErrorType type, WGPUStringView message,
+         void* userdata1, void* userdata2) {
+        ++g_validation_errors;
+        std::cout << "[Error] " << std::string(message.data, message.length)
+                  << '\n';
+      };
+
+  wgpu::Device device = nullptr;
+  wgpuAdapterRequestDevice(
+      adapter.Get(), &device_descriptor,
+      {
+          .callback =
+              [](WGPURequestDeviceStatus status, WGPUDevice device,
+                 WGPUStringView message, void* userdata1, void* userdata2) {
+                *reinterpret_cast<wgpu::Device*>(userdata1) =
+                    wgpu::Device::Acquire(device);
+              },
+          .userdata1 = &device,
+      });
+
+  if (!device) {
+    std::cout << "[Test] No device.\n";
+    return 1;
+  }
+
+  Context context = {};
+  context.instance = instance.Get();
+  context.device = device.Get();
+  context.queue = wgpuDeviceGetQueue(context.device);
+
+  WGPUBufferDescriptor readback_descriptor = {};
+  readback_descriptor.usage =
+      WGPUBufferUsage_MapRead | WGPUBufferUsage_CopyDst;
+  readback_descriptor.size = kBufferSize;
+  context.readback_buffer =
+      wgpuDeviceCreateBuffer(context.device, &readback_descriptor);
+
+  bool success = true;
+
+  // Later writes win over the bytes they overlap, adjacent ones merge. Run
+  // through staging memory only, then with ranges up to 64 KiB inline.
+  auto* queue_impl = static_cast<vkgfx::GFXQueue*>(context.queue);
+  for (size_t threshold : {size_t(0), vkgfx::GFXQueue::kMaxInlineWriteSize}) {
+    queue_impl->SetInlineWriteThreshold(threshold);
+    WGPUBuffer buffer = CreateBuffer(context);
+    std::vector<uint8_t> expected(kBufferSize);
+    Write(context, buffer, &expected, 0, kBufferSize, 0);
+    Write(context, buffer, &expected, 0, 96 * 1024, 1);
+    Write(context, buffer, &expected, 64 * 1024, 96 * 1024, 2);
+    Write(context, buffer, &expected, 160 * 1024, 4096, 3);
+    Write(context, buffer, &expected, 8, 16, 4);
+    Write(context, buffer, &expected, 24, 8, 5);
+    Write(context, buffer, &expected, 160 * 1024 - 4, 8, 6);
+    Write(context, buffer, &expected, 200 * 1024, 256, 7);
+    Write(context, buffer, &expected, 200 * 1024 + 256, 256, 8);
+    Write(context, buffer, &expected, 200 * 1024 + 128, 256, 9);
+    success &= CheckContents(context, "Overlapping writes", buffer, expected);
+
+    // Again after a Submit, on top of the first contents
+    Write(context, buffer, &expected, 32 * 1024, 128 * 1024, 10);
+    Write(context, buffer, &expected, 0, 64, 11);
+    success &= CheckContents(context, "Rewrites", buffer, expected);
+    wgpuBufferRelease(buffer);
+  }
+  queue_impl->SetInlineWriteThreshold(0);
+
+  // Writes to a buffer destroyed before Submit are dropped
+  {
+    WGPUBuffer buffer = CreateBuffer(context);
+    std::vector<uint8_t> expected(kBufferSize);
+    Write(context, buffer, &expected, 0, 128 * 1024, 1);
+    Write(context, buffer, &expected, 0, 64, 2);
+    wgpuBufferDestroy(buffer);
+    wgpuQueueSubmit(context.queue, 0, nullptr);
+
+    // Rejected with a validation error
+    Write(context, buffer, &expected, 0, 64, 3);
+    wgpuQueueSubmit(context.queue, 0, nullptr);
+    wgpuBufferRelease(buffer);
+
+    if (g_validation_errors != 1) {
+      std::cout << "[Test] Write to a destroyed buffer: "
+                << g_validation_errors << " errors, expected 1.\n";
+      success = false;
+    }
+    g_validation_errors = 0;
+
+    // The queue still works afterwards
+    WGPUBuffer other_buffer = CreateBuffer(context);
+    Write(context, other_buffer, &expected, 0, kBufferSize, 0);
+    Write(context, other_buffer, &expected, 4096, 4096, 12);
+    success &=
+        CheckContents(context, "Write after destroy", other_buffer, expected);
+    wgpuBufferRelease(other_buffer);
+  }
+
+  wgpuBufferRelease(context.readback_buffer);
+  wgpuQueueRelease(context.queue);
+
+  std::cout << "[Test] " << g_validation_errors << " validation errors.\n";
+  return success && !g_validation_errors ? 0 : 1;
+}
@@ -0,0 +1,366 @@
+#include <array>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include "gfx/gfx_instance.h"
+#include "webgpu/webgpu_cpp.hpp"
+
+// Texture hazard tracking through bind groups. A compute shader fetches every
+// texel of a texture into a storage buffer, first after a queue upload and
+// then after a render pass cleared the texture, and the results are read back
+// through a mapped buffer. Meant to run on lavapipe with synchronization
+// validation, e.g. VK_DRIVER_FILES=lvp_icd.x86_64.json: any validation error
+// or wrong texel fails the test.
+
+namespace {
+
+constexpr uint32_t kTextureSize = 4;
+constexpr uint32_t kTexelCount = kTextureSize * kTextureSize;
+constexpr uint64_t kResultSize = kTexelCount * 4 * sizeof(float);
+
+// layout(local_size_x = 1) in;
+// layout(set = 0, binding = 0) uniform texture2D source;
+// layout(set = 0, binding = 1) buffer Result { vec4 texels[]; };
+// void main() {
+//   uvec2 id = gl_GlobalInvocationID.xy;
+//   texels[id.y * 4 + id.x] = texelFetch(source, ivec2(id), 0);
+// }
+constexpr uint32_t kFetchShader[] = {
+    0x07230203, 0x00010000, 0x00000000, 0x00000022, 0x00000000, 0x00020011,
+    0x00000001, 0x0003000e, 0x00000000, 0x00000001, 0x0006000f, 0x00000005,
+    0x00000001, 0x6e69616d, 0x00000000, 0x00000002, 0x00060010, 0x00000001,
+    0x00000011, 0x00000001, 0x00000001, 0x00000001, 0x00040047, 0x00000002,
+    0x0000000b, 0x0000001c, 0x00040047, 0x00000003, 0x00000022, 0x00000000,
+    0x00040047, 0x00000003, 0x00000021, 0x00000000, 0x00040047, 0x00000004,
+    0x00000022, 0x00000000, 0x00040047, 0x00000004, 0x00000021, 0x00000001,
+    0x00040047, 0x00000005, 0x00000006, 0x00000010, 0x00050048, 0x00000006,
+    0x00000000, 0x00000023, 0x00000000, 0x00030047, 0x00000006, 0x00000003,
+    0x00020013, 0x00000007, 0x00030021, 0x00000008, 0x00000007, 0x00040015,
+    0x00000009, 0x00000020, 0x00000000, 0x00040015, 0x0000000a, 0x00000020,
+    0x00000001, 0x00030016, 0x0000000b, 0x00000020, 0x00040017, 0x0000000c,
+    0x00000009, 0x00000003, 0x00040017, 0x0000000d, 0x0000000a, 0x00000002,
+    0x00040017, 0x0000000e, 0x0000000b, 0x00000004, 0x00040020, 0x0000000f,
+    0x00000001, 0x0000000c, 0x0004003b, 0x0000000f, 0x00000002, 0x00000001,
+    0x00090019, 0x00000010, 0x0000000b, 0x00000001, 0x00000000, 0x00000000,
+    0x00000000, 0x00000001, 0x00000000, 0x00040020, 0x00000011, 0x00000000,
+    0x00000010, 0x0004003b, 0x00000011, 0x00000003, 0x00000000, 0x0003001d,
+    0x00000005, 0x0000000e, 0x0003001e, 0x00000006, 0x00000005, 0x00040020,
+    0x00000012, 0x00000002, 0x00000006, 0x0004003b, 0x00000012, 0x00000004,
+    0x00000002, 0x00040020, 0x00000013, 0x00000002, 0x0000000e, 0x0004002b,
+    0x0000000a, 0x00000014, 0x00000000, 0x0004002b, 0x00000009, 0x00000015,
+    0x00000004, 0x00050036, 0x00000007, 0x00000001, 0x00000000, 0x00000008,
+    0x000200f8, 0x00000016, 0x0004003d, 0x0000000c, 0x00000017, 0x00000002,
+    0x00050051, 0x00000009, 0x00000018, 0x00000017, 0x00000000, 0x00050051,
+    0x00000009, 0x00000019, 0x00000017, 0x00000001, 0x0004007c, 0x0000000a,
+    0x0000001a, 0x00000018, 0x0004007c, 0x0000000a, 0x0000001b, 0x00000019,
+    0x00050050, 0x0000000d, 0x0000001c, 0x0000001a, 0x0000001b, 0x0004003d,
+    0x00000010, 0x0000001d, 0x00000003, 0x0007005f, 0x0000000e, 0x0000001e,
+    0x0000001d, 0x0000001c, 0x00000002, 0x00000014, 0x00050084, 0x00000009,
+    0x0000001f, 0x00000019, 0x00000015, 0x00050080, 0x00000009, 0x00000020,
+    0x0000001f, 0x00000018, 0x00060041, 0x00000013, 0x00000021, 0x00000004,
+    0x00000014, 0x00000020, 0x0003003e, 0x00000021, 0x0000001e, 0x000100fd,
+    0x00010038,
+};
+
+uint32_t g_validation_errors = 0;
+
+VKAPI_ATTR VkBool32 VKAPI_CALL OnValidationMessage(
+    VkDebugUtilsMessageSeverityFlagBitsEXT messageSeverity,
+    VkDebugUtilsMessageTypeFlagsEXT messageTypes,
+    const VkDebugUtilsMessengerCallbackDataEXT* pCallbackData,
+    void* pUserData) {
+  ++g_validation_errors;
+  std::cout << "[Validation] " << pCallbackData->pMessage << '\n';
+  return VK_FALSE;
+}
+
+struct Context {
+  WGPUInstance instance;
+  WGPUDevice device;
+  WGPUQueue queue;
+  WGPUBindGroupLayout bind_group_layout;
+  WGPUComputePipeline pipeline;
+  WGPUBuffer result_buffer;
+  WGPUBuffer readback_buffer;
+};
+
+// Records the fetch of every texel of |view| and the copy of the result to
+// the readback buffer into |encoder|.
+void EncodeFetch(const Context& context,
+                 WGPUCommandEncoder encoder,
+                 WGPUTextureView view) {
+  std::array<WGPUBindGroupEntry, 2> entries = {};
+  entries[0].binding = 0;
+  entries[0].textureView = view;
+  entries[1].binding = 1;
+  entries[1].buffer = context.result_buffer;
+  entries[1].size = kResultSize;
+
+  WGPUBindGroupDescriptor bind_group_descriptor = {};
+  bind_group_descriptor.layout = context.bind_group_layout;
+  bind_group_descriptor.entryCount = entries.size();
+  bind_group_descriptor.entries = entries.data();
+  WGPUBindGroup bind_group =
+      wgpuDeviceCreateBindGroup(context.device, &bind_group_descriptor);
+
+  WGPUComputePassEncoder pass =
+      wgpuCommandEncoderBeginComputePass(encoder, nullptr);
+  wgpuComputePassEncoderSetPipeline(pass, context.pipeline);
+  wgpuComputePassEncoderSetBindGroup(pass, 0, bind_group, 0, nullptr);
+  wgpuComputePassEncoderDispatchWorkgroups(pass, kTextureSize, kTextureSize,
+                                           1);
+  wgpuComputePassEncoderEnd(pass);
+  wgpuComputePassEncoderRelease(pass);
+
+  // Released right away, the command buffer keeps it alive
+  wgpuBindGroupRelease(bind_group);
+
+  wgpuCommandEncoderCopyBufferToBuffer(encoder, context.result_buffer, 0,
+                                       context.readback_buffer, 0,
+                                       kResultSize);
+}
+
+void Submit(const Context& context, WGPUCommandEncoder encoder) {
+  WGPUCommandBuffer command_buffer =
+      wgpuCommandEncoderFinish(encoder, nullptr);
+  wgpuQueueSubmit(context.queue, 1, &command_buffer);
+  wgpuCommandBufferRelease(command_buffer);
+  wgpuCommandEncoderRelease(encoder);
+}
+
+// Maps the readback buffer and compares each texel with |expected|.
+bool CheckResult(const Context& context,
+                 const char* name,
+                 const std::vector<float>& expected) {
+  WGPUBufferMapCallbackInfo callback_info = {};
+  callback_info.mode = WGPUCallbackMode_WaitAnyOnly;
+  callback_info.callback = [](WGPUMapAsyncStatus status, WGPUStringView,
+                              void* userdata1, void*) {
+    *static_cast<WGPUMapAsyncStatus*>(userdata1) = status;
+  };
+  WGPUMapAsyncStatus map_status = WGPUMapAsyncStatus_Error;
+  callback_info.userdata1 = &map_status;
+
+  WGPUFutureWaitInfo wait_info = {};
+  wait_info.future = wgpuBufferMapAsync(context.readback_buffer,
+                                        WGPUMapMode_Read, 0, kResultSize,
+                                        callback_info);
+  wgpuInstanceWaitAny(context.instance, 1, &wait_info, UINT64_MAX);
+  if (map_status != WGPUMapAsyncStatus_Success) {
+    std::cout << "[Test] " << name << ": Failed to map the result.\n";
+    return false;
+  }
+
+  const auto* texels = static_cast<const float*>(
+      wgpuBufferGetConstMappedRange(context.readback_buffer, 0, kResultSize));
+  bool match = true;
+  for (size_t i = 0; i < expected.size(); ++i) {
+    if (std::fabs(texels[i] - expected[i]) > 1.0f / 255.0f) {
+      std::cout << "[Test] " << name << ": Component " << i << " is "
+                << texels[i] << ", expected " << expected[i] << ".\n";
+      match = false;
+      break;
+    }
+  }
+  wgpuBufferUnmap(context.readback_buffer);
+
+  return match;
+}
+
+}  // namespace
+
+int main() {
+  // Synchronization validation reports missing or wrong barriers
+#if defined(_WIN32)
+  _putenv_s("VK_LAYER_ENABLES",
+            "VK_VALIDATION_FEATURE_ENABLE_SYNCHRONIZATION_VALIDATION_EXT");
+#else
+  setenv("VK_LAYER_ENABLES",
+         "VK_VALIDATION_FEATURE_ENABLE_SYNCHRONIZATION_VALIDATION_EXT", 1);
+#endif
+
+  auto instance = wgpu::CreateInstance(nullptr);
+
+  wgpu::Adapter adapter = nullptr;
+  instance.RequestAdapter(
+      nullptr,
+      {
+          .callback =
+              [](WGPURequestAdapterStatus status, WGPUAdapter adapter,
+                 WGPUStringView message, void* userdata1, void* userdata2) {
+                *reinterpret_cast<wgpu::Adapter*>(userdata1) =
+                    wgpu::Adapter::Acquire(adapter);
+              },
+          .userdata1 = &adapter,
+      });
+
+  wgpu::Device device = nullptr;
+  adapter.RequestDevice(
+      nullptr,
+      {
+          .callback =
+              [](WGPURequestDeviceStatus status, WGPUDevice device,
+                 WGPUStringView message, void* userdata1, void* userdata2) {
+                *reinterpret_cast<wgpu::Device*>(userdata1) =
+                    wgpu::Device::Acquire(device);
+              },
+          .userdata1 = &device,
+      });
+
+  if (!device) {
+    std::cout << "[Test] No device.\n";
+    return 1;
+  }
+
+  auto* instance_impl = static_cast<vkgfx::GFXInstance*>(instance.Get());
+  VkDebugUtilsMessengerCreateInfoEXT messenger_info = {
+      VK_STRUCTURE_TYPE_DEBUG_UTILS_MESSENGER_CREATE_INFO_EXT};
+  messenger_info.messageSeverity =
+      VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT;
+  messenger_info.messageType = VK_DEBUG_UTILS_MESSAGE_TYPE_VALIDATION_BIT_EXT;
+  messenger_info.pfnUserCallback = OnValidationMessage;
+  VkDebugUtilsMessengerEXT messenger = VK_NULL_HANDLE;
+  vkCreateDebugUtilsMessengerEXT(instance_impl->GetVkHandle(),
+                                 &messenger_info, nullptr, &messenger);
+
+  Context context = {};
+  context.instance = instance.Get();
+  context.device = device.Get();
+  context.queue = wgpuDeviceGetQueue(context.device);
+
+  WGPUShaderSourceSPIRV spirv_source = {};
+  spirv_source.chain.sType = WGPUSType_ShaderSourceSPIRV;
+  spirv_source.codeSize = sizeof(kFetchShader) / sizeof(uint32_t);
+  spirv_source.code = kFetchShader;
+  WGPUShaderModuleDescriptor module_descriptor = {};
+  module_descriptor.nextInChain = &spirv_source.chain;
+  WGPUShaderModule module =
+      wgpuDeviceCreateShaderModule(context.device, &module_descriptor);
+
+  std::array<WGPUBindGroupLayoutEntry, 2> layout_entries = {};
+  layout_entries[0].binding = 0;
+  layout_entries[0].visibility = WGPUShaderStage_Compute;
+  layout_entries[0].texture.sampleType = WGPUTextureSampleType_Float;
+  layout_entries[0].texture.viewDimension = WGPUTextureViewDimension_2D;
+  layout_entries[1].binding = 1;
+  layout_entries[1].visibility = WGPUShaderStage_Compute;
+  layout_entries[1].buffer.type = WGPUBufferBindingType_Storage;
+
+  WGPUBindGroupLayoutDescriptor layout_descriptor = {};
+  layout_descriptor.entryCount = layout_entries.size();
+  layout_descriptor.entries = layout_entries.data();
+  context.bind_group_layout =
+      wgpuDeviceCreateBindGroupLayout(context.device, &layout_descriptor);
+
+  WGPUPipelineLayoutDescriptor pipeline_layout_descriptor = {};
+  pipeline_layout_descriptor.bindGroupLayoutCount = 1;
+  pipeline_layout_descriptor.bindGroupLayouts = &context.bind_group_layout;
+  WGPUPipelineLayout pipeline_layout = wgpuDeviceCreatePipelineLayout(
+      context.device, &pipeline_layout_descriptor);
+
+  WGPUComputePipelineDescriptor pipeline_descriptor = {};
+  pipeline_descriptor.layout = pipeline_layout;
+  pipeline_descriptor.compute.module = module;
+  pipeline_descriptor.compute.entryPoint = {"main", WGPU_STRLEN};
+  context.pipeline =
+      wgpuDeviceCreateComputePipeline(context.device, &pipeline_descriptor);
+
+  WGPUBufferDescriptor buffer_descriptor = {};
+  buffer_descriptor.usage = WGPUBufferUsage_Storage | WGPUBufferUsage_CopySrc;
+  buffer_descriptor.size = kResultSize;
+  context.result_buffer =
+      wgpuDeviceCreateBuffer(context.device, &buffer_descriptor);
+  buffer_descriptor.usage = WGPUBufferUsage_MapRead | WGPUBufferUsage_CopyDst;
+  context.readback_buffer =
+      wgpuDeviceCreateBuffer(context.device, &buffer_descriptor);
+
+  WGPUTextureDescriptor texture_descriptor = {};
+  texture_descriptor.usage = WGPUTextureUsage_TextureBinding |
+                             WGPUTextureUsage_CopyDst |
+                             WGPUTextureUsage_RenderAttachment;
+  texture_descriptor.dimension = WGPUTextureDimension_2D;
+  texture_descriptor.size = {kTextureSize, kTextureSize, 1};
+  texture_descriptor.format = WGPUTextureFormat_RGBA8Unorm;
+  texture_descriptor.mipLevelCount = 1;
+  texture_descriptor.sampleCount = 1;
+  WGPUTexture texture =
+      wgpuDeviceCreateTexture(context.device, &texture_descriptor);
+  WGPUTextureView view = wgpuTextureCreateView(texture, nullptr);
+
+  bool success = true;
+
+  // Upload then sample: the texture leaves WriteTexture in a transfer layout
+  {
+    std::vector<uint8_t> pixels(kTexelCount * 4);
+    std::vector<float> expected(kTexelCount * 4);
+    for (uint32_t i = 0; i < kTexelCount; ++i) {
+      const uint8_t texel[4] = {static_cast<uint8_t>(i * 16),
+                                static_cast<uint8_t>(255 - i * 16), 0, 255};
+      for (uint32_t c = 0; c < 4; ++c) {
+        pixels[i * 4 + c] = texel[c];
+        expected[i * 4 + c] = texel[c] / 255.0f;
+      }
+    }
+
+    WGPUTexelCopyTextureInfo destination = {};
+    destination.texture = texture;
+    WGPUTexelCopyBufferLayout data_layout = {};
+    data_layout.bytesPerRow = kTextureSize * 4;
+    data_layout.rowsPerImage = kTextureSize;
+    WGPUExtent3D write_size = {kTextureSize, kTextureSize, 1};
+    wgpuQueueWriteTexture(context.queue, &destination, pixels.data(),
+                          pixels.size(), &data_layout, &write_size);
+
+    WGPUCommandEncoder encoder =
+        wgpuDeviceCreateCommandEncoder(context.device, nullptr);
+    EncodeFetch(context, encoder, view);
+    Submit(context, encoder);
+    success &= CheckResult(context, "Upload then sample", expected);
+  }
+
+  // Render then sample: the pass leaves a color attachment layout
+  {
+    WGPURenderPassColorAttachment color_attachment = {};
+    color_attachment.view = view;
+    color_attachment.depthSlice = WGPU_DEPTH_SLICE_UNDEFINED;
+    color_attachment.loadOp = WGPULoadOp_Clear;
+    color_attachment.storeOp = WGPUStoreOp_Store;
+    color_attachment.clearValue = {0.0, 1.0, 0.0, 1.0};
+    WGPURenderPassDescriptor pass_descriptor = {};
+    pass_descriptor.colorAttachmentCount = 1;
+    pass_descriptor.colorAttachments = &color_attachment;
+
+    WGPUCommandEncoder encoder =
+        wgpuDeviceCreateCommandEncoder(context.device, nullptr);
+    WGPURenderPassEncoder pass =
+        wgpuCommandEncoderBeginRenderPass(encoder, &pass_descriptor);
+    wgpuRenderPassEncoderEnd(pass);
+    wgpuRenderPassEncoderRelease(pass);
+    EncodeFetch(context, encoder, view);
+    Submit(context, encoder);
+
+    std::vector<float> expected;
+    for (uint32_t i = 0; i < kTexelCount; ++i)
+      expected.insert(expected.end(), {0.0f, 1.0f, 0.0f, 1.0f});
+    success &= CheckResult(context, "Render then sample", expected);
+  }
+
+  wgpuTextureViewRelease(view);
+  wgpuTextureRelease(texture);
+  wgpuBufferRelease(context.readback_buffer);
+  wgpuBufferRelease(context.result_buffer);
+  wgpuComputePipelineRelease(context.pipeline);
+  wgpuPipelineLayoutRelease(pipeline_layout);
+  wgpuBindGroupLayoutRelease(context.bind_group_layout);
+  wgpuShaderModuleRelease(module);
+  wgpuQueueRelease(context.queue);
+
+  if (messenger)
+    vkDestroyDebugUtilsMessengerEXT(instance_impl->GetVkHandle(), messenger,
+                                    nullptr);
+
+  std::cout << "[Test] " << g_validation_errors << " validation errors.\n";
+  return success && !g_validation_errors ? 0 : 1;
+}